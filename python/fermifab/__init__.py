@@ -6,10 +6,21 @@ FermiFab toolbox for fermionic many-particle quantum systems.
 
 """
 
-from .fermistate      import *
-from .fermiop         import *
-from .rdm             import *
-from .p2N             import *
-from .tensor_op       import *
-from .repr_conditions import *
-from .util            import *
+from .fermistate       import *
+from .sparse_state     import *
+from .excitation_graph import *
+from .restricted       import *
+from .config_union     import *
+from .fermiop          import *
+from .rdm              import *
+from .p2N              import *
+from .tensor_op        import *
+from .slater           import *
+from .boson            import *
+from .string_ci        import *
+from .integrals        import *
+from .selected_ci      import *
+from .symmetry         import *
+from .transform        import *
+from .repr_conditions  import *
+from .util             import *
@@ -0,0 +1,171 @@
+import numpy as np
+from scipy.special import comb
+from scipy.sparse.linalg import LinearOperator
+from .rdm import kernel_matrices
+import fermifab.kernel
+
+__all__ = ['boson_dim', 'boson_rank', 'boson_unrank', 'boson_encode', 'boson_decode', 'boson_tensor_op',
+           'boson_rdm_kernel', 'boson_rdm', 'boson_p2N']
+
+
+def boson_dim(modes, N):
+    """
+    Dimension of the bosonic space of N particles in `modes` modes,
+    i.e., the number of occupation number vectors.
+    """
+    return comb(modes + N - 1, N, exact=True)
+
+
+def boson_rank(occ):
+    """
+    Calculate the base indices of bosonic occupation number vectors
+    with respect to the ordered bosonic basis.
+
+    The ordering agrees with the lexicographically ordered fermionic basis
+    of N particles in `modes + N - 1` orbitals ("stars and bars"),
+    and the ranking requires only O(modes) operations, without storing the basis.
+
+    Args:
+        occ: occupation numbers, either a vector of length `modes` or
+             a matrix with one occupation number vector per row (same particle number in each row)
+
+    Returns:
+        base index or vector of base indices
+    """
+    occ = np.asarray(occ, dtype=np.intc)
+    if occ.ndim == 1:
+        return fermifab.kernel.boson_rank(occ.reshape((1, -1)))[0]
+    return fermifab.kernel.boson_rank(occ)
+
+
+def boson_unrank(modes, N, r):
+    """
+    Calculate the bosonic occupation number vectors of base indices,
+    inverse of `boson_rank`.
+
+    Args:
+        modes: number of modes
+        N:     number of particles
+        r:     base index or vector of base indices
+
+    Returns:
+        numpy.ndarray: occupation number vector or matrix with one occupation number vector per row
+    """
+    if np.ndim(r) == 0:
+        return fermifab.kernel.boson_unrank(modes, N, np.array([r], dtype=np.int64))[0]
+    return fermifab.kernel.boson_unrank(modes, N, np.asarray(r, dtype=np.int64))
+
+
+def boson_encode(occ):
+    """
+    Encode bosonic occupation number vectors as bit patterns stored in (possibly several) 64-bit words,
+    with `occ[m]` 1-bits for mode `m` followed by a 0-bit as separator, such that the
+    particle number is not restricted by the word size.
+
+    Args:
+        occ: occupation numbers, matrix with one occupation number vector per row
+
+    Returns:
+        numpy.ndarray: matrix of type uint64, with the words of one bit pattern per row (least significant word first)
+    """
+    return fermifab.kernel.boson_encode(np.atleast_2d(np.asarray(occ, dtype=np.intc)))
+
+
+def boson_decode(modes, w):
+    """
+    Decode bit patterns generated by `boson_encode` into occupation number vectors.
+    """
+    return fermifab.kernel.boson_decode(modes, np.atleast_2d(np.asarray(w, dtype=np.uint64)))
+
+
+def boson_tensor_op(A, N):
+    """
+    Calculate the matrix representation of the N-fold symmetric tensor product of a one-body operator
+    on the bosonic N-particle space, i.e., the operator :math:`A \\otimes \\cdots \\otimes A` restricted to
+    symmetric states, with respect to the normalized occupation number basis ordered as in `boson_rank`.
+
+    The entries are permanents of submatrices of `A` with rows and columns repeated according to the
+    occupation numbers, divided by :math:`\\sqrt{\\prod_m n_m! \\prod_m n'_m!}`.
+
+    Args:
+        A: one-body operator, square matrix of dimension `modes x modes`
+        N: number of particles
+
+    Returns:
+        numpy.ndarray: N-fold symmetric tensor product
+    """
+    return fermifab.kernel.tensor_op_boson(np.asarray(A), N)
+
+
+def boson_rdm_kernel(modes, p, N1, N2=None):
+    """
+    Generate the kernel K (as array of sparse matrices) required for calculating
+    bosonic p-body reduced density matrices, with K[I][J] the operator
+    :math:`B_J^\\dagger B_I` mapping the N2- to the N1-particle space, where
+    :math:`B_I = \\prod_m b_m^{i_m} / \\sqrt{\\prod_m i_m!}`.
+    """
+    if N2 is None:
+        N2 = N1
+    return kernel_matrices(*fermifab.kernel.gen_rdm_boson(modes, p, N1, N2))
+
+
+def boson_rdm(psi, modes, N, p, use_kernel=False):
+    """
+    Calculate the p-body reduced density matrix :math:`G_{IJ} = \\langle\\psi | B_J^\\dagger B_I \\psi\\rangle`
+    of a bosonic N-particle state, with respect to the normalized occupation number basis.
+
+    Args:
+        psi:        state vector w.r.t. the ordered occupation number basis
+        modes:      number of modes
+        N:          number of particles
+        p:          target particle number
+        use_kernel: whether to evaluate via the sparse kernel tensor (optional);
+                    by default, the RDM is computed directly from `psi`
+
+    Returns:
+        numpy.ndarray: reduced density matrix, with trace `Binomial(N, p)` for normalized `psi`
+    """
+    psi = np.asarray(psi)
+    if use_kernel:
+        K = boson_rdm_kernel(modes, p, N)
+        G = np.array([[np.vdot(psi, K[i][j] @ psi) for j in range(len(K[0]))] for i in range(len(K))])
+    else:
+        G = fermifab.kernel.boson_rdm(modes, p, N, psi)
+    if np.isrealobj(psi):
+        G = G.real
+    return G
+
+
+def boson_p2N(h, modes, p, N, matrix_free=False):
+    """
+    Calculate the bosonic N-body operator generated from the p-body operator `h`,
+    :math:`H = \\sum_{IJ} h_{IJ} B_I^\\dagger B_J`.
+
+    Args:
+        h:           p-body operator, square matrix w.r.t. the ordered occupation number basis
+        modes:       number of modes
+        p:           particle number of `h`
+        N:           target particle number
+        matrix_free: whether to return a `scipy.sparse.linalg.LinearOperator` which applies `H`
+                     without constructing it (optional)
+
+    Returns:
+        N-body operator generated from `h`, as numpy.ndarray or LinearOperator
+    """
+    h = np.asarray(h)
+    dim = boson_dim(modes, N)
+    if matrix_free:
+        dtype = np.result_type(h.dtype, float)
+        def matvec(psi):
+            out = fermifab.kernel.boson_p2N_apply(modes, p, N, h, np.asarray(psi).reshape(-1))
+            if np.isrealobj(h) and np.isrealobj(psi):
+                out = out.real
+            return out
+        return LinearOperator((dim, dim), matvec=matvec, dtype=dtype)
+    K = boson_rdm_kernel(modes, p, N)
+    H = np.zeros((dim, dim), dtype=np.result_type(h.dtype, float))
+    for i in range(len(K)):
+        for j in range(len(K[0])):
+            if h[i, j] != 0:
+                H += h[i, j] * K[j][i].toarray()
+    return H
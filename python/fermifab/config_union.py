@@ -0,0 +1,89 @@
+import numpy as np
+from .fermiop import FermiOp
+from .rdm import kernel_expectation, kernel_operator
+import fermifab.kernel
+
+__all__ = ['gen_config', 'ConfigUnion']
+
+
+def gen_config(nc, N, maxC=None):
+    """
+    Enumerate all configurations of `N` particles in `nc` slots,
+    such that not more than `maxC[i]` particles are in slot `i`.
+
+    Example:
+        gen_config(3, 2, [2, 2, 1]) ->
+            [[2, 0, 0], [1, 1, 0], [0, 2, 0], [1, 0, 1], [0, 1, 1]]
+
+    Returns:
+        numpy.ndarray: one configuration per row
+    """
+    if maxC is not None:
+        maxC = np.asarray(maxC, dtype=np.intc)
+    return fermifab.kernel.gen_config(nc, N, maxC)
+
+
+class ConfigUnion(object):
+
+    def __init__(self, orbs, configs):
+        """
+        Basis given by the union of several configurations (particle numbers per partition)
+        with equal total particle number, e.g., the output of `gen_config`.
+
+        The Slater determinants of the first configuration come first, followed by those
+        of the second configuration and so on; the orbitals of all partitions are numbered consecutively.
+
+        Args:
+            orbs:    list of numbers of orbitals per partition
+            configs: list of configurations, one per row
+        """
+        self.orbs = np.asarray(orbs, dtype=np.intc).reshape(-1)
+        self.configs = np.asarray(configs, dtype=np.intc).reshape(-1, len(self.orbs))
+        self.dets, self.offsets = fermifab.kernel.union_map(self.orbs, self.configs)
+
+    @property
+    def norbs(self):
+        """Total number of orbitals."""
+        return int(np.sum(self.orbs))
+
+    @property
+    def N(self):
+        """Total number of particles."""
+        return int(np.sum(self.configs[0])) if len(self.configs) > 0 else 0
+
+    def __len__(self):
+        return len(self.dets)
+
+    def sector(self, s):
+        """Range of base indices of configuration `s`."""
+        return slice(self.offsets[s], self.offsets[s+1])
+
+    def index(self, dets):
+        """Indices of bit-encoded Slater determinants within the union, or -1 if not contained."""
+        return fermifab.kernel.union_index(self.orbs, self.configs, np.asarray(dets, dtype=np.uint64))
+
+    def embedding(self):
+        """Base indices of the Slater determinants with respect to the Slater basis of all orbitals."""
+        return fermifab.kernel.fermi_index(self.dets)
+
+    def rdm(self, psi, p):
+        """
+        Calculate the p-body reduced density matrix (with respect to all orbitals) of a state
+        given by its coefficients `psi` in the union basis, covering all configurations in a single kernel call.
+        """
+        psi = np.asarray(psi).reshape(-1)
+        assert len(psi) == len(self)
+        dims, val, ind = fermifab.kernel.gen_rdm_union(self.orbs, p, self.configs, self.configs)
+        return FermiOp(self.norbs, p, p, data=kernel_expectation(dims, val, ind, psi))
+
+    def p2N(self, h):
+        """
+        N-body operator :math:`H = \\sum_{ij} h_{ij} \\, a^\\dagger_i a_j` generated from the p-body operator `h`
+        (with respect to all orbitals), projected onto the union basis.
+
+        Returns:
+            scipy.sparse.csr_matrix: operator w.r.t. the union basis
+        """
+        assert type(h) == FermiOp and h.orbs == self.norbs and h.pFrom == h.pTo
+        dims, val, ind = fermifab.kernel.gen_rdm_union(self.orbs, h.pFrom, self.configs, self.configs)
+        return kernel_operator(dims, val, ind, h.data)
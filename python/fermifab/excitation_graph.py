@@ -0,0 +1,92 @@
+import numpy as np
+from scipy.sparse.linalg import LinearOperator
+from .fermistate import FermiState
+from .fermiop import FermiOp
+import fermifab.kernel
+
+__all__ = ['ExcitationGraph']
+
+
+class ExcitationGraph(object):
+
+    def __init__(self, orbs, N, level=2):
+        """
+        Precompute the compressed graphs of single and (if `level` is 2) double excitations
+        connecting the Slater determinants of a configuration, for repeated evaluation
+        of reduced density matrices and operator applications.
+
+        Each row lists the target determinants (delta-encoded base indices), excitation signs
+        and created and annihilated orbitals. The excitations conserve the particle number
+        of each partition; the orbitals of all partitions are numbered consecutively.
+
+        Args:
+            orbs:  number of orbitals, or list of numbers of orbitals per partition
+            N:     number of particles, or list of numbers of particles per partition
+            level: maximum excitation level, 1 or 2 (optional)
+        """
+        if not hasattr(orbs, '__len__'): orbs = (orbs,)
+        if not hasattr(N,    '__len__'): N    = (N,)
+        assert len(orbs) == len(N)
+        assert level in (1, 2)
+        self.orbs = tuple(orbs)
+        self.N = tuple(N)
+        self.level = level
+        # capsule owning the graphs and the Slater determinants, and read-only views (offset, data) of the graphs
+        self._capsule, self.singles, self.doubles = fermifab.kernel.excitation_graph(self.orbs, self.N, level)
+
+    @property
+    def norbs(self):
+        """Total number of orbitals."""
+        return sum(self.orbs)
+
+    def __len__(self):
+        return len(self.singles[0]) - 1
+
+    @property
+    def nbytes(self):
+        """Memory size of the encoded graphs in bytes."""
+        return sum(g[0].nbytes + g[1].nbytes for g in (self.singles, self.doubles) if g is not None)
+
+    def _state_data(self, psi):
+        if type(psi) == FermiState:
+            assert len(self.orbs) == 1 and psi.orbs == self.orbs[0] and psi.N == self.N[0]
+            psi = psi.data
+        psi = np.asarray(psi).reshape(-1)
+        assert len(psi) == len(self)
+        return psi
+
+    def rdm(self, psi, p):
+        """
+        Calculate the p-body reduced density matrix (p <= level) of a state vector,
+        with respect to the orbitals of all partitions.
+        """
+        assert p <= self.level
+        psi = self._state_data(psi)
+        G = fermifab.kernel.excitation_graph_rdm(self._capsule, p, psi)
+        if np.isrealobj(psi):
+            G = G.real
+        return FermiOp(self.norbs, p, p, data=G)
+
+    def apply(self, h, psi):
+        """
+        Apply the N-body operator generated from the p-body operator `h` (p <= level),
+        :math:`H = \\sum_{ij} h_{ij} \\, a^\\dagger_i a_j` (same convention as `p2N`), to a state vector.
+        """
+        assert type(h) == FermiOp and h.orbs == self.norbs and h.pFrom == h.pTo and h.pFrom <= self.level
+        is_state = (type(psi) == FermiState)
+        psi = self._state_data(psi)
+        out = fermifab.kernel.excitation_graph_apply(self._capsule, h.pFrom, h.data, psi)
+        if np.isrealobj(h.data) and np.isrealobj(psi):
+            out = out.real
+        if is_state:
+            return FermiState(self.orbs[0], self.N[0], data=out)
+        return out
+
+    def p2N(self, h):
+        """
+        N-body operator generated from the p-body operator `h` as matrix-free
+        `scipy.sparse.linalg.LinearOperator`, e.g., for use with iterative eigensolvers.
+        """
+        dim = len(self)
+        dtype = np.result_type(h.data.dtype, float)
+        return LinearOperator((dim, dim), matvec=lambda psi: self.apply(h, psi), dtype=dtype)
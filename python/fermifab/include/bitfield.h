@@ -76,6 +76,19 @@ static inline bitfield_t LastBit(const bitfield_t x)
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Count the number of trailing 0-bits in 'x', i.e., the position of the last 1-bit (x must be non-zero)
+///
+/// Equivalent to the 'TZCNT' instruction (count trailing zeros)
+///
+static inline int BitTrailingZeros(const bitfield_t x)
+{
+	assert(x != 0);
+	return BitCount(LastBit(x) - 1);
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Sets trailing zeros to 1
@@ -86,3 +99,33 @@ static inline bitfield_t BitTrailFill(const bitfield_t x)
 {
 	return x | (x - 1);  // e.g., ...011100_2 -> ...011111_2
 }
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Distribute bits in 'x' to locations specified by 1s in 'k',
+/// assuming that BitLength(x) <= BitCount(k)
+///
+/// Equivalent to the 'PDEP' instruction (parallel bits deposit)
+///
+static inline bitfield_t BitDistribute(const bitfield_t x, const bitfield_t k)
+{
+	// local copies
+	bitfield_t y = x;
+	bitfield_t m = k;
+
+	bitfield_t d = 0;
+	while (y)
+	{
+		bitfield_t t = LastBit(m);
+		assert(m != 0);
+
+		d |= (y & 1)*t;
+
+		// remove current bit
+		m -= t;
+		y >>= 1;
+	}
+
+	return d;
+}
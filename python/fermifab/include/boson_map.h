@@ -1,7 +1,7 @@
 /// \file boson_map.h
 /// \brief Map between bit field representations of bosonic occupations and coordinate lists.
 //
-//  Copyright (c) 2008-2015, Christian B. Mendl
+//  Copyright (c) 2008-2020, Christian B. Mendl
 //  All rights reserved.
 //  http://christian.mendl.net
 //
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "bitfield.h"
+#include <stdint.h>
 
 
 //________________________________________________________________________________________________________________________
@@ -36,20 +37,42 @@ bitfield_t BosonEncode(const boson_coords_t *x, const int N);
 void BosonDecode(const bitfield_t w, boson_coords_t *x, const int N);
 
 
+// number of 64-bit words required for the multi-word encoding
+int BosonWords(const int modes, const int N);
+
+// encode occupation numbers 'occ' into a multi-word bitfield
+void BosonEncodeWords(const int modes, const int *occ, bitfield_t *w);
+
+// decode the multi-word bitfield 'w' into occupation numbers 'occ'
+void BosonDecodeWords(const int modes, const int nwords, const bitfield_t *w, int *occ);
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Bose map for enumeration of bit-encoded occupations
 ///
 typedef struct
 {
-    bitfield_t *map;	//!< list of bit-encoded occupations
-    int num;			//!< length of the list
+	bitfield_t *map;    //!< list of bit-encoded occupations (NULL if not materialised)
+	int64_t *binom;     //!< table of binomial coefficients Binomial(m + k, m), m = 0, ..., modes - 1, k = 0, ..., N, used for ranking
+	int64_t num;        //!< number of basis states
+	int modes;          //!< number of modes
+	int N;              //!< number of particles
 }
 boson_map_t;
 
 
+// ranking tables for a bosonic basis, without materialising the map
+int BosonBasis(const int modes, const int N, boson_map_t *bm);
+
 // map base indices to bit-encoded coordinates
 int BosonMap(const int modes, const int N, boson_map_t *bm);
 
-// convert bosonic coordinates to base index
-int Boson2Base(const boson_map_t *bm, const boson_coords_t *x, const int N);
+void DeleteBosonMap(boson_map_t *bm);
+
+
+// base index of occupation numbers
+int64_t BosonRank(const boson_map_t *bm, const int *occ);
+
+// occupation numbers of base index
+void BosonUnrank(const boson_map_t *bm, const int64_t r, int *occ);
@@ -0,0 +1,58 @@
+/// \file compact_kernel.h
+/// \brief Compact encoding of the kernel tensors for calculating reduced density matrices.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+
+#pragma once
+
+#include "sparse.h"
+#include <complex.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compact representation of a rank-4 kernel tensor K{i,j}[t,d] with entries +-1
+///
+/// The entries are grouped into blocks of equal (i, j). The signs are packed into a bitmap (bit set for -1),
+/// and the indices (t, d) are stored in the narrowest unsigned integer type which can hold 'dims[2]' and 'dims[3]',
+/// i.e., 2, 4 or 8 bytes per entry (two indices) instead of 24 bytes for a 'sparse_array_t'.
+///
+typedef struct
+{
+	uint64_t *sign;         //!< sign bitmap, bit k is set if entry k is -1
+	void *ind;              //!< indices (t, d) of the entries, interleaved, 'width' bytes each
+	int64_t *blockstart;    //!< start of each block in the list of entries, with 'nblocks + 1' entries
+	int *block;             //!< indices (i, j) of each block, interleaved
+	int64_t nnz;            //!< number of entries
+	int nblocks;            //!< number of blocks
+	int dims[4];            //!< tensor dimensions
+	int width;              //!< number of bytes per index (1, 2 or 4)
+	bool half;              //!< whether only the blocks i <= j are stored (see 'GenerateRDMHalf')
+}
+compact_kernel_t;
+
+
+int CompressRDMKernel(const sparse_array_t *K, const bool half, compact_kernel_t *C);
+
+void DeleteCompactKernel(compact_kernel_t *C);
+
+int64_t CompactKernelBytes(const compact_kernel_t *C);
+
+int ContractCompactKernel(const compact_kernel_t *C, const double complex *psi, double complex *G);
@@ -0,0 +1,39 @@
+/// \file comprise.h
+/// \brief Index permutations between partition layouts, under orbital permutations and particle-hole conjugation, applied as signed gathers.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "fermi_map.h"
+
+
+// bit pattern of a base index of a configuration, inverse of 'Fermi2Base'
+bitfield_t FermiUnrank(const fermi_config_t *config, const int index);
+
+int ComprisePermutation(const fermi_config_t *src, const fermi_config_t *dst, int *perm);
+
+int OrbitalPermutation(const int orbs, const int N, const int *sigma, int *perm, int *sign);
+
+int ParticleHolePermutation(const int orbs, const int N, int *perm, int *sign);
+
+
+void PermuteGather(const int n, const int *perm, const int *sign, const int ncomp, const double *x, double *y);
+
+void PermuteGatherMatrix(const int n1, const int *perm1, const int *sign1, const int n2, const int *perm2, const int *sign2, const int ldx, const int ncomp, const double *x, double *y);
+
+int PermuteInPlace(const int n, const int *perm, const int *sign, const int ncomp, double *x);
@@ -0,0 +1,116 @@
+/// \file excitation_graph.h
+/// \brief Compressed graph of the single or double excitations connecting the Slater determinants of a configuration.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "fermi_map.h"
+#include <stdint.h>
+#include <complex.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Excitation graph in compressed sparse row (CSR) format
+///
+/// Row 'n' lists all Slater determinants T of the configuration which differ from determinant D = map[n]
+/// by exactly 'level' orbitals (pure single or double excitations), in ascending order of their base index.
+/// Each entry is encoded as variable-length integer (7 bits per byte, least significant group first)
+/// of '(t - t_prev) << 1 | (sign < 0)', with 't' the base index of T, 't_prev' the index of the preceding
+/// entry in the row (0 for the first), followed by 'level' bytes with the created orbitals (T & ~D) and 'level' bytes
+/// with the annihilated orbitals (D & ~T), each in ascending order. The sign is the one of the single term
+/// of the reduced density matrix of |DXT| (see 'SlaterRDM'), i.e., <T| a_B^dagger a_A |D> for the
+/// created and annihilated orbitals B and A.
+///
+typedef struct
+{
+	uint8_t *data;          //!< encoded entries
+	int64_t *offset;        //!< start of the entries of each row in 'data', with 'num + 1' entries
+	int num;                //!< number of rows (Slater determinants)
+	int level;              //!< excitation level, 1 (singles) or 2 (doubles)
+}
+excitation_graph_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Decode the excitation graph entry at 'ptr'; advances 'ptr' and 'target', and returns the sign
+///
+static inline int ExcitationGraphDecode(const uint8_t **ptr, const int level, int *target, int *created, int *annihilated)
+{
+	const uint8_t *p = *ptr;
+	uint64_t v = 0;
+	int shift = 0;
+	while (*p & 0x80)
+	{
+		v |= ((uint64_t)(*p & 0x7F)) << shift;
+		shift += 7;
+		p++;
+	}
+	v |= ((uint64_t)*p) << shift;
+	p++;
+
+	(*target) += (int)(v >> 1);
+
+	int k;
+	for (k = 0; k < level; k++) {
+		created[k] = *p++;
+	}
+	for (k = 0; k < level; k++) {
+		annihilated[k] = *p++;
+	}
+
+	*ptr = p;
+
+	return (v & 1) ? -1 : 1;
+}
+
+
+int ExcitationGraph(const fermi_config_t *config, const int level, excitation_graph_t *graph);
+
+void DeleteExcitationGraph(excitation_graph_t *graph);
+
+int ExcitationGraphValidate(const fermi_config_t *config, const excitation_graph_t *graph);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Excitation graphs up to the given level together with the Fermi map of the configuration,
+/// precomputed once for repeated evaluations of reduced density matrices and operator applications,
+/// and for the assembly of the Hamiltonian with respect to the configuration (see 'HamiltonianCSR')
+///
+typedef struct
+{
+	excitation_graph_t graph1;  //!< single excitations
+	excitation_graph_t graph2;  //!< double excitations (empty for level 1)
+	fermi_map_t fm;             //!< bit-encoded Slater determinants of the configuration
+	int norbs;                  //!< total number of orbitals
+	int Ntot;                   //!< total number of particles
+	int level;                  //!< maximum excitation level, 1 or 2
+}
+excitation_graphs_t;
+
+
+int ExcitationGraphs(const fermi_config_t *config, const int level, excitation_graphs_t *graphs);
+
+void DeleteExcitationGraphs(excitation_graphs_t *graphs);
+
+
+int ExcitationGraphRDM(const excitation_graphs_t *graphs, const int p, const double complex *psi, double complex *G);
+
+int ExcitationGraphApply(const excitation_graphs_t *graphs, const int p, const double complex *h, const double complex *psi, double complex *out);
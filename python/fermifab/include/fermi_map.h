@@ -61,9 +61,70 @@ typedef struct
 fermi_map_t;
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Rule for combining symmetry labels
+///
+typedef enum
+{
+	SYMMETRY_XOR = 0,   //!< bitwise XOR, for the irreducible representations of abelian point groups (D2h and subgroups)
+	SYMMETRY_ADD = 1,   //!< addition modulo the number of sectors, e.g., for lattice momentum
+}
+symmetry_rule_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Abelian symmetry labels of the orbitals, with the orbitals of all partitions numbered consecutively
+///
+/// The label of a Slater determinant is the combination of the labels of its occupied orbitals.
+/// Labels must lie in { 0, ..., order - 1 }, and 'order' must be a power of 2 for 'SYMMETRY_XOR'.
+///
+typedef struct
+{
+	const int *label;       //!< symmetry label of each orbital
+	int order;              //!< number of symmetry sectors
+	symmetry_rule_t rule;   //!< combination rule
+}
+fermi_symmetry_t;
+
+
+static inline int SymmetryCombine(const fermi_symmetry_t *sym, const int a, const int b)
+{
+	return (sym->rule == SYMMETRY_XOR ? a ^ b : (a + b) % sym->order);
+}
+
+
+static inline int SymmetryInverse(const fermi_symmetry_t *sym, const int a)
+{
+	return (sym->rule == SYMMETRY_XOR ? a : (sym->order - a) % sym->order);
+}
+
+
+// lexicographically next fermionic bit pattern
+bitfield_t NextFermi(const bitfield_t f);
+
+// next bit pattern of a configuration, or -1 if the last one has been reached
+bitfield_t NextFermiConfig(const int *orbs, const int nc, const bitfield_t f);
+
+
 // map base indices to bit-encoded coordinates
 int FermiMap(const fermi_config_t *config, fermi_map_t *fm);
 
+// symmetry label of a bit pattern
+int FermiSymmetryLabel(const fermi_symmetry_t *sym, const bitfield_t f);
+
+// Fermi map ordered by symmetry sectors, and Fermi map of a single sector
+int FermiMapSectors(const fermi_config_t *config, const fermi_symmetry_t *sym, fermi_map_t *fm, int *offset);
+int FermiMapSymmetry(const fermi_config_t *config, const fermi_symmetry_t *sym, const int target, fermi_map_t *fm);
+
+// base index of a bit pattern with respect to a single partition
+int FermiIndex(const bitfield_t f);
+
+// table of binomial coefficients up to 64, and base index of a bit pattern with respect to a configuration
+void BinomialTable(int *binom);
+int FermiConfigRank(const fermi_config_t *config, const int *binom, const bitfield_t f);
+
 // convert Fermi coordinates to base index and permutation sign
 int Fermi2Base    (const fermi_map_t *fm, const fermi_coords_t *x, const int N);
 int Fermi2BaseSign(const fermi_map_t *fm, const fermi_coords_t *x, const int N, int *sign);
@@ -74,3 +135,14 @@ int AnnihilSign(const bitfield_t n, const bitfield_t a);
 
 // annihilation sign mask
 bitfield_t AnnihilSignMask(const bitfield_t f);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sign of the permutation reversing a list of the given length
+///
+static inline int ReversePermSign(const int length)
+{
+	int n = (length-1)*length/2;
+	return 1 - 2*(n % 2);
+}
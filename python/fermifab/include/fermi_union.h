@@ -0,0 +1,70 @@
+/// \file fermi_union.h
+/// \brief Basis given by the union of several configurations (particle numbers per partition) of a partitioned Fermi space.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "fermi_map.h"
+#include "sparse.h"
+#include <stdint.h>
+
+
+// number of configurations of 'N' particles in 'nc' slots with at most 'maxC[i]' particles in slot 'i'
+int ConfigCount(const int nc, const int N, const int *maxC);
+
+// enumerate these configurations (same order as the Matlab 'gen_config'), stored as rows of 'conf'
+int GenConfig(const int nc, const int N, const int *maxC, int *conf);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Union of the configurations N[s*nc], ..., N[s*nc + nc-1] (s = 0, ..., nconf-1) of a partitioned Fermi space
+///
+/// The basis consists of the Slater determinants of configuration 0 (in the order of 'FermiMap'),
+/// followed by those of configuration 1 and so on; configuration 's' starts at base index 'offset[s]'.
+/// The configurations are identified by their particle numbers packed into a bit code, which enables ranking
+/// by binary search over the sorted codes.
+///
+typedef struct
+{
+	const int *orbs;        //!< number of orbitals in each partition
+	const int *N;           //!< particle numbers of each configuration, as 'nconf x nc' array
+	int nc;                 //!< number of partitions
+	int nconf;              //!< number of configurations
+	int *offset;            //!< base index offset of each configuration, with 'nconf + 1' entries
+	int *stride;            //!< base index strides of the partitions within each configuration, as 'nconf x nc' array
+	uint64_t *code;         //!< sorted codes of the configurations
+	int *sector;            //!< configuration corresponding to each sorted code
+	int partoff[64];        //!< first orbital of each partition
+	int codeoff[64];        //!< first bit of the particle number of each partition in a code
+	int num;                //!< dimension of the union
+}
+fermi_union_t;
+
+
+int FermiUnion(const int *orbs, const int nc, const int *N, const int nconf, fermi_union_t *fu);
+
+void DeleteFermiUnion(fermi_union_t *fu);
+
+
+int FermiUnionMap(const fermi_union_t *fu, fermi_map_t *fm);
+
+int FermiUnionIndex(const fermi_union_t *fu, const bitfield_t f);
+
+
+int GenerateRDMUnion(const fermi_union_t *fu1, const fermi_union_t *fu2, const int p1, sparse_array_t *K);
@@ -20,6 +20,21 @@
 #pragma once
 
 #include "sparse.h"
+#include "fermi_map.h"
+#include <stdbool.h>
+#include <complex.h>
+
+
+/// \brief Rank of the Slater determinant 'f' within a subspace described by 'data', or -1 if not contained
+typedef int (*determinant_rank_t)(const void *data, const bitfield_t f);
 
 
 int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, const int nc, sparse_array_t *K);
+
+int GenerateRDMHalf(const int *orbs, const int *p, const int *N, const int nc, sparse_array_t *K);
+
+int RDMPartialTrace(const int orbs, const int p, const int N, const double complex *G, double complex *Gt);
+
+int GenerateRDMSymmetry(const int *orbs, const int *p1, const int *N1, const int *N2, const int nc, const fermi_symmetry_t *sym, const int target1, const int target2, sparse_array_t *K, int *offsetP1, int *offsetP2);
+
+int GenerateRDMRow(const int norbs, const bitfield_t D, const int n, const int p1, const int p2, determinant_rank_t rank, const void *data, int *ind, double *val);
@@ -0,0 +1,31 @@
+/// \file generate_rdm_boson.h
+/// \brief Generate the kernel for calculating bosonic p-body reduced density matrices, and matrix-free variants.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "sparse.h"
+#include <complex.h>
+
+
+int GenerateRDMBoson(const int modes, const int p1, const int N1, const int N2, sparse_array_t *K);
+
+
+int BosonRDM(const int modes, const int p, const int N, const double complex *psi, double complex *G);
+
+int BosonP2NApply(const int modes, const int p, const int N, const double complex *h, const double complex *psi, double complex *out);
@@ -0,0 +1,40 @@
+/// \file hamiltonian.h
+/// \brief Sparse second-quantized electronic Hamiltonian from one- and two-electron integrals (Slater-Condon rules).
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "fermi_map.h"
+#include "integrals.h"
+#include "sparse.h"
+#include <stdint.h>
+
+
+// matrix elements <D|H|T> between Slater determinants of the 2*norb spin orbitals (alpha spin orbitals first)
+double SlaterCondon(const integrals_t *ints, const bitfield_t D, const bitfield_t T);
+
+void SlaterCondonPairs(const integrals_t *ints, const int64_t n, const bitfield_t *D, const bitfield_t *T, double *val);
+
+void SlaterCondonBlock(const integrals_t *ints, const int nrows, const bitfield_t *D, const int ncols, const bitfield_t *T, double *val);
+
+
+// sparse Hamiltonian with respect to the Slater determinants of a configuration
+int HamiltonianCSR(const integrals_t *ints, const fermi_config_t *config, const double tol, sparse_csr_t *H);
+
+// sparse Hamiltonian with respect to a sorted list of selected Slater determinants
+int HamiltonianSelectedCSR(const integrals_t *ints, const bitfield_t *dets, const int ndets, const double tol, sparse_csr_t *H);
@@ -0,0 +1,126 @@
+/// \file integrals.h
+/// \brief One- and two-electron integrals over real spatial orbitals: FCIDUMP reader and memory-mappable binary format.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Packed index of the orbital pair (a, b) == (b, a), i.e., b*(b + 1)/2 + a for a <= b
+///
+static inline int64_t PairIndex(const int a, const int b)
+{
+	return (a <= b ? (int64_t)b*(b + 1)/2 + a : (int64_t)a*(a + 1)/2 + b);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Canonical representative of the Coulomb integral (ab|cd) under the 8-fold permutation symmetry
+/// for real spatial orbitals (same as 'ApplySymmetry' in the Matlab and Mathematica 'spintrace_coul')
+///
+/// Afterwards ab[0] <= ab[1], cd[0] <= cd[1], and the pair 'ab' precedes 'cd' when ordered by the second
+/// and then the first orbital, which is the order of their 'PairIndex'.
+///
+static inline void CoulombCanonical(int *ab, int *cd)
+{
+	int t;
+
+	// assume that all spatial orbitals are real,
+	// so e.g. (ab|cd) = (ba|cd)
+	if (ab[0] > ab[1]) { t = ab[0]; ab[0] = ab[1]; ab[1] = t; }
+	if (cd[0] > cd[1]) { t = cd[0]; cd[0] = cd[1]; cd[1] = t; }
+
+	// Coulomb operator is symmetric
+	if (ab[1] > cd[1] || (ab[1] == cd[1] && ab[0] > cd[0]))
+	{
+		t = ab[0]; ab[0] = cd[0]; cd[0] = t;
+		t = ab[1]; ab[1] = cd[1]; cd[1] = t;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Position of the Coulomb integral (ab|cd) in the 8-fold packed storage, i.e., Q*(Q + 1)/2 + P
+/// for the pair indices P <= Q of the canonical representative (see 'CoulombCanonical')
+///
+static inline int64_t CoulombIndex(const int a, const int b, const int c, const int d)
+{
+	const int64_t p = PairIndex(a, b);
+	const int64_t q = PairIndex(c, d);
+
+	return (p <= q ? q*(q + 1)/2 + p : p*(p + 1)/2 + q);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief One- and two-electron integrals over 'norb' real spatial orbitals, with the FCIDUMP header data
+///
+/// The one-electron integrals h[a,b] are stored by 'PairIndex', and the two-electron integrals (ab|cd)
+/// (chemists' notation) by 'CoulombIndex'. If the integrals are memory-mapped from a binary file
+/// (see 'MapIntegrals'), the arrays point into the read-only mapping.
+///
+typedef struct
+{
+	double *h1;             //!< one-electron integrals, norb*(norb + 1)/2 entries
+	double *eri;            //!< two-electron integrals, npair*(npair + 1)/2 entries with npair = norb*(norb + 1)/2
+	int32_t *orbsym;        //!< symmetry label of each orbital (as in the FCIDUMP file, 1-based), or 0 if not specified
+	double ecore;           //!< constant core energy
+	int norb;               //!< number of spatial orbitals
+	int nelec;              //!< number of electrons
+	int ms2;                //!< twice the spin projection, i.e., N_alpha - N_beta
+	int isym;               //!< symmetry label of the target state
+	void *map;              //!< memory mapping of a binary file, or NULL if the arrays are allocated
+	size_t mapsize;         //!< size of the memory mapping in bytes
+}
+integrals_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of stored one- and two-electron integrals
+///
+static inline int64_t IntegralsPairCount(const int norb)
+{
+	return (int64_t)norb*(norb + 1)/2;
+}
+
+static inline int64_t IntegralsCoulombCount(const int norb)
+{
+	const int64_t npair = IntegralsPairCount(norb);
+	return npair*(npair + 1)/2;
+}
+
+
+int AllocateIntegrals(const int norb, integrals_t *ints);
+
+void DeleteIntegrals(integrals_t *ints);
+
+
+int ReadFCIDUMP(const char *filename, integrals_t *ints);
+
+
+int WriteIntegrals(const char *filename, const integrals_t *ints);
+
+int MapIntegrals(const char *filename, integrals_t *ints);
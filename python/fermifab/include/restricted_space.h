@@ -0,0 +1,82 @@
+/// \file restricted_space.h
+/// \brief Configuration spaces restricted by the excitation level or by the particle numbers of orbital sections (RAS).
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "fermi_map.h"
+#include "sparse.h"
+#include <stdint.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Restricted configuration space of 'N' particles in 'orbs' orbitals
+///
+/// The orbitals are divided into sections of consecutive orbitals (starting from orbital 0), e.g., the RAS1, RAS2
+/// and RAS3 subspaces, and each section holds between 'sec_min' and 'sec_max' particles. Additionally, the
+/// excitation level with respect to the reference determinant 'ref', i.e., the number of orbitals occupied in 'ref'
+/// but not in a Slater determinant, can be limited to 'max_exc' (e.g., 2 for CISD).
+///
+typedef struct
+{
+	const int *sec_orbs;    //!< number of orbitals in each section, summing to 'orbs'
+	const int *sec_min;     //!< minimum number of particles in each section
+	const int *sec_max;     //!< maximum number of particles in each section
+	int nsec;               //!< number of sections
+	int orbs;               //!< total number of orbitals
+	int N;                  //!< number of particles
+	bitfield_t ref;         //!< reference determinant
+	int max_exc;            //!< maximum excitation level with respect to 'ref', or -1 for no restriction
+}
+restricted_config_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Completion count table of a restricted configuration space, for ranking and enumeration
+///
+/// The orbitals are assigned from the highest to the lowest one, such that the resulting order is the numerical
+/// order of the bit patterns (as for 'FermiMap'). The state after assigning orbitals b, ..., orbs-1 consists of the
+/// number 'n' of remaining particles, the number 'c' of particles in the (incomplete) section of orbital b-1 and
+/// the current excitation level 'h'; 'count' stores the number of valid completions of orbitals 0, ..., b-1.
+///
+typedef struct
+{
+	restricted_config_t config;     //!< configuration (arrays referenced, not copied)
+	int64_t *count;                 //!< completion counts, indexed by ((b*(N + 1) + n)*(N + 1) + c)*hdim + h
+	int section[64];                //!< section of each orbital
+	int start[64];                  //!< first orbital of each section
+	int required[65];               //!< number of sections preceding a section with a positive minimum particle number
+	int hdim;                       //!< number of tracked excitation levels
+	int num;                        //!< dimension of the restricted space
+}
+restricted_table_t;
+
+
+int RestrictedTable(const restricted_config_t *config, restricted_table_t *table);
+
+void DeleteRestrictedTable(restricted_table_t *table);
+
+
+int RestrictedRank(const restricted_table_t *table, const bitfield_t f);
+
+int RestrictedMap(const restricted_table_t *table, fermi_map_t *fm);
+
+
+int GenerateRDMRestricted(const restricted_config_t *config1, const restricted_config_t *config2, const int p1, sparse_array_t *K);
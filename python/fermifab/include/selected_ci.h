@@ -0,0 +1,43 @@
+/// \file selected_ci.h
+/// \brief Selected configuration interaction: connected determinants and perturbative selection criteria.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "integrals.h"
+#include "bitfield.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Determinants outside a variational space which are connected to it by the Hamiltonian
+///
+typedef struct
+{
+	bitfield_t *dets;       //!< bit-encoded Slater determinants, sorted in ascending order
+	double *coupling;       //!< coupling sum_n <T|H|D_n> c_n to the variational state, for each determinant T
+	double *diag;           //!< diagonal matrix elements <T|H|T>
+	int num;                //!< number of determinants
+}
+ci_candidates_t;
+
+
+void DeleteCICandidates(ci_candidates_t *cand);
+
+
+int SelectedCICandidates(const integrals_t *ints, const bitfield_t *dets, const double *coeffs, const int ndets, const double eps, ci_candidates_t *cand);
@@ -0,0 +1,34 @@
+/// \file slater_rdm.h
+/// \brief Calculate reduced density matrices of outer products of Slater determinants.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "bitfield.h"
+#include "sparse.h"
+#include <complex.h>
+
+
+// calculate the reduced density matrix of the outer product of two Slater determinants
+int SlaterRDM(const bitfield_t s1, const bitfield_t s2, const int p1, bitfield_t *a1, bitfield_t *a2, int *sign);
+
+
+// accumulate the reduced density matrices of weighted outer products of Slater determinants
+int SlaterPairRDM(const int orbs, const int p1, const int p2, const int npairs, const bitfield_t *s1, const bitfield_t *s2, const double complex *w, double complex *G);
+
+int SlaterPairRDMSparse(const int orbs, const int p1, const int p2, const int npairs, const bitfield_t *s1, const bitfield_t *s2, const double complex *w, sparse_complex_array_t *G);
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <complex.h>
+#include <stdint.h>
 
 
 //________________________________________________________________________________________________________________________
@@ -62,3 +63,21 @@ void DeleteSparseComplexArray(sparse_complex_array_t *a);
 
 
 void SparseComplexToDense(const sparse_complex_array_t *a, double complex *mat);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sparse matrix in compressed sparse row (CSR) format with real-valued entries
+///
+typedef struct
+{
+	double *val;        //!< non-zero values, ordered by rows and ascending column indices within each row
+	int *col;           //!< corresponding column indices
+	int64_t *rowptr;    //!< start of each row in 'val' and 'col', with 'nrows + 1' entries
+	int nrows;          //!< number of rows
+	int ncols;          //!< number of columns
+}
+sparse_csr_t;
+
+
+void DeleteSparseCSR(sparse_csr_t *a);
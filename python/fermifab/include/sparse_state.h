@@ -0,0 +1,84 @@
+/// \file sparse_state.h
+/// \brief Sparse fermionic states stored as lists of bit-encoded Slater determinants and coefficients.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "bitfield.h"
+#include <complex.h>
+#include <stdbool.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sparse fermionic state
+///
+typedef struct
+{
+	bitfield_t *dets;           //!< bit-encoded Slater determinants, sorted in ascending order
+	double complex *coeffs;     //!< corresponding coefficients
+	int nnz;                    //!< number of stored determinants
+}
+sparse_fermi_state_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Open addressing hash table mapping bit-encoded Slater determinants to coefficients
+///
+typedef struct
+{
+	bitfield_t key;         //!< bit-encoded Slater determinant; must be the first member for sorting by 'CompareBitfield'
+	double complex val;     //!< accumulated coefficient
+}
+det_entry_t;
+
+typedef struct
+{
+	det_entry_t *entries;   //!< table entries
+	bool *used;             //!< whether the corresponding entry is occupied
+	int size;               //!< table size, a power of 2
+	int count;              //!< number of occupied entries
+}
+det_hash_table_t;
+
+
+static inline int HashBitfield(const bitfield_t f, const int size)
+{
+	// Fibonacci hashing
+	return (int)((f * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+
+int CreateDetHashTable(const int size, det_hash_table_t *table);
+
+void DeleteDetHashTable(det_hash_table_t *table);
+
+int DetHashTableAdd(det_hash_table_t *table, const bitfield_t key, const double complex val);
+
+
+void DeleteSparseFermiState(sparse_fermi_state_t *psi);
+
+
+int SparseStateFind(const sparse_fermi_state_t *psi, const bitfield_t f);
+
+
+int SparseStateRDM(const int orbs, const int p, const sparse_fermi_state_t *psi, double complex *G);
+
+
+int SparseStateApply(const int orbs, const int p, const double complex *h, const sparse_fermi_state_t *psi, sparse_fermi_state_t *out);
@@ -0,0 +1,75 @@
+/// \file string_ci.h
+/// \brief Alpha/beta string-factorized configuration interaction (CI) spaces.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "bitfield.h"
+#include <complex.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Single excitations E_ij = a_i^dagger a_j of all N-particle strings on 'norb' orbitals
+///
+/// The strings are lexicographically ordered (as for 'FermiMap'). For string 'K' and excitation 'e',
+/// entry 'K*nexc + e' stores the target string index 'T', sign 's' and orbital pair 'i*norb + j'
+/// such that E_ij |K> = s |T>; diagonal excitations i == j are included.
+///
+typedef struct
+{
+	bitfield_t *strings;    //!< bit-encoded strings
+	int *target;            //!< target string indices
+	int *sign;              //!< excitation signs
+	int *pair;              //!< orbital pairs 'i*norb + j'
+	int num;                //!< number of strings
+	int nexc;               //!< number of excitations per string, N*(norb - N + 1)
+	int norb;               //!< number of orbitals
+	int N;                  //!< number of particles
+}
+string_excitation_list_t;
+
+
+int StringExcitationList(const int norb, const int N, string_excitation_list_t *list);
+
+void DeleteStringExcitationList(string_excitation_list_t *list);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Alpha and beta string excitation lists of the CI space with 'Na' alpha and 'Nb' beta electrons
+/// on 'norb' spatial orbitals, built once and shared by all operations on this space
+///
+typedef struct
+{
+	string_excitation_list_t alpha;     //!< excitations of the alpha strings
+	string_excitation_list_t beta;      //!< excitations of the beta strings
+}
+string_ci_space_t;
+
+
+int StringCISpace(const int norb, const int Na, const int Nb, string_ci_space_t *space);
+
+void DeleteStringCISpace(string_ci_space_t *space);
+
+
+int StringCIRDM1(const string_ci_space_t *space, const double complex *C, double complex *Ga, double complex *Gb);
+
+int StringCIRDM2(const string_ci_space_t *space, const double complex *C, double complex *Ga, double complex *Gb, double complex *Gaa, double complex *Gab, double complex *Gbb, double complex *P);
+
+int StringCISigma(const string_ci_space_t *space, const double complex *h, const double complex *g, const double complex *C, double complex *sigma);
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "sparse.h"
+#include "fermi_map.h"
 
 
 double Det(const int n, double *A);
@@ -30,3 +31,23 @@ double complex ComplexDet(const int n, double complex *A);
 int TensorOp(const int orbs, const int N, const double *A, sparse_array_t *AN);
 
 int TensorOpComplex(const int orbs, const int N, const double complex *A, sparse_complex_array_t *AN);
+
+
+int TensorOpSymmetry(const int orbs, const int N, const double *A, const fermi_symmetry_t *sym, const int target, sparse_array_t *AN);
+
+int TensorOpSymmetryComplex(const int orbs, const int N, const double complex *A, const fermi_symmetry_t *sym, const int target, sparse_complex_array_t *AN);
+
+
+int TensorOpDiag(const int orbs, const int N, const double *A, double *d);
+
+int TensorOpDiagComplex(const int orbs, const int N, const double complex *A, double complex *d);
+
+
+int MaximalMinors(const int orbs, const int N, const double *C, double *psi);
+
+int MaximalMinorsComplex(const int orbs, const int N, const double complex *C, double complex *psi);
+
+
+int CompoundMatrix(const int m, const int n, const int p, const double *A, double *Ap);
+
+int CompoundMatrixComplex(const int m, const int n, const int p, const double complex *A, double complex *Ap);
@@ -0,0 +1,32 @@
+/// \file tensor_op_boson.h
+/// \brief Calculate the symmetric tensor product (A otimes A ... otimes A): Sym^N H -> Sym^N H via permanents.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include <complex.h>
+
+
+double Permanent(const int nr, const int nc, const double *M, const int *rmul, const int *cmul);
+
+double complex PermanentComplex(const int nr, const int nc, const double complex *M, const int *rmul, const int *cmul);
+
+
+int TensorOpBoson(const int modes, const int N, const double *A, double *AN);
+
+int TensorOpBosonComplex(const int modes, const int N, const double complex *A, double complex *AN);
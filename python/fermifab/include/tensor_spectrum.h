@@ -0,0 +1,29 @@
+/// \file tensor_spectrum.h
+/// \brief Traces and spectra of the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H via the eigenvalues of A.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#pragma once
+
+#include "bitfield.h"
+#include <complex.h>
+
+
+void ElementarySymmetric(const int n, const double complex *x, double complex *e);
+
+
+int TopSubsetProducts(const int n, const double complex *x, const int N, const int k, double complex *prod, bitfield_t *subsets);
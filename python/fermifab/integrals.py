@@ -0,0 +1,176 @@
+import numpy as np
+from scipy.sparse import csr_matrix
+import fermifab.kernel
+
+__all__ = ['Integrals', 'pair_index', 'coulomb_index', 'read_fcidump', 'load_integrals']
+
+
+def pair_index(a, b):
+    """
+    Packed index of the orbital pair (a, b) == (b, a), i.e., `b*(b + 1)/2 + a` for `a <= b`
+    (vectorized over integer arrays).
+    """
+    a, b = np.minimum(a, b), np.maximum(a, b)
+    return b*(b + 1)//2 + a
+
+
+def coulomb_index(a, b, c, d):
+    """
+    Position of the two-electron integral (ab|cd) in the 8-fold packed storage, such that all
+    permutations of (ab|cd) for real orbitals share the same entry (vectorized over integer arrays).
+    """
+    return pair_index(pair_index(a, b), pair_index(c, d))
+
+
+class Integrals(object):
+
+    def __init__(self, h1, eri, ecore=0., nelec=0, ms2=0, isym=1, orbsym=None):
+        """
+        One- and two-electron integrals over real spatial orbitals, as in FCIDUMP files.
+
+        The one-electron integrals are stored by `pair_index` and the two-electron integrals (ab|cd)
+        (chemists' notation) by `coulomb_index`, i.e., each of the 8 equivalent permutations only once.
+
+        Args:
+            h1:     one-electron integrals, symmetric `norb x norb` matrix or packed vector
+            eri:    two-electron integrals (ab|cd), `norb x norb x norb x norb` tensor or packed vector
+            ecore:  constant core energy (optional)
+            nelec:  number of electrons (optional)
+            ms2:    twice the spin projection (optional)
+            isym:   symmetry label of the target state (optional)
+            orbsym: symmetry labels of the orbitals (optional)
+        """
+        h1 = np.asarray(h1, dtype=float)
+        eri = np.asarray(eri, dtype=float)
+        if h1.ndim == 2:
+            norb = h1.shape[0]
+            b, a = np.tril_indices(norb)
+            h1 = h1[a, b]
+        else:
+            norb = int(round((np.sqrt(8*len(h1) + 1) - 1) / 2))
+        if eri.ndim == 4:
+            assert eri.shape == 4*(norb,)
+            # pairs a <= b and pair indices p <= q in packed order
+            q, p = np.tril_indices(norb*(norb + 1)//2)
+            b, a = np.tril_indices(norb)
+            eri = eri[a[p], b[p], a[q], b[q]]
+        assert len(h1) == norb*(norb + 1)//2
+        assert len(eri) == len(h1)*(len(h1) + 1)//2
+        self.norb = norb
+        self.h1 = h1
+        self.eri = eri
+        self.ecore = float(ecore)
+        self.nelec = nelec
+        self.ms2 = ms2
+        self.isym = isym
+        self.orbsym = np.zeros(norb, dtype=np.int32) if orbsym is None else np.asarray(orbsym, dtype=np.int32)
+        # capsule owning the arrays if read from a file
+        self._capsule = None
+
+    @classmethod
+    def _from_kernel(cls, data):
+        norb, nelec, ms2, isym, ecore, orbsym, h1, eri, capsule = data
+        ints = cls(h1, eri, ecore=ecore, nelec=nelec, ms2=ms2, isym=isym, orbsym=orbsym)
+        ints._capsule = capsule
+        return ints
+
+    @property
+    def nbytes(self):
+        """Memory size of the stored integrals in bytes."""
+        return self.h1.nbytes + self.eri.nbytes
+
+    def h1_matrix(self):
+        """One-electron integrals as symmetric `norb x norb` matrix."""
+        a = np.arange(self.norb)
+        return self.h1[pair_index(a[:, None], a[None, :])]
+
+    def eri_tensor(self):
+        """Two-electron integrals (ab|cd) as `norb x norb x norb x norb` tensor (chemists' notation)."""
+        a = np.arange(self.norb)
+        pab = pair_index(a[:, None], a[None, :]).reshape(-1)
+        return self.eri[pair_index(pab[:, None], pab[None, :])].reshape(4*(self.norb,))
+
+    def coulomb(self, a, b, c, d):
+        """Two-electron integral (ab|cd), vectorized over integer arrays."""
+        return self.eri[coulomb_index(a, b, c, d)]
+
+    def hamiltonian(self, N, tol=0.):
+        """
+        Sparse N-body Hamiltonian
+        `H = ecore + sum_{pq} h_{pq} a_p^dagger a_q + 1/2 sum_{pqrs} (pq|rs) a_p^dagger a_r^dagger a_s a_q`
+        with respect to the Slater determinants of the `2*norb` spin orbitals (alpha spin orbitals first),
+        assembled in parallel by the Slater-Condon rules.
+
+        Args:
+            N:   total number of electrons, or tuple `(N_alpha, N_beta)` to restrict to fixed spin projection
+            tol: drop off-diagonal entries with magnitude at most `tol`
+
+        Returns:
+            `scipy.sparse.csr_matrix`
+        """
+        if np.isscalar(N):
+            orbs, N = (2*self.norb,), (N,)
+        else:
+            orbs, N = (self.norb, self.norb), tuple(N)
+        rowptr, col, val = fermifab.kernel.hamiltonian_csr(self.norb, self.ecore, self.h1, self.eri, orbs, N, tol)
+        dim = len(rowptr) - 1
+        return csr_matrix((val, col, rowptr), shape=(dim, dim))
+
+    def matrix_element(self, D, T):
+        """
+        Hamiltonian matrix elements `<D|H|T>` (see `hamiltonian`) between bit-encoded Slater determinants
+        of the `2*norb` spin orbitals by the Slater-Condon rules, vectorized over pairs of determinants.
+        """
+        D, T = np.broadcast_arrays(np.asarray(D, dtype=np.uint64), np.asarray(T, dtype=np.uint64))
+        val = fermifab.kernel.slater_condon_pairs(self.norb, self.ecore, self.h1, self.eri, D.reshape(-1), T.reshape(-1))
+        return val.reshape(D.shape) if D.ndim > 0 else val[0]
+
+    def matrix_block(self, D, T):
+        """
+        Dense Hamiltonian matrix block `<D[k]|H|T[l]>` between two lists of bit-encoded Slater determinants,
+        e.g., whole matrix rows with respect to a selected determinant space.
+        """
+        return fermifab.kernel.slater_condon_block(self.norb, self.ecore, self.h1, self.eri,
+                                                   np.asarray(D, dtype=np.uint64), np.asarray(T, dtype=np.uint64))
+
+    def save(self, filename):
+        """
+        Save the integrals in the binary format, which can be memory-mapped by `load_integrals`.
+        """
+        fermifab.kernel.write_integrals(filename, self.norb, self.nelec, self.ms2, self.isym, self.ecore,
+                                        self.orbsym, self.h1, self.eri)
+
+    def write_fcidump(self, filename, tol=0.):
+        """
+        Write the integrals to an FCIDUMP text file, skipping entries with magnitude at most `tol`.
+        """
+        with open(filename, 'w') as f:
+            f.write(' &FCI NORB={},NELEC={},MS2={},\n'.format(self.norb, self.nelec, self.ms2))
+            f.write('  ORBSYM=' + ','.join(str(s) for s in self.orbsym) + ',\n')
+            f.write('  ISYM={},\n &END\n'.format(self.isym))
+            q, p = np.tril_indices(len(self.h1))
+            b, a = np.tril_indices(self.norb)
+            for v, i, j, k, l in zip(self.eri, a[p], b[p], a[q], b[q]):
+                if abs(v) > tol:
+                    f.write('{:23.16e} {:4d} {:4d} {:4d} {:4d}\n'.format(v, i + 1, j + 1, k + 1, l + 1))
+            for v, i, j in zip(self.h1, a, b):
+                if abs(v) > tol:
+                    f.write('{:23.16e} {:4d} {:4d} {:4d} {:4d}\n'.format(v, i + 1, j + 1, 0, 0))
+            f.write('{:23.16e} {:4d} {:4d} {:4d} {:4d}\n'.format(self.ecore, 0, 0, 0, 0))
+
+
+def read_fcidump(filename):
+    """
+    Read one- and two-electron integrals from an FCIDUMP text file.
+    """
+    return Integrals._from_kernel(fermifab.kernel.read_fcidump(filename))
+
+
+def load_integrals(filename):
+    """
+    Memory-map a binary integral file written by `Integrals.save`.
+
+    The integral arrays are read-only views of the mapping, which is loaded on demand
+    and shared between processes mapping the same file.
+    """
+    return Integrals._from_kernel(fermifab.kernel.map_integrals(filename))
@@ -2,10 +2,12 @@ import numpy as np
 from scipy.sparse import csr_matrix
 from .fermistate import FermiState
 from .fermiop import FermiOp
+from .sparse_state import SparseFermiState
 from .util import trace_prod
-from fermifab.kernel import gen_rdm
+import fermifab.kernel
+from fermifab.kernel import gen_rdm, fermi_rdm, gen_rdm_compact, compact_rdm
 
-__all__ = ['rdm']
+__all__ = ['rdm', 'RDMKernel', 'rdm_partial_trace', 'rdm_hierarchy']
 
 
 def construct_rdm_kernel(orbs, p1, N1, N2):
@@ -19,6 +21,14 @@ def construct_rdm_kernel(orbs, p1, N1, N2):
     if not hasattr(N1,   '__len__'): N1   = (N1,)
     if not hasattr(N2,   '__len__'): N2   = (N2,)
     dims, val, ind = gen_rdm(orbs, p1, N1, N2)
+    return kernel_matrices(dims, val, ind)
+
+
+def kernel_matrices(dims, val, ind):
+    """
+    Convert a sparse kernel tensor of dimensions `dims` with values `val` and
+    indices `ind` (one row per entry) into an array of sparse matrices.
+    """
     # store data in nested lists
     val_arr = [[[] for j in range(dims[1])] for i in range(dims[0])]
     row_arr = [[[] for j in range(dims[1])] for i in range(dims[0])]
@@ -33,33 +43,129 @@ def construct_rdm_kernel(orbs, p1, N1, N2):
     return K
 
 
+def kernel_expectation(dims, val, ind, psi):
+    """
+    Expectation values :math:`G_{ij} = \langle \psi | K_{ij} | \psi \rangle` of a sparse kernel tensor
+    (see `kernel_matrices`) for the coefficient vector `psi`, as `numpy.ndarray`.
+    """
+    G = np.zeros((dims[0], dims[1]), dtype=np.result_type(psi.dtype, float))
+    np.add.at(G, (ind[:, 0], ind[:, 1]), val * psi[ind[:, 2]].conj() * psi[ind[:, 3]])
+    return G
+
+
+def kernel_operator(dims, val, ind, h):
+    """
+    Operator :math:`\sum_{ij} h_{ij} \, a^\dagger_i a_j` assembled from a sparse kernel tensor
+    (see `kernel_matrices`), with `h` given as matrix w.r.t. the p-particle basis of the kernel.
+
+    Returns:
+        scipy.sparse.csr_matrix: operator w.r.t. the N-particle bases of the kernel
+    """
+    # K{i,j} represents a^dagger_j a_i
+    data = np.asarray(h)[ind[:, 1], ind[:, 0]] * val
+    return csr_matrix((data, (ind[:, 2], ind[:, 3])), shape=(dims[2], dims[3]))
+
+
+class RDMKernel(object):
+
+    def __init__(self, orbs, p, N):
+        """
+        Kernel for calculating p-body reduced density matrices of N-body states, which can be reused for several states.
+
+        Only the blocks K{i,j} with i <= j are stored, with the signs packed into a bitmap and the indices
+        in the narrowest integer type which can hold the N-body dimension.
+
+        Args:
+            orbs: number of orbitals (or list for several partitions)
+            p:    target particle number (or list)
+            N:    particle number of the states (or list)
+        """
+        if not hasattr(orbs, '__len__'): orbs = (orbs,)
+        if not hasattr(p,    '__len__'): p    = (p,)
+        if not hasattr(N,    '__len__'): N    = (N,)
+        self.orbs = tuple(orbs)
+        self.p = tuple(p)
+        self.N = tuple(N)
+        self._capsule, self.dims, self.nbytes = gen_rdm_compact(self.orbs, self.p, self.N)
+
+    def __call__(self, psi):
+        """
+        Reduced density matrix of the state vector `psi` as `numpy.ndarray`.
+        """
+        psi = np.asarray(psi)
+        G = compact_rdm(self._capsule, psi)
+        return G if np.iscomplexobj(psi) else G.real
+
+
 def rdm(state, p):
     """
     Calculate the p-body reduced density matrix of a N-body quantum state.
 
     Args:
-        state: quantum state of type 'FermiState'
+        state: quantum state of type 'FermiState' or 'SparseFermiState', or density matrix of type 'FermiOp'
         p:     target particle number
 
     Returns:
         numpy.ndarray: reduced density matrix
     """
+    if type(state) == SparseFermiState:
+        # evaluated directly from the stored determinants
+        return state.rdm(p)
     if type(state) == FermiState:
-        N1 = state.N
-        N2 = N1
-    elif type(state) == FermiOp:
-        N1 = state.pFrom
-        N2 = state.pTo
-        # TODO: add support for lists of N
-        assert N1 == N2
+        # half-storage kernel, G is Hermitian
+        G = fermi_rdm((state.orbs,), (p,), (state.N,), state.data)
+        if not np.iscomplexobj(state.data):
+            G = G.real
+        return FermiOp(state.orbs, p, p, data=G)
+    # FermiOp
+    N1 = state.pFrom
+    N2 = state.pTo
+    # TODO: add support for lists of N
+    assert N1 == N2
 
     K = construct_rdm_kernel(state.orbs, p, N1, N2)
     G = np.zeros((len(K), len(K[0])), dtype=state.data.dtype)
     for i in range(G.shape[0]):
         for j in range(G.shape[1]):
-            if type(state) == FermiState:
-                G[i, j] = np.vdot(state.data, K[i][j].dot(state.data))
-            else:
-                G[i, j] = trace_prod(K[i][j], state.data)
+            G[i, j] = trace_prod(K[i][j], state.data)
 
     return FermiOp(state.orbs, p, p, data=G)
+
+
+def rdm_partial_trace(g, N):
+    """
+    Partial trace of the p-body reduced density matrix `g` of an N-body state, resulting in the (p-1)-body
+    reduced density matrix, i.e., including the normalization factor 1/(N - p + 1).
+
+    Args:
+        g: p-body reduced density matrix of type 'FermiOp'
+        N: overall particle number
+
+    Returns:
+        FermiOp: (p-1)-body reduced density matrix
+    """
+    assert g.pFrom == g.pTo
+    p = g.pFrom
+    G = fermifab.kernel.rdm_partial_trace(g.orbs, p, N, g.data)
+    if not np.iscomplexobj(g.data):
+        G = G.real
+    return FermiOp(g.orbs, p - 1, p - 1, data=G)
+
+
+def rdm_hierarchy(state, k):
+    """
+    Calculate the p-body reduced density matrices for p = 1, ..., k of a N-body quantum state,
+    by evaluating the k-body reduced density matrix and successive partial traces.
+
+    Args:
+        state: quantum state of type 'FermiState' or 'SparseFermiState', or density matrix of type 'FermiOp'
+        k:     maximum particle number
+
+    Returns:
+        list: reduced density matrices of type 'FermiOp', for p = 1, ..., k
+    """
+    N = state.pFrom if type(state) == FermiOp else state.N
+    G = [rdm(state, k)]
+    for p in range(k, 1, -1):
+        G.append(rdm_partial_trace(G[-1], N))
+    return G[::-1]
@@ -1,7 +1,7 @@
 import numpy as np
 from scipy.special import binom
 from .fermiop import FermiOp
-from .rdm import rdm
+from .rdm import rdm_partial_trace
 from .p2N import p2N
 
 __all__ = ['calcQ', 'calcQ_', 'calcT1', 'calcT1_']
@@ -33,7 +33,7 @@ def calcQ_(g2, N):
         The reduced density matrix method for electronic structure calculations and the role of three-index representability conditions
         J. Chem. Phys. 120, 2095 (2004); doi:10.1063/1.1636721
     """
-    g1 = rdm(g2, 1)/(N - 1)
+    g1 = rdm_partial_trace(g2, N)
     return calcQ(g2, g1)
 
 
@@ -63,5 +63,5 @@ def calcT1_(g2, N):
         The reduced density matrix method for electronic structure calculations and the role of three-index representability conditions
         J. Chem. Phys. 120, 2095 (2004); doi:10.1063/1.1636721
     """
-    g1 = rdm(g2, 1)/(N - 1)
+    g1 = rdm_partial_trace(g2, N)
     return calcT1(g2, g1)
@@ -0,0 +1,111 @@
+import numpy as np
+from .fermiop import FermiOp
+from .rdm import kernel_matrices, kernel_expectation, kernel_operator
+import fermifab.kernel
+
+__all__ = ['RestrictedSpace', 'excitation_space', 'ras_space']
+
+
+class RestrictedSpace(object):
+
+    def __init__(self, orbs, N, sections=None, ref=None, max_exc=None):
+        """
+        Restricted configuration space of `N` particles in `orbs` orbitals,
+        e.g., for truncated configuration interaction (CISD, CISDT) or RAS calculations.
+
+        The Slater determinants are numerically ordered by their bit encoding
+        (orbital 0 in the least significant bit), consistent with the unrestricted Slater basis.
+
+        Args:
+            orbs:     number of orbitals
+            N:        number of particles
+            sections: list of tuples (number of orbitals, minimum and maximum number of particles)
+                      for consecutive sections of orbitals covering all orbitals (optional)
+            ref:      occupied orbitals of the reference determinant (optional, default the lowest `N` orbitals)
+            max_exc:  maximum excitation level with respect to the reference determinant (optional)
+        """
+        if sections is None:
+            sections = [(orbs, N, N)]
+        sections = np.asarray(sections, dtype=np.intc).reshape(-1, 3)
+        if np.sum(sections[:, 0]) != orbs:
+            raise ValueError('sections must cover all orbitals')
+        if ref is None:
+            ref = range(N)
+        self.orbs = orbs
+        self.N = N
+        self.sections = sections
+        self.ref = tuple(ref)
+        self.max_exc = max_exc
+        self.dets = fermifab.kernel.restricted_map(self._space)
+
+    @property
+    def _space(self):
+        ref = 0
+        for i in self.ref:
+            ref |= (1 << int(i))
+        return (self.orbs, self.N,
+                np.ascontiguousarray(self.sections[:, 0]),
+                np.ascontiguousarray(self.sections[:, 1]),
+                np.ascontiguousarray(self.sections[:, 2]),
+                ref, -1 if self.max_exc is None else self.max_exc)
+
+    def __len__(self):
+        return len(self.dets)
+
+    def index(self, dets):
+        """Indices of bit-encoded Slater determinants within the restricted space, or -1 if not contained."""
+        return fermifab.kernel.restricted_index(self._space, np.asarray(dets, dtype=np.uint64))
+
+    def embedding(self):
+        """Base indices of the Slater determinants with respect to the unrestricted Slater basis."""
+        return fermifab.kernel.fermi_index(self.dets)
+
+    def rdm_kernel(self, p, other=None):
+        """
+        Kernel K (as array of sparse matrices) for calculating p-body reduced density matrices,
+        with K[i][j] representing :math:`a^\\dagger_j a_i` as map from `self` to `other` (default `self`).
+        """
+        if other is None:
+            other = self
+        dims, val, ind = fermifab.kernel.gen_rdm_restricted(other._space, self._space, p)
+        return kernel_matrices(dims, val, ind)
+
+    def rdm(self, psi, p):
+        """
+        Calculate the p-body reduced density matrix of a state given by its coefficients `psi`
+        with respect to the restricted space.
+        """
+        psi = np.asarray(psi).reshape(-1)
+        assert len(psi) == len(self)
+        dims, val, ind = fermifab.kernel.gen_rdm_restricted(self._space, self._space, p)
+        return FermiOp(self.orbs, p, p, data=kernel_expectation(dims, val, ind, psi))
+
+    def p2N(self, h):
+        """
+        N-body operator :math:`H = \\sum_{ij} h_{ij} \\, a^\\dagger_i a_j` generated from the p-body operator `h`,
+        projected onto the restricted space.
+
+        Returns:
+            scipy.sparse.csr_matrix: operator w.r.t. the Slater determinants of the restricted space
+        """
+        assert type(h) == FermiOp and h.orbs == self.orbs and h.pFrom == h.pTo
+        dims, val, ind = fermifab.kernel.gen_rdm_restricted(self._space, self._space, h.pFrom)
+        return kernel_operator(dims, val, ind, h.data)
+
+
+def excitation_space(orbs, N, level, ref=None):
+    """
+    Slater determinants with at most `level` excitations with respect to
+    a reference determinant (default the lowest `N` orbitals), e.g., `level = 2` for CISD.
+    """
+    return RestrictedSpace(orbs, N, ref=ref, max_exc=level)
+
+
+def ras_space(ras1, ras2, ras3, N, max_holes, max_particles):
+    """
+    Restricted active space with `ras1`, `ras2` and `ras3` orbitals, allowing at most `max_holes` holes
+    in RAS1 and at most `max_particles` particles in RAS3.
+    """
+    sections = [(ras1, max(ras1 - max_holes, 0), ras1), (ras2, 0, ras2), (ras3, 0, max_particles)]
+    sections = [s for s in sections if s[0] > 0]
+    return RestrictedSpace(ras1 + ras2 + ras3, N, sections=sections)
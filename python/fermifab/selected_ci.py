@@ -0,0 +1,114 @@
+import numpy as np
+from scipy.sparse import csr_matrix
+from scipy.sparse.linalg import eigsh
+from .sparse_state import SparseFermiState
+import fermifab.kernel
+
+__all__ = ['SelectedCI']
+
+
+class SelectedCI(object):
+
+    def __init__(self, ints, N, dets=None):
+        """
+        Selected configuration interaction (CIPSI-type) for the Hamiltonian defined by one- and two-electron integrals,
+        growing a set of Slater determinants of the `2*norb` spin orbitals (alpha spin orbitals first) iteratively.
+
+        Args:
+            ints: `Integrals`
+            N:    tuple `(N_alpha, N_beta)`, or total number of electrons (then N_alpha = ceil(N/2))
+            dets: initial bit-encoded Slater determinants (optional, aufbau determinant by default)
+        """
+        self.ints = ints
+        norb = ints.norb
+        if np.isscalar(N):
+            N = ((N + 1)//2, N//2)
+        self.Na, self.Nb = N
+        assert 0 <= self.Na <= norb and 0 <= self.Nb <= norb and 2*norb <= 64
+        if dets is None:
+            dets = [(1 << self.Na) - 1 + (((1 << self.Nb) - 1) << norb)]
+        self.dets = np.unique(np.asarray(dets, dtype=np.uint64))
+        self.coeffs = None
+        self.energy = None
+        self.pt2 = None
+
+    def __len__(self):
+        return len(self.dets)
+
+    def hamiltonian(self, tol=0.):
+        """Sparse Hamiltonian with respect to the current determinants."""
+        rowptr, col, val = fermifab.kernel.hamiltonian_selected(self.ints.norb, self.ints.ecore, self.ints.h1, self.ints.eri, self.dets, tol)
+        n = len(self.dets)
+        return csr_matrix((val, col, rowptr), shape=(n, n))
+
+    def diagonalize(self, v0=None):
+        """
+        Ground state energy and coefficients in the space of the current determinants,
+        using an iterative eigensolver for larger spaces.
+        """
+        H = self.hamiltonian()
+        if H.shape[0] <= 256:
+            w, v = np.linalg.eigh(H.toarray())
+            self.energy, self.coeffs = w[0], v[:, 0]
+        else:
+            w, v = eigsh(H, k=1, which='SA', v0=v0)
+            self.energy, self.coeffs = w[0], v[:, 0]
+        return self.energy, self.coeffs
+
+    def candidates(self, eps=0.):
+        """
+        Determinants connected to the current variational state, together with their
+        Epstein-Nesbet second-order energy contributions.
+
+        Args:
+            eps: heat-bath threshold; only contributions |<T|H|D_n> c_n| > eps are generated
+
+        Returns:
+            tuple `(dets, e2)`
+        """
+        dets, coupling, diag = fermifab.kernel.selected_ci_candidates(self.ints.norb, self.ints.ecore, self.ints.h1, self.ints.eri,
+                                                                      self.dets, self.coeffs, eps)
+        denom = self.energy - diag
+        e2 = np.divide(coupling**2, denom, out=np.zeros_like(coupling), where=(denom != 0))
+        return dets, e2
+
+    def run(self, eps=1e-4, grow=2., max_dets=100000, max_iter=20, pt2_tol=1e-8):
+        """
+        Iteratively diagonalize the Hamiltonian in the selected space and add the connected determinants
+        with the largest second-order energy contributions, increasing the space by the factor `grow`
+        in each iteration.
+
+        Args:
+            eps:      heat-bath threshold for generating connected determinants
+            grow:     growth factor of the number of determinants per iteration
+            max_dets: maximum number of determinants
+            max_iter: maximum number of iterations
+            pt2_tol:  stop if the magnitude of the second-order energy correction falls below this tolerance
+
+        Returns:
+            tuple `(energy, pt2)` of the variational energy and second-order correction
+        """
+        v0 = None
+        for it in range(max_iter + 1):
+            self.diagonalize(v0)
+            dets, e2 = self.candidates(eps)
+            self.pt2 = np.sum(e2)
+            nadd = min(len(dets), max(1, int(np.ceil((grow - 1)*len(self.dets)))), max_dets - len(self.dets))
+            if nadd <= 0 or abs(self.pt2) < pt2_tol or it == max_iter:
+                break
+            sel = np.sort(np.argpartition(-np.abs(e2), nadd - 1)[:nadd])
+            # start vector: previous coefficients, with zeros for the new determinants
+            old = self.dets
+            self.dets = np.union1d(old, dets[sel])
+            v0 = np.zeros(len(self.dets))
+            v0[np.searchsorted(self.dets, old)] = self.coeffs
+        return self.energy, self.pt2
+
+    @property
+    def state(self):
+        """Variational state as `SparseFermiState` of the `2*norb` spin orbitals."""
+        return SparseFermiState(2*self.ints.norb, self.Na + self.Nb, dets=self.dets, data=self.coeffs)
+
+    def rdm(self, p):
+        """p-body reduced density matrix of the variational state (spin orbitals)."""
+        return self.state.rdm(p)
@@ -0,0 +1,70 @@
+import numpy as np
+from .fermistate import FermiState
+from .fermiop import FermiOp
+import fermifab.kernel
+
+__all__ = ['slater_state', 'slater_rdm', 'wick_rdm']
+
+
+def slater_state(C):
+    """
+    Construct the Slater determinant of N (not necessarily orthonormal) orbitals.
+
+    The state coefficients are the maximal minors (Pluecker coordinates) of `C`,
+    evaluated incrementally along the ordered Slater basis.
+
+    Args:
+        C: orbital coefficient matrix of dimension `orbs x N`, with the n-th column
+           containing the expansion coefficients of the n-th orbital
+
+    Returns:
+        FermiState: Slater determinant of the orbitals
+    """
+    C = np.asarray(C)
+    orbs, N = C.shape
+    return FermiState(orbs, N, data=fermifab.kernel.slater_state(C))
+
+
+def wick_rdm(g1, p):
+    """
+    Calculate the p-body reduced density matrix of a Slater determinant or,
+    more generally, of a quasi-free state, directly from its one-body reduced density matrix.
+
+    By Wick's theorem, the entries of the p-body RDM are the p x p minors of the one-body RDM,
+    such that the N-body space is never constructed.
+
+    Args:
+        g1: one-body reduced density matrix of type `FermiOp`
+        p:  target particle number
+
+    Returns:
+        FermiOp: p-body reduced density matrix
+    """
+    if g1.pFrom != 1 or g1.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    return FermiOp(g1.orbs, p, p, data=fermifab.kernel.compound_matrix(g1.data, p))
+
+
+def slater_rdm(C, p):
+    """
+    Calculate the p-body reduced density matrix of the (normalized) Slater determinant
+    of the orbitals given by the columns of `C`, without constructing the N-body state.
+
+    Using the Cauchy-Binet formula, the p-body RDM is the product of the p-th compound matrix
+    of the orthonormalized orbital coefficients with its adjoint.
+
+    Args:
+        C: orbital coefficient matrix of dimension `orbs x N`
+        p: target particle number
+
+    Returns:
+        FermiOp: p-body reduced density matrix
+    """
+    C = np.asarray(C)
+    orbs, N = C.shape
+    if p > N:
+        raise ValueError('target particle number cannot be larger than the number of orbitals in the determinant')
+    # orthonormalize orbitals; only changes the overall normalization of the determinant
+    Q, _ = np.linalg.qr(C)
+    W = fermifab.kernel.compound_matrix(Q, p)
+    return FermiOp(orbs, p, p, data=W @ W.conj().T)
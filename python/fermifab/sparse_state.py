@@ -0,0 +1,196 @@
+import numpy as np
+from scipy.sparse import csr_matrix
+from scipy.special import binom
+from .fermistate import FermiState
+from .fermiop import FermiOp
+import fermifab.kernel
+
+__all__ = ['SparseFermiState', 'slater_pair_rdm']
+
+
+def _det_bits(orbs, N):
+    """
+    Bit-encoded Slater determinants of the ordered N-particle basis.
+    """
+    coords = fermifab.kernel.fermi2coords((orbs,), (N,)).astype(np.uint64)
+    return np.bitwise_or.reduce(np.left_shift(np.uint64(1), coords), axis=1)
+
+
+def _popcount(dets):
+    count = np.zeros(len(dets), dtype=int)
+    for k in range(64):
+        count += ((dets >> np.uint64(k)) & np.uint64(1)).astype(int)
+    return count
+
+
+class SparseFermiState(object):
+
+    def __init__(self, orbs, N, dets=None, data=None):
+        """
+        Construct a sparse Fermi state, stored as list of bit-encoded Slater determinants
+        (bit `k` set if orbital `k` is occupied) and corresponding coefficients.
+
+        Repeated determinants are combined by adding their coefficients.
+
+        Args:
+            orbs:  number of orbitals (at most 64)
+            N:     number of particles
+            dets:  bit-encoded Slater determinants (optional, empty state by default)
+            data:  corresponding coefficients (optional)
+        """
+        self.orbs = orbs
+        self.N = N
+        assert 0 <= N <= orbs <= 64
+        if dets is None:
+            dets = np.zeros(0, dtype=np.uint64)
+            data = np.zeros(0, dtype=complex)
+        dets = np.asarray(dets, dtype=np.uint64).reshape(-1)
+        data = np.asarray(data).reshape(-1)
+        assert len(dets) == len(data)
+        assert np.all(_popcount(dets) == N)
+        if orbs < 64:
+            assert np.all(dets >> np.uint64(orbs) == 0)
+        # sort and combine repeated determinants
+        self.dets, inv = np.unique(dets, return_inverse=True)
+        self.data = np.zeros(len(self.dets), dtype=np.result_type(data.dtype, float))
+        np.add.at(self.data, inv, data)
+
+    @classmethod
+    def from_dense(cls, state, tol=0):
+        """
+        Convert a dense `FermiState` to a sparse state, discarding coefficients
+        with absolute value not larger than `tol`.
+        """
+        assert type(state) == FermiState
+        nz = np.nonzero(np.abs(state.data) > tol)[0]
+        return cls(state.orbs, state.N, dets=_det_bits(state.orbs, state.N)[nz], data=state.data[nz])
+
+    def to_dense(self):
+        """
+        Convert to a dense `FermiState` with respect to the ordered Slater basis.
+        """
+        psi = np.zeros(int(binom(self.orbs, self.N)), dtype=self.data.dtype)
+        psi[fermifab.kernel.fermi_index(self.dets)] = self.data
+        return FermiState(self.orbs, self.N, data=psi)
+
+    @property
+    def nnz(self):
+        return len(self.dets)
+
+    def __len__(self):
+        return int(binom(self.orbs, self.N))
+
+    def __repr__(self):
+        state_info = "Sparse Fermi State (orbs == {0}, N == {1}, nnz == {2})".format(self.orbs, self.N, self.nnz)
+        occ = [''.join('1' if (int(d) >> k) & 1 else '0' for k in range(self.orbs)) for d in self.dets]
+        data_info = '\n'.join('{0}  {1}'.format(o, c) for o, c in zip(occ, self.data))
+        return state_info + "\n\nOccupations and coefficients:\n\n" + data_info
+
+    # Operations with scalars
+
+    def __mul__(self, other):
+        if isinstance(other, (float, complex, int)):
+            return SparseFermiState(self.orbs, self.N, dets=self.dets, data=(other*self.data))
+        else:
+            raise ValueError("Argument for multiplication must be numeric. For operator multiplication, use the matmul operator '@' instead.")
+
+    def __rmul__(self, other):
+        return self.__mul__(other)
+
+    def __truediv__(self, other):
+        if isinstance(other, (float, complex, int)):
+            return SparseFermiState(self.orbs, self.N, dets=self.dets, data=(self.data / other))
+        else:
+            raise ValueError("Argument for division must be numeric.")
+
+    # Operations with other sparse fermi states
+
+    def __add__(self, other):
+        if type(self) == type(other):
+            assert ((self.orbs == other.orbs) & (self.N == other.N))
+            return SparseFermiState(self.orbs, self.N,
+                                    dets=np.concatenate((self.dets, other.dets)),
+                                    data=np.concatenate((self.data, other.data)))
+        else:
+            raise TypeError("Addition implemented only for objects of same type")
+
+    def __sub__(self, other):
+        if type(self) == type(other):
+            return self + (-1)*other
+        else:
+            raise TypeError("Subtraction implemented only for objects of same type")
+
+    def vdot(self, other):
+        """
+        Inner product <self | other>.
+        """
+        assert type(self) == type(other)
+        assert ((self.orbs == other.orbs) & (self.N == other.N))
+        _, i, j = np.intersect1d(self.dets, other.dets, assume_unique=True, return_indices=True)
+        return np.vdot(self.data[i], other.data[j])
+
+    def norm(self):
+        return np.linalg.norm(self.data)
+
+    # Operations with FermiOps
+
+    def __rmatmul__(self, other):
+        # FermiOp @ SparseFermiState: apply the N-body operator generated from the p-body operator,
+        # consistent with 'p2N'
+        if type(other) == FermiOp:
+            assert self.orbs == other.orbs
+            assert other.pFrom == other.pTo and other.pFrom <= self.N
+            dets, data = fermifab.kernel.sparse_apply(self.orbs, other.pFrom, other.data, self.dets, self.data)
+            if np.isrealobj(self.data) and np.isrealobj(other.data):
+                data = data.real
+            return SparseFermiState(self.orbs, self.N, dets=dets, data=data)
+        else:
+            raise TypeError("Operator multiplication only implemented for FermiOp @ SparseFermiState --> SparseFermiState")
+
+    def rdm(self, p):
+        """
+        Calculate the p-body reduced density matrix, without constructing the dense state vector.
+        """
+        G = fermifab.kernel.sparse_rdm(self.orbs, p, self.dets, self.data)
+        if np.isrealobj(self.data):
+            G = G.real
+        return FermiOp(self.orbs, p, p, data=G)
+
+    def copy(self):
+        return SparseFermiState(self.orbs, self.N, dets=self.dets.copy(), data=self.data.copy())
+
+
+def slater_pair_rdm(orbs, p, s1, s2, w=None, sparse=False):
+    """
+    Calculate the p-body reduced density matrix of a weighted sum of outer products
+    of Slater determinants :math:`\\sum_k w_k |s1_k\\rangle\\langle s2_k|`.
+
+    The cost scales with the number of determinant pairs instead of the Hilbert space dimension,
+    such that the RDM of a sparse CI expansion :math:`\\sum_n c_n |D_n\\rangle` can be evaluated
+    from the pairs (D_n, D_m) with weights :math:`c_n \\bar{c}_m` which are actually connected.
+
+    Args:
+        orbs:   number of orbitals (at most 64)
+        p:      target particle number
+        s1:     bit-encoded Slater determinants (bit `k` set if orbital `k` is occupied)
+        s2:     bit-encoded Slater determinants, same length as `s1`
+        w:      weights (optional, all equal to 1 by default)
+        sparse: whether to return a sparse matrix (optional)
+
+    Returns:
+        FermiOp: p-body reduced density matrix, or `scipy.sparse.csr_matrix` if `sparse` is True
+    """
+    s1 = np.asarray(s1, dtype=np.uint64).reshape(-1)
+    s2 = np.asarray(s2, dtype=np.uint64).reshape(-1)
+    if w is None:
+        w = np.ones(len(s1))
+    w = np.asarray(w).reshape(-1)
+    if sparse:
+        dims, val, ind = fermifab.kernel.slater_pair_rdm(orbs, p, p, s1, s2, w, True)
+        if np.isrealobj(w):
+            val = val.real
+        return csr_matrix((val, (ind[:, 0], ind[:, 1])), shape=dims)
+    G = fermifab.kernel.slater_pair_rdm(orbs, p, p, s1, s2, w)
+    if np.isrealobj(w):
+        G = G.real
+    return FermiOp(orbs, p, p, data=G)
@@ -1,7 +1,7 @@
 /// \file boson_map.c
 /// \brief Map between bit field representations of bosonic occupations and coordinate lists.
 //
-//  Copyright (c) 2008-2015, Christian B. Mendl
+//  Copyright (c) 2008-2020, Christian B. Mendl
 //  All rights reserved.
 //  http://christian.mendl.net
 //
@@ -22,7 +22,7 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <memory.h>
-#include <search.h>
+#include <limits.h>
 #include <assert.h>
 
 
@@ -98,12 +98,150 @@ void BosonDecode(const bitfield_t w, boson_coords_t *x, const int N)
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of 64-bit words required for the multi-word encoding of 'N' particles in 'modes' modes
+///
+int BosonWords(const int modes, const int N)
+{
+	const int nbits = 8*sizeof(bitfield_t);
+	return (modes + N - 1 + nbits - 1) / nbits;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Encode occupation numbers 'occ' into a multi-word bitfield
+///
+/// Same bit pattern as for 'BosonEncode', i.e., 'occ[m]' 1-bits for mode m followed by a 0-bit as separator,
+/// but spread over several words (bit k stored in word k / 64), such that the number of particles is not restricted
+/// by the word size. The output 'w' must have length 'BosonWords(modes, N)'.
+///
+void BosonEncodeWords(const int modes, const int *occ, bitfield_t *w)
+{
+	const int nbits = 8*sizeof(bitfield_t);
+
+	int N = IntegerSum(occ, modes);
+	memset(w, 0, BosonWords(modes, N) * sizeof(bitfield_t));
+
+	int k = 0;
+	int m;
+	for (m = 0; m < modes; m++)
+	{
+		int i;
+		for (i = 0; i < occ[m]; i++, k++)
+		{
+			w[k / nbits] |= ((bitfield_t)1) << (k % nbits);
+		}
+		// separator
+		k++;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Decode the multi-word bitfield 'w' of length 'nwords' into occupation numbers 'occ'
+///
+/// The number of particles N is the number of 1-bits, and the scan is restricted to the 'modes - 1 + N' bits
+/// of the encoding, such that no word beyond 'w[nwords - 1]' is accessed (the separator of the last mode
+/// is implicit and can lie beyond the last word). The last mode holds the remaining particles.
+///
+void BosonDecodeWords(const int modes, const int nwords, const bitfield_t *w, int *occ)
+{
+	const int nbits = 8*sizeof(bitfield_t);
+
+	int N = 0;
+	int j;
+	for (j = 0; j < nwords; j++) {
+		N += BitCount(w[j]);
+	}
+	const int len = modes - 1 + N;
+
+	int k = 0;
+	int n = 0;
+	int m;
+	for (m = 0; m < modes - 1; m++)
+	{
+		occ[m] = 0;
+		while (k < len && (w[k / nbits] & (((bitfield_t)1) << (k % nbits))))
+		{
+			occ[m]++;
+			k++;
+		}
+		n += occ[m];
+		// separator
+		k++;
+	}
+	occ[modes - 1] = N - n;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set up the ranking tables of the bosonic basis with 'N' particles in 'modes' modes,
+/// without materialising the map; return -1 if out of memory or if the dimension exceeds the 64-bit integer range
+///
+/// Using the "stars and bars" correspondence with the lexicographically ordered fermionic basis
+/// of 'N' particles in 'modes + N - 1' orbitals (see 'BosonEncode'), the base index of the occupation numbers n_m is
+/// sum_m [Binomial(m + k_m + n_m, m) - Binomial(m + k_m, m)], with k_m = n_0 + ... + n_{m-1}.
+///
+int BosonBasis(const int modes, const int N, boson_map_t *bm)
+{
+	assert(modes > 0 && N >= 0);
+
+	bm->map   = NULL;
+	bm->modes = modes;
+	bm->N     = N;
+
+	bm->binom = (int64_t *)malloc(modes*(N + 1) * sizeof(int64_t));
+	if (bm->binom == NULL) {
+		return -1;
+	}
+
+	// Pascal's rule: Binomial(m + k, m) = Binomial(m + k - 1, m - 1) + Binomial(m + k - 1, m)
+	int m, k;
+	for (k = 0; k <= N; k++) {
+		bm->binom[k] = 1;
+	}
+	for (m = 1; m < modes; m++)
+	{
+		int64_t *b  = &bm->binom[ m     *(N + 1)];
+		int64_t *bp = &bm->binom[(m - 1)*(N + 1)];
+		b[0] = 1;
+		for (k = 1; k <= N; k++)
+		{
+			if (bp[k] > INT64_MAX - b[k - 1]) {
+				free(bm->binom);
+				bm->binom = NULL;
+				return -1;
+			}
+			b[k] = bp[k] + b[k - 1];
+		}
+	}
+
+	bm->num = bm->binom[(modes - 1)*(N + 1) + N];
+
+	return 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Create a 'BosonMap': enumerate base indices and map to bit-encoded coordinates
 ///
 int BosonMap(const int modes, const int N, boson_map_t *bm)
 {
+	int status = BosonBasis(modes, N, bm);
+	if (status < 0) {
+		return status;
+	}
+	if (modes + N - 1 > (int)(8*sizeof(bitfield_t)) || bm->num > INT_MAX) {
+		// bit patterns do not fit into a single word
+		DeleteBosonMap(bm);
+		return -1;
+	}
+
 	// same as Fermi map - just interpreting bit patterns differently
 	int forbs = modes + N - 1;
 	fermi_config_t config;
@@ -112,31 +250,82 @@ int BosonMap(const int modes, const int N, boson_map_t *bm)
 	config.nc   = 1;
 
 	fermi_map_t fm;
-	int status = FermiMap(&config, &fm);
+	status = FermiMap(&config, &fm);
 	if (status < 0) {
+		DeleteBosonMap(bm);
 		return status;
 	}
-	bm->map = fm.map;  // copy pointers
-	bm->num = fm.num;
+	bm->map = fm.map;  // copy pointer
+	assert(bm->num == fm.num);
 
 	return 0;
 }
 
 
+void DeleteBosonMap(boson_map_t *bm)
+{
+	if (bm->map   != NULL) { free(bm->map);   }
+	if (bm->binom != NULL) { free(bm->binom); }
+
+	bm->map   = NULL;
+	bm->binom = NULL;
+	bm->num   = 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Convert bosonic coordinates to base index;
-/// return -1 if coordinates cannot be found
+/// \brief Base index of the occupation numbers 'occ' (vector of length 'modes'), with cost O(modes)
 ///
-int Boson2Base(const boson_map_t *bm, const boson_coords_t *x, const int N)
+int64_t BosonRank(const boson_map_t *bm, const int *occ)
 {
-	// encode 'x'
-	bitfield_t w = BosonEncode(x, N);
+	const int64_t *binom = bm->binom;
+	const int stride = bm->N + 1;
 
-	bitfield_t *bs = bsearch(&w, bm->map, bm->num, sizeof(bitfield_t), CompareBitfield);
-	if (bs == NULL) {
-		return -1;
+	int64_t r = 0;
+	int k = occ[0];
+	int m;
+	for (m = 1; m < bm->modes; m++)
+	{
+		if (occ[m] > 0)
+		{
+			r += binom[m*stride + k + occ[m]] - binom[m*stride + k];
+			k += occ[m];
+		}
 	}
+	assert(k == bm->N);
+
+	return r;
+}
 
-	return (int)(bs - bm->map);
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Occupation numbers 'occ' (vector of length 'modes') of the base index 'r', with cost O(modes + N)
+///
+void BosonUnrank(const boson_map_t *bm, const int64_t r, int *occ)
+{
+	assert(0 <= r && r < bm->num);
+
+	const int64_t *binom = bm->binom;
+	const int stride = bm->N + 1;
+
+	int64_t s = r;
+	// number of particles in modes 0, ..., m
+	int R = bm->N;
+	int m;
+	for (m = bm->modes - 1; m > 0; m--)
+	{
+		// find smallest k such that Binomial(m + k, m) >= Binomial(m + R, m) - s
+		const int64_t t = binom[m*stride + R] - s;
+		int k = R;
+		while (k > 0 && binom[m*stride + k - 1] >= t) {
+			k--;
+		}
+		occ[m] = R - k;
+		s -= binom[m*stride + R] - binom[m*stride + k];
+		R = k;
+	}
+	occ[0] = R;
+	assert(s == 0);
 }
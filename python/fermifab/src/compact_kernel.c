@@ -0,0 +1,237 @@
+/// \file compact_kernel.c
+/// \brief Compact encoding of the kernel tensors for calculating reduced density matrices.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+
+#include "compact_kernel.h"
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Convert the kernel tensor 'K' (entries +-1 ordered by (i, j), as generated by 'GenerateRDM' or 'GenerateRDMHalf')
+/// into the compact representation; 'half' indicates that only the blocks i <= j are stored
+///
+/// Returns -2 if 'K' is not of this form.
+///
+int CompressRDMKernel(const sparse_array_t *K, const bool half, compact_kernel_t *C)
+{
+	memset(C, 0, sizeof(compact_kernel_t));
+
+	if (K->rank != 4 || K->nnz < 0 || (half && K->dims[0] != K->dims[1])) {
+		return -2;
+	}
+
+	int n;
+	for (n = 0; n < 4; n++) {
+		C->dims[n] = K->dims[n];
+	}
+	const int maxdim = (K->dims[2] > K->dims[3] ? K->dims[2] : K->dims[3]);
+	C->width = (maxdim <= (1 << 8) ? 1 : (maxdim <= (1 << 16) ? 2 : 4));
+	C->half = half;
+	C->nnz = K->nnz;
+
+	// count blocks
+	int64_t k;
+	int nblocks = 0;
+	for (k = 0; k < K->nnz; k++)
+	{
+		const int *ind = &K->ind[4*k];
+		if (k == 0 || ind[0] != ind[-4] || ind[1] != ind[-3])
+		{
+			// blocks must be ordered by (i, j)
+			if (k > 0 && (ind[0] < ind[-4] || (ind[0] == ind[-4] && ind[1] < ind[-3]))) {
+				return -2;
+			}
+			nblocks++;
+		}
+		if (K->val[k] != 1 && K->val[k] != -1) {
+			return -2;
+		}
+	}
+	C->nblocks = nblocks;
+
+	const size_t nnz = (size_t)K->nnz;
+	C->sign       = (uint64_t *)calloc((nnz + 63) / 64, sizeof(uint64_t));
+	C->ind        = malloc(2*nnz * C->width);
+	C->blockstart = (int64_t *)malloc(((size_t)nblocks + 1) * sizeof(int64_t));
+	C->block      = (int *)malloc(2*(size_t)nblocks * sizeof(int));
+	if ((C->sign == NULL && K->nnz > 0) || (C->ind == NULL && K->nnz > 0) || C->blockstart == NULL || (C->block == NULL && nblocks > 0))
+	{
+		DeleteCompactKernel(C);
+		return -1;
+	}
+
+	int b = 0;
+	for (k = 0; k < K->nnz; k++)
+	{
+		const int *ind = &K->ind[4*k];
+		if (k == 0 || ind[0] != ind[-4] || ind[1] != ind[-3])
+		{
+			C->blockstart[b] = k;
+			C->block[2*b  ] = ind[0];
+			C->block[2*b+1] = ind[1];
+			b++;
+		}
+
+		if (K->val[k] < 0) {
+			C->sign[k >> 6] |= ((uint64_t)1 << (k & 63));
+		}
+
+		switch (C->width)
+		{
+			case 1:
+				((uint8_t *)C->ind)[2*k  ] = (uint8_t)ind[2];
+				((uint8_t *)C->ind)[2*k+1] = (uint8_t)ind[3];
+				break;
+			case 2:
+				((uint16_t *)C->ind)[2*k  ] = (uint16_t)ind[2];
+				((uint16_t *)C->ind)[2*k+1] = (uint16_t)ind[3];
+				break;
+			default:
+				((uint32_t *)C->ind)[2*k  ] = (uint32_t)ind[2];
+				((uint32_t *)C->ind)[2*k+1] = (uint32_t)ind[3];
+				break;
+		}
+	}
+	assert(b == nblocks);
+	C->blockstart[nblocks] = K->nnz;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a compact kernel (free memory)
+///
+void DeleteCompactKernel(compact_kernel_t *C)
+{
+	free(C->block);
+	free(C->blockstart);
+	free(C->ind);
+	free(C->sign);
+
+	C->block      = NULL;
+	C->blockstart = NULL;
+	C->ind        = NULL;
+	C->sign       = NULL;
+	C->nnz        = 0;
+	C->nblocks    = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Memory size of the compact kernel in bytes
+///
+int64_t CompactKernelBytes(const compact_kernel_t *C)
+{
+	return ((C->nnz + 63) / 64) * (int64_t)sizeof(uint64_t) + 2*C->nnz * C->width
+		+ (C->nblocks + 1) * (int64_t)sizeof(int64_t) + 2*C->nblocks * (int64_t)sizeof(int);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sum of sign * conj(psi[t]) * psi[d] over the entries in the range [start, end)
+///
+/// The loop is specialized for each index width, such that the indices are decoded by plain loads.
+///
+static double complex CompactBlockSum(const compact_kernel_t *C, const double complex *psi, const int64_t start, const int64_t end)
+{
+	double complex sum = 0;
+	int64_t k;
+
+	switch (C->width)
+	{
+		case 1:
+		{
+			const uint8_t *ind = (const uint8_t *)C->ind;
+			for (k = start; k < end; k++)
+			{
+				const double complex z = conj(psi[ind[2*k]]) * psi[ind[2*k+1]];
+				sum += ((C->sign[k >> 6] >> (k & 63)) & 1) ? -z : z;
+			}
+			break;
+		}
+		case 2:
+		{
+			const uint16_t *ind = (const uint16_t *)C->ind;
+			for (k = start; k < end; k++)
+			{
+				const double complex z = conj(psi[ind[2*k]]) * psi[ind[2*k+1]];
+				sum += ((C->sign[k >> 6] >> (k & 63)) & 1) ? -z : z;
+			}
+			break;
+		}
+		default:
+		{
+			const uint32_t *ind = (const uint32_t *)C->ind;
+			for (k = start; k < end; k++)
+			{
+				const double complex z = conj(psi[ind[2*k]]) * psi[ind[2*k+1]];
+				sum += ((C->sign[k >> 6] >> (k & 63)) & 1) ? -z : z;
+			}
+			break;
+		}
+	}
+
+	return sum;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Contract the compact kernel with the state 'psi', G[i,j] = <psi | K{i,j} psi>
+///
+/// The blocks are evaluated in parallel, and if only the blocks i <= j are stored, the lower triangle of G is filled
+/// by complex conjugation. 'G' must have dimension 'dims[0] x dims[1]', and 'psi' length 'dims[2]' (== dims[3]).
+///
+int ContractCompactKernel(const compact_kernel_t *C, const double complex *psi, double complex *G)
+{
+	assert(C->dims[2] == C->dims[3]);
+
+	const int ncols = C->dims[1];
+
+	memset(G, 0, (size_t)C->dims[0]*ncols * sizeof(double complex));
+
+	// every block contributes to a different entry of G
+	int b;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (b = 0; b < C->nblocks; b++)
+	{
+		G[(size_t)C->block[2*b]*ncols + C->block[2*b+1]] = CompactBlockSum(C, psi, C->blockstart[b], C->blockstart[b + 1]);
+	}
+
+	if (C->half)
+	{
+		int i, j;
+		for (i = 0; i < C->dims[0]; i++)
+		{
+			for (j = 0; j < i; j++)
+			{
+				G[(size_t)i*ncols + j] = conj(G[(size_t)j*ncols + i]);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,365 @@
+/// \file comprise.c
+/// \brief Index permutations between partition layouts, under orbital permutations and particle-hole conjugation, applied as signed gathers.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "comprise.h"
+#include "util.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Bit pattern with 'N' particles in 'orbs' orbitals and the given base index (single partition),
+/// using the combinatorial number system (inverse of 'FermiIndex')
+///
+static bitfield_t FermiUnrankSingle(const int orbs, const int N, int index)
+{
+	bitfield_t f = 0;
+	int x = orbs;
+	int k;
+	for (k = N; k > 0; k--)
+	{
+		// largest 'x' with Binomial(x, k) <= index
+		do {
+			x--;
+		}
+		while (Binomial(x, k) > index);
+		f |= ((bitfield_t)1) << x;
+		index -= Binomial(x, k);
+	}
+	assert(index == 0);
+
+	return f;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Bit pattern of the Slater determinant with the given base index of a configuration (inverse of 'Fermi2Base')
+///
+bitfield_t FermiUnrank(const fermi_config_t *config, const int index)
+{
+	bitfield_t f = 0;
+	int rem = index;
+	int offset = 0;
+	int k;
+	for (k = 0; k < config->nc; k++)
+	{
+		// partition 0 varies fastest
+		const int dim = Binomial(config->orbs[k], config->N[k]);
+		f |= FermiUnrankSingle(config->orbs[k], config->N[k], rem % dim) << offset;
+		rem /= dim;
+		offset += config->orbs[k];
+	}
+	assert(rem == 0);
+
+	return f;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Index permutation between two partition layouts 'src' and 'dst' of the same orbitals and particle number
+///
+/// For each base index 'i' of 'dst', perm[i] is the base index of the same Slater determinant with respect to 'src',
+/// or -1 if it is not contained in 'src' (e.g., if 'dst' merges partitions of 'src'). Since the orbitals are numbered
+/// consecutively in both layouts, the determinants agree including their sign. The 'dst' determinants are
+/// enumerated in parallel blocks, each starting from an unranked bit pattern, and ranked in 'src' by 'FermiConfigRank'
+/// in O(min(N, orbs - N)) operations, i.e., without storing a Fermi map or binary search (as the Matlab 'gen_comprise').
+///
+int ComprisePermutation(const fermi_config_t *src, const fermi_config_t *dst, int *perm)
+{
+	assert(IntegerSum(src->orbs, src->nc) == IntegerSum(dst->orbs, dst->nc));
+	assert(IntegerSum(src->N, src->nc) == IntegerSum(dst->N, dst->nc));
+
+	int num = 1;
+	int k;
+	for (k = 0; k < dst->nc; k++) {
+		num *= Binomial(dst->orbs[k], dst->N[k]);
+	}
+
+	int binom[65*65];
+	BinomialTable(binom);
+
+	const int block = 4096;
+	const int nblocks = (num + block - 1) / block;
+
+	int b;
+	#pragma omp parallel for schedule(static)
+	for (b = 0; b < nblocks; b++)
+	{
+		const int start = b * block;
+		const int end = (start + block < num ? start + block : num);
+		bitfield_t f = FermiUnrank(dst, start);
+		int i;
+		for (i = start; i < end; i++)
+		{
+			perm[i] = FermiConfigRank(src, binom, f);
+			if (i + 1 < end) {
+				f = NextFermiConfig(dst->orbs, dst->nc, f);
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Index map and fermionic sign of an orbital permutation 'sigma' (old orbital k -> new orbital sigma[k]),
+/// acting on the Slater determinants of 'N' particles in 'orbs' orbitals (single partition)
+///
+/// The permutation maps |k_1 ... k_N> to |sigma[k_1] ... sigma[k_N]> = sign |sorted>. For each new determinant 'i',
+/// perm[i] is the base index of its preimage and sign[i] the sign, such that the transformed state is the gather
+/// psi'[i] = sign[i] psi[perm[i]] (see 'PermuteGather'), avoiding the dim x dim permutation matrix.
+///
+int OrbitalPermutation(const int orbs, const int N, const int *sigma, int *perm, int *sign)
+{
+	assert(0 < orbs && orbs <= (int)(8*sizeof(bitfield_t)) && 0 <= N && N <= orbs);
+
+	int inv[64];
+	int k;
+	for (k = 0; k < orbs; k++) {
+		inv[sigma[k]] = k;
+	}
+
+	int binom[65*65];
+	BinomialTable(binom);
+
+	const int num = binom[orbs*65 + N];
+	const int block = 4096;
+	const int nblocks = (num + block - 1) / block;
+
+	fermi_config_t config;
+	config.orbs = (int *)&orbs;
+	config.N = (int *)&N;
+	config.nc = 1;
+
+	int b;
+	#pragma omp parallel for schedule(static)
+	for (b = 0; b < nblocks; b++)
+	{
+		const int start = b * block;
+		const int end = (start + block < num ? start + block : num);
+		bitfield_t f = FermiUnrank(&config, start);
+		int i;
+		for (i = start; i < end; i++)
+		{
+			// preimage of 'f'
+			bitfield_t g = 0;
+			bitfield_t h = f;
+			while (h)
+			{
+				const bitfield_t t = LastBit(h);
+				g |= ((bitfield_t)1) << inv[BitCount(t - 1)];
+				h -= t;
+			}
+			perm[i] = FermiConfigRank(&config, binom, g);
+
+			// parity of the number of inversions of sigma[k_1], ..., sigma[k_N]
+			int count = 0;
+			bitfield_t seen = 0;
+			h = g;
+			while (h)
+			{
+				const bitfield_t t = LastBit(h);
+				const bitfield_t s = ((bitfield_t)1) << sigma[BitCount(t - 1)];
+				count += BitCount(seen & ~(BitTrailFill(s)));
+				seen |= s;
+				h -= t;
+			}
+			sign[i] = 1 - 2*(count & 1);
+
+			if (i + 1 < end) {
+				f = NextFermi(f);
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Index map and sign of the particle-hole conjugation, mapping determinants of 'N' particles
+/// to those of 'orbs - N' particles in 'orbs' orbitals (single partition)
+///
+/// The determinant |D> is mapped to sign(D) |~D>, with the complement ~D and the sign of
+/// |D> wedge |~D> = sign(D) |0 1 ... orbs-1>, i.e., the annihilation sign of D within all orbitals.
+/// For each new determinant 'i' (with 'orbs - N' particles), perm[i] is the base index of its preimage
+/// and sign[i] the sign, to be applied as gather psi'[i] = sign[i] psi[perm[i]].
+///
+int ParticleHolePermutation(const int orbs, const int N, int *perm, int *sign)
+{
+	assert(0 < orbs && orbs <= (int)(8*sizeof(bitfield_t)) && 0 <= N && N <= orbs);
+
+	const bitfield_t full = (orbs < (int)(8*sizeof(bitfield_t)) ? ((bitfield_t)1) << orbs : 0) - 1;
+
+	int binom[65*65];
+	BinomialTable(binom);
+
+	const int M = orbs - N;
+	const int num = binom[orbs*65 + M];
+	const int block = 4096;
+	const int nblocks = (num + block - 1) / block;
+
+	fermi_config_t config_src, config_dst;
+	config_src.orbs = (int *)&orbs;
+	config_src.N = (int *)&N;
+	config_src.nc = 1;
+	config_dst.orbs = (int *)&orbs;
+	config_dst.N = (int *)&M;
+	config_dst.nc = 1;
+
+	int b;
+	#pragma omp parallel for schedule(static)
+	for (b = 0; b < nblocks; b++)
+	{
+		const int start = b * block;
+		const int end = (start + block < num ? start + block : num);
+		bitfield_t f = FermiUnrank(&config_dst, start);
+		int i;
+		for (i = start; i < end; i++)
+		{
+			const bitfield_t g = full & ~f;
+			perm[i] = FermiConfigRank(&config_src, binom, g);
+			sign[i] = AnnihilSign(full, g);
+			if (i + 1 < end) {
+				f = NextFermi(f);
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Gather y[i] = sign[i] * x[perm[i]], or 0 if perm[i] < 0, for vectors with 'ncomp' doubles per entry
+/// (1 for real and 2 for complex numbers); 'sign' can be NULL
+///
+void PermuteGather(const int n, const int *perm, const int *sign, const int ncomp, const double *x, double *y)
+{
+	int i;
+	#pragma omp parallel for schedule(static)
+	for (i = 0; i < n; i++)
+	{
+		const int j = perm[i];
+		const double s = (j < 0 ? 0 : (sign != NULL ? sign[i] : 1));
+		int c;
+		for (c = 0; c < ncomp; c++) {
+			y[i*ncomp + c] = (j < 0 ? 0 : s * x[j*ncomp + c]);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Gather y[i,j] = sign1[i] sign2[j] x[perm1[i], perm2[j]] (zero for negative indices) for row-major
+/// matrices with 'ncomp' doubles per entry, 'y' of dimension n1 x n2 and leading dimension 'ldx' of 'x';
+/// the sign arrays can be NULL
+///
+void PermuteGatherMatrix(const int n1, const int *perm1, const int *sign1, const int n2, const int *perm2, const int *sign2, const int ldx, const int ncomp, const double *x, double *y)
+{
+	int i;
+	#pragma omp parallel for schedule(static)
+	for (i = 0; i < n1; i++)
+	{
+		double *yrow = &y[(size_t)i*n2*ncomp];
+		if (perm1[i] < 0)
+		{
+			int j;
+			for (j = 0; j < n2*ncomp; j++) {
+				yrow[j] = 0;
+			}
+			continue;
+		}
+		const double *xrow = &x[(size_t)perm1[i]*ldx*ncomp];
+		const int s1 = (sign1 != NULL ? sign1[i] : 1);
+		int j;
+		for (j = 0; j < n2; j++)
+		{
+			const int m = perm2[j];
+			const double s = (m < 0 ? 0 : s1 * (sign2 != NULL ? sign2[j] : 1));
+			int c;
+			for (c = 0; c < ncomp; c++) {
+				yrow[j*ncomp + c] = (m < 0 ? 0 : s * xrow[m*ncomp + c]);
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief In-place version of 'PermuteGather' for a bijective index map 'perm' (no negative entries),
+/// following the cycles of the permutation; 'sign' can be NULL
+///
+int PermuteInPlace(const int n, const int *perm, const int *sign, const int ncomp, double *x)
+{
+	assert(ncomp == 1 || ncomp == 2);
+
+	char *visited = (char *)calloc(n > 0 ? n : 1, sizeof(char));
+	if (visited == NULL) {
+		return -1;
+	}
+
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		if (visited[i]) {
+			continue;
+		}
+
+		// x[j] <- sign[j] x[perm[j]] along the cycle starting at 'i'
+		double tmp[2];
+		int c;
+		for (c = 0; c < ncomp; c++) {
+			tmp[c] = x[i*ncomp + c];
+		}
+		int j = i;
+		for (;;)
+		{
+			visited[j] = 1;
+			const int k = perm[j];
+			assert(0 <= k && k < n);
+			const double s = (sign != NULL ? sign[j] : 1);
+			if (k == i)
+			{
+				for (c = 0; c < ncomp; c++) {
+					x[j*ncomp + c] = s * tmp[c];
+				}
+				break;
+			}
+			for (c = 0; c < ncomp; c++) {
+				x[j*ncomp + c] = s * x[k*ncomp + c];
+			}
+			j = k;
+		}
+	}
+
+	free(visited);
+
+	return 0;
+}
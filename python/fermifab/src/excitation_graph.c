@@ -0,0 +1,664 @@
+/// \file excitation_graph.c
+/// \brief Compressed graph of the single or double excitations connecting the Slater determinants of a configuration.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "excitation_graph.h"
+#include "slater_rdm.h"
+#include "util.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Ranking of the bit-encoded Slater determinants of a configuration, consistent with 'FermiMap'
+///
+typedef struct
+{
+	int part[64];           //!< partition of each orbital
+	int offset[64];         //!< first orbital of each partition
+	int stride[64];         //!< base index stride of each partition
+	int norbs;              //!< total number of orbitals
+	int nc;                 //!< number of partitions
+}
+config_rank_t;
+
+
+static void ConfigRank(const fermi_config_t *config, config_rank_t *rank)
+{
+	rank->nc = config->nc;
+	rank->norbs = 0;
+	int stride = 1;
+	int k;
+	for (k = 0; k < config->nc; k++)
+	{
+		rank->offset[k] = rank->norbs;
+		rank->stride[k] = stride;
+		int i;
+		for (i = 0; i < config->orbs[k]; i++) {
+			rank->part[rank->norbs + i] = k;
+		}
+		rank->norbs += config->orbs[k];
+		stride *= Binomial(config->orbs[k], config->N[k]);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Base index of the bit-encoded Slater determinant 'f', in O(N) operations
+///
+static inline int ConfigIndex(const config_rank_t *rank, const fermi_config_t *config, const bitfield_t f)
+{
+	int index = 0;
+	int k;
+	for (k = 0; k < rank->nc; k++)
+	{
+		const bitfield_t mask = (config->orbs[k] < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << config->orbs[k]) : 0) - 1;
+		index += FermiIndex((f >> rank->offset[k]) & mask) * rank->stride[k];
+	}
+
+	return index;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Decoded excitation graph entry
+///
+typedef struct
+{
+	int target;             //!< base index of the target determinant
+	int sign;               //!< sign
+	int orb[4];             //!< created orbitals followed by annihilated orbitals
+}
+excitation_entry_t;
+
+
+static int CompareExcitationEntry(const void *x, const void *y)
+{
+	const excitation_entry_t *a = (const excitation_entry_t *)x;
+	const excitation_entry_t *b = (const excitation_entry_t *)y;
+
+	if (a->target < b->target) {
+		return -1;
+	}
+	if (a->target > b->target) {
+		return 1;
+	}
+	return 0;
+}
+
+
+static inline void AddExcitation(const config_rank_t *rank, const fermi_config_t *config, const bitfield_t D, const bitfield_t A, const bitfield_t B, const int level, const int *orb, excitation_entry_t *e)
+{
+	const bitfield_t T = (D - A) | B;
+	bitfield_t a1, a2;
+	int sign;
+	SlaterRDM(D, T, level, &a1, &a2, &sign);
+
+	e->target = ConfigIndex(rank, config, T);
+	e->sign = sign;
+	memcpy(e->orb, orb, 2*level * sizeof(int));
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate all pure excitations of the given level of 'D' which conserve the particle number of each partition,
+/// sorted by target index; returns the number of excitations
+///
+static int GenerateExcitations(const config_rank_t *rank, const fermi_config_t *config, const bitfield_t D, const int level, excitation_entry_t *entries)
+{
+	const int norbs = rank->norbs;
+	int count = 0;
+
+	int i, j, k, l;
+	if (level == 1)
+	{
+		for (j = 0; j < norbs; j++)
+		{
+			const bitfield_t bj = ((bitfield_t)1) << j;
+			if ((D & bj) == 0) {
+				continue;
+			}
+			for (i = 0; i < norbs; i++)
+			{
+				const bitfield_t bi = ((bitfield_t)1) << i;
+				if ((D & bi) != 0 || rank->part[i] != rank->part[j]) {
+					continue;
+				}
+				const int orb[2] = { i, j };
+				AddExcitation(rank, config, D, bj, bi, 1, orb, &entries[count++]);
+			}
+		}
+	}
+	else
+	{
+		assert(level == 2);
+
+		for (j = 0; j < norbs; j++)
+		{
+			const bitfield_t bj = ((bitfield_t)1) << j;
+			if ((D & bj) == 0) {
+				continue;
+			}
+			for (l = j + 1; l < norbs; l++)
+			{
+				const bitfield_t bl = ((bitfield_t)1) << l;
+				if ((D & bl) == 0) {
+					continue;
+				}
+				for (i = 0; i < norbs; i++)
+				{
+					const bitfield_t bi = ((bitfield_t)1) << i;
+					if ((D & bi) != 0) {
+						continue;
+					}
+					for (k = i + 1; k < norbs; k++)
+					{
+						const bitfield_t bk = ((bitfield_t)1) << k;
+						if ((D & bk) != 0) {
+							continue;
+						}
+						// particle number of each partition must be conserved
+						const int pi = rank->part[i], pj = rank->part[j], pk = rank->part[k], pl = rank->part[l];
+						if (!((pi == pj && pk == pl) || (pi == pl && pk == pj))) {
+							continue;
+						}
+						const int orb[4] = { i, k, j, l };
+						AddExcitation(rank, config, D, bj | bl, bi | bk, 2, orb, &entries[count++]);
+					}
+				}
+			}
+		}
+	}
+
+	qsort(entries, count, sizeof(excitation_entry_t), CompareExcitationEntry);
+
+	return count;
+}
+
+
+static inline int VarintSize(uint64_t v)
+{
+	int size = 1;
+	while (v >= 0x80)
+	{
+		v >>= 7;
+		size++;
+	}
+
+	return size;
+}
+
+
+static inline uint8_t *VarintEncode(uint64_t v, uint8_t *p)
+{
+	while (v >= 0x80)
+	{
+		*p++ = (uint8_t)(v & 0x7F) | 0x80;
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+
+	return p;
+}
+
+
+static inline uint64_t EntryCode(const excitation_entry_t *e, const int prev)
+{
+	return (((uint64_t)(e->target - prev)) << 1) | (e->sign < 0 ? 1 : 0);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Build the excitation graph of the given level (1: singles, 2: doubles) for a fermionic configuration
+///
+/// The rows are generated in parallel, first to determine their encoded size and then to fill the preallocated data.
+///
+int ExcitationGraph(const fermi_config_t *config, const int level, excitation_graph_t *graph)
+{
+	assert(level == 1 || level == 2);
+
+	config_rank_t rank;
+	ConfigRank(config, &rank);
+	assert(rank.norbs <= (int)(8*sizeof(bitfield_t)));
+
+	fermi_map_t fm;
+	int status = FermiMap(config, &fm);
+	if (status < 0) {
+		return status;
+	}
+
+	graph->num = fm.num;
+	graph->level = level;
+	graph->data = NULL;
+	graph->offset = (int64_t *)malloc((fm.num + 1) * sizeof(int64_t));
+	if (graph->offset == NULL) {
+		free(fm.map);
+		return -1;
+	}
+
+	// maximum number of excitations per determinant
+	const int Ntot = IntegerSum(config->N, config->nc);
+	const int maxexc = Binomial(Ntot, level) * Binomial(rank.norbs - Ntot, level);
+
+	int pass;
+	for (pass = 0; pass < 2 && status == 0; pass++)
+	{
+		#pragma omp parallel
+		{
+			// thread-local workspace
+			excitation_entry_t *entries = (excitation_entry_t *)malloc((maxexc > 0 ? maxexc : 1) * sizeof(excitation_entry_t));
+			if (entries == NULL)
+			{
+				#pragma omp atomic write
+				status = -1;
+			}
+			else
+			{
+				int n;
+				#pragma omp for schedule(dynamic, 16)
+				for (n = 0; n < fm.num; n++)
+				{
+					const int count = GenerateExcitations(&rank, config, fm.map[n], level, entries);
+					int prev = 0;
+					int k;
+					if (pass == 0)
+					{
+						// encoded size of row 'n'
+						int64_t size = 0;
+						for (k = 0; k < count; k++)
+						{
+							size += VarintSize(EntryCode(&entries[k], prev)) + 2*level;
+							prev = entries[k].target;
+						}
+						graph->offset[n + 1] = size;
+					}
+					else
+					{
+						uint8_t *p = graph->data + graph->offset[n];
+						for (k = 0; k < count; k++)
+						{
+							p = VarintEncode(EntryCode(&entries[k], prev), p);
+							int m;
+							for (m = 0; m < 2*level; m++) {
+								*p++ = (uint8_t)entries[k].orb[m];
+							}
+							prev = entries[k].target;
+						}
+						assert(p == graph->data + graph->offset[n + 1]);
+					}
+				}
+			}
+
+			free(entries);
+		}
+
+		if (pass == 0 && status == 0)
+		{
+			graph->offset[0] = 0;
+			int n;
+			for (n = 0; n < fm.num; n++) {
+				graph->offset[n + 1] += graph->offset[n];
+			}
+			graph->data = (uint8_t *)malloc((graph->offset[fm.num] > 0 ? graph->offset[fm.num] : 1) * sizeof(uint8_t));
+			if (graph->data == NULL) {
+				status = -1;
+			}
+		}
+	}
+
+	free(fm.map);
+
+	if (status < 0) {
+		DeleteExcitationGraph(graph);
+	}
+
+	return status;
+}
+
+
+void DeleteExcitationGraph(excitation_graph_t *graph)
+{
+	if (graph->data   != NULL) { free(graph->data);   }
+	if (graph->offset != NULL) { free(graph->offset); }
+
+	graph->data   = NULL;
+	graph->offset = NULL;
+	graph->num    = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Check that an excitation graph (e.g., passed from outside) can be safely decoded for the given configuration;
+/// returns -1 otherwise
+///
+int ExcitationGraphValidate(const fermi_config_t *config, const excitation_graph_t *graph)
+{
+	config_rank_t rank;
+	ConfigRank(config, &rank);
+
+	int num = 1;
+	int k;
+	for (k = 0; k < config->nc; k++) {
+		num *= Binomial(config->orbs[k], config->N[k]);
+	}
+	if (graph->num != num || (graph->level != 1 && graph->level != 2) || graph->offset[0] != 0) {
+		return -1;
+	}
+
+	int n;
+	for (n = 0; n < graph->num; n++)
+	{
+		if (graph->offset[n + 1] < graph->offset[n]) {
+			return -1;
+		}
+		const uint8_t *p   = graph->data + graph->offset[n];
+		const uint8_t *end = graph->data + graph->offset[n + 1];
+		int64_t target = 0;
+		while (p < end)
+		{
+			// bounded variable-length integer decoding
+			uint64_t v = 0;
+			int shift = 0;
+			while (p < end && (*p & 0x80) && shift < 63)
+			{
+				v |= ((uint64_t)(*p & 0x7F)) << shift;
+				shift += 7;
+				p++;
+			}
+			if (p == end || (*p & 0x80)) {
+				return -1;
+			}
+			v |= ((uint64_t)*p) << shift;
+			p++;
+			target += (int64_t)(v >> 1);
+			if (target >= num || end - p < 2*graph->level) {
+				return -1;
+			}
+			for (k = 0; k < 2*graph->level; k++)
+			{
+				if (*p++ >= rank.norbs) {
+					return -1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Build and validate the excitation graphs up to the given level (1 or 2), and the Fermi map of the configuration
+///
+int ExcitationGraphs(const fermi_config_t *config, const int level, excitation_graphs_t *graphs)
+{
+	assert(level == 1 || level == 2);
+
+	memset(graphs, 0, sizeof(excitation_graphs_t));
+	graphs->norbs = IntegerSum(config->orbs, config->nc);
+	graphs->Ntot  = IntegerSum(config->N, config->nc);
+	graphs->level = level;
+
+	int status = FermiMap(config, &graphs->fm);
+	if (status < 0) {
+		return status;
+	}
+
+	status = ExcitationGraph(config, 1, &graphs->graph1);
+	if (status == 0 && level == 2) {
+		status = ExcitationGraph(config, 2, &graphs->graph2);
+	}
+	if (status == 0 && (ExcitationGraphValidate(config, &graphs->graph1) < 0 || (level == 2 && ExcitationGraphValidate(config, &graphs->graph2) < 0))) {
+		status = -2;
+	}
+	if (status < 0) {
+		DeleteExcitationGraphs(graphs);
+	}
+
+	return status;
+}
+
+
+void DeleteExcitationGraphs(excitation_graphs_t *graphs)
+{
+	DeleteExcitationGraph(&graphs->graph1);
+	DeleteExcitationGraph(&graphs->graph2);
+	free(graphs->fm.map);
+
+	graphs->fm.map = NULL;
+	graphs->fm.num = 0;
+}
+
+
+static inline bitfield_t OrbitalBits(const int *orb, const int n)
+{
+	bitfield_t f = 0;
+	int k;
+	for (k = 0; k < n; k++) {
+		f |= ((bitfield_t)1) << orb[k];
+	}
+
+	return f;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Add the terms sign[m] * w to G[a1[m], a2[m]], with atomic updates
+///
+static inline void AccumulateRDMTerms(const int dimP, const int nterms, const bitfield_t *a1, const bitfield_t *a2, const int *sign, const double complex w, double complex *G)
+{
+	int m;
+	for (m = 0; m < nterms; m++)
+	{
+		const double complex v = sign[m] * w;
+		double *g = (double *)&G[(size_t)FermiIndex(a1[m])*dimP + FermiIndex(a2[m])];
+		#pragma omp atomic
+		g[0] += creal(v);
+		#pragma omp atomic
+		g[1] += cimag(v);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sum of the terms sign[m] * h[a1[m], a2[m]]
+///
+static inline double complex ContractTerms(const int dimP, const int nterms, const bitfield_t *a1, const bitfield_t *a2, const int *sign, const double complex *h)
+{
+	double complex v = 0;
+	int m;
+	for (m = 0; m < nterms; m++)
+	{
+		v += sign[m] * h[(size_t)FermiIndex(a1[m])*dimP + FermiIndex(a2[m])];
+	}
+
+	return v;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-body reduced density matrix (p <= 2) of the state 'psi' using the excitation graphs
+///
+/// Same conventions as for 'GenerateRDM', with the orbitals of all partitions combined:
+/// G[i,j] = <psi | a_j^dagger a_i psi>, with 'G' of dimension 'Binomial(norbs, p) x Binomial(norbs, p)' and p <= level.
+/// Excitations of level p contribute a single term which is read off from the graph directly.
+///
+int ExcitationGraphRDM(const excitation_graphs_t *graphs, const int p, const double complex *psi, double complex *G)
+{
+	assert(0 <= p && p <= graphs->level);
+
+	const fermi_map_t *fm = &graphs->fm;
+	const int dimP = Binomial(graphs->norbs, p);
+	int status = 0;
+	memset(G, 0, (size_t)dimP*dimP * sizeof(double complex));
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		bitfield_t *a1 = (bitfield_t *)malloc(dimP * sizeof(bitfield_t));
+		bitfield_t *a2 = (bitfield_t *)malloc(dimP * sizeof(bitfield_t));
+		int *sign = (int *)malloc(dimP * sizeof(int));
+		if (a1 == NULL || a2 == NULL || sign == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int n;
+			#pragma omp for schedule(dynamic, 16)
+			for (n = 0; n < fm->num; n++)
+			{
+				if (psi[n] == 0) {
+					continue;
+				}
+				const bitfield_t D = fm->map[n];
+
+				// diagonal
+				int nterms = SlaterRDM(D, D, p, a1, a2, sign);
+				AccumulateRDMTerms(dimP, nterms, a1, a2, sign, psi[n] * conj(psi[n]), G);
+
+				int lev;
+				for (lev = 1; lev <= p; lev++)
+				{
+					const excitation_graph_t *graph = (lev == 1 ? &graphs->graph1 : &graphs->graph2);
+					const uint8_t *ptr = graph->data + graph->offset[n];
+					const uint8_t *end = graph->data + graph->offset[n + 1];
+					int t = 0;
+					while (ptr < end)
+					{
+						int cre[2], ann[2];
+						const int s = ExcitationGraphDecode(&ptr, lev, &t, cre, ann);
+						if (psi[t] == 0) {
+							continue;
+						}
+						if (lev == p)
+						{
+							a1[0] = OrbitalBits(ann, lev);
+							a2[0] = OrbitalBits(cre, lev);
+							sign[0] = s;
+							nterms = 1;
+						}
+						else {
+							nterms = SlaterRDM(D, fm->map[t], p, a1, a2, sign);
+						}
+						AccumulateRDMTerms(dimP, nterms, a1, a2, sign, psi[n] * conj(psi[t]), G);
+					}
+				}
+			}
+		}
+
+		free(sign);
+		free(a2);
+		free(a1);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply the N-body operator generated from the p-body operator 'h' (p <= 2) to the state 'psi'
+/// using the excitation graphs, i.e., out = sum_{ij} h[i,j] a_i^dagger a_j psi (same convention as 'p2N')
+///
+/// The graph is symmetric, such that each row of the output is gathered from the entries of the corresponding row
+/// without synchronization between threads. 'h' must have dimension 'Binomial(norbs, p) x Binomial(norbs, p)', and p <= level.
+///
+int ExcitationGraphApply(const excitation_graphs_t *graphs, const int p, const double complex *h, const double complex *psi, double complex *out)
+{
+	assert(0 <= p && p <= graphs->level);
+
+	const fermi_map_t *fm = &graphs->fm;
+	const int dimP = Binomial(graphs->norbs, p);
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		bitfield_t *a1 = (bitfield_t *)malloc(dimP * sizeof(bitfield_t));
+		bitfield_t *a2 = (bitfield_t *)malloc(dimP * sizeof(bitfield_t));
+		int *sign = (int *)malloc(dimP * sizeof(int));
+		if (a1 == NULL || a2 == NULL || sign == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int n;
+			#pragma omp for schedule(dynamic, 16)
+			for (n = 0; n < fm->num; n++)
+			{
+				const bitfield_t D = fm->map[n];
+
+				// diagonal
+				int nterms = SlaterRDM(D, D, p, a1, a2, sign);
+				double complex v = ContractTerms(dimP, nterms, a1, a2, sign, h) * psi[n];
+
+				int lev;
+				for (lev = 1; lev <= p; lev++)
+				{
+					const excitation_graph_t *graph = (lev == 1 ? &graphs->graph1 : &graphs->graph2);
+					const uint8_t *ptr = graph->data + graph->offset[n];
+					const uint8_t *end = graph->data + graph->offset[n + 1];
+					int t = 0;
+					while (ptr < end)
+					{
+						int cre[2], ann[2];
+						const int s = ExcitationGraphDecode(&ptr, lev, &t, cre, ann);
+						if (psi[t] == 0) {
+							continue;
+						}
+						if (lev == p)
+						{
+							a1[0] = OrbitalBits(ann, lev);
+							a2[0] = OrbitalBits(cre, lev);
+							sign[0] = s;
+							nterms = 1;
+						}
+						else {
+							nterms = SlaterRDM(D, fm->map[t], p, a1, a2, sign);
+						}
+						v += ContractTerms(dimP, nterms, a1, a2, sign, h) * psi[t];
+					}
+				}
+
+				out[n] = v;
+			}
+		}
+
+		free(sign);
+		free(a2);
+		free(a1);
+	}
+
+	return status;
+}
@@ -19,6 +19,8 @@
 
 #include "fermi_map.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <malloc.h>
 #include <memory.h>
@@ -108,7 +110,7 @@ bitfield_t NextFermi(const bitfield_t f)
 /// i.e., particle numbers N = { 4, 2 }
 /// -> output 0|01100|001111_2
 ///
-static bitfield_t NextFermiConfig(const int *orbs, const int nc, const bitfield_t f)
+bitfield_t NextFermiConfig(const int *orbs, const int nc, const bitfield_t f)
 {
 	assert(orbs[0] > 0);
 
@@ -186,6 +188,224 @@ int FermiMap(const fermi_config_t *config, fermi_map_t *fm)
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Symmetry label of the bit pattern 'f', i.e., combined label of the occupied orbitals
+///
+int FermiSymmetryLabel(const fermi_symmetry_t *sym, const bitfield_t f)
+{
+	bitfield_t g = f;  // local copy
+
+	int label = 0;
+	while (g)
+	{
+		bitfield_t t = LastBit(g);
+		label = SymmetryCombine(sym, label, sym->label[BitCount(t - 1)]);
+		g -= t;
+	}
+
+	return label;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a Fermi map ordered by symmetry sectors
+///
+/// The bit patterns of sector 's' are stored at 'fm->map[offset[s]], ..., fm->map[offset[s+1] - 1]', in lexicographical
+/// order within each sector. 'offset' must provide space for 'sym->order + 1' entries.
+/// Note that 'Fermi2Base' requires a numerically ordered map and can only be applied to individual sectors.
+///
+int FermiMapSectors(const fermi_config_t *config, const fermi_symmetry_t *sym, fermi_map_t *fm, int *offset)
+{
+	fermi_map_t full;
+	int status = FermiMap(config, &full);
+	if (status < 0) {
+		return status;
+	}
+
+	int *label = (int *)malloc(full.num * sizeof(int));
+	fm->num = full.num;
+	fm->map = (bitfield_t *)malloc(full.num * sizeof(bitfield_t));
+	if (label == NULL || fm->map == NULL)
+	{
+		free(fm->map);
+		free(label);
+		free(full.map);
+		return -1;
+	}
+
+	// counting sort by sector label, preserving the lexicographical order within each sector
+	memset(offset, 0, (sym->order + 1) * sizeof(int));
+	int i;
+	for (i = 0; i < full.num; i++)
+	{
+		label[i] = FermiSymmetryLabel(sym, full.map[i]);
+		offset[label[i] + 1]++;
+	}
+	int s;
+	for (s = 0; s < sym->order; s++) {
+		offset[s + 1] += offset[s];
+	}
+	int *pos = (int *)malloc(sym->order * sizeof(int));
+	if (pos == NULL)
+	{
+		free(fm->map);
+		free(label);
+		free(full.map);
+		return -1;
+	}
+	memcpy(pos, offset, sym->order * sizeof(int));
+	for (i = 0; i < full.num; i++)
+	{
+		fm->map[pos[label[i]]++] = full.map[i];
+	}
+
+	// clean up
+	free(pos);
+	free(label);
+	free(full.map);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a Fermi map of the bit patterns with symmetry label 'target' only
+///
+/// The resulting map is numerically ordered and can be used with 'Fermi2Base'.
+/// Only the target sector is enumerated: for each combination of bit patterns of partitions 1, ..., nc-1,
+/// the matching symmetry sector of partition 0 (see 'FermiMapSectors') is appended. Thus the full space is never
+/// enumerated, only the individual partitions and the product of the bit patterns of partitions 1, ..., nc-1.
+///
+int FermiMapSymmetry(const fermi_config_t *config, const fermi_symmetry_t *sym, const int target, fermi_map_t *fm)
+{
+	const int nc = config->nc;
+	assert(1 <= nc && nc <= 64);
+
+	fm->num = 0;
+	fm->map = NULL;
+
+	if (target < 0 || target >= sym->order)
+	{
+		// empty sector
+		fm->map = (bitfield_t *)malloc(sizeof(bitfield_t));
+		return (fm->map != NULL ? 0 : -1);
+	}
+
+	int i, k;
+	int status = 0;
+
+	// Fermi maps of the individual partitions: partition 0 ordered by symmetry sectors,
+	// and the other partitions numerically ordered, together with the labels of their bit patterns
+	fermi_map_t part[64];
+	int *plabel[64];
+	int shift[64];
+	memset(part, 0, sizeof(part));
+	memset(plabel, 0, sizeof(plabel));
+	int *offset = (int *)malloc((sym->order + 1) * sizeof(int));
+	if (offset == NULL) {
+		return -1;
+	}
+	for (k = 0; k < nc && status == 0; k++)
+	{
+		assert(0 <= config->N[k] && config->N[k] <= config->orbs[k]);
+		shift[k] = (k == 0 ? 0 : shift[k - 1] + config->orbs[k - 1]);
+
+		fermi_config_t pconfig;
+		pconfig.orbs = &config->orbs[k];
+		pconfig.N    = &config->N[k];
+		pconfig.nc   = 1;
+		fermi_symmetry_t psym = (*sym);
+		psym.label = &sym->label[shift[k]];
+
+		if (k == 0)
+		{
+			status = FermiMapSectors(&pconfig, &psym, &part[0], offset);
+		}
+		else
+		{
+			status = FermiMap(&pconfig, &part[k]);
+			if (status == 0)
+			{
+				plabel[k] = (int *)malloc(part[k].num * sizeof(int));
+				if (plabel[k] == NULL) {
+					status = -1;
+				}
+				else
+				{
+					for (i = 0; i < part[k].num; i++) {
+						plabel[k][i] = FermiSymmetryLabel(&psym, part[k].map[i]);
+					}
+				}
+			}
+		}
+	}
+
+	int pass;
+	for (pass = 0; pass < 2 && status == 0; pass++)
+	{
+		if (pass == 1)
+		{
+			fm->map = (bitfield_t *)malloc((fm->num > 0 ? fm->num : 1) * sizeof(bitfield_t));
+			if (fm->map == NULL)
+			{
+				status = -1;
+				break;
+			}
+		}
+
+		// iterate over the bit patterns of partitions 1, ..., nc-1, partition 1 fastest, such that the map is numerically ordered
+		int idx[64];
+		memset(idx, 0, sizeof(idx));
+		int count = 0;
+		while (true)
+		{
+			bitfield_t f = 0;
+			int label = 0;
+			for (k = 1; k < nc; k++)
+			{
+				f |= part[k].map[idx[k]] << shift[k];
+				label = SymmetryCombine(sym, label, plabel[k][idx[k]]);
+			}
+
+			// required sector of partition 0
+			const int s = SymmetryCombine(sym, target, SymmetryInverse(sym, label));
+			if (pass == 1)
+			{
+				for (i = offset[s]; i < offset[s + 1]; i++) {
+					fm->map[count + i - offset[s]] = part[0].map[i] | f;
+				}
+			}
+			count += offset[s + 1] - offset[s];
+
+			for (k = 1; k < nc; k++)
+			{
+				if (++idx[k] < part[k].num) {
+					break;
+				}
+				idx[k] = 0;
+			}
+			if (k == nc) {
+				break;
+			}
+		}
+		fm->num = count;
+	}
+
+	// clean up
+	for (k = 0; k < nc; k++)
+	{
+		free(plabel[k]);
+		free(part[k].map);
+	}
+	free(offset);
+
+	return status;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Swap two Fermi coordinates
@@ -318,6 +538,103 @@ int Fermi2BaseSign(const fermi_map_t *fm, const fermi_coords_t *x, const int N,
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Base index of the bit pattern 'f' with respect to a single partition, i.e., its position
+/// in the lexicographically ordered Fermi map with BitCount(f) particles
+///
+/// Uses the combinatorial number system: the occupied orbitals x[0] < x[1] < ... contribute Binomial(x[i], i + 1);
+/// avoids the stored map and binary search required by 'Fermi2Base'
+///
+int FermiIndex(const bitfield_t f)
+{
+	bitfield_t g = f;  // local copy
+
+	int index = 0;
+	int i = 1;
+	int k = 0;
+	while (g)
+	{
+		if (g & 1)
+		{
+			index += Binomial(k, i);
+			i++;
+		}
+		g >>= 1;
+		k++;
+	}
+
+	return index;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Table of binomial coefficients, binom[n*65 + k] == Binomial(n, k) for n, k <= 64 (truncated to int range)
+///
+void BinomialTable(int *binom)
+{
+	int n, k;
+	for (n = 0; n <= 64; n++)
+	{
+		binom[n*65] = 1;
+		for (k = 1; k <= 64; k++)
+		{
+			const int64_t b = (n > 0 ? (int64_t)binom[(n-1)*65 + k-1] + binom[(n-1)*65 + k] : 0);
+			binom[n*65 + k] = (b < INT_MAX ? (int)b : INT_MAX);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Base index of 'f' with respect to a configuration, or -1 if the particle numbers of the partitions differ
+///
+/// Uses the binomial table 'binom' (see 'BinomialTable') and visits the occupied orbitals of each partition,
+/// or its unoccupied orbitals (holes) if N > orbs/2: the complement reverses the lexicographic order,
+/// such that the base index equals Binomial(orbs, N) - 1 minus the index of the hole pattern.
+///
+int FermiConfigRank(const fermi_config_t *config, const int *binom, const bitfield_t f)
+{
+	int index = 0;
+	int stride = 1;
+	int offset = 0;
+	int k;
+	for (k = 0; k < config->nc; k++)
+	{
+		const int orbs = config->orbs[k];
+		const int N = config->N[k];
+		const int dim = binom[orbs*65 + N];
+		const bitfield_t mask = (orbs < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << orbs) : 0) - 1;
+		// hole picture
+		const bool holes = (2*N > orbs);
+		bitfield_t g = (f >> offset) & mask;
+		if (holes) {
+			g = mask & ~g;
+		}
+		int ind = 0;
+		int i = 1;
+		while (g)
+		{
+			// number of trailing zeros is the orbital index
+			const bitfield_t t = LastBit(g);
+			ind += binom[BitCount(t - 1)*65 + i];
+			i++;
+			g -= t;
+		}
+		if (i - 1 != (holes ? orbs - N : N)) {
+			return -1;
+		}
+		index += (holes ? dim - 1 - ind : ind) * stride;
+		stride *= dim;
+		offset += orbs;
+	}
+
+	return index;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Obtain annihilation sign
@@ -0,0 +1,459 @@
+/// \file fermi_union.c
+/// \brief Basis given by the union of several configurations (particle numbers per partition) of a partitioned Fermi space.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "fermi_union.h"
+#include "generate_rdm.h"
+#include "util.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <memory.h>
+#include <limits.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Table of the number of configurations of n particles in slots 0, ..., i-1, stored at cnt[i*(N + 1) + n]
+///
+/// Replaces the filtering and second counting pass of the Matlab 'NextConfigMax' by a dynamic program
+/// with O(nc N^2) operations.
+///
+static int64_t *ConfigCountTable(const int nc, const int N, const int *maxC)
+{
+	int64_t *cnt = (int64_t *)calloc((size_t)(nc + 1)*(N + 1), sizeof(int64_t));
+	if (cnt == NULL) {
+		return NULL;
+	}
+
+	cnt[0] = 1;
+	int i;
+	for (i = 1; i <= nc; i++)
+	{
+		const int m = (maxC != NULL && maxC[i-1] < N ? maxC[i-1] : N);
+		int n;
+		for (n = 0; n <= N; n++)
+		{
+			int64_t sum = 0;
+			int c;
+			for (c = 0; c <= m && c <= n; c++) {
+				sum += cnt[(i-1)*(N + 1) + n - c];
+			}
+			cnt[i*(N + 1) + n] = sum;
+		}
+	}
+
+	return cnt;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of configurations of 'N' particles in 'nc' slots, such that not more than 'maxC[i]' particles
+/// are in slot 'i' ('maxC' can be NULL for no restriction); returns -1 if out of memory or too many configurations
+///
+int ConfigCount(const int nc, const int N, const int *maxC)
+{
+	assert(nc > 0 && N >= 0);
+
+	int64_t *cnt = ConfigCountTable(nc, N, maxC);
+	if (cnt == NULL) {
+		return -1;
+	}
+	const int64_t num = cnt[nc*(N + 1) + N];
+	free(cnt);
+
+	return (num <= INT_MAX ? (int)num : -1);
+}
+
+
+static void EnumerateConfigs(const int i, const int n, const int nc, const int N, const int *maxC, const int64_t *cnt, int *cur, int *conf, int *pos)
+{
+	if (i == 0)
+	{
+		memcpy(&conf[(*pos)*nc], cur, nc * sizeof(int));
+		(*pos)++;
+		return;
+	}
+
+	// slot i-1 varies slowest among the remaining slots
+	const int m = (maxC != NULL && maxC[i-1] < n ? maxC[i-1] : n);
+	int c;
+	for (c = 0; c <= m; c++)
+	{
+		if (cnt[(i-1)*(N + 1) + n - c] > 0)
+		{
+			cur[i-1] = c;
+			EnumerateConfigs(i - 1, n - c, nc, N, maxC, cnt, cur, conf, pos);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Enumerate all configurations of 'N' particles in 'nc' slots, such that not more than 'maxC[i]' particles
+/// are in slot 'i' ('maxC' can be NULL for no restriction)
+///
+/// 'conf' must provide space for 'ConfigCount(nc, N, maxC) x nc' entries. The order agrees with the Matlab 'gen_config',
+/// e.g., (2,0,0), (1,1,0), (0,2,0), (1,0,1), (0,1,1), (0,0,2) for nc = 3 and N = 2.
+/// Only valid configurations are visited, guided by the count table.
+///
+int GenConfig(const int nc, const int N, const int *maxC, int *conf)
+{
+	assert(nc > 0 && N >= 0);
+
+	int64_t *cnt = ConfigCountTable(nc, N, maxC);
+	int *cur = (int *)malloc(nc * sizeof(int));
+	if (cnt == NULL || cur == NULL)
+	{
+		free(cur);
+		free(cnt);
+		return -1;
+	}
+
+	int pos = 0;
+	if (cnt[nc*(N + 1) + N] > 0) {
+		EnumerateConfigs(nc, N, nc, N, maxC, cnt, cur, conf, &pos);
+	}
+	assert(pos == cnt[nc*(N + 1) + N]);
+
+	// clean up
+	free(cur);
+	free(cnt);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Packed code of the particle numbers of each partition
+///
+static inline uint64_t UnionCode(const fermi_union_t *fu, const int *N)
+{
+	uint64_t code = 0;
+	int k;
+	for (k = 0; k < fu->nc; k++) {
+		code |= ((uint64_t)N[k]) << fu->codeoff[k];
+	}
+	return code;
+}
+
+
+typedef struct
+{
+	uint64_t code;
+	int sector;
+}
+union_code_t;
+
+
+static int CompareUnionCode(const void *x, const void *y)
+{
+	const uint64_t cx = ((const union_code_t *)x)->code;
+	const uint64_t cy = ((const union_code_t *)y)->code;
+	return (cx > cy) - (cx < cy);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set up the union of the configurations N[s*nc], ..., N[s*nc + nc-1] (s = 0, ..., nconf-1);
+/// returns -2 if a configuration appears twice
+///
+int FermiUnion(const int *orbs, const int nc, const int *N, const int nconf, fermi_union_t *fu)
+{
+	assert(nc > 0 && nconf >= 0);
+
+	fu->orbs = orbs;
+	fu->N = N;
+	fu->nc = nc;
+	fu->nconf = nconf;
+
+	int k;
+	int norbs = 0;
+	int bits = 0;
+	for (k = 0; k < nc; k++)
+	{
+		fu->partoff[k] = norbs;
+		fu->codeoff[k] = bits;
+		norbs += orbs[k];
+		// number of bits required for storing 0, ..., orbs[k]
+		int b = 1;
+		while ((1 << b) <= orbs[k]) {
+			b++;
+		}
+		bits += b;
+	}
+	assert(norbs <= (int)(8*sizeof(bitfield_t)) && bits <= 64);
+
+	fu->offset = (int *)malloc((nconf + 1) * sizeof(int));
+	fu->stride = (int *)malloc((nconf > 0 ? nconf*nc : 1) * sizeof(int));
+	fu->code   = (uint64_t *)malloc((nconf > 0 ? nconf : 1) * sizeof(uint64_t));
+	fu->sector = (int *)malloc((nconf > 0 ? nconf : 1) * sizeof(int));
+	if (fu->offset == NULL || fu->stride == NULL || fu->code == NULL || fu->sector == NULL)
+	{
+		DeleteFermiUnion(fu);
+		return -1;
+	}
+
+	// closed-form dimensions and strides of the configurations
+	int64_t offset = 0;
+	int s;
+	for (s = 0; s < nconf; s++)
+	{
+		fu->offset[s] = (int)offset;
+		int stride = 1;
+		for (k = 0; k < nc; k++)
+		{
+			assert(0 <= N[s*nc + k] && N[s*nc + k] <= orbs[k]);
+			fu->stride[s*nc + k] = stride;
+			stride *= Binomial(orbs[k], N[s*nc + k]);
+		}
+		offset += stride;
+		if (offset > INT_MAX)
+		{
+			DeleteFermiUnion(fu);
+			return -1;
+		}
+	}
+	fu->offset[nconf] = (int)offset;
+	fu->num = (int)offset;
+
+	// sort the configuration codes, for ranking by binary search
+	union_code_t *codes = (union_code_t *)malloc((nconf > 0 ? nconf : 1) * sizeof(union_code_t));
+	if (codes == NULL)
+	{
+		DeleteFermiUnion(fu);
+		return -1;
+	}
+	for (s = 0; s < nconf; s++)
+	{
+		codes[s].code = UnionCode(fu, &N[s*nc]);
+		codes[s].sector = s;
+	}
+	qsort(codes, nconf, sizeof(union_code_t), CompareUnionCode);
+	for (s = 0; s < nconf; s++)
+	{
+		fu->code[s]   = codes[s].code;
+		fu->sector[s] = codes[s].sector;
+	}
+	free(codes);
+	for (s = 1; s < nconf; s++)
+	{
+		if (fu->code[s] == fu->code[s-1])
+		{
+			DeleteFermiUnion(fu);
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a union of configurations (free memory)
+///
+void DeleteFermiUnion(fermi_union_t *fu)
+{
+	free(fu->sector);
+	free(fu->code);
+	free(fu->stride);
+	free(fu->offset);
+	fu->sector = NULL;
+	fu->code   = NULL;
+	fu->stride = NULL;
+	fu->offset = NULL;
+	fu->num = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Bit patterns of the union basis, with the configurations in the given order
+///
+int FermiUnionMap(const fermi_union_t *fu, fermi_map_t *fm)
+{
+	fm->num = fu->num;
+	fm->map = (bitfield_t *)malloc((fu->num > 0 ? fu->num : 1) * sizeof(bitfield_t));
+	if (fm->map == NULL) {
+		return -1;
+	}
+
+	fermi_config_t config;
+	config.orbs = (int *)fu->orbs;
+	config.nc = fu->nc;
+
+	int s;
+	for (s = 0; s < fu->nconf; s++)
+	{
+		fermi_map_t sector;
+		config.N = (int *)&fu->N[s*fu->nc];
+		int status = FermiMap(&config, &sector);
+		if (status < 0)
+		{
+			free(fm->map);
+			fm->map = NULL;
+			return status;
+		}
+		assert(sector.num == fu->offset[s + 1] - fu->offset[s]);
+		memcpy(&fm->map[fu->offset[s]], sector.map, sector.num * sizeof(bitfield_t));
+		free(sector.map);
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Base index of the bit pattern 'f' within the union, or -1 if its configuration is not contained
+///
+int FermiUnionIndex(const fermi_union_t *fu, const bitfield_t f)
+{
+	// particle numbers and base indices within each partition
+	int N[64];
+	int ind[64];
+	int k;
+	for (k = 0; k < fu->nc; k++)
+	{
+		const bitfield_t mask = (fu->orbs[k] < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << fu->orbs[k]) : 0) - 1;
+		const bitfield_t g = (f >> fu->partoff[k]) & mask;
+		N[k] = BitCount(g);
+		ind[k] = FermiIndex(g);
+	}
+	const uint64_t code = UnionCode(fu, N);
+
+	// binary search
+	int lo = 0, hi = fu->nconf;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (fu->code[mid] < code) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	if (lo == fu->nconf || fu->code[lo] != code) {
+		return -1;
+	}
+	const int s = fu->sector[lo];
+
+	int index = fu->offset[s];
+	for (k = 0; k < fu->nc; k++) {
+		index += ind[k] * fu->stride[s*fu->nc + k];
+	}
+
+	return index;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Rank callback of 'GenerateRDMRow' for the union basis 'fu'
+///
+static int FermiUnionRankCallback(const void *fu, const bitfield_t f)
+{
+	return FermiUnionIndex((const fermi_union_t *)fu, f);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the kernel tensor K for calculating p-body reduced density matrices on unions of configurations,
+/// covering all configurations in a single call
+///
+/// Same conventions as for 'GenerateRDM', with the N1- and N2-particle indices referring to the union bases
+/// 'fu1' and 'fu2' (with the same partitioning and total particle numbers N1 and N2, respectively), and
+/// the p1- and p2-particle indices to the lexicographically ordered Slater basis of all orbitals
+/// (p2 = N1 - N2 + p1), which contains the p-particle configurations of all partitions.
+/// The rows are generated in parallel, first to determine their number of entries and then to fill them.
+///
+int GenerateRDMUnion(const fermi_union_t *fu1, const fermi_union_t *fu2, const int p1, sparse_array_t *K)
+{
+	assert(fu1->nc == fu2->nc);
+
+	const int norbs = IntegerSum(fu1->orbs, fu1->nc);
+	const int N1 = (fu1->nconf > 0 ? IntegerSum(fu1->N, fu1->nc) : 0);
+	const int N2 = (fu2->nconf > 0 ? IntegerSum(fu2->N, fu2->nc) : 0);
+	const int p2 = N1 - N2 + p1;
+	assert(0 <= p1 && p1 <= N2);
+	assert(0 <= p2 && p2 <= norbs - N2 + p1);
+
+	fermi_map_t map2;
+	int status = FermiUnionMap(fu2, &map2);
+	if (status < 0) {
+		return status;
+	}
+
+	int *offset = (int *)malloc((map2.num + 1) * sizeof(int));
+	if (offset == NULL) {
+		free(map2.map);
+		return -1;
+	}
+
+	// number of entries of each row
+	int n;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (n = 0; n < map2.num; n++)
+	{
+		offset[n + 1] = GenerateRDMRow(norbs, map2.map[n], n, p1, p2, FermiUnionRankCallback, fu1, NULL, NULL);
+	}
+	offset[0] = 0;
+	for (n = 0; n < map2.num; n++) {
+		offset[n + 1] += offset[n];
+	}
+
+	// create sparse array
+	K->rank = 4;
+	K->dims = (int *)malloc(K->rank * sizeof(int));
+	K->nnz = offset[map2.num];
+	K->val = (double *)malloc((K->nnz > 0 ? K->nnz : 1) * sizeof(double));
+	K->ind = (int *)malloc((K->nnz > 0 ? K->nnz : 1)*K->rank * sizeof(int));
+	if (K->dims == NULL || K->val == NULL || K->ind == NULL)
+	{
+		free(offset);
+		free(map2.map);
+		return -1;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (n = 0; n < map2.num; n++)
+	{
+		const int count = GenerateRDMRow(norbs, map2.map[n], n, p1, p2, FermiUnionRankCallback, fu1, &K->ind[4*offset[n]], &K->val[offset[n]]);
+		assert(count == offset[n + 1] - offset[n]);
+		(void)count;
+	}
+
+	// set array dimensions
+	K->dims[0] = Binomial(norbs, p1);
+	K->dims[1] = Binomial(norbs, p2);
+	K->dims[2] = fu1->num;
+	K->dims[3] = fu2->num;
+
+	// clean up
+	free(offset);
+	free(map2.map);
+
+	return 0;
+}
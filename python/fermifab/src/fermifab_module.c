@@ -3,10 +3,26 @@
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 #include <numpy/arrayobject.h>
 #include "fermi_map.h"
+#include "boson_map.h"
 #include "generate_rdm.h"
+#include "generate_rdm_boson.h"
 #include "tensor_op.h"
+#include "tensor_op_boson.h"
+#include "tensor_spectrum.h"
+#include "sparse_state.h"
+#include "slater_rdm.h"
+#include "string_ci.h"
+#include "excitation_graph.h"
+#include "restricted_space.h"
+#include "fermi_union.h"
+#include "comprise.h"
+#include "integrals.h"
+#include "hamiltonian.h"
+#include "selected_ci.h"
+#include "compact_kernel.h"
 #include <stdbool.h>
 #include <inttypes.h>
+#include <limits.h>
 
 
 //________________________________________________________________________________________________________________________
@@ -419,6 +435,241 @@ static PyObject *gen_rdm(PyObject *self, PyObject *args)
 }
 
 
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_boson(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int modes, p1, N1, N2;
+	if (!PyArg_ParseTuple(args, "iiii", &modes, &p1, &N1, &N2)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_boson(modes, p1, N1, N2)");
+		return NULL;
+	}
+	if (modes <= 0 || p1 < 0 || N1 < 0 || N2 < 0) {
+		PyErr_SetString(PyExc_ValueError, "'modes' must be positive and 'p1', 'N1', 'N2' non-negative; syntax: gen_rdm_boson(modes, p1, N1, N2)");
+		return NULL;
+	}
+	if (p1 > N2 || N1 - N2 + p1 < 0) {
+		PyErr_SetString(PyExc_ValueError, "'p1' cannot be larger than 'N2', and 'N1 - N2 + p1' must be non-negative; syntax: gen_rdm_boson(modes, p1, N1, N2)");
+		return NULL;
+	}
+
+	// actually compute kernel tensor
+	sparse_array_t K = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMBoson(modes, p1, N1, N2, &K);
+	Py_END_ALLOW_THREADS
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+
+	// kernel tensor dimensions
+	assert(K.rank == 4);
+	PyObject *dims_obj = Py_BuildValue("(iiii)", K.dims[0], K.dims[1], K.dims[2], K.dims[3]);
+
+	// construct array of values
+	npy_intp dims_val[1] = { K.nnz };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_DOUBLE);
+	if (val_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned value vector");
+		Py_DECREF(dims_obj);
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(val_arr), K.val, K.nnz * sizeof(double));
+
+	// construct array of indices
+	npy_intp dims_ind[2] = { K.nnz, K.rank };
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(K.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned array of indices");
+		Py_DECREF(dims_obj);
+		Py_DECREF(val_arr);
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(ind_arr), K.ind, K.nnz*K.rank * sizeof(K.ind[0]));
+
+	// clean up
+	DeleteSparseArray(&K);
+
+	return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Dimension of the bosonic basis, or -1 if it exceeds the integer range
+///
+static int BosonDim(const int modes, const int N)
+{
+	boson_map_t bm;
+	if (BosonBasis(modes, N, &bm) < 0) {
+		return -1;
+	}
+	const int64_t num = bm.num;
+	DeleteBosonMap(&bm);
+
+	return (num <= INT_MAX ? (int)num : -1);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int modes, p, N;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "iiiO", &modes, &p, &N, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_rdm(modes, p, N, psi)");
+		return NULL;
+	}
+	if (modes <= 0 || p < 0 || p > N) {
+		PyErr_SetString(PyExc_ValueError, "'modes' must be positive and 'p' between 0 and 'N'; syntax: boson_rdm(modes, p, N, psi)");
+		return NULL;
+	}
+
+	const int dimN = BosonDim(modes, N);
+	const int dimP = BosonDim(modes, p);
+	if (dimN < 0 || dimP < 0) {
+		PyErr_SetString(PyExc_ValueError, "bosonic basis dimension too large; syntax: boson_rdm(modes, p, N, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector; syntax: boson_rdm(modes, p, N, psi)");
+		return NULL;
+	}
+	if (PyArray_DIM(psi, 0) != dimN)
+	{
+		PyErr_SetString(PyExc_ValueError, "length of 'psi' must agree with the dimension of the bosonic N-particle space; syntax: boson_rdm(modes, p, N, psi)");
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { dimP, dimP };
+	PyArrayObject *G_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (G_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = BosonRDM(modes, p, N, PyArray_DATA(psi), PyArray_DATA(G_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(G_arr);
+		return NULL;
+	}
+
+	return (PyObject *)G_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_p2N_apply(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int modes, p, N;
+	PyObject *obj_h;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "iiiOO", &modes, &p, &N, &obj_h, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		return NULL;
+	}
+	if (modes <= 0 || p < 0 || p > N) {
+		PyErr_SetString(PyExc_ValueError, "'modes' must be positive and 'p' between 0 and 'N'; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		return NULL;
+	}
+
+	const int dimN = BosonDim(modes, N);
+	const int dimP = BosonDim(modes, p);
+	if (dimN < 0 || dimP < 0) {
+		PyErr_SetString(PyExc_ValueError, "bosonic basis dimension too large; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *h = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h, NPY_CDOUBLE, 2, 2);
+	if (h == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'h' as matrix; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		return NULL;
+	}
+	if (PyArray_DIM(h, 0) != dimP || PyArray_DIM(h, 1) != dimP)
+	{
+		PyErr_SetString(PyExc_ValueError, "dimension of 'h' must agree with the dimension of the bosonic p-particle space; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		Py_DECREF(h);
+		return NULL;
+	}
+	if (PyArray_DIM(psi, 0) != dimN)
+	{
+		PyErr_SetString(PyExc_ValueError, "length of 'psi' must agree with the dimension of the bosonic N-particle space; syntax: boson_p2N_apply(modes, p, N, h, psi)");
+		Py_DECREF(psi);
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { dimN };
+	PyArrayObject *out_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	if (out_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(psi);
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = BosonP2NApply(modes, p, N, PyArray_DATA(h), PyArray_DATA(psi), PyArray_DATA(out_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+	Py_DECREF(h);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(out_arr);
+		return NULL;
+	}
+
+	return (PyObject *)out_arr;
+}
+
+
 //________________________________________________________________________________________________________________________
 //
 
@@ -605,10 +856,4188 @@ static PyObject *tensor_op(PyObject *self, PyObject *args)
 //
 
 
+static PyObject *tensor_op_diag(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *Ain;
+	int N;
+	if (!PyArg_ParseTuple(args, "Oi", &Ain, &N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: tensor_op_diag(A, N)");
+		return NULL;
+	}
+
+	if (N < 0) {
+		PyErr_SetString(PyExc_ValueError, "'N' must be non-negative; syntax: tensor_op_diag(A, N)");
+		return NULL;
+	}
+
+	// find out if we should aim for a real or complex matrix
+	bool use_complex;
+	{
+		PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(Ain);
+		if (arr == NULL)
+		{
+			PyErr_SetString(PyExc_SyntaxError, "cannot interpret 'A' as array; syntax: tensor_op_diag(A, N)");
+			return NULL;
+		}
+		use_complex = PyArray_ISCOMPLEX(arr);
+		Py_DECREF(arr);
+	}
+
+	PyArrayObject *A = (PyArrayObject *)PyArray_ContiguousFromObject(Ain, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	if (A == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as matrix");
+		return NULL;
+	}
+
+	if (PyArray_DIM(A, 0) != PyArray_DIM(A, 1))
+	{
+		PyErr_SetString(PyExc_ValueError, "'A' must be a square matrix");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	const int orbs = PyArray_DIM(A, 0);
+
+	if (N > orbs) {
+		PyErr_SetString(PyExc_ValueError, "'N' cannot be larger than number of orbitals; syntax: tensor_op_diag(A, N)");
+		Py_DECREF(A);
+		return NULL;
+	}
+	if (orbs > (int)(8*sizeof(bitfield_t))) {
+		PyErr_SetString(PyExc_ValueError, "number of orbitals cannot exceed 64; syntax: tensor_op_diag(A, N)");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { Binomial(orbs, N) };
+	PyArrayObject *d_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (d_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	int status;
+	if (!use_complex) {
+		status = TensorOpDiag(orbs, N, PyArray_DATA(A), PyArray_DATA(d_arr));
+	}
+	else {
+		status = TensorOpDiagComplex(orbs, N, PyArray_DATA(A), PyArray_DATA(d_arr));
+	}
+	Py_DECREF(A);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(d_arr);
+		return NULL;
+	}
+
+	return (PyObject *)d_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *tensor_op_boson(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *Ain;
+	int N;
+	if (!PyArg_ParseTuple(args, "Oi", &Ain, &N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: tensor_op_boson(A, N)");
+		return NULL;
+	}
+
+	if (N < 0) {
+		PyErr_SetString(PyExc_ValueError, "'N' must be non-negative; syntax: tensor_op_boson(A, N)");
+		return NULL;
+	}
+
+	// find out if we should aim for a real or complex matrix
+	bool use_complex;
+	{
+		PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(Ain);
+		if (arr == NULL)
+		{
+			PyErr_SetString(PyExc_SyntaxError, "cannot interpret 'A' as array; syntax: tensor_op_boson(A, N)");
+			return NULL;
+		}
+		use_complex = PyArray_ISCOMPLEX(arr);
+		Py_DECREF(arr);
+	}
+
+	PyArrayObject *A = (PyArrayObject *)PyArray_ContiguousFromObject(Ain, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	if (A == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as matrix");
+		return NULL;
+	}
+
+	if (PyArray_DIM(A, 0) != PyArray_DIM(A, 1) || PyArray_DIM(A, 0) == 0)
+	{
+		PyErr_SetString(PyExc_ValueError, "'A' must be a non-empty square matrix");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	const int modes = PyArray_DIM(A, 0);
+
+	boson_map_t bm;
+	if (BosonBasis(modes, N, &bm) < 0 || bm.num > INT_MAX)
+	{
+		PyErr_SetString(PyExc_ValueError, "bosonic basis dimension too large; syntax: tensor_op_boson(A, N)");
+		Py_DECREF(A);
+		return NULL;
+	}
+	npy_intp dims[2] = { bm.num, bm.num };
+	DeleteBosonMap(&bm);
+
+	PyArrayObject *AN_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (AN_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	if (!use_complex) {
+		status = TensorOpBoson(modes, N, PyArray_DATA(A), PyArray_DATA(AN_arr));
+	}
+	else {
+		status = TensorOpBosonComplex(modes, N, PyArray_DATA(A), PyArray_DATA(AN_arr));
+	}
+	Py_END_ALLOW_THREADS
+	Py_DECREF(A);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(AN_arr);
+		return NULL;
+	}
+
+	return (PyObject *)AN_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *slater_state(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *Cin;
+	if (!PyArg_ParseTuple(args, "O", &Cin)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: slater_state(C)");
+		return NULL;
+	}
+
+	// find out if we should aim for a real or complex state
+	bool use_complex;
+	{
+		PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(Cin);
+		if (arr == NULL)
+		{
+			PyErr_SetString(PyExc_SyntaxError, "cannot interpret 'C' as array; syntax: slater_state(C)");
+			return NULL;
+		}
+		use_complex = PyArray_ISCOMPLEX(arr);
+		Py_DECREF(arr);
+	}
+
+	PyArrayObject *C = (PyArrayObject *)PyArray_ContiguousFromObject(Cin, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	if (C == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'C' as matrix; syntax: slater_state(C)");
+		return NULL;
+	}
+
+	const int orbs = PyArray_DIM(C, 0);
+	const int N    = PyArray_DIM(C, 1);
+
+	if (N > orbs) {
+		PyErr_SetString(PyExc_ValueError, "number of columns of 'C' cannot be larger than number of rows; syntax: slater_state(C)");
+		Py_DECREF(C);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { Binomial(orbs, N) };
+	PyArrayObject *psi_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (psi_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(C);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	if (!use_complex) {
+		status = MaximalMinors(orbs, N, PyArray_DATA(C), PyArray_DATA(psi_arr));
+	}
+	else {
+		status = MaximalMinorsComplex(orbs, N, PyArray_DATA(C), PyArray_DATA(psi_arr));
+	}
+	Py_END_ALLOW_THREADS
+	Py_DECREF(C);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(psi_arr);
+		return NULL;
+	}
+
+	return (PyObject *)psi_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *compound_matrix(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *Ain;
+	int p;
+	if (!PyArg_ParseTuple(args, "Oi", &Ain, &p)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: compound_matrix(A, p)");
+		return NULL;
+	}
+
+	// find out if we should aim for a real or complex matrix
+	bool use_complex;
+	{
+		PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(Ain);
+		if (arr == NULL)
+		{
+			PyErr_SetString(PyExc_SyntaxError, "cannot interpret 'A' as array; syntax: compound_matrix(A, p)");
+			return NULL;
+		}
+		use_complex = PyArray_ISCOMPLEX(arr);
+		Py_DECREF(arr);
+	}
+
+	PyArrayObject *A = (PyArrayObject *)PyArray_ContiguousFromObject(Ain, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	if (A == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as matrix; syntax: compound_matrix(A, p)");
+		return NULL;
+	}
+
+	const int m = PyArray_DIM(A, 0);
+	const int n = PyArray_DIM(A, 1);
+
+	if (p < 0 || p > m || p > n) {
+		PyErr_SetString(PyExc_ValueError, "'p' must be non-negative and cannot exceed the matrix dimensions; syntax: compound_matrix(A, p)");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { Binomial(m, p), Binomial(n, p) };
+	PyArrayObject *Ap_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (Ap_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	if (!use_complex) {
+		status = CompoundMatrix(m, n, p, PyArray_DATA(A), PyArray_DATA(Ap_arr));
+	}
+	else {
+		status = CompoundMatrixComplex(m, n, p, PyArray_DATA(A), PyArray_DATA(Ap_arr));
+	}
+	Py_END_ALLOW_THREADS
+	Py_DECREF(A);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(Ap_arr);
+		return NULL;
+	}
+
+	return (PyObject *)Ap_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *fermi_index(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_dets;
+	if (!PyArg_ParseTuple(args, "O", &obj_dets)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: fermi_index(dets)");
+		return NULL;
+	}
+
+	PyArrayObject *dets = (PyArrayObject *)PyArray_ContiguousFromObject(obj_dets, NPY_UINT64, 1, 1);
+	if (dets == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'dets' as vector of bit-encoded Slater determinants; syntax: fermi_index(dets)");
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(dets, 0) };
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(dets);
+		return NULL;
+	}
+
+	const bitfield_t *f = (bitfield_t *)PyArray_DATA(dets);
+	int *ind = (int *)PyArray_DATA(ind_arr);
+	npy_intp i;
+	for (i = 0; i < dims[0]; i++)
+	{
+		ind[i] = FermiIndex(f[i]);
+	}
+
+	Py_DECREF(dets);
+
+	return (PyObject *)ind_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret Python objects as sorted list of bit-encoded Slater determinants and corresponding coefficients;
+/// the returned arrays hold references which must be released by the caller
+///
+static int ParseSparseState(PyObject *obj_dets, PyObject *obj_coeffs, const char *syntax, PyArrayObject **dets, PyArrayObject **coeffs, sparse_fermi_state_t *psi)
+{
+	char msg[1024];
+
+	*dets = (PyArrayObject *)PyArray_ContiguousFromObject(obj_dets, NPY_UINT64, 1, 1);
+	if (*dets == NULL)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'dets' as vector of bit-encoded Slater determinants; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return -1;
+	}
+
+	*coeffs = (PyArrayObject *)PyArray_ContiguousFromObject(obj_coeffs, NPY_CDOUBLE, 1, 1);
+	if (*coeffs == NULL)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'coeffs' as vector; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_DECREF(*dets);
+		return -1;
+	}
+
+	if (PyArray_DIM(*dets, 0) != PyArray_DIM(*coeffs, 0))
+	{
+		snprintf(msg, sizeof(msg), "'dets' and 'coeffs' must have the same length; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_DECREF(*coeffs);
+		Py_DECREF(*dets);
+		return -1;
+	}
+
+	psi->dets   = (bitfield_t *)PyArray_DATA(*dets);
+	psi->coeffs = (double complex *)PyArray_DATA(*coeffs);
+	psi->nnz    = PyArray_DIM(*dets, 0);
+
+	// must be strictly sorted for binary search
+	int i;
+	for (i = 1; i < psi->nnz; i++)
+	{
+		if (psi->dets[i] <= psi->dets[i-1])
+		{
+			snprintf(msg, sizeof(msg), "'dets' must be sorted in strictly ascending order; syntax: %s", syntax);
+			PyErr_SetString(PyExc_ValueError, msg);
+			Py_DECREF(*coeffs);
+			Py_DECREF(*dets);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *sparse_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int orbs;
+	int p;
+	PyObject *obj_dets;
+	PyObject *obj_coeffs;
+	if (!PyArg_ParseTuple(args, "iiOO", &orbs, &p, &obj_dets, &obj_coeffs)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: sparse_rdm(orbs, p, dets, coeffs)");
+		return NULL;
+	}
+
+	if (orbs <= 0 || orbs > (int)(8*sizeof(bitfield_t))) {
+		PyErr_SetString(PyExc_ValueError, "'orbs' must be positive and cannot exceed 64; syntax: sparse_rdm(orbs, p, dets, coeffs)");
+		return NULL;
+	}
+	if (p < 0 || p > orbs) {
+		PyErr_SetString(PyExc_ValueError, "'p' must be non-negative and cannot be larger than 'orbs'; syntax: sparse_rdm(orbs, p, dets, coeffs)");
+		return NULL;
+	}
+
+	PyArrayObject *dets, *coeffs;
+	sparse_fermi_state_t psi;
+	if (ParseSparseState(obj_dets, obj_coeffs, "sparse_rdm(orbs, p, dets, coeffs)", &dets, &coeffs, &psi) < 0) {
+		return NULL;
+	}
+
+	const int dim = Binomial(orbs, p);
+	npy_intp dims[2] = { dim, dim };
+	PyArrayObject *G_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (G_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(coeffs);
+		Py_DECREF(dets);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = SparseStateRDM(orbs, p, &psi, PyArray_DATA(G_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(coeffs);
+	Py_DECREF(dets);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(G_arr);
+		return NULL;
+	}
+
+	return (PyObject *)G_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *sparse_apply(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int orbs;
+	int p;
+	PyObject *obj_h;
+	PyObject *obj_dets;
+	PyObject *obj_coeffs;
+	if (!PyArg_ParseTuple(args, "iiOOO", &orbs, &p, &obj_h, &obj_dets, &obj_coeffs)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: sparse_apply(orbs, p, h, dets, coeffs)");
+		return NULL;
+	}
+
+	if (orbs <= 0 || orbs > (int)(8*sizeof(bitfield_t))) {
+		PyErr_SetString(PyExc_ValueError, "'orbs' must be positive and cannot exceed 64; syntax: sparse_apply(orbs, p, h, dets, coeffs)");
+		return NULL;
+	}
+	if (p < 0 || p > orbs) {
+		PyErr_SetString(PyExc_ValueError, "'p' must be non-negative and cannot be larger than 'orbs'; syntax: sparse_apply(orbs, p, h, dets, coeffs)");
+		return NULL;
+	}
+
+	const int dim = Binomial(orbs, p);
+
+	PyArrayObject *h = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h, NPY_CDOUBLE, 2, 2);
+	if (h == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'h' as matrix; syntax: sparse_apply(orbs, p, h, dets, coeffs)");
+		return NULL;
+	}
+	if (PyArray_DIM(h, 0) != dim || PyArray_DIM(h, 1) != dim)
+	{
+		PyErr_SetString(PyExc_ValueError, "'h' must be a square matrix of dimension Binomial(orbs, p); syntax: sparse_apply(orbs, p, h, dets, coeffs)");
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	PyArrayObject *dets, *coeffs;
+	sparse_fermi_state_t psi;
+	if (ParseSparseState(obj_dets, obj_coeffs, "sparse_apply(orbs, p, h, dets, coeffs)", &dets, &coeffs, &psi) < 0) {
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	sparse_fermi_state_t out = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = SparseStateApply(orbs, p, PyArray_DATA(h), &psi, &out);
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(coeffs);
+	Py_DECREF(dets);
+	Py_DECREF(h);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		DeleteSparseFermiState(&out);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { out.nnz };
+	PyArrayObject *dets_arr   = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_UINT64);
+	PyArrayObject *coeffs_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	if (dets_arr == NULL || coeffs_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(coeffs_arr);
+		Py_XDECREF(dets_arr);
+		DeleteSparseFermiState(&out);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(dets_arr),   out.dets,   out.nnz * sizeof(bitfield_t));
+	memcpy(PyArray_DATA(coeffs_arr), out.coeffs, out.nnz * sizeof(double complex));
+
+	// clean up
+	DeleteSparseFermiState(&out);
+
+	return Py_BuildValue("(NN)", dets_arr, coeffs_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *slater_pair_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int orbs;
+	int p1, p2;
+	PyObject *obj_s1;
+	PyObject *obj_s2;
+	PyObject *obj_w;
+	int sparse = 0;
+	if (!PyArg_ParseTuple(args, "iiiOOO|p", &orbs, &p1, &p2, &obj_s1, &obj_s2, &obj_w, &sparse)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: slater_pair_rdm(orbs, p1, p2, s1, s2, w, sparse=False)");
+		return NULL;
+	}
+
+	if (orbs <= 0 || orbs > (int)(8*sizeof(bitfield_t))) {
+		PyErr_SetString(PyExc_ValueError, "'orbs' must be positive and cannot exceed 64; syntax: slater_pair_rdm(orbs, p1, p2, s1, s2, w, sparse=False)");
+		return NULL;
+	}
+	if (p1 < 0 || p1 > orbs || p2 < 0 || p2 > orbs) {
+		PyErr_SetString(PyExc_ValueError, "'p1' and 'p2' must be non-negative and cannot be larger than 'orbs'; syntax: slater_pair_rdm(orbs, p1, p2, s1, s2, w, sparse=False)");
+		return NULL;
+	}
+
+	PyArrayObject *s1 = (PyArrayObject *)PyArray_ContiguousFromObject(obj_s1, NPY_UINT64, 1, 1);
+	PyArrayObject *s2 = (PyArrayObject *)PyArray_ContiguousFromObject(obj_s2, NPY_UINT64, 1, 1);
+	PyArrayObject *w  = (PyArrayObject *)PyArray_ContiguousFromObject(obj_w,  NPY_CDOUBLE, 1, 1);
+	if (s1 == NULL || s2 == NULL || w == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 's1', 's2' and 'w' as vectors; syntax: slater_pair_rdm(orbs, p1, p2, s1, s2, w, sparse=False)");
+		Py_XDECREF(w);
+		Py_XDECREF(s2);
+		Py_XDECREF(s1);
+		return NULL;
+	}
+	const npy_intp npairs = PyArray_DIM(s1, 0);
+	if (PyArray_DIM(s2, 0) != npairs || PyArray_DIM(w, 0) != npairs)
+	{
+		PyErr_SetString(PyExc_ValueError, "'s1', 's2' and 'w' must have the same length; syntax: slater_pair_rdm(orbs, p1, p2, s1, s2, w, sparse=False)");
+		Py_DECREF(w);
+		Py_DECREF(s2);
+		Py_DECREF(s1);
+		return NULL;
+	}
+
+	if (!sparse)
+	{
+		npy_intp dims[2] = { Binomial(orbs, p1), Binomial(orbs, p2) };
+		PyArrayObject *G_arr = (PyArrayObject *)PyArray_ZEROS(2, dims, NPY_CDOUBLE, 0);
+		if (G_arr == NULL) {
+			PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+			Py_DECREF(w);
+			Py_DECREF(s2);
+			Py_DECREF(s1);
+			return NULL;
+		}
+
+		int status;
+		Py_BEGIN_ALLOW_THREADS
+		status = SlaterPairRDM(orbs, p1, p2, npairs, PyArray_DATA(s1), PyArray_DATA(s2), PyArray_DATA(w), PyArray_DATA(G_arr));
+		Py_END_ALLOW_THREADS
+
+		Py_DECREF(w);
+		Py_DECREF(s2);
+		Py_DECREF(s1);
+
+		if (status < 0) {
+			PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+			Py_DECREF(G_arr);
+			return NULL;
+		}
+
+		return (PyObject *)G_arr;
+	}
+	else
+	{
+		sparse_complex_array_t G;
+		int status;
+		Py_BEGIN_ALLOW_THREADS
+		status = SlaterPairRDMSparse(orbs, p1, p2, npairs, PyArray_DATA(s1), PyArray_DATA(s2), PyArray_DATA(w), &G);
+		Py_END_ALLOW_THREADS
+
+		Py_DECREF(w);
+		Py_DECREF(s2);
+		Py_DECREF(s1);
+
+		if (status < 0) {
+			PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+			return NULL;
+		}
+
+		// dimensions
+		assert(G.rank == 2);
+		PyObject *dims_obj = Py_BuildValue("(ii)", G.dims[0], G.dims[1]);
+
+		// construct array of values
+		npy_intp dims_val[1] = { G.nnz };
+		PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_CDOUBLE);
+		if (val_arr == NULL) {
+			PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned value vector");
+			Py_DECREF(dims_obj);
+			DeleteSparseComplexArray(&G);
+			return NULL;
+		}
+		memcpy(PyArray_DATA(val_arr), G.val, G.nnz * sizeof(double complex));
+
+		// construct array of indices
+		npy_intp dims_ind[2] = { G.nnz, G.rank };
+		PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(G.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+		if (ind_arr == NULL) {
+			PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned array of indices");
+			Py_DECREF(dims_obj);
+			Py_DECREF(val_arr);
+			DeleteSparseComplexArray(&G);
+			return NULL;
+		}
+		memcpy(PyArray_DATA(ind_arr), G.ind, G.nnz*G.rank * sizeof(G.ind[0]));
+
+		// clean up
+		DeleteSparseComplexArray(&G);
+
+		return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static void StringCISpaceCapsuleDestructor(PyObject *capsule)
+{
+	string_ci_space_t *space = (string_ci_space_t *)PyCapsule_GetPointer(capsule, "fermifab.string_ci_space");
+	if (space != NULL)
+	{
+		DeleteStringCISpace(space);
+		free(space);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *string_ci_space(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int norb, Na, Nb;
+	if (!PyArg_ParseTuple(args, "iii", &norb, &Na, &Nb)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: string_ci_space(norb, Na, Nb)");
+		return NULL;
+	}
+	if (norb <= 0 || norb > 64 || Na < 0 || Na > norb || Nb < 0 || Nb > norb) {
+		PyErr_SetString(PyExc_ValueError, "'norb' must be between 1 and 64, and 'Na' and 'Nb' between 0 and 'norb'; syntax: string_ci_space(norb, Na, Nb)");
+		return NULL;
+	}
+
+	string_ci_space_t *space = (string_ci_space_t *)malloc(sizeof(string_ci_space_t));
+	if (space == NULL) {
+		PyErr_SetString(PyExc_MemoryError, "out of memory");
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = StringCISpace(norb, Na, Nb, space);
+	Py_END_ALLOW_THREADS
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		free(space);
+		return NULL;
+	}
+
+	PyObject *capsule = PyCapsule_New(space, "fermifab.string_ci_space", StringCISpaceCapsuleDestructor);
+	if (capsule == NULL)
+	{
+		DeleteStringCISpace(space);
+		free(space);
+		return NULL;
+	}
+
+	return capsule;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Obtain the CI space from a capsule returned by 'string_ci_space', and check the length of 'psi'
+///
+static const string_ci_space_t *ParseStringCISpace(PyObject *capsule, PyArrayObject *psi, const char *syntax)
+{
+	char msg[1024];
+
+	const string_ci_space_t *space = (const string_ci_space_t *)PyCapsule_GetPointer(capsule, "fermifab.string_ci_space");
+	if (space == NULL)
+	{
+		snprintf(msg, sizeof(msg), "'space' must be a capsule returned by 'string_ci_space'; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return NULL;
+	}
+	if (PyArray_DIM(psi, 0) != (npy_intp)space->alpha.num * space->beta.num)
+	{
+		snprintf(msg, sizeof(msg), "length of 'psi' must agree with the number of alpha times beta strings; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return NULL;
+	}
+
+	return space;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *string_ci_rdm1(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "string_ci_rdm1(space, psi)";
+
+	PyObject *capsule;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OO", &capsule, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: string_ci_rdm1(space, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector; syntax: string_ci_rdm1(space, psi)");
+		return NULL;
+	}
+	const string_ci_space_t *space = ParseStringCISpace(capsule, psi, syntax);
+	if (space == NULL) {
+		Py_DECREF(psi);
+		return NULL;
+	}
+	const int norb = space->alpha.norb;
+
+	npy_intp dims[2] = { norb, norb };
+	PyArrayObject *Ga_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	PyArrayObject *Gb_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (Ga_arr == NULL || Gb_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrices");
+		Py_XDECREF(Gb_arr);
+		Py_XDECREF(Ga_arr);
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = StringCIRDM1(space, PyArray_DATA(psi), PyArray_DATA(Ga_arr), PyArray_DATA(Gb_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(Gb_arr);
+		Py_DECREF(Ga_arr);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NN)", Ga_arr, Gb_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *string_ci_rdm2(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "string_ci_rdm2(space, psi)";
+
+	PyObject *capsule;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OO", &capsule, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: string_ci_rdm2(space, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector; syntax: string_ci_rdm2(space, psi)");
+		return NULL;
+	}
+	const string_ci_space_t *space = ParseStringCISpace(capsule, psi, syntax);
+	if (space == NULL) {
+		Py_DECREF(psi);
+		return NULL;
+	}
+	const int norb = space->alpha.norb;
+
+	npy_intp dims_one[2]  = { norb, norb };
+	npy_intp dims_same[2] = { norb*(norb - 1)/2, norb*(norb - 1)/2 };
+	npy_intp dims_diff[2] = { norb*norb, norb*norb };
+	npy_intp dims_spin[4] = { norb, norb, norb, norb };
+	PyArrayObject *Ga_arr  = (PyArrayObject *)PyArray_SimpleNew(2, dims_one,  NPY_CDOUBLE);
+	PyArrayObject *Gb_arr  = (PyArrayObject *)PyArray_SimpleNew(2, dims_one,  NPY_CDOUBLE);
+	PyArrayObject *Gaa_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_same, NPY_CDOUBLE);
+	PyArrayObject *Gab_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_diff, NPY_CDOUBLE);
+	PyArrayObject *Gbb_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_same, NPY_CDOUBLE);
+	PyArrayObject *P_arr   = (PyArrayObject *)PyArray_SimpleNew(4, dims_spin, NPY_CDOUBLE);
+	if (Ga_arr == NULL || Gb_arr == NULL || Gaa_arr == NULL || Gab_arr == NULL || Gbb_arr == NULL || P_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrices");
+		Py_XDECREF(P_arr);
+		Py_XDECREF(Gbb_arr);
+		Py_XDECREF(Gab_arr);
+		Py_XDECREF(Gaa_arr);
+		Py_XDECREF(Gb_arr);
+		Py_XDECREF(Ga_arr);
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = StringCIRDM2(space, PyArray_DATA(psi), PyArray_DATA(Ga_arr), PyArray_DATA(Gb_arr), PyArray_DATA(Gaa_arr), PyArray_DATA(Gab_arr), PyArray_DATA(Gbb_arr), PyArray_DATA(P_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(P_arr);
+		Py_DECREF(Gbb_arr);
+		Py_DECREF(Gab_arr);
+		Py_DECREF(Gaa_arr);
+		Py_DECREF(Gb_arr);
+		Py_DECREF(Ga_arr);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NNNNNN)", Ga_arr, Gb_arr, Gaa_arr, Gab_arr, Gbb_arr, P_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *string_ci_sigma(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "string_ci_sigma(space, h, g, psi)";
+
+	PyObject *capsule;
+	PyObject *obj_h;
+	PyObject *obj_g;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OOOO", &capsule, &obj_h, &obj_g, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: string_ci_sigma(space, h, g, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector; syntax: string_ci_sigma(space, h, g, psi)");
+		return NULL;
+	}
+	const string_ci_space_t *space = ParseStringCISpace(capsule, psi, syntax);
+	if (space == NULL) {
+		Py_DECREF(psi);
+		return NULL;
+	}
+	const int norb = space->alpha.norb;
+
+	PyArrayObject *h = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h, NPY_CDOUBLE, 2, 2);
+	if (h == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'h' as matrix; syntax: string_ci_sigma(space, h, g, psi)");
+		Py_DECREF(psi);
+		return NULL;
+	}
+	if (PyArray_DIM(h, 0) != norb || PyArray_DIM(h, 1) != norb)
+	{
+		PyErr_SetString(PyExc_ValueError, "'h' must be a 'norb x norb' matrix; syntax: string_ci_sigma(space, h, g, psi)");
+		Py_DECREF(h);
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	PyArrayObject *g = (PyArrayObject *)PyArray_ContiguousFromObject(obj_g, NPY_CDOUBLE, 4, 4);
+	if (g == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'g' as four-dimensional array; syntax: string_ci_sigma(space, h, g, psi)");
+		Py_DECREF(h);
+		Py_DECREF(psi);
+		return NULL;
+	}
+	if (PyArray_DIM(g, 0) != norb || PyArray_DIM(g, 1) != norb || PyArray_DIM(g, 2) != norb || PyArray_DIM(g, 3) != norb)
+	{
+		PyErr_SetString(PyExc_ValueError, "'g' must have dimension 'norb x norb x norb x norb'; syntax: string_ci_sigma(space, h, g, psi)");
+		Py_DECREF(g);
+		Py_DECREF(h);
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(psi, 0) };
+	PyArrayObject *sigma_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	if (sigma_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(g);
+		Py_DECREF(h);
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = StringCISigma(space, PyArray_DATA(h), PyArray_DATA(g), PyArray_DATA(psi), PyArray_DATA(sigma_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(g);
+	Py_DECREF(h);
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(sigma_arr);
+		return NULL;
+	}
+
+	return (PyObject *)sigma_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Dimension of the Hilbert space of a fermionic configuration
+///
+static npy_intp FermiConfigDim(const fermi_config_t *config)
+{
+	npy_intp dim = 1;
+	int k;
+	for (k = 0; k < config->nc; k++) {
+		dim *= Binomial(config->orbs[k], config->N[k]);
+	}
+
+	return dim;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret Python objects as lists of orbital and particle numbers of a fermionic configuration;
+/// 'orbs' and 'N' must provide space for 64 entries
+///
+static int ParseFermiConfig(PyObject *obj_orbs, PyObject *obj_N, const char *syntax, int *orbs, int *N, fermi_config_t *config)
+{
+	char msg[1024];
+
+	PyArrayObject *orbs_arr = (PyArrayObject *)PyArray_ContiguousFromObject(obj_orbs, NPY_LONG, 1, 1);
+	PyArrayObject *N_arr    = (PyArrayObject *)PyArray_ContiguousFromObject(obj_N,    NPY_LONG, 1, 1);
+	if (orbs_arr == NULL || N_arr == NULL)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'orbs' and 'N' as lists of integers; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_XDECREF(N_arr);
+		Py_XDECREF(orbs_arr);
+		return -1;
+	}
+
+	const npy_intp nc = PyArray_DIM(orbs_arr, 0);
+	const long *orbs_data = (long *)PyArray_DATA(orbs_arr);
+	const long *N_data    = (long *)PyArray_DATA(N_arr);
+	long norbs = 0;
+	bool valid = (nc > 0 && nc <= 64 && PyArray_DIM(N_arr, 0) == nc);
+	npy_intp k;
+	for (k = 0; valid && k < nc; k++)
+	{
+		valid = (orbs_data[k] > 0 && 0 <= N_data[k] && N_data[k] <= orbs_data[k]);
+		norbs += orbs_data[k];
+		orbs[k] = (int)orbs_data[k];
+		N[k]    = (int)N_data[k];
+	}
+	Py_DECREF(N_arr);
+	Py_DECREF(orbs_arr);
+	if (!valid || norbs > 64)
+	{
+		snprintf(msg, sizeof(msg), "'orbs' and 'N' must have the same number of entries, with positive orbital numbers (at most 64 in total) and particle numbers not exceeding them; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return -1;
+	}
+
+	config->orbs = orbs;
+	config->N    = N;
+	config->nc   = (int)nc;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_half(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "gen_rdm_half(orbs, p, N)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_p;
+	PyObject *obj_N;
+	if (!PyArg_ParseTuple(args, "OOO", &obj_orbs, &obj_p, &obj_N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_half(orbs, p, N)");
+		return NULL;
+	}
+
+	int orbs[64], p[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	fermi_config_t configP;
+	if (ParseFermiConfig(obj_orbs, obj_p, syntax, orbs, p, &configP) < 0) {
+		return NULL;
+	}
+	int i;
+	for (i = 0; i < config.nc; i++)
+	{
+		if (p[i] > N[i]) {
+			PyErr_SetString(PyExc_ValueError, "entries in 'p' must not exceed the corresponding entries in 'N'; syntax: gen_rdm_half(orbs, p, N)");
+			return NULL;
+		}
+	}
+
+	sparse_array_t K = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMHalf(orbs, p, N, config.nc, &K);
+	Py_END_ALLOW_THREADS
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+
+	npy_intp dims_val[1] = { K.nnz };
+	npy_intp dims_ind[2] = { K.nnz, K.rank };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_DOUBLE);
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(K.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (val_arr == NULL || ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(ind_arr);
+		Py_XDECREF(val_arr);
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(val_arr), K.val, K.nnz * sizeof(double));
+	memcpy(PyArray_DATA(ind_arr), K.ind, K.nnz*K.rank * sizeof(K.ind[0]));
+
+	PyObject *dims_obj = Py_BuildValue("(iiii)", K.dims[0], K.dims[1], K.dims[2], K.dims[3]);
+
+	// clean up
+	DeleteSparseArray(&K);
+
+	return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *fermi_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "fermi_rdm(orbs, p, N, psi)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_p;
+	PyObject *obj_N;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OOOO", &obj_orbs, &obj_p, &obj_N, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: fermi_rdm(orbs, p, N, psi)");
+		return NULL;
+	}
+
+	int orbs[64], p[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	fermi_config_t configP;
+	if (ParseFermiConfig(obj_orbs, obj_p, syntax, orbs, p, &configP) < 0) {
+		return NULL;
+	}
+	int i;
+	for (i = 0; i < config.nc; i++)
+	{
+		if (p[i] > N[i]) {
+			PyErr_SetString(PyExc_ValueError, "entries in 'p' must not exceed the corresponding entries in 'N'; syntax: fermi_rdm(orbs, p, N, psi)");
+			return NULL;
+		}
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL || PyArray_DIM(psi, 0) != FermiConfigDim(&config))
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector with length equal to the dimension of the configuration; syntax: fermi_rdm(orbs, p, N, psi)");
+		Py_XDECREF(psi);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { FermiConfigDim(&configP), FermiConfigDim(&configP) };
+	PyArrayObject *G_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (G_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	// half-storage kernel in compact encoding, lower triangle of G filled by conjugation
+	sparse_array_t K = { 0 };
+	compact_kernel_t C = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMHalf(orbs, p, N, config.nc, &K);
+	if (status >= 0) {
+		status = CompressRDMKernel(&K, true, &C);
+	}
+	DeleteSparseArray(&K);
+	if (status >= 0) {
+		status = ContractCompactKernel(&C, PyArray_DATA(psi), PyArray_DATA(G_arr));
+	}
+	Py_END_ALLOW_THREADS
+
+	DeleteCompactKernel(&C);
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(G_arr);
+		return NULL;
+	}
+
+	return (PyObject *)G_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static void CompactKernelCapsuleDestructor(PyObject *capsule)
+{
+	compact_kernel_t *C = (compact_kernel_t *)PyCapsule_GetPointer(capsule, "fermifab.compact_kernel");
+	if (C != NULL)
+	{
+		DeleteCompactKernel(C);
+		free(C);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_compact(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "gen_rdm_compact(orbs, p, N)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_p;
+	PyObject *obj_N;
+	if (!PyArg_ParseTuple(args, "OOO", &obj_orbs, &obj_p, &obj_N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_compact(orbs, p, N)");
+		return NULL;
+	}
+
+	int orbs[64], p[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	fermi_config_t configP;
+	if (ParseFermiConfig(obj_orbs, obj_p, syntax, orbs, p, &configP) < 0) {
+		return NULL;
+	}
+	int i;
+	for (i = 0; i < config.nc; i++)
+	{
+		if (p[i] > N[i]) {
+			PyErr_SetString(PyExc_ValueError, "entries in 'p' must not exceed the corresponding entries in 'N'; syntax: gen_rdm_compact(orbs, p, N)");
+			return NULL;
+		}
+	}
+
+	compact_kernel_t *C = (compact_kernel_t *)malloc(sizeof(compact_kernel_t));
+	if (C == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "out of memory");
+		return NULL;
+	}
+
+	sparse_array_t K = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMHalf(orbs, p, N, config.nc, &K);
+	if (status >= 0) {
+		status = CompressRDMKernel(&K, true, C);
+	}
+	DeleteSparseArray(&K);
+	Py_END_ALLOW_THREADS
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		free(C);
+		return NULL;
+	}
+
+	PyObject *capsule = PyCapsule_New(C, "fermifab.compact_kernel", CompactKernelCapsuleDestructor);
+	if (capsule == NULL)
+	{
+		DeleteCompactKernel(C);
+		free(C);
+		return NULL;
+	}
+
+	return Py_BuildValue("(N(iiii)L)", capsule, C->dims[0], C->dims[1], C->dims[2], C->dims[3], (long long)CompactKernelBytes(C));
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *compact_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *capsule;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OO", &capsule, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: compact_rdm(kernel, psi)");
+		return NULL;
+	}
+
+	const compact_kernel_t *C = (const compact_kernel_t *)PyCapsule_GetPointer(capsule, "fermifab.compact_kernel");
+	if (C == NULL) {
+		PyErr_SetString(PyExc_ValueError, "'kernel' must be a capsule returned by 'gen_rdm_compact'; syntax: compact_rdm(kernel, psi)");
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL || PyArray_DIM(psi, 0) != C->dims[2])
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector with length equal to the kernel dimension; syntax: compact_rdm(kernel, psi)");
+		Py_XDECREF(psi);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { C->dims[0], C->dims[1] };
+	PyArrayObject *G_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (G_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = ContractCompactKernel(C, PyArray_DATA(psi), PyArray_DATA(G_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred");
+		Py_DECREF(G_arr);
+		return NULL;
+	}
+
+	return (PyObject *)G_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *rdm_partial_trace(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int orbs, p, N;
+	PyObject *obj_G;
+	if (!PyArg_ParseTuple(args, "iiiO", &orbs, &p, &N, &obj_G)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: rdm_partial_trace(orbs, p, N, G)");
+		return NULL;
+	}
+	if (orbs > 64 || p < 1 || p > N || N > orbs) {
+		PyErr_SetString(PyExc_ValueError, "require 1 <= p <= N <= orbs <= 64; syntax: rdm_partial_trace(orbs, p, N, G)");
+		return NULL;
+	}
+
+	const int dimP = Binomial(orbs, p);
+	const int dimQ = Binomial(orbs, p - 1);
+
+	PyArrayObject *G = (PyArrayObject *)PyArray_ContiguousFromObject(obj_G, NPY_CDOUBLE, 2, 2);
+	if (G == NULL || PyArray_DIM(G, 0) != dimP || PyArray_DIM(G, 1) != dimP)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'G' as square matrix of dimension binomial(orbs, p); syntax: rdm_partial_trace(orbs, p, N, G)");
+		Py_XDECREF(G);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { dimQ, dimQ };
+	PyArrayObject *Gt_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (Gt_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(G);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = RDMPartialTrace(orbs, p, N, PyArray_DATA(G), PyArray_DATA(Gt_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(G);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(Gt_arr);
+		return NULL;
+	}
+
+	return (PyObject *)Gt_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static void ExcitationGraphsCapsuleDestructor(PyObject *capsule)
+{
+	excitation_graphs_t *graphs = (excitation_graphs_t *)PyCapsule_GetPointer(capsule, "fermifab.excitation_graphs");
+	if (graphs != NULL)
+	{
+		DeleteExcitationGraphs(graphs);
+		free(graphs);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Read-only array views '(offset, data)' of an excitation graph owned by 'capsule'
+///
+static PyObject *ExcitationGraphToPython(const excitation_graph_t *graph, PyObject *capsule)
+{
+	npy_intp dims_offset[1] = { graph->num + 1 };
+	npy_intp dims_data[1]   = { graph->offset[graph->num] };
+	PyArrayObject *offset_arr = (PyArrayObject *)PyArray_SimpleNewFromData(1, dims_offset, NPY_INT64, graph->offset);
+	PyArrayObject *data_arr   = (PyArrayObject *)PyArray_SimpleNewFromData(1, dims_data,   NPY_UINT8, graph->data);
+	if (offset_arr == NULL || data_arr == NULL) {
+		Py_XDECREF(data_arr);
+		Py_XDECREF(offset_arr);
+		return NULL;
+	}
+	PyArrayObject *arrays[2] = { offset_arr, data_arr };
+	int k;
+	for (k = 0; k < 2; k++)
+	{
+		PyArray_CLEARFLAGS(arrays[k], NPY_ARRAY_WRITEABLE);
+		// array views keep the capsule alive
+		Py_INCREF(capsule);
+		PyArray_SetBaseObject(arrays[k], capsule);
+	}
+
+	return Py_BuildValue("(NN)", offset_arr, data_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *excitation_graph(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "excitation_graph(orbs, N, level)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_N;
+	int level;
+	if (!PyArg_ParseTuple(args, "OOi", &obj_orbs, &obj_N, &level)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: excitation_graph(orbs, N, level)");
+		return NULL;
+	}
+
+	int orbs[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	if (level != 1 && level != 2) {
+		PyErr_SetString(PyExc_ValueError, "'level' must be 1 (singles) or 2 (singles and doubles); syntax: excitation_graph(orbs, N, level)");
+		return NULL;
+	}
+
+	excitation_graphs_t *graphs = (excitation_graphs_t *)malloc(sizeof(excitation_graphs_t));
+	if (graphs == NULL) {
+		PyErr_SetString(PyExc_MemoryError, "out of memory");
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = ExcitationGraphs(&config, level, graphs);
+	Py_END_ALLOW_THREADS
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		free(graphs);
+		return NULL;
+	}
+
+	PyObject *capsule = PyCapsule_New(graphs, "fermifab.excitation_graphs", ExcitationGraphsCapsuleDestructor);
+	if (capsule == NULL)
+	{
+		DeleteExcitationGraphs(graphs);
+		free(graphs);
+		return NULL;
+	}
+
+	PyObject *singles = ExcitationGraphToPython(&graphs->graph1, capsule);
+	PyObject *doubles;
+	if (level == 2) {
+		doubles = ExcitationGraphToPython(&graphs->graph2, capsule);
+	}
+	else {
+		Py_INCREF(Py_None);
+		doubles = Py_None;
+	}
+	if (singles == NULL || doubles == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(doubles);
+		Py_XDECREF(singles);
+		Py_DECREF(capsule);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NNN)", capsule, singles, doubles);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Obtain the excitation graphs from a capsule returned by 'excitation_graph', and check the RDM order 'p'
+///
+static const excitation_graphs_t *ParseExcitationGraphs(PyObject *capsule, const int p, const char *syntax)
+{
+	char msg[1024];
+
+	const excitation_graphs_t *graphs = (const excitation_graphs_t *)PyCapsule_GetPointer(capsule, "fermifab.excitation_graphs");
+	if (graphs == NULL)
+	{
+		snprintf(msg, sizeof(msg), "'graphs' must be a capsule returned by 'excitation_graph'; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return NULL;
+	}
+	if (p < 0 || p > graphs->level || p > graphs->Ntot)
+	{
+		snprintf(msg, sizeof(msg), "'p' must be between 0 and the excitation level and not exceed the total particle number; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return NULL;
+	}
+
+	return graphs;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *excitation_graph_rdm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "excitation_graph_rdm(graphs, p, psi)";
+
+	PyObject *capsule;
+	int p;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OiO", &capsule, &p, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: excitation_graph_rdm(graphs, p, psi)");
+		return NULL;
+	}
+
+	const excitation_graphs_t *graphs = ParseExcitationGraphs(capsule, p, syntax);
+	if (graphs == NULL) {
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL || PyArray_DIM(psi, 0) != graphs->fm.num)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector with length equal to the dimension of the configuration; syntax: excitation_graph_rdm(graphs, p, psi)");
+		Py_XDECREF(psi);
+		return NULL;
+	}
+
+	const int dimP = Binomial(graphs->norbs, p);
+	npy_intp dims[2] = { dimP, dimP };
+	PyArrayObject *G_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_CDOUBLE);
+	if (G_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(psi);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = ExcitationGraphRDM(graphs, p, PyArray_DATA(psi), PyArray_DATA(G_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(G_arr);
+		return NULL;
+	}
+
+	return (PyObject *)G_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *excitation_graph_apply(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "excitation_graph_apply(graphs, p, h, psi)";
+
+	PyObject *capsule;
+	int p;
+	PyObject *obj_h;
+	PyObject *obj_psi;
+	if (!PyArg_ParseTuple(args, "OiOO", &capsule, &p, &obj_h, &obj_psi)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: excitation_graph_apply(graphs, p, h, psi)");
+		return NULL;
+	}
+
+	const excitation_graphs_t *graphs = ParseExcitationGraphs(capsule, p, syntax);
+	if (graphs == NULL) {
+		return NULL;
+	}
+	const int dimP = Binomial(graphs->norbs, p);
+
+	PyArrayObject *h = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h, NPY_CDOUBLE, 2, 2);
+	if (h == NULL || PyArray_DIM(h, 0) != dimP || PyArray_DIM(h, 1) != dimP)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'h' as square matrix with dimension equal to the number of p-particle Slater determinants; syntax: excitation_graph_apply(graphs, p, h, psi)");
+		Py_XDECREF(h);
+		return NULL;
+	}
+
+	PyArrayObject *psi = (PyArrayObject *)PyArray_ContiguousFromObject(obj_psi, NPY_CDOUBLE, 1, 1);
+	if (psi == NULL || PyArray_DIM(psi, 0) != graphs->fm.num)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'psi' as vector with length equal to the dimension of the configuration; syntax: excitation_graph_apply(graphs, p, h, psi)");
+		Py_XDECREF(psi);
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(psi, 0) };
+	PyArrayObject *out_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	if (out_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(psi);
+		Py_DECREF(h);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = ExcitationGraphApply(graphs, p, PyArray_DATA(h), PyArray_DATA(psi), PyArray_DATA(out_arr));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(psi);
+	Py_DECREF(h);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(out_arr);
+		return NULL;
+	}
+
+	return (PyObject *)out_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret Python objects as symmetry labels of 'norbs' orbitals, number of sectors and combination rule;
+/// the returned array holds a reference which must be released by the caller
+///
+static int ParseFermiSymmetry(PyObject *obj_labels, const int order, const int rule, const int norbs, const char *syntax, PyArrayObject **labels, fermi_symmetry_t *sym)
+{
+	char msg[1024];
+
+	if (order <= 0 || (rule != SYMMETRY_XOR && rule != SYMMETRY_ADD) || (rule == SYMMETRY_XOR && (order & (order - 1)) != 0))
+	{
+		snprintf(msg, sizeof(msg), "'order' must be positive and 'rule' either 0 (XOR, 'order' a power of 2) or 1 (addition modulo 'order'); syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return -1;
+	}
+
+	*labels = (PyArrayObject *)PyArray_ContiguousFromObject(obj_labels, NPY_INT, 1, 1);
+	if (*labels == NULL)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'labels' as integer vector; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return -1;
+	}
+	const int *label = (int *)PyArray_DATA(*labels);
+	bool valid = (PyArray_DIM(*labels, 0) == norbs);
+	int i;
+	for (i = 0; valid && i < norbs; i++) {
+		valid = (0 <= label[i] && label[i] < order);
+	}
+	if (!valid)
+	{
+		snprintf(msg, sizeof(msg), "'labels' must contain one label in { 0, ..., order - 1 } per orbital; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_DECREF(*labels);
+		return -1;
+	}
+
+	sym->label = label;
+	sym->order = order;
+	sym->rule  = (symmetry_rule_t)rule;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *fermi_map_sectors(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "fermi_map_sectors(orbs, N, labels, order, rule)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_N;
+	PyObject *obj_labels;
+	int order, rule;
+	if (!PyArg_ParseTuple(args, "OOOii", &obj_orbs, &obj_N, &obj_labels, &order, &rule)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: fermi_map_sectors(orbs, N, labels, order, rule)");
+		return NULL;
+	}
+
+	int orbs[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	PyArrayObject *labels;
+	fermi_symmetry_t sym;
+	if (ParseFermiSymmetry(obj_labels, order, rule, IntegerSum(orbs, config.nc), syntax, &labels, &sym) < 0) {
+		return NULL;
+	}
+
+	npy_intp dims_offset[1] = { order + 1 };
+	PyArrayObject *offset_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_offset, NPY_INT);
+	if (offset_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(labels);
+		return NULL;
+	}
+
+	fermi_map_t fm;
+	int status = FermiMapSectors(&config, &sym, &fm, PyArray_DATA(offset_arr));
+	Py_DECREF(labels);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(offset_arr);
+		return NULL;
+	}
+
+	npy_intp dims_map[1] = { fm.num };
+	PyArrayObject *map_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_map, NPY_UINT64);
+	if (map_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(offset_arr);
+		free(fm.map);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(map_arr), fm.map, fm.num * sizeof(bitfield_t));
+
+	// clean up
+	free(fm.map);
+
+	return Py_BuildValue("(NN)", map_arr, offset_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_sym(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "gen_rdm_sym(orbs, p1, N1, N2, labels, order, rule, target1, target2)";
+
+	PyObject *obj_orbs;
+	PyObject *obj_p1;
+	PyObject *obj_N1;
+	PyObject *obj_N2;
+	PyObject *obj_labels;
+	int order, rule, target1, target2;
+	if (!PyArg_ParseTuple(args, "OOOOOiiii", &obj_orbs, &obj_p1, &obj_N1, &obj_N2, &obj_labels, &order, &rule, &target1, &target2)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_sym(orbs, p1, N1, N2, labels, order, rule, target1, target2)");
+		return NULL;
+	}
+
+	int orbs[64], p1[64], N1[64], N2[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_p1, syntax, orbs, p1, &config) < 0 ||
+	    ParseFermiConfig(obj_orbs, obj_N1, syntax, orbs, N1, &config) < 0 ||
+	    ParseFermiConfig(obj_orbs, obj_N2, syntax, orbs, N2, &config) < 0) {
+		return NULL;
+	}
+	const int nc = config.nc;
+	int i;
+	for (i = 0; i < nc; i++)
+	{
+		if (N1[i] - N2[i] + p1[i] < 0 || N1[i] - N2[i] + p1[i] > orbs[i]) {
+			PyErr_SetString(PyExc_ValueError, "all entries in 'N1 - N2 + p1' must be between 0 and 'orbs'; syntax: gen_rdm_sym(orbs, p1, N1, N2, labels, order, rule, target1, target2)");
+			return NULL;
+		}
+	}
+
+	PyArrayObject *labels;
+	fermi_symmetry_t sym;
+	if (ParseFermiSymmetry(obj_labels, order, rule, IntegerSum(orbs, nc), syntax, &labels, &sym) < 0) {
+		return NULL;
+	}
+	if (target1 < 0 || target1 >= order || target2 < 0 || target2 >= order) {
+		PyErr_SetString(PyExc_ValueError, "'target1' and 'target2' must be in { 0, ..., order - 1 }; syntax: gen_rdm_sym(orbs, p1, N1, N2, labels, order, rule, target1, target2)");
+		Py_DECREF(labels);
+		return NULL;
+	}
+
+	npy_intp dims_offset[1] = { order + 1 };
+	PyArrayObject *offsetP1_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_offset, NPY_INT);
+	PyArrayObject *offsetP2_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_offset, NPY_INT);
+	if (offsetP1_arr == NULL || offsetP2_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(offsetP2_arr);
+		Py_XDECREF(offsetP1_arr);
+		Py_DECREF(labels);
+		return NULL;
+	}
+
+	// actually compute kernel tensor
+	sparse_array_t K = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMSymmetry(orbs, p1, N1, N2, nc, &sym, target1, target2, &K, PyArray_DATA(offsetP1_arr), PyArray_DATA(offsetP2_arr));
+	Py_END_ALLOW_THREADS
+	Py_DECREF(labels);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		DeleteSparseArray(&K);
+		Py_DECREF(offsetP2_arr);
+		Py_DECREF(offsetP1_arr);
+		return NULL;
+	}
+
+	// kernel tensor dimensions
+	assert(K.rank == 4);
+	PyObject *dims_obj = Py_BuildValue("(iiii)", K.dims[0], K.dims[1], K.dims[2], K.dims[3]);
+
+	npy_intp dims_val[1] = { K.nnz };
+	npy_intp dims_ind[2] = { K.nnz, K.rank };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_DOUBLE);
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(K.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (val_arr == NULL || ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(ind_arr);
+		Py_XDECREF(val_arr);
+		Py_DECREF(dims_obj);
+		DeleteSparseArray(&K);
+		Py_DECREF(offsetP2_arr);
+		Py_DECREF(offsetP1_arr);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(val_arr), K.val, K.nnz * sizeof(double));
+	memcpy(PyArray_DATA(ind_arr), K.ind, K.nnz*K.rank * sizeof(K.ind[0]));
+
+	// clean up
+	DeleteSparseArray(&K);
+
+	return Py_BuildValue("(NNNNN)", dims_obj, val_arr, ind_arr, offsetP1_arr, offsetP2_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *tensor_op_sym(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "tensor_op_sym(A, N, labels, order, rule, target)";
+
+	PyObject *Ain;
+	int N;
+	PyObject *obj_labels;
+	int order, rule, target;
+	if (!PyArg_ParseTuple(args, "OiOiii", &Ain, &N, &obj_labels, &order, &rule, &target)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: tensor_op_sym(A, N, labels, order, rule, target)");
+		return NULL;
+	}
+
+	// find out if we should aim for a real or complex matrix
+	PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(Ain);
+	if (arr == NULL) {
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as array; syntax: tensor_op_sym(A, N, labels, order, rule, target)");
+		return NULL;
+	}
+	const bool use_complex = PyArray_ISCOMPLEX(arr);
+	Py_DECREF(arr);
+
+	PyArrayObject *A = (PyArrayObject *)PyArray_ContiguousFromObject(Ain, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	if (A == NULL || PyArray_DIM(A, 0) != PyArray_DIM(A, 1) || PyArray_DIM(A, 0) > 64)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as square matrix of dimension at most 64; syntax: tensor_op_sym(A, N, labels, order, rule, target)");
+		Py_XDECREF(A);
+		return NULL;
+	}
+	const int orbs = (int)PyArray_DIM(A, 0);
+	if (N <= 0 || N > orbs) {
+		PyErr_SetString(PyExc_ValueError, "'N' must be positive and cannot be larger than number of orbitals; syntax: tensor_op_sym(A, N, labels, order, rule, target)");
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	PyArrayObject *labels;
+	fermi_symmetry_t sym;
+	if (ParseFermiSymmetry(obj_labels, order, rule, orbs, syntax, &labels, &sym) < 0) {
+		Py_DECREF(A);
+		return NULL;
+	}
+	if (target < 0 || target >= order) {
+		PyErr_SetString(PyExc_ValueError, "'target' must be in { 0, ..., order - 1 }; syntax: tensor_op_sym(A, N, labels, order, rule, target)");
+		Py_DECREF(labels);
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	sparse_array_t AN = { 0 };
+	sparse_complex_array_t ANc = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	if (use_complex) {
+		status = TensorOpSymmetryComplex(orbs, N, PyArray_DATA(A), &sym, target, &ANc);
+	}
+	else {
+		status = TensorOpSymmetry(orbs, N, PyArray_DATA(A), &sym, target, &AN);
+	}
+	Py_END_ALLOW_THREADS
+	Py_DECREF(labels);
+	Py_DECREF(A);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		DeleteSparseComplexArray(&ANc);
+		DeleteSparseArray(&AN);
+		return NULL;
+	}
+
+	const int nnz = (use_complex ? ANc.nnz : AN.nnz);
+	const int *dims = (use_complex ? ANc.dims : AN.dims);
+	const int *ind  = (use_complex ? ANc.ind  : AN.ind);
+	PyObject *dims_obj = Py_BuildValue("(ii)", dims[0], dims[1]);
+
+	npy_intp dims_val[1] = { nnz };
+	npy_intp dims_ind[2] = { nnz, 2 };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (val_arr == NULL || ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(ind_arr);
+		Py_XDECREF(val_arr);
+		Py_DECREF(dims_obj);
+		DeleteSparseComplexArray(&ANc);
+		DeleteSparseArray(&AN);
+		return NULL;
+	}
+	if (use_complex) {
+		memcpy(PyArray_DATA(val_arr), ANc.val, nnz * sizeof(double complex));
+	}
+	else {
+		memcpy(PyArray_DATA(val_arr), AN.val, nnz * sizeof(double));
+	}
+	memcpy(PyArray_DATA(ind_arr), ind, 2*nnz * sizeof(ind[0]));
+
+	// clean up
+	DeleteSparseComplexArray(&ANc);
+	DeleteSparseArray(&AN);
+
+	return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret a Python tuple (orbs, N, sec_orbs, sec_min, sec_max, ref, max_exc) as restricted configuration space;
+/// the returned arrays hold references which must be released by the caller (see 'ReleaseRestrictedConfig')
+///
+static int ParseRestrictedConfig(PyObject *obj_space, const char *syntax, PyArrayObject **sec, restricted_config_t *config)
+{
+	char msg[1024];
+
+	PyObject *obj_sec[3];
+	unsigned long long ref;
+	if (!PyTuple_Check(obj_space) || !PyArg_ParseTuple(obj_space, "iiOOOKi", &config->orbs, &config->N, &obj_sec[0], &obj_sec[1], &obj_sec[2], &ref, &config->max_exc))
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret restricted space as tuple (orbs, N, sec_orbs, sec_min, sec_max, ref, max_exc); syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		return -1;
+	}
+	config->ref = (bitfield_t)ref;
+
+	int k;
+	for (k = 0; k < 3; k++)
+	{
+		sec[k] = (PyArrayObject *)PyArray_ContiguousFromObject(obj_sec[k], NPY_INT, 1, 1);
+		if (sec[k] == NULL || PyArray_DIM(sec[k], 0) != PyArray_DIM(sec[0], 0))
+		{
+			snprintf(msg, sizeof(msg), "cannot interpret section data as integer vectors of equal length; syntax: %s", syntax);
+			PyErr_SetString(PyExc_ValueError, msg);
+			for (; k >= 0; k--) {
+				Py_XDECREF(sec[k]);
+			}
+			return -1;
+		}
+	}
+	config->sec_orbs = (int *)PyArray_DATA(sec[0]);
+	config->sec_min  = (int *)PyArray_DATA(sec[1]);
+	config->sec_max  = (int *)PyArray_DATA(sec[2]);
+	config->nsec = (int)PyArray_DIM(sec[0], 0);
+
+	bool valid = (0 < config->orbs && config->orbs <= 64 && 0 <= config->N && config->N <= config->orbs && config->nsec > 0);
+	for (k = 0; valid && k < config->nsec; k++) {
+		valid = (config->sec_orbs[k] > 0 && 0 <= config->sec_min[k] && config->sec_min[k] <= config->sec_max[k]);
+	}
+	valid = valid && (IntegerSum(config->sec_orbs, config->nsec) == config->orbs);
+	valid = valid && (config->orbs == 64 || (config->ref >> config->orbs) == 0);
+	if (!valid)
+	{
+		snprintf(msg, sizeof(msg), "invalid restricted space: requires 0 < orbs <= 64, 0 <= N <= orbs, positive section sizes summing to orbs, 0 <= sec_min <= sec_max and ref within orbs; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		for (k = 0; k < 3; k++) {
+			Py_DECREF(sec[k]);
+		}
+		return -1;
+	}
+
+	return 0;
+}
+
+
+static void ReleaseRestrictedConfig(PyArrayObject **sec)
+{
+	int k;
+	for (k = 0; k < 3; k++) {
+		Py_DECREF(sec[k]);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *restricted_map(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_space;
+	if (!PyArg_ParseTuple(args, "O", &obj_space)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: restricted_map(space)");
+		return NULL;
+	}
+
+	PyArrayObject *sec[3];
+	restricted_config_t config;
+	if (ParseRestrictedConfig(obj_space, "restricted_map(space)", sec, &config) < 0) {
+		return NULL;
+	}
+
+	restricted_table_t table;
+	fermi_map_t fm;
+	int status = RestrictedTable(&config, &table);
+	if (status == 0)
+	{
+		status = RestrictedMap(&table, &fm);
+		DeleteRestrictedTable(&table);
+	}
+	ReleaseRestrictedConfig(sec);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory or dimension too large");
+		return NULL;
+	}
+
+	npy_intp dims[1] = { fm.num };
+	PyArrayObject *dets = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_UINT64);
+	if (dets == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		free(fm.map);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(dets), fm.map, fm.num * sizeof(bitfield_t));
+
+	// clean up
+	free(fm.map);
+
+	return (PyObject *)dets;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *restricted_index(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_space;
+	PyObject *obj_dets;
+	if (!PyArg_ParseTuple(args, "OO", &obj_space, &obj_dets)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: restricted_index(space, dets)");
+		return NULL;
+	}
+
+	PyArrayObject *sec[3];
+	restricted_config_t config;
+	if (ParseRestrictedConfig(obj_space, "restricted_index(space, dets)", sec, &config) < 0) {
+		return NULL;
+	}
+
+	PyArrayObject *dets = (PyArrayObject *)PyArray_ContiguousFromObject(obj_dets, NPY_UINT64, 1, 1);
+	if (dets == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'dets' as vector of bit-encoded Slater determinants; syntax: restricted_index(space, dets)");
+		ReleaseRestrictedConfig(sec);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(dets, 0) };
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(dets);
+		ReleaseRestrictedConfig(sec);
+		return NULL;
+	}
+
+	restricted_table_t table;
+	if (RestrictedTable(&config, &table) < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory or dimension too large");
+		Py_DECREF(ind_arr);
+		Py_DECREF(dets);
+		ReleaseRestrictedConfig(sec);
+		return NULL;
+	}
+
+	const bitfield_t *f = (bitfield_t *)PyArray_DATA(dets);
+	int *ind = (int *)PyArray_DATA(ind_arr);
+	npy_intp i;
+	for (i = 0; i < dims[0]; i++)
+	{
+		ind[i] = RestrictedRank(&table, f[i]);
+	}
+
+	// clean up
+	DeleteRestrictedTable(&table);
+	Py_DECREF(dets);
+	ReleaseRestrictedConfig(sec);
+
+	return (PyObject *)ind_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_restricted(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "gen_rdm_restricted(space1, space2, p1)";
+
+	PyObject *obj_space1;
+	PyObject *obj_space2;
+	int p1;
+	if (!PyArg_ParseTuple(args, "OOi", &obj_space1, &obj_space2, &p1)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_restricted(space1, space2, p1)");
+		return NULL;
+	}
+
+	PyArrayObject *sec1[3], *sec2[3];
+	restricted_config_t config1, config2;
+	if (ParseRestrictedConfig(obj_space1, syntax, sec1, &config1) < 0) {
+		return NULL;
+	}
+	if (ParseRestrictedConfig(obj_space2, syntax, sec2, &config2) < 0) {
+		ReleaseRestrictedConfig(sec1);
+		return NULL;
+	}
+	const int p2 = config1.N - config2.N + p1;
+	if (config1.orbs != config2.orbs || p1 < 0 || p1 > config2.N || p2 < 0 || p2 > config1.N)
+	{
+		PyErr_SetString(PyExc_ValueError, "restricted spaces must have the same number of orbitals, and 'p1' and 'N1 - N2 + p1' must be between 0 and the particle numbers; syntax: gen_rdm_restricted(space1, space2, p1)");
+		ReleaseRestrictedConfig(sec2);
+		ReleaseRestrictedConfig(sec1);
+		return NULL;
+	}
+
+	// actually compute kernel tensor
+	sparse_array_t K = { 0 };
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = GenerateRDMRestricted(&config1, &config2, p1, &K);
+	Py_END_ALLOW_THREADS
+	ReleaseRestrictedConfig(sec2);
+	ReleaseRestrictedConfig(sec1);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory or dimension too large");
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+
+	// kernel tensor dimensions
+	assert(K.rank == 4);
+	PyObject *dims_obj = Py_BuildValue("(iiii)", K.dims[0], K.dims[1], K.dims[2], K.dims[3]);
+
+	npy_intp dims_val[1] = { K.nnz };
+	npy_intp dims_ind[2] = { K.nnz, K.rank };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_DOUBLE);
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(K.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (val_arr == NULL || ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(ind_arr);
+		Py_XDECREF(val_arr);
+		Py_DECREF(dims_obj);
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(val_arr), K.val, K.nnz * sizeof(double));
+	memcpy(PyArray_DATA(ind_arr), K.ind, K.nnz*K.rank * sizeof(K.ind[0]));
+
+	// clean up
+	DeleteSparseArray(&K);
+
+	return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_config(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int nc, N;
+	PyObject *obj_maxC = NULL;
+	if (!PyArg_ParseTuple(args, "ii|O", &nc, &N, &obj_maxC)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_config(nc, N[, maxC])");
+		return NULL;
+	}
+	if (nc < 1 || N < 0) {
+		PyErr_SetString(PyExc_ValueError, "number of slots 'nc' must at least be 1 and 'N' must be non-negative; syntax: gen_config(nc, N[, maxC])");
+		return NULL;
+	}
+
+	PyArrayObject *maxC = NULL;
+	if (obj_maxC != NULL && obj_maxC != Py_None)
+	{
+		maxC = (PyArrayObject *)PyArray_ContiguousFromObject(obj_maxC, NPY_INT, 1, 1);
+		if (maxC == NULL || PyArray_DIM(maxC, 0) != nc) {
+			PyErr_SetString(PyExc_ValueError, "'maxC' must be an integer vector of length 'nc'; syntax: gen_config(nc, N[, maxC])");
+			Py_XDECREF(maxC);
+			return NULL;
+		}
+		const int *m = (int *)PyArray_DATA(maxC);
+		int i;
+		for (i = 0; i < nc; i++)
+		{
+			if (m[i] < 0) {
+				PyErr_SetString(PyExc_ValueError, "maximum number of particles in each slot must be non-negative; syntax: gen_config(nc, N[, maxC])");
+				Py_DECREF(maxC);
+				return NULL;
+			}
+		}
+	}
+	const int *m = (maxC != NULL ? (int *)PyArray_DATA(maxC) : NULL);
+
+	const int num = ConfigCount(nc, N, m);
+	if (num < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory or too many configurations");
+		Py_XDECREF(maxC);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { num, nc };
+	PyArrayObject *conf = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_INT);
+	if (conf == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned array");
+		Py_XDECREF(maxC);
+		return NULL;
+	}
+	int status = GenConfig(nc, N, m, PyArray_DATA(conf));
+	Py_XDECREF(maxC);
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_DECREF(conf);
+		return NULL;
+	}
+
+	return (PyObject *)conf;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret Python objects as numbers of orbitals per partition and list of configurations (one per row)
+/// with equal total particle number; the returned arrays hold references which must be released by the caller
+///
+static int ParseFermiUnion(PyObject *obj_orbs, PyObject *obj_configs, const char *syntax, PyArrayObject **orbs, PyArrayObject **configs, fermi_union_t *fu)
+{
+	char msg[1024];
+
+	*orbs = (PyArrayObject *)PyArray_ContiguousFromObject(obj_orbs, NPY_INT, 1, 1);
+	if (*orbs == NULL || PyArray_DIM(*orbs, 0) < 1 || PyArray_DIM(*orbs, 0) > 64)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'orbs' as non-empty integer vector; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_XDECREF(*orbs);
+		return -1;
+	}
+	const int nc = (int)PyArray_DIM(*orbs, 0);
+	const int *o = (int *)PyArray_DATA(*orbs);
+
+	*configs = (PyArrayObject *)PyArray_ContiguousFromObject(obj_configs, NPY_INT, 2, 2);
+	if (*configs == NULL || PyArray_DIM(*configs, 1) != nc)
+	{
+		snprintf(msg, sizeof(msg), "cannot interpret 'configs' as integer matrix with one configuration (particle numbers per partition) per row; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_XDECREF(*configs);
+		Py_DECREF(*orbs);
+		return -1;
+	}
+	const int nconf = (int)PyArray_DIM(*configs, 0);
+	const int *N = (int *)PyArray_DATA(*configs);
+
+	bool valid = (IntegerSum(o, nc) <= 64);
+	int k, s;
+	for (k = 0; valid && k < nc; k++) {
+		valid = (o[k] > 0);
+	}
+	for (s = 0; valid && s < nconf; s++)
+	{
+		valid = (IntegerSum(&N[s*nc], nc) == IntegerSum(N, nc));
+		for (k = 0; valid && k < nc; k++) {
+			valid = (0 <= N[s*nc + k] && N[s*nc + k] <= o[k]);
+		}
+	}
+	if (!valid)
+	{
+		snprintf(msg, sizeof(msg), "requires positive 'orbs' summing to at most 64, and configurations with 0 <= N <= orbs and equal total particle number; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_DECREF(*configs);
+		Py_DECREF(*orbs);
+		return -1;
+	}
+
+	int status = FermiUnion(o, nc, N, nconf, fu);
+	if (status < 0)
+	{
+		if (status == -2) {
+			snprintf(msg, sizeof(msg), "configurations must be distinct; syntax: %s", syntax);
+			PyErr_SetString(PyExc_ValueError, msg);
+		}
+		else {
+			PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory or dimension too large");
+		}
+		Py_DECREF(*configs);
+		Py_DECREF(*orbs);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *union_map(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_orbs;
+	PyObject *obj_configs;
+	if (!PyArg_ParseTuple(args, "OO", &obj_orbs, &obj_configs)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: union_map(orbs, configs)");
+		return NULL;
+	}
+
+	PyArrayObject *orbs, *configs;
+	fermi_union_t fu;
+	if (ParseFermiUnion(obj_orbs, obj_configs, "union_map(orbs, configs)", &orbs, &configs, &fu) < 0) {
+		return NULL;
+	}
+
+	npy_intp dims_offset[1] = { fu.nconf + 1 };
+	PyArrayObject *offset_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_offset, NPY_INT);
+	fermi_map_t fm;
+	int status = (offset_arr != NULL ? FermiUnionMap(&fu, &fm) : -1);
+	if (status < 0)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		Py_XDECREF(offset_arr);
+		DeleteFermiUnion(&fu);
+		Py_DECREF(configs);
+		Py_DECREF(orbs);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(offset_arr), fu.offset, (fu.nconf + 1) * sizeof(int));
+
+	// clean up
+	DeleteFermiUnion(&fu);
+	Py_DECREF(configs);
+	Py_DECREF(orbs);
+
+	npy_intp dims_map[1] = { fm.num };
+	PyArrayObject *map_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_map, NPY_UINT64);
+	if (map_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(offset_arr);
+		free(fm.map);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(map_arr), fm.map, fm.num * sizeof(bitfield_t));
+	free(fm.map);
+
+	return Py_BuildValue("(NN)", map_arr, offset_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *union_index(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_orbs;
+	PyObject *obj_configs;
+	PyObject *obj_dets;
+	if (!PyArg_ParseTuple(args, "OOO", &obj_orbs, &obj_configs, &obj_dets)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: union_index(orbs, configs, dets)");
+		return NULL;
+	}
+
+	PyArrayObject *dets = (PyArrayObject *)PyArray_ContiguousFromObject(obj_dets, NPY_UINT64, 1, 1);
+	if (dets == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'dets' as vector of bit-encoded Slater determinants; syntax: union_index(orbs, configs, dets)");
+		return NULL;
+	}
+
+	PyArrayObject *orbs, *configs;
+	fermi_union_t fu;
+	if (ParseFermiUnion(obj_orbs, obj_configs, "union_index(orbs, configs, dets)", &orbs, &configs, &fu) < 0) {
+		Py_DECREF(dets);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(dets, 0) };
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (ind_arr != NULL)
+	{
+		const bitfield_t *f = (bitfield_t *)PyArray_DATA(dets);
+		int *ind = (int *)PyArray_DATA(ind_arr);
+		npy_intp i;
+		for (i = 0; i < dims[0]; i++)
+		{
+			ind[i] = FermiUnionIndex(&fu, f[i]);
+		}
+	}
+	else {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+	}
+
+	// clean up
+	DeleteFermiUnion(&fu);
+	Py_DECREF(configs);
+	Py_DECREF(orbs);
+	Py_DECREF(dets);
+
+	return (PyObject *)ind_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *gen_rdm_union(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "gen_rdm_union(orbs, p1, configs1, configs2)";
+
+	PyObject *obj_orbs;
+	int p1;
+	PyObject *obj_configs1;
+	PyObject *obj_configs2;
+	if (!PyArg_ParseTuple(args, "OiOO", &obj_orbs, &p1, &obj_configs1, &obj_configs2)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: gen_rdm_union(orbs, p1, configs1, configs2)");
+		return NULL;
+	}
+
+	PyArrayObject *orbs1, *configs1, *orbs2, *configs2;
+	fermi_union_t fu1, fu2;
+	if (ParseFermiUnion(obj_orbs, obj_configs1, syntax, &orbs1, &configs1, &fu1) < 0) {
+		return NULL;
+	}
+	if (ParseFermiUnion(obj_orbs, obj_configs2, syntax, &orbs2, &configs2, &fu2) < 0) {
+		DeleteFermiUnion(&fu1);
+		Py_DECREF(configs1);
+		Py_DECREF(orbs1);
+		return NULL;
+	}
+	const int norbs = IntegerSum(fu1.orbs, fu1.nc);
+	const int N1 = (fu1.nconf > 0 ? IntegerSum(fu1.N, fu1.nc) : 0);
+	const int N2 = (fu2.nconf > 0 ? IntegerSum(fu2.N, fu2.nc) : 0);
+	const int p2 = N1 - N2 + p1;
+
+	sparse_array_t K = { 0 };
+	int status;
+	if (fu1.nconf == 0 || fu2.nconf == 0 || p1 < 0 || p1 > N2 || p2 < 0 || p2 > norbs - N2 + p1)
+	{
+		PyErr_SetString(PyExc_ValueError, "configuration lists must be non-empty, and 'p1' and 'N1 - N2 + p1' must be between 0 and the particle numbers; syntax: gen_rdm_union(orbs, p1, configs1, configs2)");
+		status = -3;
+	}
+	else
+	{
+		// actually compute kernel tensor, covering all configurations at once
+		Py_BEGIN_ALLOW_THREADS
+		status = GenerateRDMUnion(&fu1, &fu2, p1, &K);
+		Py_END_ALLOW_THREADS
+		if (status < 0) {
+			PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		}
+	}
+
+	// clean up
+	DeleteFermiUnion(&fu2);
+	DeleteFermiUnion(&fu1);
+	Py_DECREF(configs2);
+	Py_DECREF(orbs2);
+	Py_DECREF(configs1);
+	Py_DECREF(orbs1);
+
+	if (status < 0) {
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+
+	// kernel tensor dimensions
+	assert(K.rank == 4);
+	PyObject *dims_obj = Py_BuildValue("(iiii)", K.dims[0], K.dims[1], K.dims[2], K.dims[3]);
+
+	npy_intp dims_val[1] = { K.nnz };
+	npy_intp dims_ind[2] = { K.nnz, K.rank };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_val, NPY_DOUBLE);
+	PyArrayObject *ind_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims_ind, sizeof(K.ind[0]) == 4 ? NPY_INT32 : NPY_INT64);
+	if (val_arr == NULL || ind_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(ind_arr);
+		Py_XDECREF(val_arr);
+		Py_DECREF(dims_obj);
+		DeleteSparseArray(&K);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(val_arr), K.val, K.nnz * sizeof(double));
+	memcpy(PyArray_DATA(ind_arr), K.ind, K.nnz*K.rank * sizeof(K.ind[0]));
+
+	DeleteSparseArray(&K);
+
+	return Py_BuildValue("(NNN)", dims_obj, val_arr, ind_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *comprise_perm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "comprise_perm(orbs1, N1, orbs2, N2)";
+
+	PyObject *obj_orbs1, *obj_N1, *obj_orbs2, *obj_N2;
+	if (!PyArg_ParseTuple(args, "OOOO", &obj_orbs1, &obj_N1, &obj_orbs2, &obj_N2)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: comprise_perm(orbs1, N1, orbs2, N2)");
+		return NULL;
+	}
+
+	int orbs1[64], N1[64], orbs2[64], N2[64];
+	fermi_config_t config1, config2;
+	if (ParseFermiConfig(obj_orbs1, obj_N1, syntax, orbs1, N1, &config1) < 0 ||
+	    ParseFermiConfig(obj_orbs2, obj_N2, syntax, orbs2, N2, &config2) < 0) {
+		return NULL;
+	}
+	if (IntegerSum(orbs1, config1.nc) != IntegerSum(orbs2, config2.nc) || IntegerSum(N1, config1.nc) != IntegerSum(N2, config2.nc)) {
+		PyErr_SetString(PyExc_ValueError, "both layouts must have the same total number of orbitals and particles; syntax: comprise_perm(orbs1, N1, orbs2, N2)");
+		return NULL;
+	}
+
+	npy_intp dims[1] = { FermiConfigDim(&config2) };
+	PyArrayObject *perm = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (perm == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	ComprisePermutation(&config1, &config2, PyArray_DATA(perm));
+	Py_END_ALLOW_THREADS
+
+	return (PyObject *)perm;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Interpret a Python object as optional sign vector of the given length;
+/// returns 0 and sets '*sign' to NULL for 'None'
+///
+static int ParseSignVector(PyObject *obj_sign, const npy_intp n, const char *syntax, PyArrayObject **sign)
+{
+	*sign = NULL;
+	if (obj_sign == NULL || obj_sign == Py_None) {
+		return 0;
+	}
+
+	*sign = (PyArrayObject *)PyArray_ContiguousFromObject(obj_sign, NPY_INT, 1, 1);
+	if (*sign == NULL || PyArray_DIM(*sign, 0) != n)
+	{
+		char msg[1024];
+		snprintf(msg, sizeof(msg), "sign vector must be an integer vector with the same length as the permutation; syntax: %s", syntax);
+		PyErr_SetString(PyExc_ValueError, msg);
+		Py_XDECREF(*sign);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *permute_gather(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "permute_gather(x, perm, sign=None)";
+
+	PyObject *obj_x, *obj_perm;
+	PyObject *obj_sign = NULL;
+	if (!PyArg_ParseTuple(args, "OO|O", &obj_x, &obj_perm, &obj_sign)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: permute_gather(x, perm, sign=None)");
+		return NULL;
+	}
+
+	// find out if the vector is real or complex
+	PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(obj_x);
+	if (arr == NULL) {
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'x' as array; syntax: permute_gather(x, perm, sign=None)");
+		return NULL;
+	}
+	const bool use_complex = PyArray_ISCOMPLEX(arr);
+	Py_DECREF(arr);
+
+	PyArrayObject *x = (PyArrayObject *)PyArray_ContiguousFromObject(obj_x, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 1, 1);
+	PyArrayObject *perm = (PyArrayObject *)PyArray_ContiguousFromObject(obj_perm, NPY_INT, 1, 1);
+	if (x == NULL || perm == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'x' as vector and 'perm' as integer vector; syntax: permute_gather(x, perm, sign=None)");
+		Py_XDECREF(perm);
+		Py_XDECREF(x);
+		return NULL;
+	}
+	const npy_intp n = PyArray_DIM(perm, 0);
+	const int *p = (int *)PyArray_DATA(perm);
+	npy_intp i;
+	for (i = 0; i < n; i++)
+	{
+		if (p[i] >= PyArray_DIM(x, 0)) {
+			PyErr_SetString(PyExc_ValueError, "entries of 'perm' must be smaller than the length of 'x'; syntax: permute_gather(x, perm, sign=None)");
+			Py_DECREF(perm);
+			Py_DECREF(x);
+			return NULL;
+		}
+	}
+	PyArrayObject *sign;
+	if (ParseSignVector(obj_sign, n, syntax, &sign) < 0) {
+		Py_DECREF(perm);
+		Py_DECREF(x);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { n };
+	PyArrayObject *y = (PyArrayObject *)PyArray_SimpleNew(1, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (y == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+	}
+	else
+	{
+		Py_BEGIN_ALLOW_THREADS
+		PermuteGather((int)n, p, sign != NULL ? PyArray_DATA(sign) : NULL, use_complex ? 2 : 1, PyArray_DATA(x), PyArray_DATA(y));
+		Py_END_ALLOW_THREADS
+	}
+
+	// clean up
+	Py_XDECREF(sign);
+	Py_DECREF(perm);
+	Py_DECREF(x);
+
+	return (PyObject *)y;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *permute_gather_matrix(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "permute_gather_matrix(A, perm1, perm2, sign1=None, sign2=None)";
+
+	PyObject *obj_A, *obj_perm1, *obj_perm2;
+	PyObject *obj_sign1 = NULL, *obj_sign2 = NULL;
+	if (!PyArg_ParseTuple(args, "OOO|OO", &obj_A, &obj_perm1, &obj_perm2, &obj_sign1, &obj_sign2)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: permute_gather_matrix(A, perm1, perm2, sign1=None, sign2=None)");
+		return NULL;
+	}
+
+	// find out if the matrix is real or complex
+	PyArrayObject *arr = (PyArrayObject *)PyArray_FROM_O(obj_A);
+	if (arr == NULL) {
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as array; syntax: permute_gather_matrix(A, perm1, perm2, sign1=None, sign2=None)");
+		return NULL;
+	}
+	const bool use_complex = PyArray_ISCOMPLEX(arr);
+	Py_DECREF(arr);
+
+	PyArrayObject *A = (PyArrayObject *)PyArray_ContiguousFromObject(obj_A, use_complex ? NPY_CDOUBLE : NPY_DOUBLE, 2, 2);
+	PyArrayObject *perm1 = (PyArrayObject *)PyArray_ContiguousFromObject(obj_perm1, NPY_INT, 1, 1);
+	PyArrayObject *perm2 = (PyArrayObject *)PyArray_ContiguousFromObject(obj_perm2, NPY_INT, 1, 1);
+	if (A == NULL || perm1 == NULL || perm2 == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'A' as matrix and 'perm1' and 'perm2' as integer vectors; syntax: permute_gather_matrix(A, perm1, perm2, sign1=None, sign2=None)");
+		Py_XDECREF(perm2);
+		Py_XDECREF(perm1);
+		Py_XDECREF(A);
+		return NULL;
+	}
+	const npy_intp n1 = PyArray_DIM(perm1, 0);
+	const npy_intp n2 = PyArray_DIM(perm2, 0);
+	bool valid = true;
+	npy_intp i;
+	for (i = 0; valid && i < n1; i++) {
+		valid = (((int *)PyArray_DATA(perm1))[i] < PyArray_DIM(A, 0));
+	}
+	for (i = 0; valid && i < n2; i++) {
+		valid = (((int *)PyArray_DATA(perm2))[i] < PyArray_DIM(A, 1));
+	}
+	PyArrayObject *sign1 = NULL, *sign2 = NULL;
+	if (!valid) {
+		PyErr_SetString(PyExc_ValueError, "entries of 'perm1' and 'perm2' must be smaller than the corresponding dimensions of 'A'; syntax: permute_gather_matrix(A, perm1, perm2, sign1=None, sign2=None)");
+	}
+	if (!valid || ParseSignVector(obj_sign1, n1, syntax, &sign1) < 0 || ParseSignVector(obj_sign2, n2, syntax, &sign2) < 0)
+	{
+		Py_XDECREF(sign1);
+		Py_DECREF(perm2);
+		Py_DECREF(perm1);
+		Py_DECREF(A);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { n1, n2 };
+	PyArrayObject *B = (PyArrayObject *)PyArray_SimpleNew(2, dims, use_complex ? NPY_CDOUBLE : NPY_DOUBLE);
+	if (B == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+	}
+	else
+	{
+		Py_BEGIN_ALLOW_THREADS
+		PermuteGatherMatrix((int)n1, PyArray_DATA(perm1), sign1 != NULL ? PyArray_DATA(sign1) : NULL,
+		                    (int)n2, PyArray_DATA(perm2), sign2 != NULL ? PyArray_DATA(sign2) : NULL,
+		                    (int)PyArray_DIM(A, 1), use_complex ? 2 : 1, PyArray_DATA(A), PyArray_DATA(B));
+		Py_END_ALLOW_THREADS
+	}
+
+	// clean up
+	Py_XDECREF(sign2);
+	Py_XDECREF(sign1);
+	Py_DECREF(perm2);
+	Py_DECREF(perm1);
+	Py_DECREF(A);
+
+	return (PyObject *)B;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *orbital_perm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_sigma;
+	int N;
+	if (!PyArg_ParseTuple(args, "Oi", &obj_sigma, &N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: orbital_perm(sigma, N)");
+		return NULL;
+	}
+
+	PyArrayObject *sigma = (PyArrayObject *)PyArray_ContiguousFromObject(obj_sigma, NPY_INT, 1, 1);
+	if (sigma == NULL) {
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'sigma' as integer vector; syntax: orbital_perm(sigma, N)");
+		return NULL;
+	}
+	const int orbs = (int)PyArray_DIM(sigma, 0);
+	const int *s = (int *)PyArray_DATA(sigma);
+	bool valid = (0 < orbs && orbs <= 64 && 0 <= N && N <= orbs);
+	bitfield_t image = 0;
+	int k;
+	for (k = 0; valid && k < orbs; k++)
+	{
+		valid = (0 <= s[k] && s[k] < orbs && ((image >> s[k]) & 1) == 0);
+		if (valid) {
+			image |= ((bitfield_t)1) << s[k];
+		}
+	}
+	if (!valid) {
+		PyErr_SetString(PyExc_ValueError, "'sigma' must be a permutation of 0, ..., orbs - 1 (orbs <= 64) and 0 <= N <= orbs; syntax: orbital_perm(sigma, N)");
+		Py_DECREF(sigma);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { Binomial(orbs, N) };
+	PyArrayObject *perm = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	PyArrayObject *sign = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (perm == NULL || sign == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(sign);
+		Py_XDECREF(perm);
+		Py_DECREF(sigma);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	OrbitalPermutation(orbs, N, s, PyArray_DATA(perm), PyArray_DATA(sign));
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF(sigma);
+
+	return Py_BuildValue("(NN)", perm, sign);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *particle_hole_perm(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int orbs, N;
+	if (!PyArg_ParseTuple(args, "ii", &orbs, &N)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: particle_hole_perm(orbs, N)");
+		return NULL;
+	}
+	if (orbs <= 0 || orbs > 64 || N < 0 || N > orbs) {
+		PyErr_SetString(PyExc_ValueError, "requires 0 < orbs <= 64 and 0 <= N <= orbs; syntax: particle_hole_perm(orbs, N)");
+		return NULL;
+	}
+
+	npy_intp dims[1] = { Binomial(orbs, N) };
+	PyArrayObject *perm = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	PyArrayObject *sign = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+	if (perm == NULL || sign == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(sign);
+		Py_XDECREF(perm);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	ParticleHolePermutation(orbs, N, PyArray_DATA(perm), PyArray_DATA(sign));
+	Py_END_ALLOW_THREADS
+
+	return Py_BuildValue("(NN)", perm, sign);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *permute_inplace(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "permute_inplace(x, perm, sign=None)";
+
+	PyObject *obj_x, *obj_perm;
+	PyObject *obj_sign = NULL;
+	if (!PyArg_ParseTuple(args, "OO|O", &obj_x, &obj_perm, &obj_sign)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: permute_inplace(x, perm, sign=None)");
+		return NULL;
+	}
+
+	if (!PyArray_Check(obj_x)) {
+		PyErr_SetString(PyExc_ValueError, "'x' must be a numpy array; syntax: permute_inplace(x, perm, sign=None)");
+		return NULL;
+	}
+	PyArrayObject *x = (PyArrayObject *)obj_x;
+	if ((PyArray_TYPE(x) != NPY_DOUBLE && PyArray_TYPE(x) != NPY_CDOUBLE) || !PyArray_IS_C_CONTIGUOUS(x) || !PyArray_ISWRITEABLE(x)) {
+		PyErr_SetString(PyExc_ValueError, "'x' must be a writeable contiguous array of type float64 or complex128; syntax: permute_inplace(x, perm, sign=None)");
+		return NULL;
+	}
+	const npy_intp n = PyArray_SIZE(x);
+
+	PyArrayObject *perm = (PyArrayObject *)PyArray_ContiguousFromObject(obj_perm, NPY_INT, 1, 1);
+	if (perm == NULL || PyArray_DIM(perm, 0) != n)
+	{
+		PyErr_SetString(PyExc_ValueError, "'perm' must be an integer vector with as many entries as 'x'; syntax: permute_inplace(x, perm, sign=None)");
+		Py_XDECREF(perm);
+		return NULL;
+	}
+	// check that 'perm' is a bijection
+	const int *p = (int *)PyArray_DATA(perm);
+	char *hit = (char *)calloc(n > 0 ? n : 1, sizeof(char));
+	bool valid = (hit != NULL);
+	npy_intp i;
+	for (i = 0; valid && i < n; i++)
+	{
+		valid = (0 <= p[i] && p[i] < n && !hit[p[i]]);
+		if (valid) {
+			hit[p[i]] = 1;
+		}
+	}
+	free(hit);
+	if (!valid) {
+		PyErr_SetString(PyExc_ValueError, "'perm' must be a permutation of 0, ..., len(x) - 1; syntax: permute_inplace(x, perm, sign=None)");
+		Py_DECREF(perm);
+		return NULL;
+	}
+	PyArrayObject *sign;
+	if (ParseSignVector(obj_sign, n, syntax, &sign) < 0) {
+		Py_DECREF(perm);
+		return NULL;
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = PermuteInPlace((int)n, p, sign != NULL ? PyArray_DATA(sign) : NULL, PyArray_TYPE(x) == NPY_CDOUBLE ? 2 : 1, PyArray_DATA(x));
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_XDECREF(sign);
+	Py_DECREF(perm);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static void IntegralsCapsuleDestructor(PyObject *capsule)
+{
+	integrals_t *ints = (integrals_t *)PyCapsule_GetPointer(capsule, "fermifab.integrals");
+	if (ints != NULL)
+	{
+		DeleteIntegrals(ints);
+		free(ints);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Wrap integrals in a capsule owning the arrays (or memory mapping), and return the header data together with
+/// array views of the orbital symmetry labels, one- and two-electron integrals referencing the capsule;
+/// memory-mapped arrays are read-only
+///
+static PyObject *IntegralsToPython(integrals_t *ints)
+{
+	PyObject *capsule = PyCapsule_New(ints, "fermifab.integrals", IntegralsCapsuleDestructor);
+	if (capsule == NULL)
+	{
+		DeleteIntegrals(ints);
+		free(ints);
+		return NULL;
+	}
+
+	npy_intp dims_orbsym[1] = { ints->norb };
+	npy_intp dims_h1[1]     = { IntegralsPairCount(ints->norb) };
+	npy_intp dims_eri[1]    = { IntegralsCoulombCount(ints->norb) };
+	PyArrayObject *orbsym = (PyArrayObject *)PyArray_SimpleNewFromData(1, dims_orbsym, NPY_INT32,  ints->orbsym);
+	PyArrayObject *h1     = (PyArrayObject *)PyArray_SimpleNewFromData(1, dims_h1,     NPY_DOUBLE, ints->h1);
+	PyArrayObject *eri    = (PyArrayObject *)PyArray_SimpleNewFromData(1, dims_eri,    NPY_DOUBLE, ints->eri);
+	if (orbsym == NULL || h1 == NULL || eri == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned arrays");
+		Py_XDECREF(eri);
+		Py_XDECREF(h1);
+		Py_XDECREF(orbsym);
+		Py_DECREF(capsule);
+		return NULL;
+	}
+	PyArrayObject *arrays[3] = { orbsym, h1, eri };
+	int k;
+	for (k = 0; k < 3; k++)
+	{
+		if (ints->map != NULL) {
+			PyArray_CLEARFLAGS(arrays[k], NPY_ARRAY_WRITEABLE);
+		}
+		// array views keep the capsule alive
+		Py_INCREF(capsule);
+		PyArray_SetBaseObject(arrays[k], capsule);
+	}
+
+	return Py_BuildValue("(iiiidNNNN)", ints->norb, ints->nelec, ints->ms2, ints->isym, ints->ecore, orbsym, h1, eri, capsule);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static int IntegralsError(const int status, const char *filename)
+{
+	if (status == -1) {
+		PyErr_SetString(PyExc_MemoryError, "out of memory");
+	}
+	else if (status == -2) {
+		PyErr_Format(PyExc_OSError, "cannot access file '%s'", filename);
+	}
+	else {
+		PyErr_Format(PyExc_ValueError, "invalid file format of '%s'", filename);
+	}
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *read_fcidump(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *filename;
+	if (!PyArg_ParseTuple(args, "s", &filename)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: read_fcidump(filename)");
+		return NULL;
+	}
+
+	integrals_t *ints = (integrals_t *)malloc(sizeof(integrals_t));
+	if (ints == NULL) {
+		return PyErr_NoMemory();
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = ReadFCIDUMP(filename, ints);
+	Py_END_ALLOW_THREADS
+	if (status < 0)
+	{
+		free(ints);
+		IntegralsError(status, filename);
+		return NULL;
+	}
+
+	return IntegralsToPython(ints);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *map_integrals(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *filename;
+	if (!PyArg_ParseTuple(args, "s", &filename)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: map_integrals(filename)");
+		return NULL;
+	}
+
+	integrals_t *ints = (integrals_t *)malloc(sizeof(integrals_t));
+	if (ints == NULL) {
+		return PyErr_NoMemory();
+	}
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = MapIntegrals(filename, ints);
+	Py_END_ALLOW_THREADS
+	if (status < 0)
+	{
+		free(ints);
+		IntegralsError(status, filename);
+		return NULL;
+	}
+
+	return IntegralsToPython(ints);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *write_integrals(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *filename;
+	integrals_t ints = { 0 };
+	PyObject *obj_orbsym, *obj_h1, *obj_eri;
+	if (!PyArg_ParseTuple(args, "siiiidOOO", &filename, &ints.norb, &ints.nelec, &ints.ms2, &ints.isym, &ints.ecore, &obj_orbsym, &obj_h1, &obj_eri)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: write_integrals(filename, norb, nelec, ms2, isym, ecore, orbsym, h1, eri)");
+		return NULL;
+	}
+	if (ints.norb < 0 || ints.norb > 65535) {
+		PyErr_SetString(PyExc_ValueError, "requires 0 <= norb <= 65535; syntax: write_integrals(filename, norb, nelec, ms2, isym, ecore, orbsym, h1, eri)");
+		return NULL;
+	}
+
+	PyArrayObject *orbsym = (PyArrayObject *)PyArray_ContiguousFromObject(obj_orbsym, NPY_INT32, 1, 1);
+	PyArrayObject *h1     = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h1,     NPY_DOUBLE, 1, 1);
+	PyArrayObject *eri    = (PyArrayObject *)PyArray_ContiguousFromObject(obj_eri,    NPY_DOUBLE, 1, 1);
+	if (orbsym == NULL || h1 == NULL || eri == NULL
+		|| PyArray_DIM(orbsym, 0) != ints.norb || PyArray_DIM(h1, 0) != IntegralsPairCount(ints.norb) || PyArray_DIM(eri, 0) != IntegralsCoulombCount(ints.norb))
+	{
+		PyErr_SetString(PyExc_ValueError, "'orbsym', 'h1' and 'eri' must be vectors with norb, norb*(norb + 1)/2 and npair*(npair + 1)/2 entries (npair = norb*(norb + 1)/2); "
+			"syntax: write_integrals(filename, norb, nelec, ms2, isym, ecore, orbsym, h1, eri)");
+		Py_XDECREF(eri);
+		Py_XDECREF(h1);
+		Py_XDECREF(orbsym);
+		return NULL;
+	}
+	ints.orbsym = PyArray_DATA(orbsym);
+	ints.h1     = PyArray_DATA(h1);
+	ints.eri    = PyArray_DATA(eri);
+
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = WriteIntegrals(filename, &ints);
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+	Py_DECREF(orbsym);
+
+	if (status < 0) {
+		IntegralsError(status, filename);
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parse packed one- and two-electron integrals; the referenced arrays must be released by the caller
+///
+static int ParsePackedIntegrals(const int norb, const double ecore, PyObject *obj_h1, PyObject *obj_eri, const char *syntax, PyArrayObject **h1, PyArrayObject **eri, integrals_t *ints)
+{
+	if (norb <= 0 || norb > 32) {
+		PyErr_Format(PyExc_ValueError, "requires 0 < norb <= 32; syntax: %s", syntax);
+		return -1;
+	}
+
+	*h1  = (PyArrayObject *)PyArray_ContiguousFromObject(obj_h1,  NPY_DOUBLE, 1, 1);
+	*eri = (PyArrayObject *)PyArray_ContiguousFromObject(obj_eri, NPY_DOUBLE, 1, 1);
+	if (*h1 == NULL || *eri == NULL || PyArray_DIM(*h1, 0) != IntegralsPairCount(norb) || PyArray_DIM(*eri, 0) != IntegralsCoulombCount(norb))
+	{
+		PyErr_Format(PyExc_ValueError, "'h1' and 'eri' must be vectors with norb*(norb + 1)/2 and npair*(npair + 1)/2 entries (npair = norb*(norb + 1)/2); syntax: %s", syntax);
+		Py_XDECREF(*eri);
+		Py_XDECREF(*h1);
+		return -1;
+	}
+
+	memset(ints, 0, sizeof(integrals_t));
+	ints->norb  = norb;
+	ints->ecore = ecore;
+	ints->h1    = PyArray_DATA(*h1);
+	ints->eri   = PyArray_DATA(*eri);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *hamiltonian_csr(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "hamiltonian_csr(norb, ecore, h1, eri, orbs, N, tol)";
+
+	int norb;
+	double ecore;
+	PyObject *obj_h1, *obj_eri;
+	PyObject *obj_orbs, *obj_N;
+	double tol;
+	if (!PyArg_ParseTuple(args, "idOOOOd", &norb, &ecore, &obj_h1, &obj_eri, &obj_orbs, &obj_N, &tol)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: hamiltonian_csr(norb, ecore, h1, eri, orbs, N, tol)");
+		return NULL;
+	}
+
+	int orbs[64], N[64];
+	fermi_config_t config;
+	if (ParseFermiConfig(obj_orbs, obj_N, syntax, orbs, N, &config) < 0) {
+		return NULL;
+	}
+	if (IntegerSum(config.orbs, config.nc) != 2*norb) {
+		PyErr_SetString(PyExc_ValueError, "total number of orbitals must be 2*norb (spin orbitals); syntax: hamiltonian_csr(norb, ecore, h1, eri, orbs, N, tol)");
+		return NULL;
+	}
+
+	PyArrayObject *h1, *eri;
+	integrals_t ints;
+	if (ParsePackedIntegrals(norb, ecore, obj_h1, obj_eri, syntax, &h1, &eri, &ints) < 0) {
+		return NULL;
+	}
+
+	sparse_csr_t H;
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = HamiltonianCSR(&ints, &config, tol, &H);
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		return NULL;
+	}
+
+	npy_intp dims_rowptr[1] = { H.nrows + 1 };
+	npy_intp dims_nnz[1]    = { H.rowptr[H.nrows] };
+	PyArrayObject *rowptr_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_rowptr, NPY_INT64);
+	PyArrayObject *col_arr    = (PyArrayObject *)PyArray_SimpleNew(1, dims_nnz,    NPY_INT32);
+	PyArrayObject *val_arr    = (PyArrayObject *)PyArray_SimpleNew(1, dims_nnz,    NPY_DOUBLE);
+	if (rowptr_arr == NULL || col_arr == NULL || val_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(val_arr);
+		Py_XDECREF(col_arr);
+		Py_XDECREF(rowptr_arr);
+		DeleteSparseCSR(&H);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(rowptr_arr), H.rowptr, (H.nrows + 1) * sizeof(int64_t));
+	memcpy(PyArray_DATA(col_arr), H.col, H.rowptr[H.nrows] * sizeof(int));
+	memcpy(PyArray_DATA(val_arr), H.val, H.rowptr[H.nrows] * sizeof(double));
+
+	// clean up
+	DeleteSparseCSR(&H);
+
+	return Py_BuildValue("(NNN)", rowptr_arr, col_arr, val_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parse two vectors of bit-encoded Slater determinants of the 2*norb spin orbitals;
+/// the referenced arrays must be released by the caller
+///
+static int ParseDeterminantPair(const int norb, PyObject *obj_D, PyObject *obj_T, const char *syntax, PyArrayObject **D, PyArrayObject **T)
+{
+	*D = (PyArrayObject *)PyArray_ContiguousFromObject(obj_D, NPY_UINT64, 1, 1);
+	*T = (PyArrayObject *)PyArray_ContiguousFromObject(obj_T, NPY_UINT64, 1, 1);
+	if (*D == NULL || *T == NULL)
+	{
+		PyErr_Format(PyExc_ValueError, "cannot interpret 'D' and 'T' as vectors of bit-encoded Slater determinants; syntax: %s", syntax);
+		Py_XDECREF(*T);
+		Py_XDECREF(*D);
+		return -1;
+	}
+
+	// all occupied orbitals must be spin orbitals
+	const bitfield_t mask = (norb < 32 ? (((bitfield_t)1) << (2*norb)) - 1 : ~((bitfield_t)0));
+	bitfield_t all = 0;
+	npy_intp k;
+	for (k = 0; k < PyArray_DIM(*D, 0); k++) {
+		all |= ((bitfield_t *)PyArray_DATA(*D))[k];
+	}
+	for (k = 0; k < PyArray_DIM(*T, 0); k++) {
+		all |= ((bitfield_t *)PyArray_DATA(*T))[k];
+	}
+	if ((all & ~mask) != 0)
+	{
+		PyErr_Format(PyExc_ValueError, "determinants must only occupy the 2*norb spin orbitals; syntax: %s", syntax);
+		Py_DECREF(*T);
+		Py_DECREF(*D);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *slater_condon_pairs(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "slater_condon_pairs(norb, ecore, h1, eri, D, T)";
+
+	int norb;
+	double ecore;
+	PyObject *obj_h1, *obj_eri;
+	PyObject *obj_D, *obj_T;
+	if (!PyArg_ParseTuple(args, "idOOOO", &norb, &ecore, &obj_h1, &obj_eri, &obj_D, &obj_T)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: slater_condon_pairs(norb, ecore, h1, eri, D, T)");
+		return NULL;
+	}
+
+	PyArrayObject *h1, *eri;
+	integrals_t ints;
+	if (ParsePackedIntegrals(norb, ecore, obj_h1, obj_eri, syntax, &h1, &eri, &ints) < 0) {
+		return NULL;
+	}
+
+	PyArrayObject *D, *T;
+	if (ParseDeterminantPair(norb, obj_D, obj_T, syntax, &D, &T) < 0) {
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+	if (PyArray_DIM(D, 0) != PyArray_DIM(T, 0))
+	{
+		PyErr_SetString(PyExc_ValueError, "'D' and 'T' must have the same length; syntax: slater_condon_pairs(norb, ecore, h1, eri, D, T)");
+		Py_DECREF(T);
+		Py_DECREF(D);
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { PyArray_DIM(D, 0) };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+	if (val_arr == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(T);
+		Py_DECREF(D);
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	SlaterCondonPairs(&ints, dims[0], (bitfield_t *)PyArray_DATA(D), (bitfield_t *)PyArray_DATA(T), (double *)PyArray_DATA(val_arr));
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(T);
+	Py_DECREF(D);
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+
+	return (PyObject *)val_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *slater_condon_block(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "slater_condon_block(norb, ecore, h1, eri, D, T)";
+
+	int norb;
+	double ecore;
+	PyObject *obj_h1, *obj_eri;
+	PyObject *obj_D, *obj_T;
+	if (!PyArg_ParseTuple(args, "idOOOO", &norb, &ecore, &obj_h1, &obj_eri, &obj_D, &obj_T)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: slater_condon_block(norb, ecore, h1, eri, D, T)");
+		return NULL;
+	}
+
+	PyArrayObject *h1, *eri;
+	integrals_t ints;
+	if (ParsePackedIntegrals(norb, ecore, obj_h1, obj_eri, syntax, &h1, &eri, &ints) < 0) {
+		return NULL;
+	}
+
+	PyArrayObject *D, *T;
+	if (ParseDeterminantPair(norb, obj_D, obj_T, syntax, &D, &T) < 0) {
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	npy_intp dims[2] = { PyArray_DIM(D, 0), PyArray_DIM(T, 0) };
+	PyArrayObject *val_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+	if (val_arr == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(T);
+		Py_DECREF(D);
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	SlaterCondonBlock(&ints, (int)dims[0], (bitfield_t *)PyArray_DATA(D), (int)dims[1], (bitfield_t *)PyArray_DATA(T), (double *)PyArray_DATA(val_arr));
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(T);
+	Py_DECREF(D);
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+
+	return (PyObject *)val_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parse a vector of bit-encoded Slater determinants of the 2*norb spin orbitals with equal particle numbers,
+/// sorted in strictly ascending order; the referenced array must be released by the caller
+///
+static int ParseSortedDeterminants(const int norb, PyObject *obj_dets, const char *syntax, PyArrayObject **dets)
+{
+	*dets = (PyArrayObject *)PyArray_ContiguousFromObject(obj_dets, NPY_UINT64, 1, 1);
+	if (*dets == NULL)
+	{
+		PyErr_Format(PyExc_ValueError, "cannot interpret 'dets' as vector of bit-encoded Slater determinants; syntax: %s", syntax);
+		return -1;
+	}
+	if (PyArray_DIM(*dets, 0) > INT_MAX)
+	{
+		PyErr_Format(PyExc_ValueError, "too many determinants; syntax: %s", syntax);
+		Py_DECREF(*dets);
+		return -1;
+	}
+
+	const bitfield_t mask = (norb < 32 ? (((bitfield_t)1) << (2*norb)) - 1 : ~((bitfield_t)0));
+	const bitfield_t *f = (bitfield_t *)PyArray_DATA(*dets);
+	npy_intp k;
+	for (k = 0; k < PyArray_DIM(*dets, 0); k++)
+	{
+		if ((f[k] & ~mask) != 0 || BitCount(f[k]) != BitCount(f[0]) || (k > 0 && f[k] <= f[k - 1]))
+		{
+			PyErr_Format(PyExc_ValueError, "'dets' must be sorted in strictly ascending order, with equal particle numbers in the 2*norb spin orbitals; syntax: %s", syntax);
+			Py_DECREF(*dets);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *hamiltonian_selected(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "hamiltonian_selected(norb, ecore, h1, eri, dets, tol)";
+
+	int norb;
+	double ecore;
+	PyObject *obj_h1, *obj_eri;
+	PyObject *obj_dets;
+	double tol;
+	if (!PyArg_ParseTuple(args, "idOOOd", &norb, &ecore, &obj_h1, &obj_eri, &obj_dets, &tol)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: hamiltonian_selected(norb, ecore, h1, eri, dets, tol)");
+		return NULL;
+	}
+
+	PyArrayObject *h1, *eri;
+	integrals_t ints;
+	if (ParsePackedIntegrals(norb, ecore, obj_h1, obj_eri, syntax, &h1, &eri, &ints) < 0) {
+		return NULL;
+	}
+
+	PyArrayObject *dets;
+	if (ParseSortedDeterminants(norb, obj_dets, syntax, &dets) < 0) {
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	sparse_csr_t H;
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = HamiltonianSelectedCSR(&ints, (bitfield_t *)PyArray_DATA(dets), (int)PyArray_DIM(dets, 0), tol, &H);
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(dets);
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		return NULL;
+	}
+
+	npy_intp dims_rowptr[1] = { H.nrows + 1 };
+	npy_intp dims_nnz[1]    = { H.rowptr[H.nrows] };
+	PyArrayObject *rowptr_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims_rowptr, NPY_INT64);
+	PyArrayObject *col_arr    = (PyArrayObject *)PyArray_SimpleNew(1, dims_nnz,    NPY_INT32);
+	PyArrayObject *val_arr    = (PyArrayObject *)PyArray_SimpleNew(1, dims_nnz,    NPY_DOUBLE);
+	if (rowptr_arr == NULL || col_arr == NULL || val_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(val_arr);
+		Py_XDECREF(col_arr);
+		Py_XDECREF(rowptr_arr);
+		DeleteSparseCSR(&H);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(rowptr_arr), H.rowptr, (H.nrows + 1) * sizeof(int64_t));
+	memcpy(PyArray_DATA(col_arr), H.col, H.rowptr[H.nrows] * sizeof(int));
+	memcpy(PyArray_DATA(val_arr), H.val, H.rowptr[H.nrows] * sizeof(double));
+
+	// clean up
+	DeleteSparseCSR(&H);
+
+	return Py_BuildValue("(NNN)", rowptr_arr, col_arr, val_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *selected_ci_candidates(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	const char *syntax = "selected_ci_candidates(norb, ecore, h1, eri, dets, coeffs, eps)";
+
+	int norb;
+	double ecore;
+	PyObject *obj_h1, *obj_eri;
+	PyObject *obj_dets, *obj_coeffs;
+	double eps;
+	if (!PyArg_ParseTuple(args, "idOOOOd", &norb, &ecore, &obj_h1, &obj_eri, &obj_dets, &obj_coeffs, &eps)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: selected_ci_candidates(norb, ecore, h1, eri, dets, coeffs, eps)");
+		return NULL;
+	}
+
+	PyArrayObject *h1, *eri;
+	integrals_t ints;
+	if (ParsePackedIntegrals(norb, ecore, obj_h1, obj_eri, syntax, &h1, &eri, &ints) < 0) {
+		return NULL;
+	}
+
+	PyArrayObject *dets;
+	if (ParseSortedDeterminants(norb, obj_dets, syntax, &dets) < 0) {
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	PyArrayObject *coeffs = (PyArrayObject *)PyArray_ContiguousFromObject(obj_coeffs, NPY_DOUBLE, 1, 1);
+	if (coeffs == NULL || PyArray_DIM(coeffs, 0) != PyArray_DIM(dets, 0))
+	{
+		PyErr_SetString(PyExc_ValueError, "'coeffs' must be a real vector with the same length as 'dets'; syntax: selected_ci_candidates(norb, ecore, h1, eri, dets, coeffs, eps)");
+		Py_XDECREF(coeffs);
+		Py_DECREF(dets);
+		Py_DECREF(eri);
+		Py_DECREF(h1);
+		return NULL;
+	}
+
+	ci_candidates_t cand;
+	int status;
+	Py_BEGIN_ALLOW_THREADS
+	status = SelectedCICandidates(&ints, (bitfield_t *)PyArray_DATA(dets), (double *)PyArray_DATA(coeffs), (int)PyArray_DIM(dets, 0), eps, &cand);
+	Py_END_ALLOW_THREADS
+
+	// clean up
+	Py_DECREF(coeffs);
+	Py_DECREF(dets);
+	Py_DECREF(eri);
+	Py_DECREF(h1);
+
+	if (status < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		return NULL;
+	}
+
+	npy_intp dims[1] = { cand.num };
+	PyArrayObject *dets_arr     = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_UINT64);
+	PyArrayObject *coupling_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+	PyArrayObject *diag_arr     = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+	if (dets_arr == NULL || coupling_arr == NULL || diag_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(diag_arr);
+		Py_XDECREF(coupling_arr);
+		Py_XDECREF(dets_arr);
+		DeleteCICandidates(&cand);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(dets_arr),     cand.dets,     cand.num * sizeof(bitfield_t));
+	memcpy(PyArray_DATA(coupling_arr), cand.coupling, cand.num * sizeof(double));
+	memcpy(PyArray_DATA(diag_arr),     cand.diag,     cand.num * sizeof(double));
+
+	// clean up
+	DeleteCICandidates(&cand);
+
+	return Py_BuildValue("(NNN)", dets_arr, coupling_arr, diag_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_rank(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_occ;
+	if (!PyArg_ParseTuple(args, "O", &obj_occ)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_rank(occ)");
+		return NULL;
+	}
+
+	PyArrayObject *occ = (PyArrayObject *)PyArray_ContiguousFromObject(obj_occ, NPY_INT, 2, 2);
+	if (occ == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'occ' as matrix of occupation numbers; syntax: boson_rank(occ)");
+		return NULL;
+	}
+	const npy_intp num   = PyArray_DIM(occ, 0);
+	const int      modes = (int)PyArray_DIM(occ, 1);
+	const int *occ_data = (int *)PyArray_DATA(occ);
+	if (modes <= 0)
+	{
+		PyErr_SetString(PyExc_ValueError, "number of modes must be positive; syntax: boson_rank(occ)");
+		Py_DECREF(occ);
+		return NULL;
+	}
+
+	// all rows must have the same non-negative particle number
+	int N = (num > 0 ? IntegerSum(occ_data, modes) : 0);
+	npy_intp i;
+	for (i = 0; i < num*modes; i++)
+	{
+		if (occ_data[i] < 0 || (i % modes == 0 && IntegerSum(&occ_data[i], modes) != N))
+		{
+			PyErr_SetString(PyExc_ValueError, "occupation numbers must be non-negative and sum to the same particle number in each row; syntax: boson_rank(occ)");
+			Py_DECREF(occ);
+			return NULL;
+		}
+	}
+
+	boson_map_t bm;
+	if (BosonBasis(modes, N, &bm) < 0)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "out of memory or basis dimension exceeds 64-bit integer range");
+		Py_DECREF(occ);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { num };
+	PyArrayObject *r_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT64);
+	if (r_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		DeleteBosonMap(&bm);
+		Py_DECREF(occ);
+		return NULL;
+	}
+	int64_t *r = (int64_t *)PyArray_DATA(r_arr);
+	for (i = 0; i < num; i++)
+	{
+		r[i] = BosonRank(&bm, &occ_data[i*modes]);
+	}
+
+	// clean up
+	DeleteBosonMap(&bm);
+	Py_DECREF(occ);
+
+	return (PyObject *)r_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_unrank(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int modes;
+	int N;
+	PyObject *obj_r;
+	if (!PyArg_ParseTuple(args, "iiO", &modes, &N, &obj_r)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_unrank(modes, N, r)");
+		return NULL;
+	}
+	if (modes <= 0 || N < 0) {
+		PyErr_SetString(PyExc_ValueError, "'modes' must be positive and 'N' non-negative; syntax: boson_unrank(modes, N, r)");
+		return NULL;
+	}
+
+	PyArrayObject *r = (PyArrayObject *)PyArray_ContiguousFromObject(obj_r, NPY_INT64, 1, 1);
+	if (r == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'r' as vector of base indices; syntax: boson_unrank(modes, N, r)");
+		return NULL;
+	}
+
+	boson_map_t bm;
+	if (BosonBasis(modes, N, &bm) < 0)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "out of memory or basis dimension exceeds 64-bit integer range");
+		Py_DECREF(r);
+		return NULL;
+	}
+
+	const npy_intp num = PyArray_DIM(r, 0);
+	const int64_t *r_data = (int64_t *)PyArray_DATA(r);
+	npy_intp i;
+	for (i = 0; i < num; i++)
+	{
+		if (r_data[i] < 0 || r_data[i] >= bm.num)
+		{
+			PyErr_SetString(PyExc_ValueError, "base index out of range; syntax: boson_unrank(modes, N, r)");
+			DeleteBosonMap(&bm);
+			Py_DECREF(r);
+			return NULL;
+		}
+	}
+
+	npy_intp dims[2] = { num, modes };
+	PyArrayObject *occ_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_INT);
+	if (occ_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		DeleteBosonMap(&bm);
+		Py_DECREF(r);
+		return NULL;
+	}
+	int *occ = (int *)PyArray_DATA(occ_arr);
+	for (i = 0; i < num; i++)
+	{
+		BosonUnrank(&bm, r_data[i], &occ[i*modes]);
+	}
+
+	// clean up
+	DeleteBosonMap(&bm);
+	Py_DECREF(r);
+
+	return (PyObject *)occ_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_encode(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *obj_occ;
+	if (!PyArg_ParseTuple(args, "O", &obj_occ)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_encode(occ)");
+		return NULL;
+	}
+
+	PyArrayObject *occ = (PyArrayObject *)PyArray_ContiguousFromObject(obj_occ, NPY_INT, 2, 2);
+	if (occ == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'occ' as matrix of occupation numbers; syntax: boson_encode(occ)");
+		return NULL;
+	}
+	const npy_intp num   = PyArray_DIM(occ, 0);
+	const int      modes = (int)PyArray_DIM(occ, 1);
+	const int *occ_data = (int *)PyArray_DATA(occ);
+
+	// maximum particle number determines number of words
+	int N = 0;
+	npy_intp i;
+	for (i = 0; i < num; i++)
+	{
+		int j;
+		for (j = 0; j < modes; j++)
+		{
+			if (occ_data[i*modes + j] < 0)
+			{
+				PyErr_SetString(PyExc_ValueError, "occupation numbers must be non-negative; syntax: boson_encode(occ)");
+				Py_DECREF(occ);
+				return NULL;
+			}
+		}
+		int n = IntegerSum(&occ_data[i*modes], modes);
+		if (n > N) {
+			N = n;
+		}
+	}
+	const int nwords = (modes > 0 ? BosonWords(modes, N) : 0);
+
+	npy_intp dims[2] = { num, nwords };
+	PyArrayObject *w_arr = (PyArrayObject *)PyArray_ZEROS(2, dims, NPY_UINT64, 0);
+	if (w_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(occ);
+		return NULL;
+	}
+	bitfield_t *w = (bitfield_t *)PyArray_DATA(w_arr);
+	for (i = 0; i < num; i++)
+	{
+		BosonEncodeWords(modes, &occ_data[i*modes], &w[i*nwords]);
+	}
+
+	Py_DECREF(occ);
+
+	return (PyObject *)w_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *boson_decode(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	int modes;
+	PyObject *obj_w;
+	if (!PyArg_ParseTuple(args, "iO", &modes, &obj_w)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: boson_decode(modes, w)");
+		return NULL;
+	}
+
+	PyArrayObject *w = (PyArrayObject *)PyArray_ContiguousFromObject(obj_w, NPY_UINT64, 2, 2);
+	if (w == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'w' as matrix of bit-encoded occupations; syntax: boson_decode(modes, w)");
+		return NULL;
+	}
+	const npy_intp num    = PyArray_DIM(w, 0);
+	const int      nwords = (int)PyArray_DIM(w, 1);
+	const bitfield_t *w_data = (bitfield_t *)PyArray_DATA(w);
+
+	// each word pattern must contain 'modes - 1' separators (the separator of the last mode is implicit)
+	npy_intp i;
+	for (i = 0; i < num; i++)
+	{
+		int zeros = 0;
+		int j;
+		for (j = 0; j < nwords; j++) {
+			zeros += 8*sizeof(bitfield_t) - BitCount(w_data[i*nwords + j]);
+		}
+		if (zeros < modes - 1)
+		{
+			PyErr_SetString(PyExc_ValueError, "bit-encoded occupations do not contain enough mode separators; syntax: boson_decode(modes, w)");
+			Py_DECREF(w);
+			return NULL;
+		}
+	}
+
+	npy_intp dims[2] = { num, modes };
+	PyArrayObject *occ_arr = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_INT);
+	if (occ_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned matrix");
+		Py_DECREF(w);
+		return NULL;
+	}
+	int *occ = (int *)PyArray_DATA(occ_arr);
+	for (i = 0; i < num; i++)
+	{
+		BosonDecodeWords(modes, nwords, &w_data[i*nwords], &occ[i*modes]);
+	}
+
+	Py_DECREF(w);
+
+	return (PyObject *)occ_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *elem_sym_poly(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *xin;
+	if (!PyArg_ParseTuple(args, "O", &xin)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: elem_sym_poly(x)");
+		return NULL;
+	}
+
+	PyArrayObject *x = (PyArrayObject *)PyArray_ContiguousFromObject(xin, NPY_CDOUBLE, 1, 1);
+	if (x == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'x' as vector; syntax: elem_sym_poly(x)");
+		return NULL;
+	}
+
+	const int n = PyArray_DIM(x, 0);
+
+	npy_intp dims[1] = { n + 1 };
+	PyArrayObject *e_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	if (e_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vector");
+		Py_DECREF(x);
+		return NULL;
+	}
+
+	ElementarySymmetric(n, PyArray_DATA(x), PyArray_DATA(e_arr));
+
+	Py_DECREF(x);
+
+	return (PyObject *)e_arr;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
+static PyObject *subset_prod(PyObject *self, PyObject *args)
+{
+	// suppress "unused parameter" warning
+	(void)self;
+
+	PyObject *xin;
+	int N;
+	int k;
+	if (!PyArg_ParseTuple(args, "Oii", &xin, &N, &k)) {
+		PyErr_SetString(PyExc_SyntaxError, "error parsing input; syntax: subset_prod(x, N, k)");
+		return NULL;
+	}
+
+	PyArrayObject *x = (PyArrayObject *)PyArray_ContiguousFromObject(xin, NPY_CDOUBLE, 1, 1);
+	if (x == NULL)
+	{
+		PyErr_SetString(PyExc_ValueError, "cannot interpret 'x' as vector; syntax: subset_prod(x, N, k)");
+		return NULL;
+	}
+
+	const int n = PyArray_DIM(x, 0);
+
+	if (n > (int)(8*sizeof(bitfield_t))) {
+		PyErr_SetString(PyExc_ValueError, "length of 'x' cannot exceed 64; syntax: subset_prod(x, N, k)");
+		Py_DECREF(x);
+		return NULL;
+	}
+	if (N < 0 || N > n) {
+		PyErr_SetString(PyExc_ValueError, "'N' must be non-negative and cannot be larger than the length of 'x'; syntax: subset_prod(x, N, k)");
+		Py_DECREF(x);
+		return NULL;
+	}
+	if (k < 0) {
+		PyErr_SetString(PyExc_ValueError, "'k' must be non-negative; syntax: subset_prod(x, N, k)");
+		Py_DECREF(x);
+		return NULL;
+	}
+
+	double complex *prod = (double complex *)malloc((k > 0 ? k : 1) * sizeof(double complex));
+	bitfield_t *subsets = (bitfield_t *)malloc((k > 0 ? k : 1) * sizeof(bitfield_t));
+	if (prod == NULL || subsets == NULL) {
+		PyErr_SetString(PyExc_MemoryError, "out of memory");
+		free(subsets);
+		free(prod);
+		Py_DECREF(x);
+		return NULL;
+	}
+	int count = TopSubsetProducts(n, PyArray_DATA(x), N, k, prod, subsets);
+	Py_DECREF(x);
+	if (count < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "internal error occurred, probably out of memory");
+		free(subsets);
+		free(prod);
+		return NULL;
+	}
+
+	npy_intp dims[1] = { count };
+	PyArrayObject *prod_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_CDOUBLE);
+	PyArrayObject *subsets_arr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_UINT64);
+	if (prod_arr == NULL || subsets_arr == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "error creating to-be-returned vectors");
+		Py_XDECREF(subsets_arr);
+		Py_XDECREF(prod_arr);
+		free(subsets);
+		free(prod);
+		return NULL;
+	}
+	memcpy(PyArray_DATA(prod_arr), prod, count * sizeof(double complex));
+	memcpy(PyArray_DATA(subsets_arr), subsets, count * sizeof(bitfield_t));
+
+	// clean up
+	free(subsets);
+	free(prod);
+
+	return Py_BuildValue("(NN)", prod_arr, subsets_arr);
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+
 static PyMethodDef methods[] = {
-	{ "fermi2coords", fermi2coords, METH_VARARGS, "Enumerate all N-particle Slater basis states for 'orbs' available orbitals." },
-	{ "gen_rdm",      gen_rdm,      METH_VARARGS, "Generate sparse kernel tensor for computing reduced density matrices." },
-	{ "tensor_op",    tensor_op,    METH_VARARGS, "Matrix representation of the N-fold tensor product of an operator." },
+	{ "fermi2coords",           fermi2coords,           METH_VARARGS, "Enumerate all N-particle Slater basis states for 'orbs' available orbitals." },
+	{ "gen_rdm",                gen_rdm,                METH_VARARGS, "Generate sparse kernel tensor for computing reduced density matrices." },
+	{ "gen_rdm_half",           gen_rdm_half,           METH_VARARGS, "Generate the kernel tensor for reduced density matrices of states, storing only the blocks i <= j." },
+	{ "fermi_rdm",              fermi_rdm,              METH_VARARGS, "Reduced density matrix of a state vector, evaluated by the half-storage kernel." },
+	{ "gen_rdm_compact",        gen_rdm_compact,        METH_VARARGS, "Generate the half-storage kernel for reduced density matrices of states in compact encoding." },
+	{ "compact_rdm",            compact_rdm,            METH_VARARGS, "Reduced density matrix of a state vector using a compact kernel." },
+	{ "rdm_partial_trace",      rdm_partial_trace,      METH_VARARGS, "Partial trace of a p-body reduced density matrix, resulting in the (p-1)-body reduced density matrix." },
+	{ "gen_rdm_boson",          gen_rdm_boson,          METH_VARARGS, "Generate the kernel for calculating bosonic p-body reduced density matrices." },
+	{ "boson_rdm",              boson_rdm,              METH_VARARGS, "Bosonic p-body reduced density matrix of a state vector, without constructing the kernel." },
+	{ "boson_p2N_apply",        boson_p2N_apply,        METH_VARARGS, "Apply the bosonic N-body operator generated from a p-body operator to a state vector." },
+	{ "tensor_op",              tensor_op,              METH_VARARGS, "Matrix representation of the N-fold tensor product of an operator." },
+	{ "tensor_op_diag",         tensor_op_diag,         METH_VARARGS, "Diagonal of the N-fold tensor product of an operator (principal minors)." },
+	{ "tensor_op_boson",        tensor_op_boson,        METH_VARARGS, "Symmetric N-fold tensor product of an operator on the bosonic space." },
+	{ "slater_state",           slater_state,           METH_VARARGS, "Slater determinant of orbitals given by the columns of a coefficient matrix." },
+	{ "compound_matrix",        compound_matrix,        METH_VARARGS, "Compound matrix consisting of all p x p minors of a matrix." },
+	{ "fermi_index",            fermi_index,            METH_VARARGS, "Base indices of bit-encoded Slater determinants (single partition)." },
+	{ "sparse_rdm",             sparse_rdm,             METH_VARARGS, "Reduced density matrix of a sparse state given by determinants and coefficients." },
+	{ "sparse_apply",           sparse_apply,           METH_VARARGS, "Apply the N-body operator generated from a p-body operator to a sparse state." },
+	{ "slater_pair_rdm",        slater_pair_rdm,        METH_VARARGS, "Reduced density matrix of weighted outer products of Slater determinants." },
+	{ "string_ci_space",        string_ci_space,        METH_VARARGS, "Alpha and beta string excitation lists of an alpha/beta string CI space, as capsule." },
+	{ "string_ci_rdm1",         string_ci_rdm1,         METH_VARARGS, "Spin-resolved one-body reduced density matrices of an alpha/beta string CI vector." },
+	{ "string_ci_rdm2",         string_ci_rdm2,         METH_VARARGS, "Spin-resolved one-body, spin-resolved (alpha-alpha, alpha-beta, beta-beta) and spin-summed two-body reduced density matrices of an alpha/beta string CI vector." },
+	{ "string_ci_sigma",        string_ci_sigma,        METH_VARARGS, "Apply a spin-free Hamiltonian to an alpha/beta string CI vector (sigma vector)." },
+	{ "excitation_graph",       excitation_graph,       METH_VARARGS, "Compressed graphs of the single and double excitations of all Slater determinants of a configuration." },
+	{ "excitation_graph_rdm",   excitation_graph_rdm,   METH_VARARGS, "Reduced density matrix (p <= 2) of a state vector using precomputed excitation graphs." },
+	{ "excitation_graph_apply", excitation_graph_apply, METH_VARARGS, "Apply the N-body operator generated from a p-body operator (p <= 2) using precomputed excitation graphs." },
+	{ "fermi_map_sectors",      fermi_map_sectors,      METH_VARARGS, "Bit-encoded Slater determinants ordered by symmetry sectors, and sector offsets." },
+	{ "gen_rdm_sym",            gen_rdm_sym,            METH_VARARGS, "Generate the reduced density matrix kernel restricted to symmetry sectors." },
+	{ "tensor_op_sym",          tensor_op_sym,          METH_VARARGS, "Block of the N-fold tensor product of an operator on a symmetry sector." },
+	{ "restricted_map",         restricted_map,         METH_VARARGS, "Bit-encoded Slater determinants of a restricted (excitation level or RAS) space, in numerical order." },
+	{ "restricted_index",       restricted_index,       METH_VARARGS, "Indices of bit-encoded Slater determinants within a restricted space, or -1 if not contained." },
+	{ "gen_rdm_restricted",     gen_rdm_restricted,     METH_VARARGS, "Generate the reduced density matrix kernel on restricted spaces." },
+	{ "gen_config",             gen_config,             METH_VARARGS, "Enumerate the configurations of N particles in nc slots, with optional maximum numbers of particles per slot." },
+	{ "union_map",              union_map,              METH_VARARGS, "Bit-encoded Slater determinants of a union of configurations, and configuration offsets." },
+	{ "union_index",            union_index,            METH_VARARGS, "Indices of bit-encoded Slater determinants within a union of configurations, or -1 if not contained." },
+	{ "gen_rdm_union",          gen_rdm_union,          METH_VARARGS, "Generate the reduced density matrix kernel on unions of configurations, in a single call." },
+	{ "comprise_perm",          comprise_perm,          METH_VARARGS, "Index permutation between two partition layouts of the same orbitals and particle number." },
+	{ "permute_gather",         permute_gather,         METH_VARARGS, "Signed gather y[i] = sign[i] x[perm[i]] of a vector (zero for negative indices)." },
+	{ "permute_gather_matrix",  permute_gather_matrix,  METH_VARARGS, "Signed gather of the rows and columns of a matrix (zero for negative indices)." },
+	{ "orbital_perm",           orbital_perm,           METH_VARARGS, "Index map and fermionic sign of the Slater determinants under an orbital permutation." },
+	{ "particle_hole_perm",     particle_hole_perm,     METH_VARARGS, "Index map and sign of the particle-hole conjugation of the Slater determinants." },
+	{ "permute_inplace",        permute_inplace,        METH_VARARGS, "In-place signed gather x[i] <- sign[i] x[perm[i]] for a permutation 'perm'." },
+	{ "read_fcidump",           read_fcidump,           METH_VARARGS, "Read one- and two-electron integrals from an FCIDUMP file, with 8-fold packed two-electron integrals." },
+	{ "write_integrals",        write_integrals,        METH_VARARGS, "Write packed integrals to a memory-mappable binary file." },
+	{ "map_integrals",          map_integrals,          METH_VARARGS, "Memory-map a binary integral file, as read-only arrays referencing a capsule." },
+	{ "hamiltonian_csr",        hamiltonian_csr,        METH_VARARGS, "Sparse N-body Hamiltonian in CSR format from packed one- and two-electron integrals (Slater-Condon rules)." },
+	{ "slater_condon_pairs",    slater_condon_pairs,    METH_VARARGS, "Hamiltonian matrix elements <D[k]|H|T[k]> of determinant pairs by the Slater-Condon rules." },
+	{ "slater_condon_block",    slater_condon_block,    METH_VARARGS, "Dense Hamiltonian matrix block <D[k]|H|T[l]> by the Slater-Condon rules, e.g., whole matrix rows." },
+	{ "hamiltonian_selected",   hamiltonian_selected,   METH_VARARGS, "Sparse Hamiltonian in CSR format with respect to a sorted list of selected Slater determinants." },
+	{ "selected_ci_candidates", selected_ci_candidates, METH_VARARGS, "Determinants connected to a variational state, with couplings and diagonal elements for selected CI." },
+	{ "boson_rank",             boson_rank,             METH_VARARGS, "Base indices of bosonic occupation numbers (stars and bars ranking)." },
+	{ "boson_unrank",           boson_unrank,           METH_VARARGS, "Bosonic occupation numbers of base indices." },
+	{ "boson_encode",           boson_encode,           METH_VARARGS, "Multi-word bit encoding of bosonic occupation numbers." },
+	{ "boson_decode",           boson_decode,           METH_VARARGS, "Bosonic occupation numbers of multi-word bit encodings." },
+	{ "elem_sym_poly",          elem_sym_poly,          METH_VARARGS, "Elementary symmetric polynomials of a list of numbers." },
+	{ "subset_prod",            subset_prod,            METH_VARARGS, "Subset products of largest magnitude of a list of numbers." },
 	{ NULL, NULL, 0, NULL }     // sentinel
 };
 
@@ -20,10 +20,213 @@
 #include "generate_rdm.h"
 #include "fermi_map.h"
 #include "util.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <malloc.h>
 #include <assert.h>
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of kernel entries with p1- and p2-particle patterns 'a' and 'b', and the strings enumerating them
+///
+/// a_b^dagger a_a |D> is non-zero if and only if 'a' is contained in D and (b - a) in the complement of D.
+/// Within partition 'k', the remaining orbitals of D are chosen from the free orbitals avail[k] (neither in 'a' nor 'b');
+/// if holes are fewer, the string selects the holes instead (besides b - a), such that D == base ^ string.
+/// len[k] is the number of selected orbitals.
+///
+static int64_t RDMStrings(const int *orbs, const int *N2, const int *p1, const int nc, const int *binom, const bitfield_t a, const bitfield_t b, bitfield_t *base, bitfield_t *avail, int *len)
+{
+	int64_t count = 1;
+	(*base) = 0;
+	int offset = 0;
+	int k;
+	for (k = 0; k < nc; k++)
+	{
+		const bitfield_t mask = ((orbs[k] < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << orbs[k]) : 0) - 1) << offset;
+		const bitfield_t ak = a & mask;
+		const bitfield_t bk = (b & ~a) & mask;
+		avail[k] = mask & ~(ak | bk);
+		const int nfree = BitCount(avail[k]);
+		// particles and holes still to be placed
+		const int np = N2[k] - p1[k];
+		const int nh = orbs[k] - N2[k] - BitCount(bk);
+		if (np < 0 || nh < 0) {
+			return 0;
+		}
+		assert(np + nh == nfree);
+		if (nh < np)
+		{
+			// hole picture
+			(*base) |= mask & ~bk;
+			len[k] = nh;
+		}
+		else
+		{
+			(*base) |= ak;
+			len[k] = np;
+		}
+		count *= binom[nfree*65 + len[k]];
+		offset += orbs[k];
+	}
+
+	return count;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Kernel tensor as in 'GenerateRDM', visiting the non-zero entries only
+///
+/// For each pair of p1- and p2-particle patterns, the N2-particle determinants are enumerated as particle or
+/// hole strings over the free orbitals (whichever are fewer), and all indices are ranked by 'FermiConfigRank'
+/// in O(min(N, orbs - N)) operations, and the signs obtained from the bit patterns; such that the cost does not
+/// grow with the particle number for N > orbs/2. The pairs are processed in parallel, after counting the entries.
+/// If 'half' is set (requires p1 == p2), only the pairs with n0 <= n1 are visited (see 'GenerateRDMHalf').
+///
+static int GenerateRDMStrings(const int *orbs, const int *p1, const int *N1, const int *N2, const int *p2, const int nc, const bool half, sparse_array_t *K)
+{
+	int i;
+	int status;
+
+	int binom[65*65];
+	BinomialTable(binom);
+
+	fermi_config_t configN1, configN2;
+	configN1.orbs = (int *)orbs; configN1.N = (int *)N1; configN1.nc = nc;
+	configN2.orbs = (int *)orbs; configN2.N = (int *)N2; configN2.nc = nc;
+
+	// configurations p1 and p2
+	fermi_config_t config;
+	config.orbs = (int *)orbs;
+	config.nc = nc;
+	fermi_map_t baseMapP1, baseMapP2;
+	config.N = (int *)p1; status = FermiMap(&config, &baseMapP1); if (status < 0) { return status; }
+	config.N = (int *)p2; status = FermiMap(&config, &baseMapP2); if (status < 0) { free(baseMapP1.map); return status; }
+
+	assert(!half || baseMapP1.num == baseMapP2.num);
+
+	// index pairs (n0, n1)
+	const int npairs = (half ? baseMapP1.num*(baseMapP1.num + 1)/2 : baseMapP1.num * baseMapP2.num);
+	int *pair = (int *)malloc(2*npairs * sizeof(int));
+	// start of the entries of each pair
+	int64_t *start = (int64_t *)malloc((npairs + 1) * sizeof(int64_t));
+	if (pair == NULL || start == NULL)
+	{
+		free(start);
+		free(pair);
+		free(baseMapP2.map);
+		free(baseMapP1.map);
+		return -1;
+	}
+	{
+		int n0, n1, t = 0;
+		for (n0 = 0; n0 < baseMapP1.num; n0++)
+		{
+			for (n1 = (half ? n0 : 0); n1 < baseMapP2.num; n1++)
+			{
+				pair[2*t  ] = n0;
+				pair[2*t+1] = n1;
+				t++;
+			}
+		}
+		assert(t == npairs);
+	}
+
+	// count entries of each pair
+	start[0] = 0;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (i = 0; i < npairs; i++)
+	{
+		bitfield_t base;
+		bitfield_t avail[64];
+		int len[64];
+		start[i + 1] = RDMStrings(orbs, N2, p1, nc, binom, baseMapP1.map[pair[2*i]], baseMapP2.map[pair[2*i+1]], &base, avail, len);
+	}
+	for (i = 0; i < npairs; i++) {
+		start[i + 1] += start[i];
+	}
+	assert(start[npairs] == K->nnz);
+
+	K->val = (double *)malloc(K->nnz * sizeof(double));
+	K->ind = (int *)malloc(K->nnz*K->rank * sizeof(int));
+	if (K->val == NULL || K->ind == NULL)
+	{
+		free(K->ind);
+		free(K->val);
+		K->ind = NULL;
+		K->val = NULL;
+		free(start);
+		free(pair);
+		free(baseMapP2.map);
+		free(baseMapP1.map);
+		return -1;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (i = 0; i < npairs; i++)
+	{
+		const bitfield_t a = baseMapP1.map[pair[2*i]];
+		const bitfield_t b = baseMapP2.map[pair[2*i+1]];
+
+		bitfield_t base;
+		bitfield_t avail[64];
+		int len[64];
+		const int64_t num = RDMStrings(orbs, N2, p1, nc, binom, a, b, &base, avail, len);
+
+		// compressed strings of each partition with 'len[k]' bits set, and their counters
+		bitfield_t s[64];
+		int cnt[64], idx[64];
+		int k;
+		for (k = 0; k < nc; k++)
+		{
+			s[k] = (((bitfield_t)1) << len[k]) - 1;
+			cnt[k] = binom[BitCount(avail[k])*65 + len[k]];
+			idx[k] = 0;
+		}
+
+		int64_t j;
+		for (j = 0; j < num; j++)
+		{
+			bitfield_t d = base;
+			for (k = 0; k < nc; k++) {
+				d ^= BitDistribute(s[k], avail[k]);
+			}
+			const bitfield_t t = (d & ~a) | b;
+
+			const int64_t m = start[i] + j;
+			K->ind[4*m  ] = pair[2*i];
+			K->ind[4*m+1] = pair[2*i+1];
+			K->ind[4*m+2] = FermiConfigRank(&configN1, binom, t);
+			K->ind[4*m+3] = FermiConfigRank(&configN2, binom, d);
+			K->val[m] = AnnihilSign(d, a) * AnnihilSign(t, b);
+			assert(K->ind[4*m+2] >= 0 && K->ind[4*m+3] >= 0 && K->val[m] != 0);
+
+			// advance strings, partition 0 fastest
+			for (k = 0; k < nc; k++)
+			{
+				if (++idx[k] < cnt[k])
+				{
+					s[k] = NextFermi(s[k]);
+					break;
+				}
+				idx[k] = 0;
+				s[k] = (((bitfield_t)1) << len[k]) - 1;
+			}
+		}
+	}
+
+	// clean up
+	free(start);
+	free(pair);
+	free(baseMapP2.map);
+	free(baseMapP1.map);
+
+	return 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Generate the kernel tensor K required for calculating p-body reduced density matrices
@@ -32,6 +235,7 @@
 /// Given a normalized N-body wavefunction psi (coefficients of canonical Slater basis in lexicographical ordering),
 /// <psi | K{i,j} psi> is the coefficient i,j of the p-body reduced density matrix of psi.
 /// In the creation/annihilation formalism, K{i,j} is the operator a_j^dagger a_i acting on the N-body space wedge^N H.
+/// If a partition is more than half-filled, the entries are enumerated in the hole picture (see 'GenerateRDMStrings').
 ///
 int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, const int nc, sparse_array_t *K)
 {
@@ -43,6 +247,41 @@ int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, co
 	const int p1tot = IntegerSum(p1, nc);
 	const int p2tot = N1tot - N2tot + p1tot;
 
+	// N2 - p1 == N1 - p2
+	int *p2 = (int *)malloc(nc*sizeof(int));
+	for (i = 0; i < nc; i++)
+	{
+		p2[i] = N1[i] - N2[i] + p1[i];
+		assert(p2[i] >= 0);
+	}
+
+	// create sparse array
+	K->rank = 4;
+	K->dims = (int *)malloc(K->rank * sizeof(int));
+	K->nnz = 1;
+	K->dims[0] = 1;
+	K->dims[1] = 1;
+	K->dims[2] = 1;
+	K->dims[3] = 1;
+	bool holes = false;
+	for (i = 0; i < nc; i++)
+	{
+		K->nnz *= Binomial(orbs[i], N2[i])*Binomial(N2[i], p1[i])*Binomial(orbs[i]-N2[i]+p1[i], p2[i]);
+		K->dims[0] *= Binomial(orbs[i], p1[i]);
+		K->dims[1] *= Binomial(orbs[i], p2[i]);
+		K->dims[2] *= Binomial(orbs[i], N1[i]);
+		K->dims[3] *= Binomial(orbs[i], N2[i]);
+		holes |= (2*N2[i] > orbs[i]);
+	}
+
+	// switch to the hole picture if a partition is more than half-filled
+	if (holes)
+	{
+		status = GenerateRDMStrings(orbs, p1, N1, N2, p2, nc, false, K);
+		free(p2);
+		return status;
+	}
+
 	// basic configuration setup
 	fermi_config_t config;
 	config.orbs = (int *)orbs;
@@ -56,23 +295,8 @@ int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, co
 	// configurations p1 and p2
 	fermi_map_t baseMapP1, baseMapP2;
 	config.N = (int *)p1; status = FermiMap(&config, &baseMapP1); if (status < 0) { return status; }
-	// N2 - p1 == N1 - p2
-	int *p2 = (int *)malloc(nc*sizeof(int));
-	for (i = 0; i < nc; i++)
-	{
-		p2[i] = N1[i] - N2[i] + p1[i];
-		assert(p2[i] >= 0);
-	}
 	config.N = p2; status = FermiMap(&config, &baseMapP2); if (status < 0) { return status; }
 
-	// create sparse array
-	K->rank = 4;
-	K->dims = (int *)malloc(K->rank * sizeof(int));
-	K->nnz = baseMapN2.num;
-	for (i = 0; i < nc; i++)
-	{
-		K->nnz *= Binomial(N2[i], p1[i])*Binomial(orbs[i]-N2[i]+p1[i], p2[i]);
-	}
 	K->val = (double *)malloc(K->nnz * sizeof(double));    if (K->val == NULL) { return -1; }
 	K->ind = (int *)malloc(K->nnz*K->rank * sizeof(int));  if (K->ind == NULL) { return -1; }
 
@@ -115,6 +339,262 @@ int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, co
 	}
 	assert(count == K->nnz);
 
+	// clean up
+	free(y);
+	free(p2);
+	free(baseMapP2.map);
+	free(baseMapP1.map);
+	free(baseMapN2.map);
+	free(baseMapN1.map);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the kernel tensor K for calculating p-body reduced density matrices of N-body states
+/// (diagonal sector p1 == p2 and N1 == N2), storing only the entries of K{i,j} with i <= j
+///
+/// Since K{j,i} is the transpose of K{i,j}, the omitted entries follow from the stored ones, and for a state psi,
+/// G[j,i] = conj(G[i,j]) (see 'ContractCompactKernel'). This roughly halves the number of entries compared to
+/// 'GenerateRDM'; the entries are enumerated as in 'GenerateRDMStrings' and ordered by the pairs (i, j).
+///
+int GenerateRDMHalf(const int *orbs, const int *p, const int *N, const int nc, sparse_array_t *K)
+{
+	K->rank = 4;
+	K->dims = (int *)malloc(K->rank * sizeof(int));
+	if (K->dims == NULL) {
+		return -1;
+	}
+	K->dims[0] = 1;
+	K->dims[1] = 1;
+	K->dims[2] = 1;
+	K->dims[3] = 1;
+	int64_t nnz_full = 1;
+	int64_t nnz_diag = 1;
+	int i;
+	for (i = 0; i < nc; i++)
+	{
+		assert(0 <= p[i] && p[i] <= N[i] && N[i] <= orbs[i]);
+		nnz_full *= (int64_t)Binomial(orbs[i], N[i])*Binomial(N[i], p[i])*Binomial(orbs[i]-N[i]+p[i], p[i]);
+		nnz_diag *= (int64_t)Binomial(orbs[i], p[i])*Binomial(orbs[i]-p[i], N[i]-p[i]);
+		K->dims[0] *= Binomial(orbs[i], p[i]);
+		K->dims[1] *= Binomial(orbs[i], p[i]);
+		K->dims[2] *= Binomial(orbs[i], N[i]);
+		K->dims[3] *= Binomial(orbs[i], N[i]);
+	}
+	// number of entries is symmetric in (i, j)
+	K->nnz = (int)((nnz_full + nnz_diag) / 2);
+
+	return GenerateRDMStrings(orbs, p, N, N, p, nc, true, K);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Partial trace of the p-body reduced density matrix 'G' of an N-body state, resulting in the
+/// (p-1)-body reduced density matrix 'Gt':
+///
+/// Gt[x,y] = 1/(N-p+1) sum_k sign(x,k) sign(y,k) G[x+k,y+k],
+///
+/// with the sum running over all orbitals k not contained in x or y, and sign(x,k) the sign of annihilating k from x+k.
+/// The ranks and signs of x+k are tabulated once for all (p-1)-body basis states x, and the rows of 'Gt' evaluated in parallel.
+/// 'G' and 'Gt' are square matrices of dimension 'binomial(orbs, p)' and 'binomial(orbs, p-1)', respectively.
+///
+int RDMPartialTrace(const int orbs, const int p, const int N, const double complex *G, double complex *Gt)
+{
+	assert(1 <= p && p <= N && N <= orbs && orbs <= 64);
+
+	int binom[65*65];
+	BinomialTable(binom);
+
+	int orbsl = orbs;
+	int pl = p;
+	int q = p - 1;
+	const fermi_config_t configP = { &orbsl, &pl, 1 };
+	const fermi_config_t configQ = { &orbsl, &q,  1 };
+
+	fermi_map_t mapQ;
+	int status = FermiMap(&configQ, &mapQ);
+	if (status < 0) {
+		return status;
+	}
+	const int dimQ = mapQ.num;
+	const int dimP = Binomial(orbs, p);
+
+	// rank of x+k, or -1 if k is contained in x, and corresponding sign
+	int *rank = (int *)malloc((size_t)dimQ*orbs * sizeof(int));
+	int *sign = (int *)malloc((size_t)dimQ*orbs * sizeof(int));
+	if (rank == NULL || sign == NULL)
+	{
+		free(sign);
+		free(rank);
+		free(mapQ.map);
+		return -1;
+	}
+	int x;
+	#pragma omp parallel for schedule(static)
+	for (x = 0; x < dimQ; x++)
+	{
+		int k;
+		for (k = 0; k < orbs; k++)
+		{
+			const bitfield_t kb = ((bitfield_t)1) << k;
+			if (mapQ.map[x] & kb)
+			{
+				rank[(size_t)x*orbs + k] = -1;
+				sign[(size_t)x*orbs + k] = 0;
+			}
+			else
+			{
+				rank[(size_t)x*orbs + k] = FermiConfigRank(&configP, binom, mapQ.map[x] | kb);
+				sign[(size_t)x*orbs + k] = AnnihilSign(mapQ.map[x] | kb, kb);
+			}
+		}
+	}
+
+	const double scale = 1.0 / (N - p + 1);
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (x = 0; x < dimQ; x++)
+	{
+		const int *rx = &rank[(size_t)x*orbs];
+		const int *sx = &sign[(size_t)x*orbs];
+		int y;
+		for (y = 0; y < dimQ; y++)
+		{
+			const int *ry = &rank[(size_t)y*orbs];
+			const int *sy = &sign[(size_t)y*orbs];
+
+			double complex sum = 0;
+			int k;
+			for (k = 0; k < orbs; k++)
+			{
+				if (rx[k] >= 0 && ry[k] >= 0) {
+					sum += (sx[k] * sy[k]) * G[(size_t)rx[k]*dimP + ry[k]];
+				}
+			}
+			Gt[(size_t)x*dimQ + y] = scale * sum;
+		}
+	}
+
+	// clean up
+	free(sign);
+	free(rank);
+	free(mapQ.map);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the kernel tensor K for calculating p-body reduced density matrices, restricted to the
+/// symmetry sectors 'target1' and 'target2' of the N1- and N2-particle spaces
+///
+/// Same conventions as for 'GenerateRDM', but the N1- and N2-particle indices refer to the Slater determinants
+/// with symmetry labels 'target1' and 'target2' (see 'FermiMapSymmetry'), and the p1- and p2-particle indices
+/// to the maps ordered by symmetry sectors (see 'FermiMapSectors'), with sector offsets stored in 'offsetP1'
+/// and 'offsetP2' ('sym->order + 1' entries each). K{i,j} can only be non-zero if the labels of i and j
+/// combine with 'target2' to 'target1', such that only these blocks are visited; in particular,
+/// for target1 == target2, reduced density matrices are block-diagonal with respect to the sectors.
+///
+int GenerateRDMSymmetry(const int *orbs, const int *p1, const int *N1, const int *N2, const int nc, const fermi_symmetry_t *sym, const int target1, const int target2, sparse_array_t *K, int *offsetP1, int *offsetP2)
+{
+	int i;
+	int status;
+
+	const int N1tot = IntegerSum(N1, nc);
+	const int N2tot = IntegerSum(N2, nc);
+	const int p1tot = IntegerSum(p1, nc);
+	const int p2tot = N1tot - N2tot + p1tot;
+
+	// basic configuration setup
+	fermi_config_t config;
+	config.orbs = (int *)orbs;
+	config.nc = nc;
+
+	// symmetry sectors of the fermionic particle spaces with configurations N1 and N2
+	fermi_map_t baseMapN1, baseMapN2;
+	config.N = (int *)N1; status = FermiMapSymmetry(&config, sym, target1, &baseMapN1); if (status < 0) { return status; }
+	config.N = (int *)N2; status = FermiMapSymmetry(&config, sym, target2, &baseMapN2); if (status < 0) { return status; }
+
+	// configurations p1 and p2, ordered by symmetry sectors
+	fermi_map_t baseMapP1, baseMapP2;
+	config.N = (int *)p1; status = FermiMapSectors(&config, sym, &baseMapP1, offsetP1); if (status < 0) { return status; }
+	// N2 - p1 == N1 - p2
+	int *p2 = (int *)malloc(nc*sizeof(int));
+	for (i = 0; i < nc; i++)
+	{
+		p2[i] = N1[i] - N2[i] + p1[i];
+		assert(p2[i] >= 0);
+	}
+	config.N = p2; status = FermiMapSectors(&config, sym, &baseMapP2, offsetP2); if (status < 0) { return status; }
+
+	// create sparse array; number of non-zero entries not known in advance
+	K->rank = 4;
+	K->dims = (int *)malloc(K->rank * sizeof(int));
+	K->nnz = 0;
+	int nzmax = 16;
+	K->val = (double *)malloc(nzmax * sizeof(double));          if (K->val == NULL) { return -1; }
+	K->ind = (int *)malloc(K->rank*nzmax * sizeof(int));        if (K->ind == NULL) { return -1; }
+
+	fermi_coords_t *y = (fermi_coords_t *)malloc(N1tot*sizeof(fermi_coords_t));
+
+	// difference of the target labels
+	const int dlabel = SymmetryCombine(sym, target1, SymmetryInverse(sym, target2));
+
+	int s;
+	for (s = 0; s < sym->order; s++)
+	{
+		// sector of the p2-particle states compatible with sector 's' of the p1-particle states
+		const int t = SymmetryCombine(sym, dlabel, s);
+
+		int n[4];
+		for (n[0] = offsetP1[s]; n[0] < offsetP1[s + 1]; n[0]++)
+		{
+			for (n[1] = offsetP2[t]; n[1] < offsetP2[t + 1]; n[1]++)
+			{
+				// fill first 'p2tot' coordinates of 'y' only
+				FermiDecode(baseMapP2.map[n[1]], y, p2tot);
+
+				for (n[3] = 0; n[3] < baseMapN2.num; n[3]++)
+				{
+					int sign[2];
+
+					sign[0] = AnnihilSign(baseMapN2.map[n[3]], baseMapP1.map[n[0]]);
+					if (!sign[0]) {
+						continue;
+					}
+					// store remaining coordinates after annihilation in tail of 'y'
+					FermiDecode(baseMapN2.map[n[3]] - baseMapP1.map[n[0]], y + p2tot, N2tot - p1tot);
+
+					n[2] = Fermi2BaseSign(&baseMapN1, y, N1tot, &sign[1]);
+					if (n[2] == -1) {
+						continue;
+					}
+
+					// check whether we have to reallocate storage space
+					if (K->nnz == nzmax)
+					{
+						nzmax *= 2;
+						K->val = (double *)realloc(K->val, nzmax * sizeof(double));        if (K->val == NULL) { return -1; }
+						K->ind = (int *)realloc(K->ind, K->rank*nzmax * sizeof(int));      if (K->ind == NULL) { return -1; }
+					}
+
+					// set entry
+					K->ind[4*K->nnz  ] = n[0];
+					K->ind[4*K->nnz+1] = n[1];
+					K->ind[4*K->nnz+2] = n[2];
+					K->ind[4*K->nnz+3] = n[3];
+					K->val[K->nnz] = sign[0]*sign[1];
+					K->nnz++;
+				}
+			}
+		}
+	}
+
 	// set array dimensions
 	K->dims[0] = baseMapP1.num;
 	K->dims[1] = baseMapP2.num;
@@ -131,3 +611,63 @@ int GenerateRDM(const int *orbs, const int *p1, const int *N1, const int *N2, co
 
 	return 0;
 }
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Visit the entries of the kernel tensor K with N2-particle index 'n' and Slater determinant 'D'
+/// on a subspace of the Slater basis of 'norbs' orbitals, whose determinants are ranked by 'rank' (with context 'data');
+/// stores the entries at 'ind' and 'val' if not NULL, and returns their number
+///
+/// Same conventions as for 'GenerateRDM' (single partition): the p1- and p2-particle indices refer to the
+/// lexicographically ordered Slater basis of all orbitals, and determinants with negative rank are skipped.
+///
+int GenerateRDMRow(const int norbs, const bitfield_t D, const int n, const int p1, const int p2, determinant_rank_t rank, const void *data, int *ind, double *val)
+{
+	const bitfield_t full = (norbs < (int)(8*sizeof(bitfield_t)) ? ((bitfield_t)1) << norbs : 0) - 1;
+	const int N2 = BitCount(D);
+
+	const int na = Binomial(N2, p1);
+	const int nb = Binomial(norbs - N2 + p1, p2);
+
+	int count = 0;
+	bitfield_t ca = (((bitfield_t)1) << p1) - 1;
+	int ia;
+	for (ia = 0; ia < na; ia++)
+	{
+		// annihilated orbitals 'a', as subset of 'D'
+		const bitfield_t a = BitDistribute(ca, D);
+		const bitfield_t r = D - a;
+		const int sign_a = AnnihilSign(D, a);
+
+		bitfield_t cb = (((bitfield_t)1) << p2) - 1;
+		int ib;
+		for (ib = 0; ib < nb; ib++)
+		{
+			// created orbitals 'b', disjoint from 'r'
+			const bitfield_t b = BitDistribute(cb, full & ~r);
+			const bitfield_t T = r | b;
+			const int m = rank(data, T);
+			if (m >= 0)
+			{
+				if (ind != NULL)
+				{
+					ind[4*count    ] = FermiIndex(a);
+					ind[4*count + 1] = FermiIndex(b);
+					ind[4*count + 2] = m;
+					ind[4*count + 3] = n;
+					val[count] = sign_a * AnnihilSign(T, b);
+				}
+				count++;
+			}
+			if (ib + 1 < nb) {
+				cb = NextFermi(cb);
+			}
+		}
+		if (ia + 1 < na) {
+			ca = NextFermi(ca);
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,469 @@
+/// \file generate_rdm_boson.c
+/// \brief Generate the kernel for calculating bosonic p-body reduced density matrices, and matrix-free variants.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "generate_rdm_boson.h"
+#include "boson_map.h"
+#include "util.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Bosonic basis together with the occupation numbers of all basis states
+///
+typedef struct
+{
+	boson_map_t bm;     //!< ranking tables
+	int *occ;           //!< occupation numbers, matrix of dimension 'num x modes'
+	int num;            //!< number of basis states
+}
+boson_basis_occ_t;
+
+
+static void DeleteBosonBasisOcc(boson_basis_occ_t *b)
+{
+	free(b->occ);
+	DeleteBosonMap(&b->bm);
+}
+
+
+static int BosonBasisOcc(const int modes, const int N, boson_basis_occ_t *b)
+{
+	b->occ = NULL;
+	if (BosonBasis(modes, N, &b->bm) < 0) {
+		return -1;
+	}
+	if (b->bm.num > INT_MAX) {
+		DeleteBosonBasisOcc(b);
+		return -1;
+	}
+	b->num = (int)b->bm.num;
+
+	b->occ = (int *)malloc((size_t)b->num*modes * sizeof(int));
+	if (b->occ == NULL) {
+		DeleteBosonBasisOcc(b);
+		return -1;
+	}
+	int i;
+	#pragma omp parallel for
+	for (i = 0; i < b->num; i++)
+	{
+		BosonUnrank(&b->bm, i, &b->occ[(size_t)i*modes]);
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Table of square roots of binomial coefficients sqrt(Binomial(n, k)), n = 0, ..., nmax, k = 0, ..., kmax,
+/// stored as 'table[n*(kmax + 1) + k]'
+///
+static double *SqrtBinomialTable(const int nmax, const int kmax)
+{
+	double *table = (double *)malloc((nmax + 1)*(kmax + 1) * sizeof(double));
+	if (table == NULL) {
+		return NULL;
+	}
+
+	// Pascal's triangle (in floating-point arithmetic to avoid integer overflow)
+	int n, k;
+	for (n = 0; n <= nmax; n++)
+	{
+		table[n*(kmax + 1)] = 1;
+		for (k = 1; k <= kmax; k++)
+		{
+			table[n*(kmax + 1) + k] = (n == 0 ? 0 : table[(n - 1)*(kmax + 1) + k - 1] + table[(n - 1)*(kmax + 1) + k]);
+		}
+	}
+	for (n = 0; n < (nmax + 1)*(kmax + 1); n++)
+	{
+		table[n] = sqrt(table[n]);
+	}
+
+	return table;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix element of the normalized annihilation operator B_I = prod_m b_m^{i_m} / sqrt(prod_m i_m!),
+/// i.e., B_I |M> = prod_m sqrt(Binomial(M_m, i_m)) |M - I>
+///
+static inline double AnnihilCoeff(const int modes, const int *occM, const int *occI, const double *sqrtbinom, const int kmax)
+{
+	double c = 1;
+	int m;
+	for (m = 0; m < modes; m++)
+	{
+		c *= sqrtbinom[occM[m]*(kmax + 1) + occI[m]];
+	}
+
+	return c;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the kernel tensor K required for calculating bosonic p-body reduced density matrices
+///
+/// Bosonic analogue of 'GenerateRDM' with respect to the normalized occupation number bases (ordered as in 'BosonRank'):
+/// K{I,J} is the operator B_J^dagger B_I mapping the N2- to the N1-particle space, with B_I = prod_m b_m^{i_m} / sqrt(prod_m i_m!)
+/// for the p1-particle basis state I and p2 = N1 - N2 + p1. For a normalized N-particle state psi,
+/// <psi | K{I,J} psi> is the coefficient I,J of the p-body reduced density matrix, whose trace equals Binomial(N, p).
+/// The non-zero entries K{I,J}[R + J, R + I] = sqrt(Binomial(R + I, I) Binomial(R + J, J)) are indexed
+/// by the (N2 - p1)-particle states R and generated in parallel.
+///
+int GenerateRDMBoson(const int modes, const int p1, const int N1, const int N2, sparse_array_t *K)
+{
+	const int p2 = N1 - N2 + p1;
+	assert(modes > 0 && 0 <= p1 && p1 <= N2 && 0 <= p2);
+
+	// bases for p1, p2, N1 and N2 particles and the remaining particles;
+	// zero-initialized such that all of them can be deleted on a single cleanup path
+	boson_basis_occ_t bP1, bP2, bR;
+	boson_map_t bmN1, bmN2;
+	memset(&bP1,  0, sizeof(bP1));
+	memset(&bP2,  0, sizeof(bP2));
+	memset(&bR,   0, sizeof(bR));
+	memset(&bmN1, 0, sizeof(bmN1));
+	memset(&bmN2, 0, sizeof(bmN2));
+	double *sqrtbinom = NULL;
+
+	K->rank = 4;
+	K->dims = NULL;
+	K->val  = NULL;
+	K->ind  = NULL;
+	K->nnz  = 0;
+
+	int status = 0;
+	if (BosonBasisOcc(modes, p1, &bP1) < 0 || BosonBasisOcc(modes, p2, &bP2) < 0 || BosonBasisOcc(modes, N2 - p1, &bR) < 0
+		|| BosonBasis(modes, N1, &bmN1) < 0 || BosonBasis(modes, N2, &bmN2) < 0 || bmN1.num > INT_MAX || bmN2.num > INT_MAX
+		|| (int64_t)bP1.num * bP2.num * bR.num > INT_MAX) {
+		status = -1;
+	}
+
+	const int kmax = (p1 > p2 ? p1 : p2);
+	const int nmax = (N1 > N2 ? N1 : N2);
+
+	// create sparse array
+	if (status == 0)
+	{
+		sqrtbinom = SqrtBinomialTable(nmax, kmax);
+		K->nnz = bP1.num * bP2.num * bR.num;
+		K->dims = (int *)malloc(K->rank * sizeof(int));
+		K->val = (double *)malloc(((size_t)K->nnz > 0 ? (size_t)K->nnz : 1) * sizeof(double));
+		K->ind = (int *)malloc(((size_t)K->nnz > 0 ? (size_t)K->nnz : 1)*K->rank * sizeof(int));
+		if (K->dims == NULL || K->val == NULL || K->ind == NULL || sqrtbinom == NULL) {
+			status = -1;
+		}
+	}
+
+	if (status == 0)
+	{
+		#pragma omp parallel
+		{
+			int *occM = (int *)malloc(modes * sizeof(int));
+			int *occL = (int *)malloc(modes * sizeof(int));
+			if (occM == NULL || occL == NULL)
+			{
+				#pragma omp atomic write
+				status = -1;
+			}
+			else
+			{
+				int i;
+				#pragma omp for schedule(dynamic)
+				for (i = 0; i < bP1.num; i++)
+				{
+					const int *occI = &bP1.occ[(size_t)i*modes];
+					int j;
+					for (j = 0; j < bP2.num; j++)
+					{
+						const int *occJ = &bP2.occ[(size_t)j*modes];
+						size_t count = ((size_t)i*bP2.num + j)*bR.num;
+						int r;
+						for (r = 0; r < bR.num; r++, count++)
+						{
+							const int *occR = &bR.occ[(size_t)r*modes];
+							int m;
+							for (m = 0; m < modes; m++)
+							{
+								occM[m] = occR[m] + occI[m];
+								occL[m] = occR[m] + occJ[m];
+							}
+
+							K->ind[4*count  ] = i;
+							K->ind[4*count+1] = j;
+							K->ind[4*count+2] = (int)BosonRank(&bmN1, occL);
+							K->ind[4*count+3] = (int)BosonRank(&bmN2, occM);
+							K->val[count] = AnnihilCoeff(modes, occM, occI, sqrtbinom, kmax) * AnnihilCoeff(modes, occL, occJ, sqrtbinom, kmax);
+						}
+					}
+				}
+			}
+
+			free(occL);
+			free(occM);
+		}
+
+		// set array dimensions
+		K->dims[0] = bP1.num;
+		K->dims[1] = bP2.num;
+		K->dims[2] = (int)bmN1.num;
+		K->dims[3] = (int)bmN2.num;
+	}
+	if (status < 0)
+	{
+		free(K->ind);
+		free(K->val);
+		free(K->dims);
+		K->ind  = NULL;
+		K->val  = NULL;
+		K->dims = NULL;
+		K->nnz  = 0;
+	}
+
+	// clean up
+	free(sqrtbinom);
+	DeleteBosonMap(&bmN2);
+	DeleteBosonMap(&bmN1);
+	DeleteBosonBasisOcc(&bR);
+	DeleteBosonBasisOcc(&bP2);
+	DeleteBosonBasisOcc(&bP1);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-body reduced density matrix G[I,J] = <psi | B_J^dagger B_I psi> of the bosonic N-particle state 'psi'
+/// without constructing the kernel
+///
+/// With the vectors a_I(R) = sqrt(Binomial(R + I, I)) psi[R + I] indexed by the p-particle states I,
+/// G is the sum of the outer products a(R) a(R)^dagger over all (N - p)-particle states R.
+/// Output matrix 'G' must have dimension 'num_p x num_p' with 'num_p = Binomial(modes + p - 1, p)'.
+///
+int BosonRDM(const int modes, const int p, const int N, const double complex *psi, double complex *G)
+{
+	assert(modes > 0 && 0 <= p && p <= N);
+
+	boson_basis_occ_t bP, bR;
+	boson_map_t bmN;
+	if (BosonBasisOcc(modes, p, &bP) < 0) {
+		return -1;
+	}
+	if (BosonBasisOcc(modes, N - p, &bR) < 0) {
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+	if (BosonBasis(modes, N, &bmN) < 0) {
+		DeleteBosonBasisOcc(&bR);
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+	double *sqrtbinom = SqrtBinomialTable(N, p);
+	if (sqrtbinom == NULL) {
+		DeleteBosonMap(&bmN);
+		DeleteBosonBasisOcc(&bR);
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+
+	const int dim = bP.num;
+	memset(G, 0, (size_t)dim*dim * sizeof(double complex));
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace and partial result
+		int *occM = (int *)malloc(modes * sizeof(int));
+		double complex *a  = (double complex *)malloc(dim * sizeof(double complex));
+		double complex *Gt = (double complex *)calloc((size_t)dim*dim, sizeof(double complex));
+		if (occM == NULL || a == NULL || Gt == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int r;
+			#pragma omp for schedule(dynamic, 16)
+			for (r = 0; r < bR.num; r++)
+			{
+				const int *occR = &bR.occ[(size_t)r*modes];
+				int i, j;
+				for (i = 0; i < dim; i++)
+				{
+					const int *occI = &bP.occ[(size_t)i*modes];
+					int m;
+					for (m = 0; m < modes; m++) {
+						occM[m] = occR[m] + occI[m];
+					}
+					a[i] = AnnihilCoeff(modes, occM, occI, sqrtbinom, p) * psi[BosonRank(&bmN, occM)];
+				}
+				for (i = 0; i < dim; i++)
+				{
+					if (a[i] == 0) {
+						continue;
+					}
+					for (j = 0; j < dim; j++)
+					{
+						Gt[(size_t)i*dim + j] += a[i] * conj(a[j]);
+					}
+				}
+			}
+
+			#pragma omp critical
+			{
+				size_t k;
+				for (k = 0; k < (size_t)dim*dim; k++) {
+					G[k] += Gt[k];
+				}
+			}
+		}
+
+		free(Gt);
+		free(a);
+		free(occM);
+	}
+
+	// clean up
+	free(sqrtbinom);
+	DeleteBosonMap(&bmN);
+	DeleteBosonBasisOcc(&bR);
+	DeleteBosonBasisOcc(&bP);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply the bosonic N-body operator generated from the p-body operator 'h',
+/// i.e., H = sum_{IJ} h[I,J] B_I^dagger B_J (same convention as 'p2N'), to the N-particle state 'psi'
+/// without constructing H or the kernel
+///
+/// For each (N - p)-particle state R, the p-body operator is applied to the vector a_J(R) = sqrt(Binomial(R + J, J)) psi[R + J],
+/// and the result is accumulated into 'out'. Output vector 'out' must have the same dimension as 'psi'.
+///
+int BosonP2NApply(const int modes, const int p, const int N, const double complex *h, const double complex *psi, double complex *out)
+{
+	assert(modes > 0 && 0 <= p && p <= N);
+
+	boson_basis_occ_t bP, bR;
+	boson_map_t bmN;
+	if (BosonBasisOcc(modes, p, &bP) < 0) {
+		return -1;
+	}
+	if (BosonBasisOcc(modes, N - p, &bR) < 0) {
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+	if (BosonBasis(modes, N, &bmN) < 0) {
+		DeleteBosonBasisOcc(&bR);
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+	double *sqrtbinom = SqrtBinomialTable(N, p);
+	if (sqrtbinom == NULL) {
+		DeleteBosonMap(&bmN);
+		DeleteBosonBasisOcc(&bR);
+		DeleteBosonBasisOcc(&bP);
+		return -1;
+	}
+
+	const int dim = bP.num;
+	memset(out, 0, bmN.num * sizeof(double complex));
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		int *occM = (int *)malloc(modes * sizeof(int));
+		int *idx = (int *)malloc(dim * sizeof(int));
+		double *c = (double *)malloc(dim * sizeof(double));
+		double complex *a = (double complex *)malloc(dim * sizeof(double complex));
+		if (occM == NULL || idx == NULL || c == NULL || a == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int r;
+			#pragma omp for schedule(dynamic, 16)
+			for (r = 0; r < bR.num; r++)
+			{
+				const int *occR = &bR.occ[(size_t)r*modes];
+				int i, j;
+				for (i = 0; i < dim; i++)
+				{
+					const int *occI = &bP.occ[(size_t)i*modes];
+					int m;
+					for (m = 0; m < modes; m++) {
+						occM[m] = occR[m] + occI[m];
+					}
+					idx[i] = (int)BosonRank(&bmN, occM);
+					c[i] = AnnihilCoeff(modes, occM, occI, sqrtbinom, p);
+					a[i] = c[i] * psi[idx[i]];
+				}
+				for (i = 0; i < dim; i++)
+				{
+					double complex b = 0;
+					for (j = 0; j < dim; j++)
+					{
+						b += h[(size_t)i*dim + j] * a[j];
+					}
+					if (b == 0) {
+						continue;
+					}
+					b *= c[i];
+					double *o = (double *)&out[idx[i]];
+					#pragma omp atomic
+					o[0] += creal(b);
+					#pragma omp atomic
+					o[1] += cimag(b);
+				}
+			}
+		}
+
+		free(a);
+		free(c);
+		free(idx);
+		free(occM);
+	}
+
+	// clean up
+	free(sqrtbinom);
+	DeleteBosonMap(&bmN);
+	DeleteBosonBasisOcc(&bR);
+	DeleteBosonBasisOcc(&bP);
+
+	return status;
+}
@@ -0,0 +1,569 @@
+/// \file hamiltonian.c
+/// \brief Sparse second-quantized electronic Hamiltonian from one- and two-electron integrals (Slater-Condon rules).
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "hamiltonian.h"
+#include "excitation_graph.h"
+#include "util.h"
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix entry of a Hamiltonian row
+///
+typedef struct
+{
+	int col;        //!< column index
+	double val;     //!< value
+}
+hamiltonian_entry_t;
+
+
+static int CompareHamiltonianEntry(const void *a, const void *b)
+{
+	const hamiltonian_entry_t *x = (const hamiltonian_entry_t *)a;
+	const hamiltonian_entry_t *y = (const hamiltonian_entry_t *)b;
+
+	return (x->col > y->col) - (x->col < y->col);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Basis of the Hamiltonian matrix: Slater determinants of a configuration together with
+/// their excitation graphs, or a sorted list of determinants
+///
+typedef struct
+{
+	const excitation_graphs_t *graphs;  //!< single and double excitation graphs of the configuration, or NULL if the basis is given by 'dets'
+	const bitfield_t *dets;             //!< bit-encoded Slater determinants in ascending order
+	int num;                            //!< number of basis states
+}
+hamiltonian_basis_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Column index of determinant 'T' in a basis given by a list of determinants, or -1 if not contained
+///
+static inline int HamiltonianColumn(const hamiltonian_basis_t *basis, const bitfield_t T)
+{
+	const bitfield_t *f = (const bitfield_t *)bsearch(&T, basis->dets, basis->num, sizeof(bitfield_t), CompareBitfield);
+	return (f != NULL ? (int)(f - basis->dets) : -1);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Sign (-1)^n with 'n' the number of orbitals in 'x' below orbital 'p',
+/// i.e., the sign of creating or annihilating a particle in orbital 'p'
+///
+static inline int OrbitalSign(const bitfield_t x, const int p)
+{
+	return IntegerParitySign(x & ((((bitfield_t)1) << p) - 1));
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Diagonal matrix element <D|H|D>
+///
+static double SlaterCondonDiagonal(const integrals_t *ints, const bitfield_t D)
+{
+	const int norb = ints->norb;
+
+	double v = ints->ecore;
+	bitfield_t x = D;
+	while (x)
+	{
+		const int p = BitTrailingZeros(x);
+		x &= x - 1;
+		const int i = (p < norb ? p : p - norb);
+		v += ints->h1[PairIndex(i, i)];
+		// pairs with the following occupied orbitals
+		bitfield_t y = x;
+		while (y)
+		{
+			const int q = BitTrailingZeros(y);
+			y &= y - 1;
+			const int j = (q < norb ? q : q - norb);
+			v += ints->eri[CoulombIndex(i, i, j, j)];
+			if ((p < norb) == (q < norb)) {
+				v -= ints->eri[CoulombIndex(i, j, j, i)];
+			}
+		}
+	}
+
+	return v;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix element <D|H|T> for the single excitation D = a_a^dagger a_i T, including the fermionic sign
+///
+static double SlaterCondonSingle(const integrals_t *ints, const bitfield_t T, const int i, const int a)
+{
+	const int norb = ints->norb;
+
+	if ((a < norb) != (i < norb)) {
+		return 0;
+	}
+
+	const int si = (i < norb ? i : i - norb);
+	const int sa = (a < norb ? a : a - norb);
+	double v = ints->h1[PairIndex(sa, si)];
+	// sum over occupied orbitals; the term q == i cancels
+	bitfield_t x = T;
+	while (x)
+	{
+		const int q = BitTrailingZeros(x);
+		x &= x - 1;
+		const int sq = (q < norb ? q : q - norb);
+		v += ints->eri[CoulombIndex(sa, si, sq, sq)];
+		if ((q < norb) == (i < norb)) {
+			v -= ints->eri[CoulombIndex(sa, sq, sq, si)];
+		}
+	}
+
+	// sign: parity of the occupied orbitals strictly between 'i' and 'a'
+	const int lo = (i < a ? i : a);
+	const int hi = (i < a ? a : i);
+	const bitfield_t between = ((((bitfield_t)1) << hi) - 1) & ~((((bitfield_t)1) << (lo + 1)) - 1);
+
+	return IntegerParitySign(T & between) * v;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix element <D|H|T> for the double excitation D = a_a^dagger a_b^dagger a_j a_i T
+/// with i < j and a < b, including the fermionic sign
+///
+static double SlaterCondonDouble(const integrals_t *ints, const bitfield_t T, const int i, const int j, const int a, const int b)
+{
+	const int norb = ints->norb;
+
+	const int spi = (i >= norb), spj = (j >= norb), spa = (a >= norb), spb = (b >= norb);
+
+	// (ai|bj) - (aj|bi), with matching spins
+	double v = 0;
+	if (spa == spi && spb == spj) {
+		v += ints->eri[CoulombIndex(a - spa*norb, i - spi*norb, b - spb*norb, j - spj*norb)];
+	}
+	if (spa == spj && spb == spi) {
+		v -= ints->eri[CoulombIndex(a - spa*norb, j - spj*norb, b - spb*norb, i - spi*norb)];
+	}
+	if (v == 0) {
+		return 0;
+	}
+
+	bitfield_t x = T;
+	int sign = OrbitalSign(x, i); x ^= ((bitfield_t)1) << i;
+	sign    *= OrbitalSign(x, j); x ^= ((bitfield_t)1) << j;
+	sign    *= OrbitalSign(x, b); x ^= ((bitfield_t)1) << b;
+	sign    *= OrbitalSign(x, a);
+
+	return sign * v;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix element <D|H|T> of the Hamiltonian (see 'HamiltonianRow') between the Slater determinants
+/// 'D' and 'T' of the 2*norb spin orbitals, by the Slater-Condon rules
+///
+/// The excitation degree is half the number of 1-bits of D XOR T; the holes (orbitals of 'T' not in 'D')
+/// and particles (orbitals of 'D' not in 'T') are extracted by counting trailing zeros, and the fermionic sign
+/// is the parity of the occupied orbitals between them. Determinants with different particle numbers
+/// or an excitation degree larger than 2 result in zero.
+///
+double SlaterCondon(const integrals_t *ints, const bitfield_t D, const bitfield_t T)
+{
+	const bitfield_t x = D ^ T;
+	if (x == 0) {
+		return SlaterCondonDiagonal(ints, D);
+	}
+
+	const bitfield_t holes = T & x;
+	const bitfield_t parts = D & x;
+	const int degree = BitCount(holes);
+	if (degree != BitCount(parts) || degree > 2) {
+		return 0;
+	}
+
+	const int i = BitTrailingZeros(holes);
+	const int a = BitTrailingZeros(parts);
+	if (degree == 1) {
+		return SlaterCondonSingle(ints, T, i, a);
+	}
+	else {
+		const int j = BitTrailingZeros(holes & (holes - 1));
+		const int b = BitTrailingZeros(parts & (parts - 1));
+		return SlaterCondonDouble(ints, T, i, j, a, b);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Evaluate the matrix elements val[k] = <D[k]|H|T[k]> of 'n' determinant pairs in parallel
+///
+void SlaterCondonPairs(const integrals_t *ints, const int64_t n, const bitfield_t *D, const bitfield_t *T, double *val)
+{
+	int64_t k;
+	#pragma omp parallel for schedule(static)
+	for (k = 0; k < n; k++)
+	{
+		val[k] = SlaterCondon(ints, D[k], T[k]);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Evaluate the dense matrix block val[k*ncols + l] = <D[k]|H|T[l]> in parallel,
+/// e.g., whole matrix rows with respect to a list of determinants 'T'
+///
+void SlaterCondonBlock(const integrals_t *ints, const int nrows, const bitfield_t *D, const int ncols, const bitfield_t *T, double *val)
+{
+	int k;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (k = 0; k < nrows; k++)
+	{
+		int l;
+		for (l = 0; l < ncols; l++)
+		{
+			val[(int64_t)k*ncols + l] = SlaterCondon(ints, D[k], T[l]);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the row of the Hamiltonian for determinant 'D' (diagonal entry first, then sorted by columns);
+/// returns the number of entries
+///
+/// Spin orbital 'p' refers to spatial orbital p % norb, with alpha spin for p < norb and beta spin otherwise.
+/// The Hamiltonian is H = ecore + sum_{pq} h[p,q] a_p^dagger a_q + 1/2 sum_{pqrs} (pq|rs) a_p^dagger a_r^dagger a_s a_q
+/// (spin orbitals, with the spin-free integrals of the spatial orbitals). Only excitations contained in 'basis' (a list of determinants)
+/// are kept, and entries with magnitude at most 'tol' are dropped.
+///
+static int HamiltonianRow(const integrals_t *ints, const hamiltonian_basis_t *basis, const bitfield_t D, const double tol, hamiltonian_entry_t *entries)
+{
+	const int norb = ints->norb;
+	const int nspin = 2*norb;
+
+	// occupied and virtual spin orbitals
+	int occ[64], vir[64];
+	int nocc = 0, nvir = 0;
+	int p;
+	for (p = 0; p < nspin; p++)
+	{
+		if (D & (((bitfield_t)1) << p)) {
+			occ[nocc++] = p;
+		}
+		else {
+			vir[nvir++] = p;
+		}
+	}
+
+	int count = 0;
+
+	// diagonal
+	entries[count].col = HamiltonianColumn(basis, D);
+	entries[count].val = SlaterCondonDiagonal(ints, D);
+	count++;
+
+	// single excitations a_a^dagger a_i
+	int ki, ka;
+	for (ki = 0; ki < nocc; ki++)
+	{
+		const int i = occ[ki];
+		for (ka = 0; ka < nvir; ka++)
+		{
+			const int a = vir[ka];
+			if ((a < norb) != (i < norb)) {
+				continue;
+			}
+			const int col = HamiltonianColumn(basis, D ^ (((bitfield_t)1) << i) ^ (((bitfield_t)1) << a));
+			if (col < 0) {
+				continue;
+			}
+			const double v = SlaterCondonSingle(ints, D, i, a);
+			if (fabs(v) <= tol) {
+				continue;
+			}
+			entries[count].col = col;
+			entries[count].val = v;
+			count++;
+		}
+	}
+
+	// double excitations a_a^dagger a_b^dagger a_j a_i with i < j and a < b
+	int kj, kb;
+	for (ki = 0; ki < nocc; ki++)
+	{
+		const int i = occ[ki];
+		for (kj = ki + 1; kj < nocc; kj++)
+		{
+			const int j = occ[kj];
+			for (ka = 0; ka < nvir; ka++)
+			{
+				const int a = vir[ka];
+				for (kb = ka + 1; kb < nvir; kb++)
+				{
+					const int b = vir[kb];
+					// spin conservation
+					if ((a >= norb) + (b >= norb) != (i >= norb) + (j >= norb)) {
+						continue;
+					}
+					const int col = HamiltonianColumn(basis, D ^ (((bitfield_t)1) << i) ^ (((bitfield_t)1) << j) ^ (((bitfield_t)1) << a) ^ (((bitfield_t)1) << b));
+					if (col < 0) {
+						continue;
+					}
+					const double v = SlaterCondonDouble(ints, D, i, j, a, b);
+					if (fabs(v) <= tol) {
+						continue;
+					}
+					entries[count].col = col;
+					entries[count].val = v;
+					count++;
+				}
+			}
+		}
+	}
+
+	// diagonal entry stays in front
+	qsort(entries + 1, count - 1, sizeof(hamiltonian_entry_t), CompareHamiltonianEntry);
+
+	return count;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the row 'n' of the Hamiltonian (same layout as 'HamiltonianRow') with respect to the Slater determinants
+/// of a configuration, reading the excitations off the excitation graphs; returns the number of entries
+///
+/// The rows of the single and double excitation graphs are both sorted by target index and merged,
+/// such that neither ranking nor sorting is required. Excitations which flip the spin of an orbital are skipped.
+///
+static int HamiltonianGraphRow(const integrals_t *ints, const excitation_graphs_t *graphs, const int n, const double tol, hamiltonian_entry_t *entries)
+{
+	const int norb = ints->norb;
+	const bitfield_t D = graphs->fm.map[n];
+
+	int count = 0;
+
+	// diagonal
+	entries[count].col = n;
+	entries[count].val = SlaterCondonDiagonal(ints, D);
+	count++;
+
+	const uint8_t *p1   = graphs->graph1.data + graphs->graph1.offset[n];
+	const uint8_t *end1 = graphs->graph1.data + graphs->graph1.offset[n + 1];
+	const uint8_t *p2   = graphs->graph2.data + graphs->graph2.offset[n];
+	const uint8_t *end2 = graphs->graph2.data + graphs->graph2.offset[n + 1];
+
+	// current single and double excitation, with created orbitals 'c' and annihilated orbitals 'a'
+	int t1 = 0, t2 = 0;
+	int c1[1] = { 0 }, a1[1] = { 0 }, c2[2] = { 0 }, a2[2] = { 0 };
+	int has1 = (p1 < end1);
+	int has2 = (p2 < end2);
+	if (has1) { ExcitationGraphDecode(&p1, 1, &t1, c1, a1); }
+	if (has2) { ExcitationGraphDecode(&p2, 2, &t2, c2, a2); }
+
+	while (has1 || has2)
+	{
+		int col;
+		double v = 0;
+		if (has1 && (!has2 || t1 < t2))
+		{
+			col = t1;
+			// spin conservation
+			if ((c1[0] < norb) == (a1[0] < norb)) {
+				v = SlaterCondonSingle(ints, D, a1[0], c1[0]);
+			}
+			has1 = (p1 < end1);
+			if (has1) { ExcitationGraphDecode(&p1, 1, &t1, c1, a1); }
+		}
+		else
+		{
+			col = t2;
+			// spin conservation
+			if ((c2[0] >= norb) + (c2[1] >= norb) == (a2[0] >= norb) + (a2[1] >= norb)) {
+				v = SlaterCondonDouble(ints, D, a2[0], a2[1], c2[0], c2[1]);
+			}
+			has2 = (p2 < end2);
+			if (has2) { ExcitationGraphDecode(&p2, 2, &t2, c2, a2); }
+		}
+		if (fabs(v) <= tol) {
+			continue;
+		}
+		entries[count].col = col;
+		entries[count].val = v;
+		count++;
+	}
+
+	return count;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Assemble the Hamiltonian matrix with respect to 'basis' (bit patterns 'map') in CSR format,
+/// for 'Ntot' particles in the 2*norb spin orbitals
+///
+/// The rows are generated in parallel, first to count the entries and then to fill the preallocated arrays.
+///
+static int AssembleHamiltonianCSR(const integrals_t *ints, const hamiltonian_basis_t *basis, const bitfield_t *map, const int Ntot, const double tol, sparse_csr_t *H)
+{
+	const int nspin = 2*ints->norb;
+	const int num = basis->num;
+
+	H->nrows = num;
+	H->ncols = num;
+	H->val = NULL;
+	H->col = NULL;
+	H->rowptr = (int64_t *)malloc((num + 1) * sizeof(int64_t));
+	if (H->rowptr == NULL) {
+		return -1;
+	}
+
+	// maximum number of entries per row
+	const int maxent = 1 + Ntot*(nspin - Ntot) + Binomial(Ntot, 2)*Binomial(nspin - Ntot, 2);
+
+	int status = 0;
+
+	int pass;
+	for (pass = 0; pass < 2 && status == 0; pass++)
+	{
+		#pragma omp parallel
+		{
+			// thread-local workspace
+			hamiltonian_entry_t *entries = (hamiltonian_entry_t *)malloc(maxent * sizeof(hamiltonian_entry_t));
+			if (entries == NULL)
+			{
+				#pragma omp atomic write
+				status = -1;
+			}
+			else
+			{
+				int n;
+				#pragma omp for schedule(dynamic, 16)
+				for (n = 0; n < num; n++)
+				{
+					const int count = (basis->graphs != NULL ?
+						HamiltonianGraphRow(ints, basis->graphs, n, tol, entries) :
+						HamiltonianRow(ints, basis, map[n], tol, entries));
+					assert(entries[0].col == n);
+					if (pass == 0)
+					{
+						H->rowptr[n + 1] = count;
+					}
+					else
+					{
+						assert(H->rowptr[n] + count == H->rowptr[n + 1]);
+						int k;
+						for (k = 0; k < count; k++)
+						{
+							H->col[H->rowptr[n] + k] = entries[k].col;
+							H->val[H->rowptr[n] + k] = entries[k].val;
+						}
+					}
+				}
+			}
+
+			free(entries);
+		}
+
+		if (pass == 0 && status == 0)
+		{
+			H->rowptr[0] = 0;
+			int n;
+			for (n = 0; n < num; n++) {
+				H->rowptr[n + 1] += H->rowptr[n];
+			}
+			H->col = (int    *)malloc((H->rowptr[num] > 0 ? H->rowptr[num] : 1) * sizeof(int));
+			H->val = (double *)malloc((H->rowptr[num] > 0 ? H->rowptr[num] : 1) * sizeof(double));
+			if (H->col == NULL || H->val == NULL) {
+				status = -1;
+			}
+		}
+	}
+
+	if (status < 0) {
+		DeleteSparseCSR(H);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Assemble the N-body Hamiltonian (see 'HamiltonianRow') in CSR format with respect to the Slater determinants
+/// of the fermionic configuration 'config' of the 2*norb spin orbitals (e.g., orbs = { norb, norb } with
+/// N = { N_alpha, N_beta }, or a single partition of all spin orbitals)
+///
+/// The diagonal entry is stored first in each row (also if it is zero), followed by the off-diagonal entries with
+/// magnitude larger than 'tol' in ascending column order. The connected determinants and their column indices
+/// are taken from the single and double excitation graphs of 'config' (see 'ExcitationGraphs').
+///
+int HamiltonianCSR(const integrals_t *ints, const fermi_config_t *config, const double tol, sparse_csr_t *H)
+{
+	assert(IntegerSum(config->orbs, config->nc) == 2*ints->norb && 2*ints->norb <= (int)(8*sizeof(bitfield_t)));
+
+	excitation_graphs_t graphs;
+	int status = ExcitationGraphs(config, 2, &graphs);
+	if (status < 0) {
+		return status;
+	}
+
+	hamiltonian_basis_t basis = { &graphs, NULL, graphs.fm.num };
+
+	status = AssembleHamiltonianCSR(ints, &basis, graphs.fm.map, graphs.Ntot, tol, H);
+
+	DeleteExcitationGraphs(&graphs);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Assemble the Hamiltonian in CSR format with respect to a selected list of 'ndets' Slater determinants
+/// with the same particle number, sorted in ascending order without duplicates (same layout as 'HamiltonianCSR')
+///
+/// Instead of testing all determinant pairs, the single and double excitations of each row are looked up
+/// by binary search, such that the cost scales as ndets log(ndets) times the number of excitations.
+/// The excitation graphs do not apply here since the selected determinants do not form a configuration.
+///
+int HamiltonianSelectedCSR(const integrals_t *ints, const bitfield_t *dets, const int ndets, const double tol, sparse_csr_t *H)
+{
+	assert(2*ints->norb <= (int)(8*sizeof(bitfield_t)));
+
+	hamiltonian_basis_t basis = { NULL, dets, ndets };
+
+	return AssembleHamiltonianCSR(ints, &basis, dets, (ndets > 0 ? BitCount(dets[0]) : 0), tol, H);
+}
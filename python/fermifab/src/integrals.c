@@ -0,0 +1,448 @@
+/// \file integrals.c
+/// \brief One- and two-electron integrals over real spatial orbitals: FCIDUMP reader and memory-mappable binary format.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "integrals.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Header of the binary integral file format
+///
+/// The header is followed by the orbital symmetry labels (int32), the one-electron and the two-electron integrals
+/// (double, packed as in 'integrals_t'), each starting at the given byte offset, which is a multiple of 64.
+/// All numbers are stored in native byte order.
+///
+typedef struct
+{
+	char magic[8];          //!< "FFINTEG", zero-terminated
+	int32_t version;        //!< format version, currently 1
+	int32_t norb;           //!< number of spatial orbitals
+	int32_t nelec;          //!< number of electrons
+	int32_t ms2;            //!< twice the spin projection
+	int32_t isym;           //!< symmetry label of the target state
+	int32_t reserved;       //!< zero
+	double ecore;           //!< constant core energy
+	int64_t offset_orbsym;  //!< byte offset of the orbital symmetry labels
+	int64_t offset_h1;      //!< byte offset of the one-electron integrals
+	int64_t offset_eri;     //!< byte offset of the two-electron integrals
+	int64_t size;           //!< total file size in bytes
+}
+integrals_header_t;
+
+
+static const char integrals_magic[8] = "FFINTEG";
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Round up to a multiple of 64 (cache line size)
+///
+static inline int64_t AlignOffset(const int64_t offset)
+{
+	return (offset + 63) & ~((int64_t)63);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate zero-initialized integral arrays for 'norb' spatial orbitals
+///
+int AllocateIntegrals(const int norb, integrals_t *ints)
+{
+	ints->norb = norb;
+	ints->nelec = 0;
+	ints->ms2 = 0;
+	ints->isym = 1;
+	ints->ecore = 0;
+	ints->map = NULL;
+	ints->mapsize = 0;
+
+	ints->h1     = (double  *)calloc(IntegralsPairCount(norb) + 1,    sizeof(double));
+	ints->eri    = (double  *)calloc(IntegralsCoulombCount(norb) + 1, sizeof(double));
+	ints->orbsym = (int32_t *)calloc(norb + 1,                        sizeof(int32_t));
+	if (ints->h1 == NULL || ints->eri == NULL || ints->orbsym == NULL)
+	{
+		DeleteIntegrals(ints);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Release the integral arrays, or unmap the binary file
+///
+void DeleteIntegrals(integrals_t *ints)
+{
+	if (ints->map != NULL)
+	{
+		munmap(ints->map, ints->mapsize);
+	}
+	else
+	{
+		free(ints->orbsym);
+		free(ints->eri);
+		free(ints->h1);
+	}
+
+	ints->map = NULL;
+	ints->mapsize = 0;
+	ints->orbsym = NULL;
+	ints->eri = NULL;
+	ints->h1 = NULL;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parse the namelist header of an FCIDUMP file, from '&FCI' to '&END' or '/';
+/// the 'ORBSYM' entries are stored in the reallocated array 'orbsym'
+///
+static int ParseFCIDUMPHeader(FILE *fd, int *norb, int *nelec, int *ms2, int *isym, int32_t **orbsym, int *norbsym)
+{
+	char line[16384];
+	char key[16] = "";
+	int capacity = 0;
+	bool started = false;
+
+	while (fgets(line, sizeof(line), fd) != NULL)
+	{
+		char *p;
+		for (p = line; *p; p++) {
+			*p = (char)toupper((unsigned char)*p);
+		}
+
+		// terminator of the namelist
+		bool done = false;
+		char *end = strstr(line, "&END");
+		if (end == NULL) {
+			end = strchr(line, '/');
+		}
+		if (end != NULL)
+		{
+			*end = '\0';
+			done = true;
+		}
+
+		char *saveptr;
+		char *token;
+		for (token = strtok_r(line, " ,\t\r\n", &saveptr); token != NULL; token = strtok_r(NULL, " ,\t\r\n", &saveptr))
+		{
+			if (token[0] == '&')
+			{
+				// '&FCI'
+				started = true;
+				continue;
+			}
+			if (!started) {
+				return -3;
+			}
+
+			char *value = token;
+			char *eq = strchr(token, '=');
+			if (eq != NULL)
+			{
+				*eq = '\0';
+				if (strlen(token) >= sizeof(key)) {
+					return -3;
+				}
+				strcpy(key, token);
+				value = eq + 1;
+				if (*value == '\0') {
+					continue;
+				}
+			}
+
+			// values of other keys (e.g., 'IUHF' or 'UHF=.FALSE.') are ignored
+			if (strcmp(key, "NORB") != 0 && strcmp(key, "NELEC") != 0 && strcmp(key, "MS2") != 0 &&
+			    strcmp(key, "ISYM") != 0 && strcmp(key, "ORBSYM") != 0) {
+				continue;
+			}
+
+			char *tail;
+			const long v = strtol(value, &tail, 10);
+			if (*tail != '\0') {
+				return -3;
+			}
+
+			if (strcmp(key, "NORB") == 0) {
+				*norb = (int)v;
+			}
+			else if (strcmp(key, "NELEC") == 0) {
+				*nelec = (int)v;
+			}
+			else if (strcmp(key, "MS2") == 0) {
+				*ms2 = (int)v;
+			}
+			else if (strcmp(key, "ISYM") == 0) {
+				*isym = (int)v;
+			}
+			else if (strcmp(key, "ORBSYM") == 0)
+			{
+				if (*norbsym == capacity)
+				{
+					capacity = 2*capacity + 16;
+					int32_t *tmp = (int32_t *)realloc(*orbsym, capacity * sizeof(int32_t));
+					if (tmp == NULL) {
+						return -1;
+					}
+					*orbsym = tmp;
+				}
+				(*orbsym)[(*norbsym)++] = (int32_t)v;
+			}
+		}
+
+		if (done) {
+			return (started ? 0 : -3);
+		}
+	}
+
+	// missing terminator
+	return -3;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Read the integrals from an FCIDUMP text file
+///
+/// Each line after the namelist header contains a value and the 1-based orbital indices i, j, k, l:
+/// (ij|kl) for non-zero indices, h[i,j] for k = l = 0, the core energy for i = j = k = l = 0, whereas orbital
+/// energies (only i non-zero) are skipped. Fortran exponents ('D') are accepted. Permuted copies of a two-electron
+/// integral are mapped to the same canonical entry (see 'CoulombCanonical').
+///
+/// Returns -1 if out of memory, -2 if the file cannot be read and -3 for an invalid file format.
+///
+int ReadFCIDUMP(const char *filename, integrals_t *ints)
+{
+	FILE *fd = fopen(filename, "r");
+	if (fd == NULL) {
+		return -2;
+	}
+
+	int norb = -1, nelec = 0, ms2 = 0, isym = 1;
+	int32_t *orbsym = NULL;
+	int norbsym = 0;
+	int status = ParseFCIDUMPHeader(fd, &norb, &nelec, &ms2, &isym, &orbsym, &norbsym);
+	if (status == 0 && (norb < 0 || norb > 65535 || (norbsym != 0 && norbsym != norb))) {
+		status = -3;
+	}
+	if (status == 0) {
+		status = AllocateIntegrals(norb, ints);
+	}
+	if (status < 0)
+	{
+		free(orbsym);
+		fclose(fd);
+		return status;
+	}
+	ints->nelec = nelec;
+	ints->ms2 = ms2;
+	ints->isym = isym;
+	if (norbsym > 0) {
+		memcpy(ints->orbsym, orbsym, norb * sizeof(int32_t));
+	}
+	free(orbsym);
+
+	char line[1024];
+	while (fgets(line, sizeof(line), fd) != NULL)
+	{
+		char *p;
+		for (p = line; *p; p++)
+		{
+			if (*p == 'D' || *p == 'd') {
+				*p = 'E';
+			}
+		}
+
+		char *tail;
+		const double v = strtod(line, &tail);
+		if (tail == line)
+		{
+			// skip blank lines
+			for (; isspace((unsigned char)*tail); tail++) { }
+			if (*tail == '\0') {
+				continue;
+			}
+			status = -3;
+			break;
+		}
+		long x[4];
+		int k;
+		for (k = 0; k < 4; k++)
+		{
+			p = tail;
+			x[k] = strtol(p, &tail, 10);
+			if (tail == p || x[k] < 0 || x[k] > norb) {
+				break;
+			}
+		}
+		if (k < 4)
+		{
+			status = -3;
+			break;
+		}
+
+		if (x[0] > 0 && x[1] > 0 && x[2] > 0 && x[3] > 0) {
+			ints->eri[CoulombIndex(x[0] - 1, x[1] - 1, x[2] - 1, x[3] - 1)] = v;
+		}
+		else if (x[0] > 0 && x[1] > 0 && x[2] == 0 && x[3] == 0) {
+			ints->h1[PairIndex(x[0] - 1, x[1] - 1)] = v;
+		}
+		else if (x[0] == 0 && x[1] == 0 && x[2] == 0 && x[3] == 0) {
+			ints->ecore = v;
+		}
+		else if (!(x[0] > 0 && x[1] == 0 && x[2] == 0 && x[3] == 0))
+		{
+			status = -3;
+			break;
+		}
+	}
+
+	fclose(fd);
+
+	if (status < 0)
+	{
+		DeleteIntegrals(ints);
+		return status;
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Write the integrals to a binary file, which can be memory-mapped by 'MapIntegrals';
+/// returns -2 if the file cannot be written
+///
+int WriteIntegrals(const char *filename, const integrals_t *ints)
+{
+	const int64_t npair = IntegralsPairCount(ints->norb);
+	const int64_t neri  = IntegralsCoulombCount(ints->norb);
+
+	integrals_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, integrals_magic, sizeof(header.magic));
+	header.version = 1;
+	header.norb  = ints->norb;
+	header.nelec = ints->nelec;
+	header.ms2   = ints->ms2;
+	header.isym  = ints->isym;
+	header.ecore = ints->ecore;
+	header.offset_orbsym = AlignOffset(sizeof(header));
+	header.offset_h1     = AlignOffset(header.offset_orbsym + ints->norb * sizeof(int32_t));
+	header.offset_eri    = AlignOffset(header.offset_h1 + npair * sizeof(double));
+	header.size          = header.offset_eri + neri * sizeof(double);
+
+	FILE *fd = fopen(filename, "wb");
+	if (fd == NULL) {
+		return -2;
+	}
+
+	static const char zeros[64] = { 0 };
+	bool ok = (fwrite(&header, sizeof(header), 1, fd) == 1);
+	ok = ok && fwrite(zeros, 1, header.offset_orbsym - sizeof(header), fd) == (size_t)(header.offset_orbsym - sizeof(header));
+	ok = ok && fwrite(ints->orbsym, sizeof(int32_t), ints->norb, fd) == (size_t)ints->norb;
+	ok = ok && fwrite(zeros, 1, header.offset_h1 - header.offset_orbsym - ints->norb * sizeof(int32_t), fd) == (size_t)(header.offset_h1 - header.offset_orbsym - ints->norb * sizeof(int32_t));
+	ok = ok && fwrite(ints->h1, sizeof(double), npair, fd) == (size_t)npair;
+	ok = ok && fwrite(zeros, 1, header.offset_eri - header.offset_h1 - npair * sizeof(double), fd) == (size_t)(header.offset_eri - header.offset_h1 - npair * sizeof(double));
+	ok = ok && fwrite(ints->eri, sizeof(double), neri, fd) == (size_t)neri;
+
+	if (fclose(fd) != 0) {
+		ok = false;
+	}
+
+	return (ok ? 0 : -2);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Memory-map a binary integral file written by 'WriteIntegrals' (read-only and shared, such that
+/// the pages are loaded on demand and shared between processes mapping the same file)
+///
+/// Returns -2 if the file cannot be read and -3 for an invalid file format. The mapping is released by 'DeleteIntegrals'.
+///
+int MapIntegrals(const char *filename, integrals_t *ints)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return -2;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return -2;
+	}
+	if ((size_t)st.st_size < sizeof(integrals_header_t))
+	{
+		close(fd);
+		return -3;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// mapping remains valid after closing the file
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -2;
+	}
+
+	const integrals_header_t *header = (const integrals_header_t *)map;
+	const int64_t npair = IntegralsPairCount(header->norb);
+	const int64_t neri  = IntegralsCoulombCount(header->norb);
+	bool valid = (memcmp(header->magic, integrals_magic, sizeof(header->magic)) == 0 && header->version == 1
+		&& 0 <= header->norb && header->norb <= 65535 && header->size == st.st_size
+		&& header->offset_orbsym % 64 == 0 && header->offset_h1 % 64 == 0 && header->offset_eri % 64 == 0
+		&& header->offset_orbsym >= (int64_t)sizeof(integrals_header_t)
+		&& header->offset_h1  >= header->offset_orbsym + header->norb * (int64_t)sizeof(int32_t)
+		&& header->offset_eri >= header->offset_h1 + npair * (int64_t)sizeof(double)
+		&& header->size       >= header->offset_eri + neri * (int64_t)sizeof(double));
+	if (!valid)
+	{
+		munmap(map, st.st_size);
+		return -3;
+	}
+
+	ints->norb  = header->norb;
+	ints->nelec = header->nelec;
+	ints->ms2   = header->ms2;
+	ints->isym  = header->isym;
+	ints->ecore = header->ecore;
+	ints->orbsym = (int32_t *)((char *)map + header->offset_orbsym);
+	ints->h1     = (double  *)((char *)map + header->offset_h1);
+	ints->eri    = (double  *)((char *)map + header->offset_eri);
+	ints->map = map;
+	ints->mapsize = st.st_size;
+
+	return 0;
+}
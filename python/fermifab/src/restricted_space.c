@@ -0,0 +1,411 @@
+/// \file restricted_space.c
+/// \brief Configuration spaces restricted by the excitation level or by the particle numbers of orbital sections (RAS).
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "restricted_space.h"
+#include "generate_rdm.h"
+#include "util.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <limits.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Pointer to the completion count of state (n, c, h) after assigning orbitals b, ..., orbs-1
+///
+static inline int64_t *RestrictedCount(const restricted_table_t *table, const int b, const int n, const int c, const int h)
+{
+	const int N = table->config.N;
+	return &table->count[(((int64_t)b*(N + 1) + n)*(N + 1) + c)*table->hdim + h];
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Assign occupation 'x' to orbital b-1 and update the state (n, c, h); returns 0 if the restrictions are violated
+///
+static inline int RestrictedStep(const restricted_table_t *table, const int b, const int x, int *n, int *c, int *h)
+{
+	const restricted_config_t *config = &table->config;
+	const int o = b - 1;
+	const int s = table->section[o];
+
+	if (x > *n) {
+		return 0;
+	}
+	int cc = *c + x;
+	if (cc > config->sec_max[s] || cc > config->N) {
+		return 0;
+	}
+	int hh = *h;
+	if (config->max_exc >= 0 && !x && ((config->ref >> o) & 1))
+	{
+		hh++;
+		if (hh > config->max_exc) {
+			return 0;
+		}
+	}
+	if (o == table->start[s])
+	{
+		// section is complete
+		if (cc < config->sec_min[s]) {
+			return 0;
+		}
+		cc = 0;
+	}
+
+	*n -= x;
+	*c = cc;
+	*h = hh;
+
+	return 1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Leave orbitals lo, ..., L-1 unoccupied and update the state (c, h) in constant time;
+/// returns 0 if the restrictions are violated
+///
+static inline int RestrictedSkip(const restricted_table_t *table, const int L, const int lo, int *c, int *h)
+{
+	if (L == lo) {
+		return 1;
+	}
+
+	const restricted_config_t *config = &table->config;
+
+	if (config->max_exc >= 0)
+	{
+		const bitfield_t mask = ((L < (int)(8*sizeof(bitfield_t)) ? ((bitfield_t)1) << L : 0) - 1) & ~((((bitfield_t)1) << lo) - 1);
+		*h += BitCount(config->ref & mask);
+		if (*h > config->max_exc) {
+			return 0;
+		}
+	}
+
+	const int s_hi = table->section[L - 1];
+	const int s_lo = table->section[lo];
+	if (s_hi == s_lo && table->start[s_hi] < lo) {
+		// still within the same section
+		return 1;
+	}
+
+	// section 's_hi' is complete, and the sections between remain empty
+	if (*c < config->sec_min[s_hi]) {
+		return 0;
+	}
+	const int s_full = (table->start[s_lo] == lo ? s_lo : s_lo + 1);
+	if (s_full < s_hi && table->required[s_hi] > table->required[s_full]) {
+		return 0;
+	}
+	*c = 0;
+
+	return 1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set up the completion count table of a restricted configuration space
+///
+int RestrictedTable(const restricted_config_t *config, restricted_table_t *table)
+{
+	assert(0 < config->orbs && config->orbs <= (int)(8*sizeof(bitfield_t)));
+	assert(0 <= config->N && config->N <= config->orbs);
+	assert(IntegerSum(config->sec_orbs, config->nsec) == config->orbs);
+
+	table->config = *config;
+
+	int s;
+	int o = 0;
+	table->required[0] = 0;
+	for (s = 0; s < config->nsec; s++)
+	{
+		table->start[s] = o;
+		int i;
+		for (i = 0; i < config->sec_orbs[s]; i++) {
+			table->section[o++] = s;
+		}
+		table->required[s + 1] = table->required[s] + (config->sec_min[s] > 0 ? 1 : 0);
+	}
+
+	const int N = config->N;
+	table->hdim = (config->max_exc < 0 ? 1 : (config->max_exc < N ? config->max_exc : N) + 1);
+	table->count = (int64_t *)calloc((size_t)(config->orbs + 1)*(N + 1)*(N + 1)*table->hdim, sizeof(int64_t));
+	if (table->count == NULL) {
+		return -1;
+	}
+
+	int h;
+	for (h = 0; h < table->hdim; h++) {
+		*RestrictedCount(table, 0, 0, 0, h) = 1;
+	}
+
+	int b;
+	for (b = 1; b <= config->orbs; b++)
+	{
+		int n;
+		for (n = 0; n <= N; n++)
+		{
+			int c;
+			for (c = 0; c <= N; c++)
+			{
+				for (h = 0; h < table->hdim; h++)
+				{
+					int64_t sum = 0;
+					int x;
+					for (x = 0; x < 2; x++)
+					{
+						int nn = n, cc = c, hh = h;
+						if (RestrictedStep(table, b, x, &nn, &cc, &hh)) {
+							sum += *RestrictedCount(table, b - 1, nn, cc, hh);
+						}
+					}
+					*RestrictedCount(table, b, n, c, h) = sum;
+				}
+			}
+		}
+	}
+
+	const int64_t num = *RestrictedCount(table, config->orbs, N, 0, 0);
+	if (num > INT_MAX) {
+		free(table->count);
+		table->count = NULL;
+		return -2;
+	}
+	table->num = (int)num;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a completion count table (free memory)
+///
+void DeleteRestrictedTable(restricted_table_t *table)
+{
+	free(table->count);
+	table->count = NULL;
+	table->num = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Index of the bit pattern 'f' within the numerically ordered restricted space, or -1 if 'f' is not contained
+///
+/// Requires O(N) operations: the unoccupied orbitals between consecutive particles are skipped
+/// in constant time, and each particle contributes the completion count of the corresponding unoccupied orbital.
+///
+int RestrictedRank(const restricted_table_t *table, const bitfield_t f)
+{
+	const restricted_config_t *config = &table->config;
+
+	if (config->orbs < (int)(8*sizeof(bitfield_t)) && (f >> config->orbs) != 0) {
+		return -1;
+	}
+	if (BitCount(f) != config->N) {
+		return -1;
+	}
+
+	fermi_coords_t x[64];
+	FermiDecode(f, x, config->N);
+
+	int64_t rank = 0;
+	int n = config->N, c = 0, h = 0;
+	int L = config->orbs;
+	int k;
+	for (k = config->N - 1; k >= 0; k--)
+	{
+		const int b = x[k];
+		if (!RestrictedSkip(table, L, b + 1, &c, &h)) {
+			return -1;
+		}
+		// all completions with unoccupied orbital 'b' precede 'f'
+		int nn = n, cc = c, hh = h;
+		if (RestrictedStep(table, b + 1, 0, &nn, &cc, &hh)) {
+			rank += *RestrictedCount(table, b, nn, cc, hh);
+		}
+		if (!RestrictedStep(table, b + 1, 1, &n, &c, &h)) {
+			return -1;
+		}
+		L = b;
+	}
+	if (!RestrictedSkip(table, L, 0, &c, &h)) {
+		return -1;
+	}
+
+	return (int)rank;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Depth-first enumeration of the completions of the state (n, c, h) after assigning orbitals b, ..., orbs-1
+///
+static void RestrictedEnumerate(const restricted_table_t *table, const int b, const int n, const int c, const int h, const bitfield_t f, bitfield_t *map, int *pos)
+{
+	if (b == 0)
+	{
+		map[(*pos)++] = f;
+		return;
+	}
+
+	// unoccupied orbital first, for numerical order
+	int x;
+	for (x = 0; x < 2; x++)
+	{
+		int nn = n, cc = c, hh = h;
+		if (RestrictedStep(table, b, x, &nn, &cc, &hh) && *RestrictedCount(table, b - 1, nn, cc, hh) > 0) {
+			RestrictedEnumerate(table, b - 1, nn, cc, hh, f | (((bitfield_t)x) << (b - 1)), map, pos);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Numerically ordered map of the bit patterns of a restricted space
+///
+int RestrictedMap(const restricted_table_t *table, fermi_map_t *fm)
+{
+	fm->num = table->num;
+	fm->map = (bitfield_t *)malloc((table->num > 0 ? table->num : 1) * sizeof(bitfield_t));
+	if (fm->map == NULL) {
+		return -1;
+	}
+
+	int pos = 0;
+	if (table->num > 0) {
+		RestrictedEnumerate(table, table->config.orbs, table->config.N, 0, 0, 0, fm->map, &pos);
+	}
+	assert(pos == table->num);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Rank callback of 'GenerateRDMRow' for the restricted space tabulated by 'table'
+///
+static int RestrictedRankCallback(const void *table, const bitfield_t f)
+{
+	return RestrictedRank((const restricted_table_t *)table, f);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the kernel tensor K for calculating p-body reduced density matrices on restricted spaces
+///
+/// Same conventions as for 'GenerateRDM' (single partition), with the N1- and N2-particle indices referring to
+/// the numerically ordered restricted spaces 'config1' and 'config2', and the p1- and p2-particle indices
+/// to the (unrestricted) lexicographically ordered Slater basis. The work is proportional to the dimension of 'config2'
+/// times the number of p-particle excitations of a single determinant; the targets are ranked in O(N) operations.
+/// The rows are generated in parallel, first to determine their number of entries and then to fill them.
+///
+int GenerateRDMRestricted(const restricted_config_t *config1, const restricted_config_t *config2, const int p1, sparse_array_t *K)
+{
+	assert(config1->orbs == config2->orbs);
+
+	const int orbs = config1->orbs;
+	const int N2 = config2->N;
+	const int p2 = config1->N - N2 + p1;
+	assert(0 <= p1 && p1 <= N2);
+	assert(0 <= p2 && p2 <= orbs - N2 + p1);
+
+	restricted_table_t table1, table2;
+	int status = RestrictedTable(config1, &table1);
+	if (status < 0) {
+		return status;
+	}
+	status = RestrictedTable(config2, &table2);
+	if (status < 0) {
+		DeleteRestrictedTable(&table1);
+		return status;
+	}
+	fermi_map_t map2;
+	status = RestrictedMap(&table2, &map2);
+	if (status < 0) {
+		DeleteRestrictedTable(&table2);
+		DeleteRestrictedTable(&table1);
+		return status;
+	}
+
+	int *offset = (int *)malloc((map2.num + 1) * sizeof(int));
+	if (offset == NULL) {
+		free(map2.map);
+		DeleteRestrictedTable(&table2);
+		DeleteRestrictedTable(&table1);
+		return -1;
+	}
+
+	// number of entries of each row
+	int n;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (n = 0; n < map2.num; n++)
+	{
+		offset[n + 1] = GenerateRDMRow(orbs, map2.map[n], n, p1, p2, RestrictedRankCallback, &table1, NULL, NULL);
+	}
+	offset[0] = 0;
+	for (n = 0; n < map2.num; n++) {
+		offset[n + 1] += offset[n];
+	}
+
+	// create sparse array
+	K->rank = 4;
+	K->dims = (int *)malloc(K->rank * sizeof(int));
+	K->nnz = offset[map2.num];
+	K->val = (double *)malloc((K->nnz > 0 ? K->nnz : 1) * sizeof(double));
+	K->ind = (int *)malloc((K->nnz > 0 ? K->nnz : 1)*K->rank * sizeof(int));
+	if (K->dims == NULL || K->val == NULL || K->ind == NULL)
+	{
+		free(offset);
+		free(map2.map);
+		DeleteRestrictedTable(&table2);
+		DeleteRestrictedTable(&table1);
+		return -1;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for (n = 0; n < map2.num; n++)
+	{
+		const int count = GenerateRDMRow(orbs, map2.map[n], n, p1, p2, RestrictedRankCallback, &table1, &K->ind[4*offset[n]], &K->val[offset[n]]);
+		assert(count == offset[n + 1] - offset[n]);
+		(void)count;
+	}
+
+	// set array dimensions
+	K->dims[0] = Binomial(orbs, p1);
+	K->dims[1] = Binomial(orbs, p2);
+	K->dims[2] = table1.num;
+	K->dims[3] = table2.num;
+
+	// clean up
+	free(offset);
+	free(map2.map);
+	DeleteRestrictedTable(&table2);
+	DeleteRestrictedTable(&table1);
+
+	return 0;
+}
@@ -0,0 +1,223 @@
+/// \file selected_ci.c
+/// \brief Selected configuration interaction: connected determinants and perturbative selection criteria.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "selected_ci.h"
+#include "hamiltonian.h"
+#include "sparse_state.h"
+#include "fermi_map.h"
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+
+void DeleteCICandidates(ci_candidates_t *cand)
+{
+	free(cand->diag);
+	free(cand->coupling);
+	free(cand->dets);
+	cand->diag = NULL;
+	cand->coupling = NULL;
+	cand->dets = NULL;
+	cand->num = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Accumulate the contribution 'v' of an excitation 'T' of a variational determinant,
+/// if 'T' is not contained in the variational space and |v| > eps (heat-bath criterion)
+///
+static inline int AddCandidate(det_hash_table_t *table, const bitfield_t *dets, const int ndets, const bitfield_t T, const double v, const double eps)
+{
+	if (fabs(v) <= eps) {
+		return 0;
+	}
+	if (bsearch(&T, dets, ndets, sizeof(bitfield_t), CompareBitfield) != NULL) {
+		return 0;
+	}
+
+	return DetHashTableAdd(table, T, v);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generate the determinants connected to the variational state sum_n coeffs[n] |dets[n]>
+/// by single and double excitations of the Hamiltonian (see 'HamiltonianCSR'), together with their couplings
+/// to the variational state and diagonal matrix elements, as required for CIPSI-type selection
+/// and Epstein-Nesbet perturbation theory
+///
+/// Only contributions |<T|H|D_n> c_n| > eps are retained (heat-bath criterion); 'dets' must be sorted
+/// in ascending order. The variational determinants are distributed among threads, each accumulating
+/// its connected determinants in a hash table, and the tables are merged afterwards. The excitations are
+/// enumerated directly instead of using excitation graphs, since the connected determinants lie outside
+/// of the variational space.
+///
+int SelectedCICandidates(const integrals_t *ints, const bitfield_t *dets, const double *coeffs, const int ndets, const double eps, ci_candidates_t *cand)
+{
+	const int norb = ints->norb;
+	const int nspin = 2*norb;
+	assert(nspin <= (int)(8*sizeof(bitfield_t)));
+
+	const bitfield_t full = (nspin < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << nspin) : 0) - 1;
+
+	cand->dets = NULL;
+	cand->coupling = NULL;
+	cand->diag = NULL;
+	cand->num = 0;
+
+	det_hash_table_t table;
+	if (CreateDetHashTable(16, &table) < 0) {
+		return -1;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local hash table
+		det_hash_table_t local;
+		int local_status = CreateDetHashTable(1024, &local);
+
+		int n;
+		#pragma omp for schedule(dynamic, 4)
+		for (n = 0; n < ndets; n++)
+		{
+			if (local_status < 0 || coeffs[n] == 0) {
+				continue;
+			}
+
+			const bitfield_t D = dets[n];
+			const int N = BitCount(D);
+
+			fermi_coords_t occ[64], vir[64];
+			FermiDecode(D, occ, N);
+			FermiDecode(full & ~D, vir, nspin - N);
+
+			// single excitations
+			int ki, ka;
+			for (ki = 0; ki < N && local_status == 0; ki++)
+			{
+				const int i = occ[ki];
+				for (ka = 0; ka < nspin - N; ka++)
+				{
+					const int a = vir[ka];
+					if ((a < norb) != (i < norb)) {
+						continue;
+					}
+					const bitfield_t T = D ^ (((bitfield_t)1) << i) ^ (((bitfield_t)1) << a);
+					if (AddCandidate(&local, dets, ndets, T, SlaterCondon(ints, T, D) * coeffs[n], eps) < 0) {
+						local_status = -1;
+						break;
+					}
+				}
+			}
+
+			// double excitations
+			int kj, kb;
+			for (ki = 0; ki < N && local_status == 0; ki++)
+			{
+				const int i = occ[ki];
+				for (kj = ki + 1; kj < N && local_status == 0; kj++)
+				{
+					const int j = occ[kj];
+					for (ka = 0; ka < nspin - N && local_status == 0; ka++)
+					{
+						const int a = vir[ka];
+						for (kb = ka + 1; kb < nspin - N; kb++)
+						{
+							const int b = vir[kb];
+							// spin conservation
+							if ((a >= norb) + (b >= norb) != (i >= norb) + (j >= norb)) {
+								continue;
+							}
+							const bitfield_t T = D ^ (((bitfield_t)1) << i) ^ (((bitfield_t)1) << j) ^ (((bitfield_t)1) << a) ^ (((bitfield_t)1) << b);
+							if (AddCandidate(&local, dets, ndets, T, SlaterCondon(ints, T, D) * coeffs[n], eps) < 0) {
+								local_status = -1;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// merge into global table
+		#pragma omp critical
+		{
+			if (local_status < 0) {
+				status = -1;
+			}
+			int k;
+			for (k = 0; k < local.size && status == 0; k++)
+			{
+				if (local.used[k]) {
+					status = DetHashTableAdd(&table, local.entries[k].key, local.entries[k].val);
+				}
+			}
+		}
+
+		DeleteDetHashTable(&local);
+	}
+
+	if (status < 0) {
+		DeleteDetHashTable(&table);
+		return -1;
+	}
+
+	// collect and sort entries
+	det_entry_t *list = (det_entry_t *)malloc((table.count > 0 ? table.count : 1) * sizeof(det_entry_t));
+	if (list == NULL) {
+		DeleteDetHashTable(&table);
+		return -1;
+	}
+	int count = 0;
+	int k;
+	for (k = 0; k < table.size; k++)
+	{
+		if (table.used[k]) {
+			list[count++] = table.entries[k];
+		}
+	}
+	DeleteDetHashTable(&table);
+
+	qsort(list, count, sizeof(det_entry_t), CompareBitfield);
+
+	cand->num = count;
+	cand->dets     = (bitfield_t *)malloc((count > 0 ? count : 1) * sizeof(bitfield_t));
+	cand->coupling = (double     *)malloc((count > 0 ? count : 1) * sizeof(double));
+	cand->diag     = (double     *)malloc((count > 0 ? count : 1) * sizeof(double));
+	if (cand->dets == NULL || cand->coupling == NULL || cand->diag == NULL) {
+		free(list);
+		DeleteCICandidates(cand);
+		return -1;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 64)
+	for (k = 0; k < count; k++)
+	{
+		cand->dets[k]     = list[k].key;
+		cand->coupling[k] = creal(list[k].val);
+		cand->diag[k]     = SlaterCondon(ints, list[k].key, list[k].key);
+	}
+
+	free(list);
+
+	return 0;
+}
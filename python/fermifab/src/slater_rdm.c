@@ -0,0 +1,342 @@
+/// \file slater_rdm.c
+/// \brief Calculate reduced density matrices of outer products of Slater determinants.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "slater_rdm.h"
+#include "fermi_map.h"
+#include "util.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-particle reduced density matrix (RDM) of the outer product of two
+/// fermionic Slater determinants 's1' and 's2': |s1Xs2|
+///
+/// The RDM is the signed sum of the terms |a1[k]Xa2[k]|, where 'a1[k]' and 'a2[k]' are the bit-encoded
+/// p1- and p2-particle Slater determinants annihilated from 's1' and 's2', respectively.
+/// Orbitals in which 's1' and 's2' differ ("force" mask) must be annihilated, and the remaining
+/// annihilated orbitals are chosen among the common orbitals ("choice" mask).
+///
+/// Encoding: orbital 0 corresponds to LSB (least significant bit)
+///
+/// \param s1       first Slater determinant
+/// \param s2       second Slater determinant
+/// \param p1       number of to-be annihilated particles in 's1'
+/// \param a1       annihilated states in 's1' (output, can be NULL for counting the terms only)
+/// \param a2       annihilated states in 's2' (output, can be NULL)
+/// \param sign     corresponding signs (output, can be NULL)
+/// \return number of terms
+///
+int SlaterRDM(const bitfield_t s1, const bitfield_t s2, const int p1, bitfield_t *a1, bitfield_t *a2, int *sign)
+{
+	// number of particles in 's1'
+	const int n1 = BitCount(s1);
+	if (p1 > n1) {
+		return 0;
+	}
+
+	// "force" mask
+	const bitfield_t fmask = s1 ^ s2;
+
+	// states which must be annihilated in 's1'
+	const bitfield_t sforce1 = fmask & s1;
+
+	// number of to-be annihilated "choice" states in 's1'
+	const int nchoice1 = p1 - BitCount(sforce1);
+	if (nchoice1 < 0) {
+		return 0;
+	}
+
+	// "choice" mask
+	const bitfield_t cmask = s1 & s2;
+
+	// number of "choice" orbitals
+	const int kchoice = BitCount(cmask);
+	assert(nchoice1 <= kchoice);
+
+	// number of terms
+	const int nterms = Binomial(kchoice, nchoice1);
+	if (a1 == NULL) {
+		return nterms;
+	}
+
+	const bitfield_t sforce2 = fmask & s2;
+
+	// annihilation sign masks
+	const bitfield_t amask1 = AnnihilSignMask(s1) << 1;
+	const bitfield_t amask2 = AnnihilSignMask(s2) << 1;
+
+	const int factor = ReversePermSign(p1)*ReversePermSign(BitCount(s2)-n1+p1)*
+		IntegerParitySign(amask1 & sforce1)*IntegerParitySign(amask2 & sforce2);
+
+	// iterate Fermi map for "choice" orbitals
+	bitfield_t t = (nchoice1 < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << nchoice1) : 0) - 1;
+	int n;
+	for (n = 0; n < nterms; n++)
+	{
+		const bitfield_t schoice = BitDistribute(t, cmask);
+
+		a1[n] = sforce1 + schoice;
+		if (a2   != NULL) { a2[n]   = sforce2 + schoice; }
+		if (sign != NULL) { sign[n] = factor*IntegerParitySign(amask1 & schoice)*IntegerParitySign(amask2 & schoice); }
+
+		// next Fermi state (not defined for t = 0)
+		if (n + 1 < nterms) {
+			t = NextFermi(t);
+		}
+	}
+
+	return nterms;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Accumulate the p-particle reduced density matrices of the weighted outer products
+/// sum_k w[k] |s1[k]Xs2[k]| into the dense matrix 'G'
+///
+/// The entry G[i,j] receives the contributions of the terms |iXj|, with i and j the lexicographically ordered
+/// p1- and p2-particle Slater basis states, such that for |psi> = sum_n c_n |D_n>, the pairs (D_n, D_m)
+/// with weights c_n conj(c_m) result in G[i,j] = <psi | a_j^dagger a_i psi> (same convention as 'GenerateRDM').
+/// Pairs whose particle numbers are incompatible with 'p1' and 'p2' do not contribute.
+/// The cost scales with the number of pairs times the number of terms per pair.
+/// Output matrix 'G' must have dimension 'Binomial(orbs, p1) x Binomial(orbs, p2)' and is not reset.
+///
+int SlaterPairRDM(const int orbs, const int p1, const int p2, const int npairs, const bitfield_t *s1, const bitfield_t *s2, const double complex *w, double complex *G)
+{
+	assert(0 <= p1 && p1 <= orbs && 0 <= p2 && p2 <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	const int dim2 = Binomial(orbs, p2);
+
+	// maximum number of terms per pair
+	const int maxterms = Binomial(orbs, p1);
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		bitfield_t *a1 = (bitfield_t *)malloc(maxterms * sizeof(bitfield_t));
+		bitfield_t *a2 = (bitfield_t *)malloc(maxterms * sizeof(bitfield_t));
+		int *sign = (int *)malloc(maxterms * sizeof(int));
+		if (a1 == NULL || a2 == NULL || sign == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int k;
+			#pragma omp for schedule(dynamic, 64)
+			for (k = 0; k < npairs; k++)
+			{
+				if (w[k] == 0 || BitCount(s2[k]) - BitCount(s1[k]) != p2 - p1) {
+					continue;
+				}
+
+				const int nterms = SlaterRDM(s1[k], s2[k], p1, a1, a2, sign);
+				int n;
+				for (n = 0; n < nterms; n++)
+				{
+					const double complex v = sign[n] * w[k];
+					double *g = (double *)&G[(size_t)FermiIndex(a1[n])*dim2 + FermiIndex(a2[n])];
+					#pragma omp atomic
+					g[0] += creal(v);
+					#pragma omp atomic
+					g[1] += cimag(v);
+				}
+			}
+		}
+
+		free(sign);
+		free(a2);
+		free(a1);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Entry of a sparse reduced density matrix
+///
+typedef struct
+{
+	int i;                  //!< row index
+	int j;                  //!< column index
+	double complex val;     //!< value
+}
+rdm_entry_t;
+
+
+static int CompareRDMEntry(const void *x, const void *y)
+{
+	const rdm_entry_t *a = (const rdm_entry_t *)x;
+	const rdm_entry_t *b = (const rdm_entry_t *)y;
+
+	if (a->i != b->i) {
+		return (a->i < b->i ? -1 : 1);
+	}
+	if (a->j != b->j) {
+		return (a->j < b->j ? -1 : 1);
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-particle reduced density matrices of the weighted outer products
+/// sum_k w[k] |s1[k]Xs2[k]| as sparse matrix
+///
+/// Same conventions as for 'SlaterPairRDM'. The terms of all pairs are first counted and then
+/// generated in parallel; finally, entries with the same index are combined.
+/// The memory requirements scale with the number of terms instead of the matrix dimension.
+///
+int SlaterPairRDMSparse(const int orbs, const int p1, const int p2, const int npairs, const bitfield_t *s1, const bitfield_t *s2, const double complex *w, sparse_complex_array_t *G)
+{
+	assert(0 <= p1 && p1 <= orbs && 0 <= p2 && p2 <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	int k;
+
+	// count terms per pair; the prefix sums can exceed the 'int' range
+	int64_t *offset = (int64_t *)malloc((npairs + 1) * sizeof(int64_t));
+	if (offset == NULL) {
+		return -1;
+	}
+	offset[0] = 0;
+	for (k = 0; k < npairs; k++)
+	{
+		int nterms = 0;
+		if (w[k] != 0 && BitCount(s2[k]) - BitCount(s1[k]) == p2 - p1) {
+			nterms = SlaterRDM(s1[k], s2[k], p1, NULL, NULL, NULL);
+		}
+		offset[k + 1] = offset[k] + nterms;
+	}
+	const int64_t nterms_total = offset[npairs];
+
+	// maximum number of terms per pair
+	const int maxterms = Binomial(orbs, p1);
+
+	rdm_entry_t *entries = (rdm_entry_t *)malloc((nterms_total > 0 ? (size_t)nterms_total : 1) * sizeof(rdm_entry_t));
+	if (entries == NULL) {
+		free(offset);
+		return -1;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		bitfield_t *a1 = (bitfield_t *)malloc(maxterms * sizeof(bitfield_t));
+		bitfield_t *a2 = (bitfield_t *)malloc(maxterms * sizeof(bitfield_t));
+		int *sign = (int *)malloc(maxterms * sizeof(int));
+		if (a1 == NULL || a2 == NULL || sign == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			#pragma omp for schedule(dynamic, 64)
+			for (k = 0; k < npairs; k++)
+			{
+				if (offset[k + 1] == offset[k]) {
+					continue;
+				}
+
+				const int nterms = SlaterRDM(s1[k], s2[k], p1, a1, a2, sign);
+				assert(nterms == offset[k + 1] - offset[k]);
+				int n;
+				for (n = 0; n < nterms; n++)
+				{
+					rdm_entry_t *e = &entries[offset[k] + n];
+					e->i = FermiIndex(a1[n]);
+					e->j = FermiIndex(a2[n]);
+					e->val = sign[n] * w[k];
+				}
+			}
+		}
+
+		free(sign);
+		free(a2);
+		free(a1);
+	}
+
+	free(offset);
+
+	if (status < 0) {
+		free(entries);
+		return -1;
+	}
+
+	// combine entries with the same index
+	qsort(entries, nterms_total, sizeof(rdm_entry_t), CompareRDMEntry);
+	int64_t nnz = 0;
+	int64_t n;
+	for (n = 0; n < nterms_total; n++)
+	{
+		if (nnz > 0 && entries[nnz-1].i == entries[n].i && entries[nnz-1].j == entries[n].j) {
+			entries[nnz-1].val += entries[n].val;
+		}
+		else {
+			entries[nnz++] = entries[n];
+		}
+	}
+
+	if (nnz > INT_MAX) {
+		free(entries);
+		return -1;
+	}
+
+	G->rank = 2;
+	G->dims = (int *)malloc(2 * sizeof(int));
+	G->val  = (double complex *)malloc((nnz > 0 ? (size_t)nnz : 1) * sizeof(double complex));
+	G->ind  = (int *)malloc((nnz > 0 ? 2*(size_t)nnz : 1) * sizeof(int));
+	if (G->dims == NULL || G->val == NULL || G->ind == NULL) {
+		free(entries);
+		return -1;
+	}
+	G->dims[0] = Binomial(orbs, p1);
+	G->dims[1] = Binomial(orbs, p2);
+
+	// skip entries which cancelled exactly
+	G->nnz = 0;
+	for (n = 0; n < nnz; n++)
+	{
+		if (entries[n].val != 0)
+		{
+			G->val[G->nnz] = entries[n].val;
+			G->ind[2*G->nnz    ] = entries[n].i;
+			G->ind[2*G->nnz + 1] = entries[n].j;
+			G->nnz++;
+		}
+	}
+
+	free(entries);
+
+	return 0;
+}
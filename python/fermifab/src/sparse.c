@@ -45,6 +45,20 @@ void DeleteSparseComplexArray(sparse_complex_array_t *a)
 }
 
 
+void DeleteSparseCSR(sparse_csr_t *a)
+{
+	if (a->rowptr != NULL) {  free(a->rowptr); }
+	if (a->col    != NULL) {  free(a->col);    }
+	if (a->val    != NULL) {  free(a->val);    }
+
+	a->rowptr = NULL;
+	a->col    = NULL;
+	a->val    = NULL;
+	a->nrows  = 0;
+	a->ncols  = 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Convert tensor index to data offset (row major ordering)
@@ -0,0 +1,374 @@
+/// \file sparse_state.c
+/// \brief Sparse fermionic states stored as lists of bit-encoded Slater determinants and coefficients.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "sparse_state.h"
+#include "fermi_map.h"
+#include "util.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+void DeleteSparseFermiState(sparse_fermi_state_t *psi)
+{
+	if (psi->dets   != NULL) { free(psi->dets);   }
+	if (psi->coeffs != NULL) { free(psi->coeffs); }
+
+	psi->dets   = NULL;
+	psi->coeffs = NULL;
+	psi->nnz    = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the bit-encoded Slater determinant 'f' in the sparse state by binary search;
+/// return -1 if 'f' is not contained in the state
+///
+int SparseStateFind(const sparse_fermi_state_t *psi, const bitfield_t f)
+{
+	int lo = 0;
+	int hi = psi->nnz - 1;
+	while (lo <= hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		if (psi->dets[mid] < f) {
+			lo = mid + 1;
+		}
+		else if (psi->dets[mid] > f) {
+			hi = mid - 1;
+		}
+		else {
+			return mid;
+		}
+	}
+
+	return -1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Advance the index list 'idx' of length 'p' to the next p-subset of { 0, ..., n - 1 };
+/// return false if the last subset has been reached
+///
+static inline bool NextSubset(int *idx, const int p, const int n)
+{
+	int k = p - 1;
+	while (k >= 0 && idx[k] == n - p + k) {
+		k--;
+	}
+	if (k < 0) {
+		return false;
+	}
+
+	idx[k]++;
+	int j;
+	for (j = k + 1; j < p; j++)
+	{
+		idx[j] = idx[j-1] + 1;
+	}
+
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Bit pattern of the orbitals 'pos[idx[0]], ..., pos[idx[p-1]]'
+///
+static inline bitfield_t SubsetBits(const fermi_coords_t *pos, const int *idx, const int p)
+{
+	bitfield_t f = 0;
+	int k;
+	for (k = 0; k < p; k++)
+	{
+		f |= ((bitfield_t)1) << pos[idx[k]];
+	}
+
+	return f;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-body reduced density matrix of a sparse state, without constructing the dense state vector
+///
+/// Same conventions as for the kernels generated by 'GenerateRDM': G[i,j] = <psi | a_j^dagger a_i psi>
+/// for the lexicographically ordered p-particle Slater basis states i and j.
+/// For each stored determinant, all annihilation and creation strings are applied,
+/// and the resulting determinant is looked up by binary search. Output matrix 'G' must have dimension
+/// 'Binomial(orbs, p) x Binomial(orbs, p)'.
+///
+int SparseStateRDM(const int orbs, const int p, const sparse_fermi_state_t *psi, double complex *G)
+{
+	assert(0 <= p && p <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	const int dim = Binomial(orbs, p);
+	memset(G, 0, (size_t)dim*dim * sizeof(double complex));
+
+	const bitfield_t full = (orbs < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << orbs) : 0) - 1;
+
+	int n;
+	#pragma omp parallel for schedule(dynamic)
+	for (n = 0; n < psi->nnz; n++)
+	{
+		const bitfield_t D = psi->dets[n];
+		const int N = BitCount(D);
+		if (N < p || psi->coeffs[n] == 0) {
+			continue;
+		}
+
+		fermi_coords_t occ[64];
+		fermi_coords_t vac[64];
+		int ia[64];
+		int ib[64];
+		FermiDecode(D, occ, N);
+
+		int k;
+		for (k = 0; k < p; k++) {
+			ia[k] = k;
+		}
+		do
+		{
+			// annihilate 'A' from 'D'
+			const bitfield_t A = SubsetBits(occ, ia, p);
+			const int sa = AnnihilSign(D, A);
+			const bitfield_t R = D - A;
+			const int i = FermiIndex(A);
+
+			// available orbitals for creation
+			const int nvac = orbs - N + p;
+			FermiDecode(full & ~R, vac, nvac);
+
+			for (k = 0; k < p; k++) {
+				ib[k] = k;
+			}
+			do
+			{
+				// create 'B'
+				const bitfield_t B = SubsetBits(vac, ib, p);
+				const int m = SparseStateFind(psi, R | B);
+				if (m < 0) {
+					continue;
+				}
+				const int sb = AnnihilSign(R | B, B);
+				const int j = FermiIndex(B);
+
+				const double complex v = (sa*sb) * conj(psi->coeffs[m]) * psi->coeffs[n];
+				double *g = (double *)&G[(size_t)i*dim + j];
+				#pragma omp atomic
+				g[0] += creal(v);
+				#pragma omp atomic
+				g[1] += cimag(v);
+			}
+			while (NextSubset(ib, p, nvac));
+		}
+		while (NextSubset(ia, p, N));
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create an empty hash table with 'size' entries (a power of 2)
+///
+int CreateDetHashTable(const int size, det_hash_table_t *table)
+{
+	table->size = size;
+	table->count = 0;
+	table->entries = (det_entry_t *)malloc(size * sizeof(det_entry_t));
+	table->used = (bool *)calloc(size, sizeof(bool));
+	if (table->entries == NULL || table->used == NULL) {
+		return -1;
+	}
+
+	return 0;
+}
+
+
+void DeleteDetHashTable(det_hash_table_t *table)
+{
+	free(table->used);
+	free(table->entries);
+	table->size = 0;
+	table->count = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Add 'val' to the coefficient of 'key', inserting the key if not present yet
+///
+int DetHashTableAdd(det_hash_table_t *table, const bitfield_t key, const double complex val)
+{
+	// keep load factor below 1/2
+	if (2*(table->count + 1) > table->size)
+	{
+		det_hash_table_t larger;
+		if (CreateDetHashTable(2*table->size, &larger) < 0) {
+			return -1;
+		}
+		int i;
+		for (i = 0; i < table->size; i++)
+		{
+			if (table->used[i]) {
+				DetHashTableAdd(&larger, table->entries[i].key, table->entries[i].val);
+			}
+		}
+		DeleteDetHashTable(table);
+		*table = larger;
+	}
+
+	int h = HashBitfield(key, table->size);
+	while (table->used[h])
+	{
+		if (table->entries[h].key == key)
+		{
+			table->entries[h].val += val;
+			return 0;
+		}
+		h = (h + 1) & (table->size - 1);
+	}
+	table->used[h] = true;
+	table->entries[h].key = key;
+	table->entries[h].val = val;
+	table->count++;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply the N-body operator generated from the p-body operator 'h' to a sparse state, i.e.,
+/// out = sum_{ij} h[i,j] a_i^dagger a_j psi (same convention as 'p2N')
+///
+/// The resulting coefficients are accumulated in a hash table and finally sorted;
+/// 'h' must have dimension 'Binomial(orbs, p) x Binomial(orbs, p)'.
+///
+int SparseStateApply(const int orbs, const int p, const double complex *h, const sparse_fermi_state_t *psi, sparse_fermi_state_t *out)
+{
+	assert(0 <= p && p <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	const int dim = Binomial(orbs, p);
+	const bitfield_t full = (orbs < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << orbs) : 0) - 1;
+
+	det_hash_table_t table;
+	int size = 16;
+	while (size < 4*psi->nnz) {
+		size *= 2;
+	}
+	if (CreateDetHashTable(size, &table) < 0) {
+		return -1;
+	}
+
+	int n;
+	for (n = 0; n < psi->nnz; n++)
+	{
+		const bitfield_t D = psi->dets[n];
+		const int N = BitCount(D);
+		if (N < p || psi->coeffs[n] == 0) {
+			continue;
+		}
+
+		fermi_coords_t occ[64];
+		fermi_coords_t vac[64];
+		int ia[64];
+		int ib[64];
+		FermiDecode(D, occ, N);
+
+		int k;
+		for (k = 0; k < p; k++) {
+			ia[k] = k;
+		}
+		do
+		{
+			// annihilate 'A' from 'D'
+			const bitfield_t A = SubsetBits(occ, ia, p);
+			const int sa = AnnihilSign(D, A);
+			const bitfield_t R = D - A;
+			const int j = FermiIndex(A);
+
+			// available orbitals for creation
+			const int nvac = orbs - N + p;
+			FermiDecode(full & ~R, vac, nvac);
+
+			for (k = 0; k < p; k++) {
+				ib[k] = k;
+			}
+			do
+			{
+				// create 'B'
+				const bitfield_t B = SubsetBits(vac, ib, p);
+				const int i = FermiIndex(B);
+				if (h[(size_t)i*dim + j] == 0) {
+					continue;
+				}
+				const int sb = AnnihilSign(R | B, B);
+
+				if (DetHashTableAdd(&table, R | B, (sa*sb) * h[(size_t)i*dim + j] * psi->coeffs[n]) < 0) {
+					DeleteDetHashTable(&table);
+					return -1;
+				}
+			}
+			while (NextSubset(ib, p, nvac));
+		}
+		while (NextSubset(ia, p, N));
+	}
+
+	// collect non-zero entries
+	det_entry_t *list = (det_entry_t *)malloc((table.count > 0 ? table.count : 1) * sizeof(det_entry_t));
+	if (list == NULL) {
+		DeleteDetHashTable(&table);
+		return -1;
+	}
+	int count = 0;
+	int i;
+	for (i = 0; i < table.size; i++)
+	{
+		if (table.used[i] && table.entries[i].val != 0) {
+			list[count++] = table.entries[i];
+		}
+	}
+	DeleteDetHashTable(&table);
+
+	qsort(list, count, sizeof(det_entry_t), CompareBitfield);
+
+	out->nnz = count;
+	out->dets   = (bitfield_t *)malloc((count > 0 ? count : 1) * sizeof(bitfield_t));
+	out->coeffs = (double complex *)malloc((count > 0 ? count : 1) * sizeof(double complex));
+	if (out->dets == NULL || out->coeffs == NULL) {
+		free(list);
+		return -1;
+	}
+	for (i = 0; i < count; i++)
+	{
+		out->dets[i]   = list[i].key;
+		out->coeffs[i] = list[i].val;
+	}
+
+	free(list);
+
+	return 0;
+}
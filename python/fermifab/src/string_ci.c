@@ -0,0 +1,630 @@
+/// \file string_ci.c
+/// \brief Alpha/beta string-factorized configuration interaction (CI) spaces.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+//  The two-partition configuration { norb, norb } with particle numbers { Na, Nb } (spin-up orbitals
+//  followed by spin-down orbitals) is the product of alpha and beta strings; the coefficient
+//  of the basis state with string indices (ia, ib) is stored at 'ib*numa + ia', consistent with 'FermiMap'.
+//  Spin-conserving operators act on the coefficient matrix C[ib, ia] by single excitations of
+//  its columns (alpha) or rows (beta), which are precomputed once per string (Knowles-Handy scheme).
+//  Since a beta excitation moves a creation and an annihilation operator across the alpha string,
+//  its sign does not depend on the alpha string.
+//
+
+#include "string_ci.h"
+#include "fermi_map.h"
+#include "util.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+#include <cblas.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Enumerate the N-particle strings on 'norb' orbitals and their single excitations
+///
+int StringExcitationList(const int norb, const int N, string_excitation_list_t *list)
+{
+	assert(0 <= N && N <= norb && norb <= (int)(8*sizeof(bitfield_t)));
+
+	list->norb = norb;
+	list->N    = N;
+	list->num  = Binomial(norb, N);
+	list->nexc = N*(norb - N + 1);
+
+	const size_t size = (size_t)list->num * list->nexc;
+
+	list->strings = (bitfield_t *)malloc(list->num * sizeof(bitfield_t));
+	list->target  = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+	list->sign    = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+	list->pair    = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+	if (list->strings == NULL || list->target == NULL || list->sign == NULL || list->pair == NULL) {
+		DeleteStringExcitationList(list);
+		return -1;
+	}
+
+	// lexicographically ordered strings
+	bitfield_t f = (N < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << N) : 0) - 1;
+	int k;
+	for (k = 0; k < list->num; k++)
+	{
+		list->strings[k] = f;
+		// next Fermi state (not defined for f = 0)
+		if (k + 1 < list->num) {
+			f = NextFermi(f);
+		}
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (k = 0; k < list->num; k++)
+	{
+		const bitfield_t s = list->strings[k];
+		int e = 0;
+		int j;
+		for (j = 0; j < norb; j++)
+		{
+			const bitfield_t bj = ((bitfield_t)1) << j;
+			if ((s & bj) == 0) {
+				continue;
+			}
+			const bitfield_t R = s - bj;
+			const int sj = AnnihilSign(s, bj);
+
+			int i;
+			for (i = 0; i < norb; i++)
+			{
+				const bitfield_t bi = ((bitfield_t)1) << i;
+				if ((R & bi) != 0) {
+					continue;
+				}
+				const bitfield_t T = R | bi;
+				const size_t n = (size_t)k*list->nexc + e;
+				list->target[n] = FermiIndex(T);
+				list->sign[n]   = sj * AnnihilSign(T, bi);
+				list->pair[n]   = i*norb + j;
+				e++;
+			}
+		}
+		assert(e == list->nexc);
+	}
+
+	return 0;
+}
+
+
+void DeleteStringExcitationList(string_excitation_list_t *list)
+{
+	free(list->pair);
+	free(list->sign);
+	free(list->target);
+	free(list->strings);
+
+	list->pair    = NULL;
+	list->sign    = NULL;
+	list->target  = NULL;
+	list->strings = NULL;
+	list->num  = 0;
+	list->nexc = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Build the alpha and beta string excitation lists of the CI space with 'Na' alpha and 'Nb' beta electrons
+///
+int StringCISpace(const int norb, const int Na, const int Nb, string_ci_space_t *space)
+{
+	if (StringExcitationList(norb, Na, &space->alpha) < 0) {
+		return -1;
+	}
+	if (StringExcitationList(norb, Nb, &space->beta) < 0) {
+		DeleteStringExcitationList(&space->alpha);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+void DeleteStringCISpace(string_ci_space_t *space)
+{
+	DeleteStringExcitationList(&space->beta);
+	DeleteStringExcitationList(&space->alpha);
+}
+
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the spin-resolved one-body reduced density matrices of the state with coefficients 'C'
+///
+/// Same conventions as for 'GenerateRDM': Ga[i,j] = <psi | a_{j,alpha}^dagger a_{i,alpha} psi>, and likewise for 'Gb'.
+/// 'C' must have dimension 'Binomial(norb, Nb) x Binomial(norb, Na)' for the CI space 'space', and 'Ga' and 'Gb' dimension 'norb x norb'.
+///
+int StringCIRDM1(const string_ci_space_t *space, const double complex *C, double complex *Ga, double complex *Gb)
+{
+	const string_excitation_list_t *la = &space->alpha;
+	const string_excitation_list_t *lb = &space->beta;
+
+	const int norb = la->norb;
+	const int numa = la->num;
+	const int numb = lb->num;
+
+	memset(Ga, 0, (size_t)norb*norb * sizeof(double complex));
+	memset(Gb, 0, (size_t)norb*norb * sizeof(double complex));
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local partial results
+		double complex *Gta = (double complex *)calloc((size_t)norb*norb, sizeof(double complex));
+		double complex *Gtb = (double complex *)calloc((size_t)norb*norb, sizeof(double complex));
+		if (Gta == NULL || Gtb == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			// alpha: contributions s conj(C[ib,L]) C[ib,T] within each row
+			int ib;
+			#pragma omp for schedule(dynamic)
+			for (ib = 0; ib < numb; ib++)
+			{
+				const double complex *Crow = &C[(size_t)ib*numa];
+				int L;
+				for (L = 0; L < numa; L++)
+				{
+					if (Crow[L] == 0) {
+						continue;
+					}
+					const double complex cL = conj(Crow[L]);
+					int e;
+					for (e = 0; e < la->nexc; e++)
+					{
+						const size_t n = (size_t)L*la->nexc + e;
+						Gta[la->pair[n]] += la->sign[n] * cL * Crow[la->target[n]];
+					}
+				}
+			}
+
+			// beta: contributions s <C[L,:], C[T,:]> of complete rows
+			int L;
+			#pragma omp for schedule(dynamic)
+			for (L = 0; L < numb; L++)
+			{
+				const double complex *CL = &C[(size_t)L*numa];
+				int e;
+				for (e = 0; e < lb->nexc; e++)
+				{
+					const size_t n = (size_t)L*lb->nexc + e;
+					const double complex *CT = &C[(size_t)lb->target[n]*numa];
+					double complex v = 0;
+					int ia;
+					for (ia = 0; ia < numa; ia++)
+					{
+						v += conj(CL[ia]) * CT[ia];
+					}
+					Gtb[lb->pair[n]] += lb->sign[n] * v;
+				}
+			}
+
+			#pragma omp critical
+			{
+				int k;
+				for (k = 0; k < norb*norb; k++) {
+					Ga[k] += Gta[k];
+					Gb[k] += Gtb[k];
+				}
+			}
+		}
+
+		free(Gtb);
+		free(Gta);
+	}
+
+	return status;
+}
+
+
+/// number of entries (norb^2 times number of CI coefficients) of the excited vectors formed at a time in 'StringCISigma' and 'StringCIRDM2'
+static const size_t excited_block_size = (size_t)1 << 20;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the excited vectors E_kl C of the alpha and beta strings restricted to the
+/// CI coefficients of the beta strings 'ib0 <= ib < ib1'
+///
+/// The output is stored coefficient-major, i.e., Da[(m - m0)*norb^2 + (k*norb + l)] with m0 = ib0*numa,
+/// such that each block can be passed to BLAS directly. 'Da' and 'Db' may coincide, in which case
+/// the sum of the alpha and beta excited vectors is formed.
+///
+static void StringCIExcitedBlock(const string_excitation_list_t *la, const string_excitation_list_t *lb, const int ib0, const int ib1,
+	const double complex *C, double complex *Da, double complex *Db)
+{
+	const int norb = la->norb;
+	const int numa = la->num;
+	const int n2 = norb*norb;
+
+	memset(Da, 0, (size_t)(ib1 - ib0)*numa*n2 * sizeof(double complex));
+	if (Db != Da) {
+		memset(Db, 0, (size_t)(ib1 - ib0)*numa*n2 * sizeof(double complex));
+	}
+
+	int ib;
+	#pragma omp parallel for schedule(dynamic)
+	for (ib = ib0; ib < ib1; ib++)
+	{
+		const double complex *Crow = &C[(size_t)ib*numa];
+		double complex *da = &Da[(size_t)(ib - ib0)*numa*n2];
+		double complex *db = &Db[(size_t)(ib - ib0)*numa*n2];
+		int e;
+
+		// alpha excitations, in "gather" form using that E_kl |K> = s |L> if and only if E_lk |L> = s |K>,
+		// such that each thread writes to distinct entries
+		int L;
+		for (L = 0; L < numa; L++)
+		{
+			for (e = 0; e < la->nexc; e++)
+			{
+				const size_t n = (size_t)L*la->nexc + e;
+				const int i = la->pair[n] / norb;
+				const int j = la->pair[n] % norb;
+				da[(size_t)L*n2 + j*norb + i] += la->sign[n] * Crow[la->target[n]];
+			}
+		}
+
+		// beta excitations
+		for (e = 0; e < lb->nexc; e++)
+		{
+			const size_t n = (size_t)ib*lb->nexc + e;
+			const int i = lb->pair[n] / norb;
+			const int j = lb->pair[n] % norb;
+			const double complex *Ctrg = &C[(size_t)lb->target[n]*numa];
+			const int s = lb->sign[n];
+			int ia;
+			for (ia = 0; ia < numa; ia++)
+			{
+				db[(size_t)ia*n2 + j*norb + i] += s * Ctrg[ia];
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of beta strings per block, such that a block of excited vectors
+/// holds at most about 'excited_block_size' entries (but at least one beta string)
+///
+static int StringCIBlockRows(const string_ci_space_t *space)
+{
+	const size_t rowsize = (size_t)space->alpha.num * space->alpha.norb * space->alpha.norb;
+	int nbrows = (int)(excited_block_size / rowsize);
+	if (nbrows < 1) { nbrows = 1; }
+	if (nbrows > space->beta.num) { nbrows = space->beta.num; }
+	return nbrows;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply the spin-free Hamiltonian with one-body integrals 'h' and two-body integrals 'g'
+/// to the state with coefficients 'C'
+///
+/// The Hamiltonian reads H = sum_{ij} h[i,j] E_ij + 1/2 sum_{ijkl} g[i,j,k,l] (E_ij E_kl - delta_jk E_il),
+/// with E_ij = sum_sigma a_{i,sigma}^dagger a_{j,sigma} and 'g' in chemists' notation (ij|kl).
+/// Following Knowles and Handy, the excited vectors D[kl] = E_kl C are contracted with the integrals
+/// to F[ij] = h'[i,j] C + 1/2 sum_{kl} g[i,j,k,l] D[kl], with h'[i,j] = h[i,j] - 1/2 sum_k g[i,k,k,j],
+/// and finally sigma = sum_{ij} E_ij F[ij]. The intermediates are formed for blocks of (at most about
+/// 'excited_block_size') CI coefficients at a time, and the contraction with 'g' is a 'zgemm' per block.
+/// 'h' must have dimension 'norb x norb', 'g' dimension 'norb x norb x norb x norb', and 'C' and 'sigma'
+/// dimension 'Binomial(norb, Nb) x Binomial(norb, Na)' for the CI space 'space'.
+///
+int StringCISigma(const string_ci_space_t *space, const double complex *h, const double complex *g, const double complex *C, double complex *sigma)
+{
+	const string_excitation_list_t *la = &space->alpha;
+	const string_excitation_list_t *lb = &space->beta;
+
+	const int norb = la->norb;
+	const int numa = la->num;
+	const int numb = lb->num;
+	const int n2 = norb*norb;
+
+	const int nbrows = StringCIBlockRows(space);
+	const size_t rowsize = (size_t)numa * n2;
+
+	// excited vectors D and contracted vectors F for the current block
+	double complex *D = (double complex *)malloc((size_t)nbrows * rowsize * sizeof(double complex));
+	double complex *F = (double complex *)malloc((size_t)nbrows * rowsize * sizeof(double complex));
+	// modified one-body integrals
+	double complex *hmod = (double complex *)malloc(n2 * sizeof(double complex));
+	if (D == NULL || F == NULL || hmod == NULL) {
+		free(hmod);
+		free(F);
+		free(D);
+		return -1;
+	}
+
+	int i, j, k;
+	for (i = 0; i < norb; i++)
+	{
+		for (j = 0; j < norb; j++)
+		{
+			double complex t = h[i*norb + j];
+			for (k = 0; k < norb; k++)
+			{
+				t -= 0.5 * g[(size_t)(i*norb + k)*n2 + k*norb + j];
+			}
+			hmod[i*norb + j] = t;
+		}
+	}
+
+	memset(sigma, 0, (size_t)numa*numb * sizeof(double complex));
+
+	const double complex one  = 1;
+	const double complex half = 0.5;
+	int ib0;
+	for (ib0 = 0; ib0 < numb; ib0 += nbrows)
+	{
+		const int ib1 = (ib0 + nbrows < numb ? ib0 + nbrows : numb);
+		const int nc = (ib1 - ib0)*numa;
+		const double complex *Cblk = &C[(size_t)ib0*numa];
+
+		// sum of the alpha and beta excited vectors
+		StringCIExcitedBlock(la, lb, ib0, ib1, C, D, D);
+
+		// F = h' C + 1/2 D g^T, with 'D' and 'F' of dimension 'nc x norb^2'
+		int m;
+		#pragma omp parallel for schedule(static)
+		for (m = 0; m < nc; m++)
+		{
+			int u;
+			for (u = 0; u < n2; u++) {
+				F[(size_t)m*n2 + u] = hmod[u] * Cblk[m];
+			}
+		}
+		cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nc, n2, n2, &half, D, n2, g, n2, &one, F, n2);
+
+		// sigma += sum_{ij} E_ij F[ij], again in gather form;
+		// alpha excitations stay within the rows of the block
+		int ib;
+		#pragma omp parallel for schedule(dynamic)
+		for (ib = ib0; ib < ib1; ib++)
+		{
+			const double complex *Fblk = &F[(size_t)(ib - ib0)*rowsize];
+			int L;
+			for (L = 0; L < numa; L++)
+			{
+				double complex t = 0;
+				int e;
+				for (e = 0; e < la->nexc; e++)
+				{
+					const size_t n = (size_t)L*la->nexc + e;
+					const int a = la->pair[n] / norb;
+					const int b = la->pair[n] % norb;
+					t += la->sign[n] * Fblk[(size_t)la->target[n]*n2 + b*norb + a];
+				}
+				sigma[(size_t)ib*numa + L] += t;
+			}
+		}
+		// beta excitations of all rows with target in the block
+		int L;
+		#pragma omp parallel for schedule(dynamic)
+		for (L = 0; L < numb; L++)
+		{
+			double complex *srow = &sigma[(size_t)L*numa];
+			int e;
+			for (e = 0; e < lb->nexc; e++)
+			{
+				const size_t n = (size_t)L*lb->nexc + e;
+				const int T = lb->target[n];
+				if (T < ib0 || T >= ib1) {
+					continue;
+				}
+				const int a = lb->pair[n] / norb;
+				const int b = lb->pair[n] % norb;
+				const double complex *Fblk = &F[(size_t)(T - ib0)*rowsize + b*norb + a];
+				const int s = lb->sign[n];
+				int ia;
+				for (ia = 0; ia < numa; ia++)
+				{
+					srow[ia] += s * Fblk[(size_t)ia*n2];
+				}
+			}
+		}
+	}
+
+	free(hmod);
+	free(F);
+	free(D);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the spin-resolved two-body reduced density matrices and the spin-summed two-body
+/// reduced density matrix of the state with coefficients 'C'
+///
+/// Same conventions as for 'GenerateRDM', G[I,J] = <psi | a_J^dagger a_I psi> for two-particle states I and J:
+/// 'Gaa' and 'Gbb' refer to pairs of alpha or beta orbitals i < k in lexicographic order (index k(k-1)/2 + i),
+/// with dimension 'Binomial(norb, 2) x Binomial(norb, 2)', and 'Gab' to pairs of an alpha orbital 'i' and
+/// a beta orbital 'k' (index k*norb + i), with dimension 'norb^2 x norb^2'. These are the non-zero blocks
+/// of the two-body reduced density matrix of the 2*norb spin orbitals. The spin-summed two-body reduced
+/// density matrix P[i,j,k,l] = <E_ij E_kl - delta_jk E_il> (dimension 'norb^4', optional, i.e., can be NULL)
+/// yields the energy of the spin-free Hamiltonian in 'StringCISigma' as sum_{ij} h[i,j] <E_ij> + 1/2 sum_{ijkl} g[i,j,k,l] P[i,j,k,l].
+/// The one-body reduced density matrices 'Ga' and 'Gb' (as for 'StringCIRDM1', optional, i.e., can be NULL)
+/// are obtained in the same pass.
+///
+/// All quantities are obtained from the overlaps <E_ji C | E_kl C> of the excited vectors, which are
+/// formed for blocks of (at most about 'excited_block_size') CI coefficients at a time and
+/// accumulated via 'zherk' and 'zgemm'.
+/// 'C' must have dimension 'Binomial(norb, Nb) x Binomial(norb, Na)' for the CI space 'space'.
+///
+int StringCIRDM2(const string_ci_space_t *space, const double complex *C, double complex *Ga, double complex *Gb, double complex *Gaa, double complex *Gab, double complex *Gbb, double complex *P)
+{
+	const string_excitation_list_t *la = &space->alpha;
+	const string_excitation_list_t *lb = &space->beta;
+
+	const int norb = la->norb;
+	const int numa = la->num;
+	const int numb = lb->num;
+	const int n2 = norb*norb;
+
+	const int nbrows = StringCIBlockRows(space);
+	const size_t rowsize = (size_t)numa * n2;
+
+	// excited vectors of the alpha and beta strings for the current block
+	double complex *Da = (double complex *)malloc((size_t)nbrows * rowsize * sizeof(double complex));
+	double complex *Db = (double complex *)malloc((size_t)nbrows * rowsize * sizeof(double complex));
+	// overlaps M[u,v] = <D[u] | D[v]> for the spin combinations aa, ab, bb,
+	// and expectation values e[u] = <C | D[u]>
+	double complex *Maa = (double complex *)calloc((size_t)n2*n2, sizeof(double complex));
+	double complex *Mab = (double complex *)calloc((size_t)n2*n2, sizeof(double complex));
+	double complex *Mbb = (double complex *)calloc((size_t)n2*n2, sizeof(double complex));
+	double complex *ea  = (double complex *)calloc(n2, sizeof(double complex));
+	double complex *eb  = (double complex *)calloc(n2, sizeof(double complex));
+	if (Da == NULL || Db == NULL || Maa == NULL || Mab == NULL || Mbb == NULL || ea == NULL || eb == NULL) {
+		free(eb);
+		free(ea);
+		free(Mbb);
+		free(Mab);
+		free(Maa);
+		free(Db);
+		free(Da);
+		return -1;
+	}
+
+	const double complex one = 1;
+	int ib0;
+	for (ib0 = 0; ib0 < numb; ib0 += nbrows)
+	{
+		const int ib1 = (ib0 + nbrows < numb ? ib0 + nbrows : numb);
+		const int nc = (ib1 - ib0)*numa;
+		const double complex *Cblk = &C[(size_t)ib0*numa];
+
+		StringCIExcitedBlock(la, lb, ib0, ib1, C, Da, Db);
+
+		// M += D^H D, with 'D' of dimension 'nc x norb^2'; 'Maa' and 'Mbb' only in the upper triangle
+		cblas_zherk(CblasRowMajor, CblasUpper, CblasConjTrans, n2, nc, 1.0, Da, n2, 1.0, Maa, n2);
+		cblas_zherk(CblasRowMajor, CblasUpper, CblasConjTrans, n2, nc, 1.0, Db, n2, 1.0, Mbb, n2);
+		cblas_zgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, n2, n2, nc, &one, Da, n2, Db, n2, &one, Mab, n2);
+
+		// conj(e) += D^H C
+		cblas_zgemv(CblasRowMajor, CblasConjTrans, nc, n2, &one, Da, n2, Cblk, 1, &one, ea, 1);
+		cblas_zgemv(CblasRowMajor, CblasConjTrans, nc, n2, &one, Db, n2, Cblk, 1, &one, eb, 1);
+	}
+
+	free(Db);
+	free(Da);
+
+	// complete the Hermitian overlap matrices
+	int u, v;
+	for (u = 0; u < n2; u++)
+	{
+		ea[u] = conj(ea[u]);
+		eb[u] = conj(eb[u]);
+		for (v = 0; v < u; v++)
+		{
+			Maa[(size_t)u*n2 + v] = conj(Maa[(size_t)v*n2 + u]);
+			Mbb[(size_t)u*n2 + v] = conj(Mbb[(size_t)v*n2 + u]);
+		}
+	}
+
+	// one-body: G[l,k] = <a_k^dagger a_l> = e[k*norb + l]
+	int i, j, k, l;
+	for (k = 0; k < norb; k++)
+	{
+		for (l = 0; l < norb; l++)
+		{
+			if (Ga != NULL) { Ga[l*norb + k] = ea[k*norb + l]; }
+			if (Gb != NULL) { Gb[l*norb + k] = eb[k*norb + l]; }
+		}
+	}
+
+	const int np = norb*(norb - 1)/2;
+
+	// same-spin blocks: G[(i,k), (j,l)] = <a_j^dagger a_l^dagger a_k a_i> = <E_ij C | E_lk C> - delta_il <E_jk>
+	for (k = 0; k < norb; k++)
+	{
+		for (i = 0; i < k; i++)
+		{
+			const int ik = k*(k - 1)/2 + i;
+			for (l = 0; l < norb; l++)
+			{
+				for (j = 0; j < l; j++)
+				{
+					const int jl = l*(l - 1)/2 + j;
+					const size_t u = (size_t)(i*norb + j)*n2 + l*norb + k;
+					Gaa[(size_t)ik*np + jl] = Maa[u] - (i == l ? ea[j*norb + k] : 0);
+					Gbb[(size_t)ik*np + jl] = Mbb[u] - (i == l ? eb[j*norb + k] : 0);
+				}
+			}
+		}
+	}
+
+	// opposite-spin block: G[(i,k), (j,l)] = <E_ij C | E_lk C> with alpha orbitals i, j and beta orbitals k, l
+	for (k = 0; k < norb; k++)
+	{
+		for (i = 0; i < norb; i++)
+		{
+			for (l = 0; l < norb; l++)
+			{
+				for (j = 0; j < norb; j++)
+				{
+					Gab[(size_t)(k*norb + i)*n2 + l*norb + j] = Mab[(size_t)(i*norb + j)*n2 + l*norb + k];
+				}
+			}
+		}
+	}
+
+	// spin-summed: P[i,j,k,l] = sum_{sigma,tau} <E_ji C | E_kl C> - delta_jk <E_il>
+	if (P != NULL)
+	{
+		for (i = 0; i < norb; i++)
+		{
+			for (j = 0; j < norb; j++)
+			{
+				const int u = j*norb + i;
+				for (k = 0; k < norb; k++)
+				{
+					for (l = 0; l < norb; l++)
+					{
+						const int v = k*norb + l;
+						P[(size_t)(i*norb + j)*n2 + v] = Maa[(size_t)u*n2 + v] + Mbb[(size_t)u*n2 + v]
+							+ Mab[(size_t)u*n2 + v] + conj(Mab[(size_t)v*n2 + u])
+							- (j == k ? ea[i*norb + l] + eb[i*norb + l] : 0);
+					}
+				}
+			}
+		}
+	}
+
+	free(eb);
+	free(ea);
+	free(Mbb);
+	free(Mab);
+	free(Maa);
+
+	return 0;
+}
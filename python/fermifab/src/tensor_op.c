@@ -23,6 +23,7 @@
 #include <lapacke.h>
 #include <stdbool.h>
 #include <math.h>
+#include <float.h>
 #include <malloc.h>
 #include <memory.h>
 #include <assert.h>
@@ -114,77 +115,258 @@ double complex ComplexDet(const int n, double complex *A)
 }
 
 
+/// minimum reciprocal condition number (1-norm) of 'A' for evaluating the minors in the hole picture; the minors obtained
+/// via Jacobi's identity then agree with the direct evaluation up to a relative error of about DBL_EPSILON / rcond <= 2e-12
+static const double hole_rcond_min = 1e-4;
+
+
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Calculate the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H for an operator A: H -> H
+/// \brief Compute the inverse and determinant of a real matrix by LU decomposition;
+/// returns 1 (without inverse) if 'A' is singular or its reciprocal condition number is below 'hole_rcond_min'
 ///
-int TensorOp(const int orbs, const int N, const double *A, sparse_array_t *AN)
+static int InverseDet(const int n, const double *A, double *Ainv, double *det)
 {
+	memcpy(Ainv, A, n*n * sizeof(double));
+
+	lapack_int *ipiv = (lapack_int *)malloc(n * sizeof(lapack_int));
+	if (ipiv == NULL) { return -1; }
+
+	const double anorm = LAPACKE_dlange(LAPACK_ROW_MAJOR, '1', n, n, Ainv, n);
+	lapack_int info = LAPACKE_dgetrf(LAPACK_ROW_MAJOR, n, n, Ainv, n, ipiv);
+	double rcond = 0;
+	if (info == 0) {
+		info = LAPACKE_dgecon(LAPACK_ROW_MAJOR, '1', n, Ainv, n, anorm, &rcond);
+	}
+	if (info != 0 || !(rcond >= hole_rcond_min))
+	{
+		free(ipiv);
+		return 1;
+	}
+
+	double d = 1;
 	int i;
-	int status;
+	for (i = 0; i < n; i++)
+	{
+		// 'ipiv' uses 1-based indexing!
+		d *= (ipiv[i] != i + 1 ? -Ainv[i*(n + 1)] : Ainv[i*(n + 1)]);
+	}
+	(*det) = d;
 
-	// create Fermi map
-	fermi_map_t baseMap;
+	info = LAPACKE_dgetri(LAPACK_ROW_MAJOR, n, Ainv, n, ipiv);
+
+	// clean up
+	free(ipiv);
+
+	return (info == 0 ? 0 : 1);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the inverse and determinant of a complex matrix by LU decomposition;
+/// returns 1 (without inverse) if 'A' is singular or its reciprocal condition number is below 'hole_rcond_min'
+///
+static int InverseDetComplex(const int n, const double complex *A, double complex *Ainv, double complex *det)
+{
+	memcpy(Ainv, A, n*n * sizeof(double complex));
+
+	lapack_int *ipiv = (lapack_int *)malloc(n * sizeof(lapack_int));
+	if (ipiv == NULL) { return -1; }
+
+	const double anorm = LAPACKE_zlange(LAPACK_ROW_MAJOR, '1', n, n, Ainv, n);
+	lapack_int info = LAPACKE_zgetrf(LAPACK_ROW_MAJOR, n, n, Ainv, n, ipiv);
+	double rcond = 0;
+	if (info == 0) {
+		info = LAPACKE_zgecon(LAPACK_ROW_MAJOR, '1', n, Ainv, n, anorm, &rcond);
+	}
+	if (info != 0 || !(rcond >= hole_rcond_min))
 	{
-		fermi_config_t config;
-		config.orbs = (int []){orbs};
-		config.N    = (int []){N};
-		config.nc   = 1;
-		status = FermiMap(&config, &baseMap);
-		if (status < 0) { return status; }
+		free(ipiv);
+		return 1;
+	}
+
+	double complex d = 1;
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		// 'ipiv' uses 1-based indexing!
+		d *= (ipiv[i] != i + 1 ? -Ainv[i*(n + 1)] : Ainv[i*(n + 1)]);
+	}
+	(*det) = d;
+
+	info = LAPACKE_zgetri(LAPACK_ROW_MAJOR, n, Ainv, n, ipiv);
+
+	// clean up
+	free(ipiv);
+
+	return (info == 0 ? 0 : 1);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the tensor product (A otimes A ... otimes A) restricted to the Slater determinants in 'baseMap'
+///
+/// The entries are the N x N minors det(A[x, y]) for the occupied orbitals x and y. For N > orbs/2 and well-conditioned 'A'
+/// (see 'hole_rcond_min'), these are evaluated in the hole picture as the smaller (orbs - N) x (orbs - N) complementary minors
+/// of the inverse, using Jacobi's identity det(A[x, y]) = (-1)^(sum x + sum y) det(A) det(A^{-1}[~y, ~x]) with the holes ~x and ~y,
+/// with a relative error of about DBL_EPSILON / rcond(A) <= 2e-12. Otherwise, the minors are evaluated directly.
+///
+static int TensorOpMap(const int orbs, const int N, const fermi_map_t *baseMap, const double *A, sparse_array_t *AN)
+{
+	int i;
+
+	const bitfield_t full = (orbs < (int)(8*sizeof(bitfield_t)) ? ((bitfield_t)1) << orbs : 0) - 1;
+
+	// bit patterns of the non-zero entries of each row and column of 'A', for short-circuit zero determinant detection
+	bitfield_t *rowmask = (bitfield_t *)calloc(orbs, sizeof(bitfield_t));
+	bitfield_t *colmask = (bitfield_t *)calloc(orbs, sizeof(bitfield_t));
+	if (rowmask == NULL || colmask == NULL)
+	{
+		free(colmask);
+		free(rowmask);
+		return -1;
+	}
+	for (i = 0; i < orbs; i++)
+	{
+		int j;
+		for (j = 0; j < orbs; j++)
+		{
+			if (A[orbs*i + j] != 0)
+			{
+				rowmask[i] |= ((bitfield_t)1) << j;
+				colmask[j] |= ((bitfield_t)1) << i;
+			}
+		}
 	}
 
-	fermi_coords_t *x = (fermi_coords_t *)malloc(N*sizeof(fermi_coords_t));
-	fermi_coords_t *y = (fermi_coords_t *)malloc(N*sizeof(fermi_coords_t));
+	// hole picture: inverse and determinant of 'A'
+	double *Ainv = NULL;
+	double detA = 0;
+	if (2*N > orbs)
+	{
+		Ainv = (double *)malloc(orbs*orbs * sizeof(double));
+		int status = (Ainv != NULL ? InverseDet(orbs, A, Ainv, &detA) : -1);
+		if (status < 0)
+		{
+			free(Ainv);
+			free(colmask);
+			free(rowmask);
+			return status;
+		}
+		if (status > 0)
+		{
+			// fall back to direct evaluation
+			free(Ainv);
+			Ainv = NULL;
+		}
+	}
+	// size of the minors
+	const int m = (Ainv != NULL ? orbs - N : N);
+
+	fermi_coords_t *x = (fermi_coords_t *)malloc(m*sizeof(fermi_coords_t));
+	fermi_coords_t *y = (fermi_coords_t *)malloc(m*sizeof(fermi_coords_t));
 
 	// temporary matrix for determinant calculation
-	double *T = (double *)malloc(N*N * sizeof(double));
-	if (T == NULL) { return -1; }
+	double *T = (double *)malloc(m*m * sizeof(double));
+	if ((x == NULL || y == NULL || T == NULL) && m > 0)
+	{
+		free(T);
+		free(y);
+		free(x);
+		free(Ainv);
+		free(colmask);
+		free(rowmask);
+		return -1;
+	}
 
 	// setup to-be returned sparse matrix
 	AN->rank = 2;
 	AN->dims = (int *)malloc(AN->rank * sizeof(int));
-	AN->dims[0] = baseMap.num;
-	AN->dims[1] = baseMap.num;
+	AN->dims[0] = baseMap->num;
+	AN->dims[1] = baseMap->num;
 	AN->nnz = 0;
 	int nzmax = 16;
 	AN->val = (double *)malloc(nzmax * sizeof(double));     if (AN->val == NULL) { return -1; }
 	AN->ind = (int *)malloc(AN->rank*nzmax * sizeof(int));  if (AN->ind == NULL) { return -1; }
 
-	for (i = 0; i < baseMap.num; i++)
+	for (i = 0; i < baseMap->num; i++)
 	{
-		FermiDecode(baseMap.map[i], x, N);
+		const bitfield_t f = baseMap->map[i];
+
+		// orbitals of the rows of 'T', and parity of their sum in the hole picture
+		int sx = 0;
+		if (Ainv == NULL)
+		{
+			FermiDecode(f, x, N);
+		}
+		else
+		{
+			FermiDecode(full & ~f, x, m);
+			int k;
+			for (k = 0; k < m; k++) {
+				sx += x[k];
+			}
+		}
 
 		int j;
-		for (j = 0; j < baseMap.num; j++)
+		for (j = 0; j < baseMap->num; j++)
 		{
-			FermiDecode(baseMap.map[j], y, N);
+			const bitfield_t g = baseMap->map[j];
 
-			// short-circuit zero determinant detection
+			// short-circuit zero determinant detection: zero row or column of A[x, y]
 			bool zero_det = false;
+			bitfield_t h = f;
+			while (h && !zero_det)
+			{
+				const bitfield_t t = LastBit(h);
+				zero_det = ((rowmask[BitCount(t - 1)] & g) == 0);
+				h -= t;
+			}
+			h = g;
+			while (h && !zero_det)
+			{
+				const bitfield_t t = LastBit(h);
+				zero_det = ((colmask[BitCount(t - 1)] & f) == 0);
+				h -= t;
+			}
+			if (zero_det) {
+				continue;
+			}
 
-			// copy entries in 'A' indexed by x and y to 'T'
-			int k;
-			for (k = 0; k < N; k++)
+			double d;
+			if (Ainv == NULL)
 			{
-				bool zero_row = true;
-				int l;
-				for (l = 0; l < N; l++)
+				// copy entries in 'A' indexed by x and y to 'T'
+				FermiDecode(g, y, N);
+				int k;
+				for (k = 0; k < N; k++)
 				{
-					T[N*k + l] = A[orbs*x[k] + y[l]];
-					if (T[N*k + l] != 0) {
-						zero_row = false;
+					int l;
+					for (l = 0; l < N; l++) {
+						T[N*k + l] = A[orbs*x[k] + y[l]];
 					}
 				}
-				zero_det |= zero_row;
+				d = Det(N, T);
 			}
-
-			// short-circuit zero determinant detection
-			if (zero_det) {
-				continue;
+			else
+			{
+				// copy entries in the inverse indexed by the holes of 'g' and 'f' to 'T'
+				FermiDecode(full & ~g, y, m);
+				int sy = 0;
+				int k;
+				for (k = 0; k < m; k++)
+				{
+					sy += y[k];
+					int l;
+					for (l = 0; l < m; l++) {
+						T[m*k + l] = Ainv[orbs*y[k] + x[l]];
+					}
+				}
+				// sum x + sum y has the same parity as the sum over the holes
+				d = ((sx + sy) & 1 ? -detA : detA) * (m > 0 ? Det(m, T) : 1);
 			}
-
-			double d = Det(N, T);
 			if (d == 0) {
 				continue;
 			}
@@ -210,7 +392,9 @@ int TensorOp(const int orbs, const int N, const double *A, sparse_array_t *AN)
 	free(T);
 	free(y);
 	free(x);
-	free(baseMap.map);
+	free(Ainv);
+	free(colmask);
+	free(rowmask);
 
 	return 0;
 }
@@ -220,9 +404,8 @@ int TensorOp(const int orbs, const int N, const double *A, sparse_array_t *AN)
 ///
 /// \brief Calculate the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H for an operator A: H -> H
 ///
-int TensorOpComplex(const int orbs, const int N, const double complex *A, sparse_complex_array_t *AN)
+int TensorOp(const int orbs, const int N, const double *A, sparse_array_t *AN)
 {
-	int i;
 	int status;
 
 	// create Fermi map
@@ -236,57 +419,208 @@ int TensorOpComplex(const int orbs, const int N, const double complex *A, sparse
 		if (status < 0) { return status; }
 	}
 
-	fermi_coords_t *x = (fermi_coords_t *)malloc(N*sizeof(fermi_coords_t));
-	fermi_coords_t *y = (fermi_coords_t *)malloc(N*sizeof(fermi_coords_t));
+	status = TensorOpMap(orbs, N, &baseMap, A, AN);
+
+	// clean up
+	free(baseMap.map);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the block of the tensor product (A otimes A ... otimes A) on the Slater determinants with symmetry
+/// label 'target' (see 'FermiMapSymmetry'), for an operator A commuting with the symmetry, i.e., A[i,j] == 0
+/// for orbitals i and j with different labels
+///
+int TensorOpSymmetry(const int orbs, const int N, const double *A, const fermi_symmetry_t *sym, const int target, sparse_array_t *AN)
+{
+	int status;
+
+	// create Fermi map of the symmetry sector
+	fermi_map_t baseMap;
+	{
+		fermi_config_t config;
+		config.orbs = (int []){orbs};
+		config.N    = (int []){N};
+		config.nc   = 1;
+		status = FermiMapSymmetry(&config, sym, target, &baseMap);
+		if (status < 0) { return status; }
+	}
+
+	status = TensorOpMap(orbs, N, &baseMap, A, AN);
+
+	// clean up
+	free(baseMap.map);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the tensor product (A otimes A ... otimes A) restricted to the Slater determinants in 'baseMap'
+///
+/// The entries are the N x N minors det(A[x, y]) for the occupied orbitals x and y. For N > orbs/2 and well-conditioned 'A'
+/// (see 'hole_rcond_min'), these are evaluated in the hole picture as the smaller (orbs - N) x (orbs - N) complementary minors
+/// of the inverse, using Jacobi's identity det(A[x, y]) = (-1)^(sum x + sum y) det(A) det(A^{-1}[~y, ~x]) with the holes ~x and ~y,
+/// with a relative error of about DBL_EPSILON / rcond(A) <= 2e-12. Otherwise, the minors are evaluated directly.
+///
+static int TensorOpMapComplex(const int orbs, const int N, const fermi_map_t *baseMap, const double complex *A, sparse_complex_array_t *AN)
+{
+	int i;
+
+	const bitfield_t full = (orbs < (int)(8*sizeof(bitfield_t)) ? ((bitfield_t)1) << orbs : 0) - 1;
+
+	// bit patterns of the non-zero entries of each row and column of 'A', for short-circuit zero determinant detection
+	bitfield_t *rowmask = (bitfield_t *)calloc(orbs, sizeof(bitfield_t));
+	bitfield_t *colmask = (bitfield_t *)calloc(orbs, sizeof(bitfield_t));
+	if (rowmask == NULL || colmask == NULL)
+	{
+		free(colmask);
+		free(rowmask);
+		return -1;
+	}
+	for (i = 0; i < orbs; i++)
+	{
+		int j;
+		for (j = 0; j < orbs; j++)
+		{
+			if (A[orbs*i + j] != 0)
+			{
+				rowmask[i] |= ((bitfield_t)1) << j;
+				colmask[j] |= ((bitfield_t)1) << i;
+			}
+		}
+	}
+
+	// hole picture: inverse and determinant of 'A'
+	double complex *Ainv = NULL;
+	double complex detA = 0;
+	if (2*N > orbs)
+	{
+		Ainv = (double complex *)malloc(orbs*orbs * sizeof(double complex));
+		int status = (Ainv != NULL ? InverseDetComplex(orbs, A, Ainv, &detA) : -1);
+		if (status < 0)
+		{
+			free(Ainv);
+			free(colmask);
+			free(rowmask);
+			return status;
+		}
+		if (status > 0)
+		{
+			// fall back to direct evaluation
+			free(Ainv);
+			Ainv = NULL;
+		}
+	}
+	// size of the minors
+	const int m = (Ainv != NULL ? orbs - N : N);
+
+	fermi_coords_t *x = (fermi_coords_t *)malloc(m*sizeof(fermi_coords_t));
+	fermi_coords_t *y = (fermi_coords_t *)malloc(m*sizeof(fermi_coords_t));
 
 	// temporary matrix for determinant calculation
-	double complex *T = (double complex *)malloc(N*N * sizeof(double complex));
-	if (T == NULL) { return -1; }
+	double complex *T = (double complex *)malloc(m*m * sizeof(double complex));
+	if ((x == NULL || y == NULL || T == NULL) && m > 0)
+	{
+		free(T);
+		free(y);
+		free(x);
+		free(Ainv);
+		free(colmask);
+		free(rowmask);
+		return -1;
+	}
 
 	// setup to-be returned sparse matrix
 	AN->rank = 2;
 	AN->dims = (int *)malloc(AN->rank * sizeof(int));
-	AN->dims[0] = baseMap.num;
-	AN->dims[1] = baseMap.num;
+	AN->dims[0] = baseMap->num;
+	AN->dims[1] = baseMap->num;
 	AN->nnz = 0;
 	int nzmax = 16;
 	AN->val = (double complex *)malloc(nzmax * sizeof(double complex));  if (AN->val == NULL) { return -1; }
 	AN->ind = (int *)malloc(AN->rank*nzmax * sizeof(int));               if (AN->ind == NULL) { return -1; }
 
-	for (i = 0; i < baseMap.num; i++)
+	for (i = 0; i < baseMap->num; i++)
 	{
-		FermiDecode(baseMap.map[i], x, N);
+		const bitfield_t f = baseMap->map[i];
+
+		// orbitals of the rows of 'T', and parity of their sum in the hole picture
+		int sx = 0;
+		if (Ainv == NULL)
+		{
+			FermiDecode(f, x, N);
+		}
+		else
+		{
+			FermiDecode(full & ~f, x, m);
+			int k;
+			for (k = 0; k < m; k++) {
+				sx += x[k];
+			}
+		}
 
 		int j;
-		for (j = 0; j < baseMap.num; j++)
+		for (j = 0; j < baseMap->num; j++)
 		{
-			FermiDecode(baseMap.map[j], y, N);
+			const bitfield_t g = baseMap->map[j];
 
-			// short-circuit zero determinant detection
+			// short-circuit zero determinant detection: zero row or column of A[x, y]
 			bool zero_det = false;
+			bitfield_t h = f;
+			while (h && !zero_det)
+			{
+				const bitfield_t t = LastBit(h);
+				zero_det = ((rowmask[BitCount(t - 1)] & g) == 0);
+				h -= t;
+			}
+			h = g;
+			while (h && !zero_det)
+			{
+				const bitfield_t t = LastBit(h);
+				zero_det = ((colmask[BitCount(t - 1)] & f) == 0);
+				h -= t;
+			}
+			if (zero_det) {
+				continue;
+			}
 
-			// copy entries in 'A' indexed by x and y to 'T'
-			int k;
-			for (k = 0; k < N; k++)
+			double complex d;
+			if (Ainv == NULL)
 			{
-				bool zero_row = true;
-				int l;
-				for (l = 0; l < N; l++)
+				// copy entries in 'A' indexed by x and y to 'T'
+				FermiDecode(g, y, N);
+				int k;
+				for (k = 0; k < N; k++)
 				{
-					T[N*k + l] = A[orbs*x[k] + y[l]];
-					if (T[N*k + l] != 0) {
-						zero_row = false;
+					int l;
+					for (l = 0; l < N; l++) {
+						T[N*k + l] = A[orbs*x[k] + y[l]];
 					}
 				}
-				zero_det |= zero_row;
+				d = ComplexDet(N, T);
 			}
-
-			// short-circuit zero determinant detection
-			if (zero_det) {
-				continue;
+			else
+			{
+				// copy entries in the inverse indexed by the holes of 'g' and 'f' to 'T'
+				FermiDecode(full & ~g, y, m);
+				int sy = 0;
+				int k;
+				for (k = 0; k < m; k++)
+				{
+					sy += y[k];
+					int l;
+					for (l = 0; l < m; l++) {
+						T[m*k + l] = Ainv[orbs*y[k] + x[l]];
+					}
+				}
+				// sum x + sum y has the same parity as the sum over the holes
+				d = ((sx + sy) & 1 ? -detA : detA) * (m > 0 ? ComplexDet(m, T) : 1);
 			}
-
-			double complex d = ComplexDet(N, T);
 			if (d == 0) {
 				continue;
 			}
@@ -312,7 +646,868 @@ int TensorOpComplex(const int orbs, const int N, const double complex *A, sparse
 	free(T);
 	free(y);
 	free(x);
-	free(baseMap.map);
+	free(Ainv);
+	free(colmask);
+	free(rowmask);
 
 	return 0;
 }
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H for an operator A: H -> H
+///
+int TensorOpComplex(const int orbs, const int N, const double complex *A, sparse_complex_array_t *AN)
+{
+	int status;
+
+	// create Fermi map
+	fermi_map_t baseMap;
+	{
+		fermi_config_t config;
+		config.orbs = (int []){orbs};
+		config.N    = (int []){N};
+		config.nc   = 1;
+		status = FermiMap(&config, &baseMap);
+		if (status < 0) { return status; }
+	}
+
+	status = TensorOpMapComplex(orbs, N, &baseMap, A, AN);
+
+	// clean up
+	free(baseMap.map);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the block of the tensor product (A otimes A ... otimes A) on the Slater determinants with symmetry
+/// label 'target' (see 'FermiMapSymmetry'), for an operator A commuting with the symmetry, i.e., A[i,j] == 0
+/// for orbitals i and j with different labels
+///
+int TensorOpSymmetryComplex(const int orbs, const int N, const double complex *A, const fermi_symmetry_t *sym, const int target, sparse_complex_array_t *AN)
+{
+	int status;
+
+	// create Fermi map of the symmetry sector
+	fermi_map_t baseMap;
+	{
+		fermi_config_t config;
+		config.orbs = (int []){orbs};
+		config.N    = (int []){N};
+		config.nc   = 1;
+		status = FermiMapSymmetry(&config, sym, target, &baseMap);
+		if (status < 0) { return status; }
+	}
+
+	status = TensorOpMapComplex(orbs, N, &baseMap, A, AN);
+
+	// clean up
+	free(baseMap.map);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Workspace for the recursive principal minor computation
+///
+typedef struct
+{
+	double *S;          //!< Schur complements for each recursion level, each of dimension 'orbs x orbs'
+	double *T;          //!< temporary matrix for determinant calculation
+	double tol;         //!< pivot threshold below which the determinants are computed with pivoting
+	int orbs;           //!< number of orbitals
+}
+minor_workspace_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Principal minors of the Schur complement 'S' (leading dimension 'orbs') restricted to subsets of
+/// { 0, ..., m - 1 } with 'r' elements, scaled by 'pivprod' and stored in lexicographical order
+///
+/// The largest element of a subset is eliminated first, such that all subsets sharing their largest elements
+/// reuse the corresponding partial LU factorization.
+///
+static void PrincipalMinors(const minor_workspace_t *ws, const int level, const int m, const int r, const double pivprod, double *d, int *index)
+{
+	const int orbs = ws->orbs;
+	const double *S = &ws->S[level*orbs*orbs];
+
+	int c;
+	for (c = r - 1; c < m; c++)
+	{
+		const double pivot = S[c*orbs + c];
+
+		if (r == 1)
+		{
+			d[(*index)++] = pivprod * pivot;
+			continue;
+		}
+
+		if (fabs(pivot) <= ws->tol)
+		{
+			// small pivot: compute determinants of the current Schur complement with pivoting
+			const int num = Binomial(c, r - 1);
+			bitfield_t f = (((bitfield_t)1) << (r - 1)) - 1;
+			int i;
+			for (i = 0; i < num; i++)
+			{
+				fermi_coords_t x[64];
+				FermiDecode(f | (((bitfield_t)1) << c), x, r);
+				int k, l;
+				for (k = 0; k < r; k++)
+				{
+					for (l = 0; l < r; l++)
+					{
+						ws->T[r*k + l] = S[orbs*x[k] + x[l]];
+					}
+				}
+				d[(*index)++] = pivprod * Det(r, ws->T);
+				f = NextFermi(f);
+			}
+			continue;
+		}
+
+		if (r == 2)
+		{
+			// only the diagonal of the next Schur complement is required
+			int i;
+			for (i = 0; i < c; i++)
+			{
+				d[(*index)++] = pivprod * (pivot*S[i*orbs + i] - S[i*orbs + c]*S[c*orbs + i]);
+			}
+			continue;
+		}
+
+		// Schur complement after eliminating 'c'
+		double *Snext = &ws->S[(level + 1)*orbs*orbs];
+		int i, j;
+		for (i = 0; i < c; i++)
+		{
+			const double s = S[i*orbs + c] / pivot;
+			for (j = 0; j < c; j++)
+			{
+				Snext[i*orbs + j] = S[i*orbs + j] - s*S[c*orbs + j];
+			}
+		}
+
+		PrincipalMinors(ws, level + 1, c, r - 1, pivprod * pivot, d, index);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the diagonal of the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H,
+/// i.e., the principal N x N minors of A, in the lexicographical ordering of the Slater basis
+///
+/// Subsets sharing their largest orbitals reuse the partial LU factorization (Schur complement),
+/// and the minors for the smallest orbital are obtained in O(1) each. Output vector 'd' must have length Binomial(orbs, N).
+///
+int TensorOpDiag(const int orbs, const int N, const double *A, double *d)
+{
+	assert(0 <= N && N <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	if (N == 0)
+	{
+		d[0] = 1;
+		return 0;
+	}
+
+	minor_workspace_t ws;
+	ws.orbs = orbs;
+	ws.S = (double *)malloc(N*orbs*orbs * sizeof(double));  if (ws.S == NULL) { return -1; }
+	ws.T = (double *)malloc(N*N * sizeof(double));          if (ws.T == NULL) { free(ws.S); return -1; }
+	memcpy(ws.S, A, orbs*orbs * sizeof(double));
+
+	// pivot threshold relative to largest matrix entry
+	double amax = 0;
+	int i;
+	for (i = 0; i < orbs*orbs; i++)
+	{
+		amax = fmax(amax, fabs(A[i]));
+	}
+	ws.tol = sqrt(DBL_EPSILON) * amax;
+
+	int index = 0;
+	PrincipalMinors(&ws, 0, orbs, N, 1, d, &index);
+	assert(index == Binomial(orbs, N));
+
+	// clean up
+	free(ws.T);
+	free(ws.S);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Workspace for the recursive principal minor computation, complex version
+///
+typedef struct
+{
+	double complex *S;  //!< Schur complements for each recursion level, each of dimension 'orbs x orbs'
+	double complex *T;  //!< temporary matrix for determinant calculation
+	double tol;         //!< pivot threshold below which the determinants are computed with pivoting
+	int orbs;           //!< number of orbitals
+}
+minor_complex_workspace_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Principal minors of the Schur complement 'S' (leading dimension 'orbs') restricted to subsets of
+/// { 0, ..., m - 1 } with 'r' elements, scaled by 'pivprod' and stored in lexicographical order, complex version
+///
+static void PrincipalMinorsComplex(const minor_complex_workspace_t *ws, const int level, const int m, const int r, const double complex pivprod, double complex *d, int *index)
+{
+	const int orbs = ws->orbs;
+	const double complex *S = &ws->S[level*orbs*orbs];
+
+	int c;
+	for (c = r - 1; c < m; c++)
+	{
+		const double complex pivot = S[c*orbs + c];
+
+		if (r == 1)
+		{
+			d[(*index)++] = pivprod * pivot;
+			continue;
+		}
+
+		if (cabs(pivot) <= ws->tol)
+		{
+			// small pivot: compute determinants of the current Schur complement with pivoting
+			const int num = Binomial(c, r - 1);
+			bitfield_t f = (((bitfield_t)1) << (r - 1)) - 1;
+			int i;
+			for (i = 0; i < num; i++)
+			{
+				fermi_coords_t x[64];
+				FermiDecode(f | (((bitfield_t)1) << c), x, r);
+				int k, l;
+				for (k = 0; k < r; k++)
+				{
+					for (l = 0; l < r; l++)
+					{
+						ws->T[r*k + l] = S[orbs*x[k] + x[l]];
+					}
+				}
+				d[(*index)++] = pivprod * ComplexDet(r, ws->T);
+				f = NextFermi(f);
+			}
+			continue;
+		}
+
+		if (r == 2)
+		{
+			// only the diagonal of the next Schur complement is required
+			int i;
+			for (i = 0; i < c; i++)
+			{
+				d[(*index)++] = pivprod * (pivot*S[i*orbs + i] - S[i*orbs + c]*S[c*orbs + i]);
+			}
+			continue;
+		}
+
+		// Schur complement after eliminating 'c'
+		double complex *Snext = &ws->S[(level + 1)*orbs*orbs];
+		int i, j;
+		for (i = 0; i < c; i++)
+		{
+			const double complex s = S[i*orbs + c] / pivot;
+			for (j = 0; j < c; j++)
+			{
+				Snext[i*orbs + j] = S[i*orbs + j] - s*S[c*orbs + j];
+			}
+		}
+
+		PrincipalMinorsComplex(ws, level + 1, c, r - 1, pivprod * pivot, d, index);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the diagonal of the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H,
+/// i.e., the principal N x N minors of A, in the lexicographical ordering of the Slater basis
+///
+int TensorOpDiagComplex(const int orbs, const int N, const double complex *A, double complex *d)
+{
+	assert(0 <= N && N <= orbs && orbs <= (int)(8*sizeof(bitfield_t)));
+
+	if (N == 0)
+	{
+		d[0] = 1;
+		return 0;
+	}
+
+	minor_complex_workspace_t ws;
+	ws.orbs = orbs;
+	ws.S = (double complex *)malloc(N*orbs*orbs * sizeof(double complex));  if (ws.S == NULL) { return -1; }
+	ws.T = (double complex *)malloc(N*N * sizeof(double complex));          if (ws.T == NULL) { free(ws.S); return -1; }
+	memcpy(ws.S, A, orbs*orbs * sizeof(double complex));
+
+	// pivot threshold relative to largest matrix entry
+	double amax = 0;
+	int i;
+	for (i = 0; i < orbs*orbs; i++)
+	{
+		amax = fmax(amax, cabs(A[i]));
+	}
+	ws.tol = sqrt(DBL_EPSILON) * amax;
+
+	int index = 0;
+	PrincipalMinorsComplex(&ws, 0, orbs, N, 1, d, &index);
+	assert(index == Binomial(orbs, N));
+
+	// clean up
+	free(ws.T);
+	free(ws.S);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Workspace for the recursive maximal minor computation
+///
+typedef struct
+{
+	double *M;          //!< partially eliminated matrices for each recursion level, each of dimension 'orbs x N'
+	int orbs;           //!< number of rows (orbitals)
+	int N;              //!< number of columns, also used as leading dimension
+}
+plucker_workspace_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Eliminate row 'c' of the first 'r' columns (r >= 2) of the 'level'-th matrix in 'ws' with column pivoting,
+/// storing the remaining 'r - 1' columns of rows 0, ..., c-1 as the ('level' + 1)-th matrix
+///
+/// Returns the prefactor of the minors of the eliminated matrix (Laplace expansion along the pivot column,
+/// with row 'c' as the last row), or 0 if the row is zero.
+///
+static double MaximalMinorsEliminate(const plucker_workspace_t *ws, const int level, const int c, const int r, const double pref)
+{
+	const int ld = ws->N;
+	const double *M = &ws->M[level*ws->orbs*ld];
+
+	// column pivoting
+	int jp = 0;
+	int j;
+	for (j = 1; j < r; j++)
+	{
+		if (fabs(M[c*ld + j]) > fabs(M[c*ld + jp])) {
+			jp = j;
+		}
+	}
+	const double pivot = M[c*ld + jp];
+	if (pivot == 0) {
+		return 0;
+	}
+
+	// eliminate row 'c' and remove column 'jp'
+	double *Mnext = &ws->M[(level + 1)*ws->orbs*ld];
+	int i;
+	for (i = 0; i < c; i++)
+	{
+		const double s = M[i*ld + jp] / pivot;
+		int k = 0;
+		for (j = 0; j < r; j++)
+		{
+			if (j != jp) {
+				Mnext[i*ld + k++] = M[i*ld + j] - s*M[c*ld + j];
+			}
+		}
+	}
+
+	return ((r - 1 + jp) & 1 ? -pref : pref) * pivot;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Maximal minors of the first 'r' columns of the 'level'-th matrix in 'ws', restricted to row subsets
+/// with largest row 'c', scaled by 'pref' and stored in lexicographical order in 'psi'
+///
+/// The largest row is eliminated first (with column pivoting), such that all row subsets sharing their
+/// largest rows reuse the corresponding partial elimination.
+///
+static void MaximalMinorsStep(const plucker_workspace_t *ws, const int level, const int c, const int r, const double pref, double *psi)
+{
+	const int ld = ws->N;
+	const double *M = &ws->M[level*ws->orbs*ld];
+
+	if (r == 1)
+	{
+		psi[0] = pref * M[c*ld];
+		return;
+	}
+
+	// number of row subsets with largest row 'c'
+	const int num = Binomial(c, r - 1);
+
+	if (r == 2)
+	{
+		// column pivoting; only a single column remains after elimination
+		const int jp = (fabs(M[c*ld + 1]) > fabs(M[c*ld]) ? 1 : 0);
+		const int q = 1 - jp;
+		const double pivot = M[c*ld + jp];
+		if (pivot == 0)
+		{
+			memset(psi, 0, num * sizeof(double));
+			return;
+		}
+		// Laplace expansion along column 'jp' after elimination; row 'c' is the last row
+		const double p = (jp == 0 ? -pref : pref) * pivot;
+		int i;
+		for (i = 0; i < c; i++)
+		{
+			psi[i] = p * (M[i*ld + q] - M[i*ld + jp]*M[c*ld + q]/pivot);
+		}
+		return;
+	}
+
+	const double p = MaximalMinorsEliminate(ws, level, c, r, pref);
+	if (p == 0)
+	{
+		memset(psi, 0, num * sizeof(double));
+		return;
+	}
+
+	int d;
+	for (d = r - 2; d < c; d++)
+	{
+		MaximalMinorsStep(ws, level + 1, d, r - 1, p, psi + Binomial(d, r - 1));
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate all maximal (N x N) minors of the 'orbs x N' matrix 'C', i.e., its Pluecker coordinates
+///
+/// If the columns of 'C' contain the orbital coefficients, then 'psi' is the Slater determinant of these orbitals
+/// in the lexicographically ordered N-particle Slater basis. Output vector 'psi' must have length Binomial(orbs, N).
+/// The row subsets with the same two largest rows are processed in parallel.
+///
+int MaximalMinors(const int orbs, const int N, const double *C, double *psi)
+{
+	assert(0 <= N && N <= orbs);
+
+	if (N == 0)
+	{
+		psi[0] = 1;
+		return 0;
+	}
+	if (N == 1)
+	{
+		memcpy(psi, C, orbs * sizeof(double));
+		return 0;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		plucker_workspace_t ws;
+		ws.orbs = orbs;
+		ws.N = N;
+		ws.M = (double *)malloc(N*orbs*N * sizeof(double));
+		if (ws.M == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			memcpy(ws.M, C, orbs*N * sizeof(double));
+		}
+
+		// pairs (c, d) of the two largest rows, with the elimination of row 'c' reused for consecutive pairs
+		int clast = -1;
+		double p = 0;
+		int t;
+		#pragma omp for schedule(dynamic)
+		for (t = 0; t < orbs*orbs; t++)
+		{
+			const int c = t / orbs;
+			const int d = t % orbs;
+			if (ws.M == NULL || c < N - 1 || d < N - 2 || d >= c) {
+				continue;
+			}
+			if (c != clast)
+			{
+				p = MaximalMinorsEliminate(&ws, 0, c, N, 1);
+				clast = c;
+			}
+			double *psi_cd = psi + Binomial(c, N) + Binomial(d, N - 1);
+			if (p == 0) {
+				memset(psi_cd, 0, Binomial(d, N - 2) * sizeof(double));
+			}
+			else {
+				MaximalMinorsStep(&ws, 1, d, N - 1, p, psi_cd);
+			}
+		}
+
+		free(ws.M);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Workspace for the recursive maximal minor computation, complex version
+///
+typedef struct
+{
+	double complex *M;  //!< partially eliminated matrices for each recursion level, each of dimension 'orbs x N'
+	int orbs;           //!< number of rows (orbitals)
+	int N;              //!< number of columns, also used as leading dimension
+}
+plucker_complex_workspace_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Eliminate row 'c' of the first 'r' columns (r >= 2) of the 'level'-th matrix in 'ws' with column pivoting,
+/// storing the remaining 'r - 1' columns of rows 0, ..., c-1 as the ('level' + 1)-th matrix
+///
+/// Returns the prefactor of the minors of the eliminated matrix (Laplace expansion along the pivot column,
+/// with row 'c' as the last row), or 0 if the row is zero; complex version
+///
+static double complex MaximalMinorsEliminateComplex(const plucker_complex_workspace_t *ws, const int level, const int c, const int r, const double complex pref)
+{
+	const int ld = ws->N;
+	const double complex *M = &ws->M[level*ws->orbs*ld];
+
+	// column pivoting
+	int jp = 0;
+	int j;
+	for (j = 1; j < r; j++)
+	{
+		if (cabs(M[c*ld + j]) > cabs(M[c*ld + jp])) {
+			jp = j;
+		}
+	}
+	const double complex pivot = M[c*ld + jp];
+	if (pivot == 0) {
+		return 0;
+	}
+
+	// eliminate row 'c' and remove column 'jp'
+	double complex *Mnext = &ws->M[(level + 1)*ws->orbs*ld];
+	int i;
+	for (i = 0; i < c; i++)
+	{
+		const double complex s = M[i*ld + jp] / pivot;
+		int k = 0;
+		for (j = 0; j < r; j++)
+		{
+			if (j != jp) {
+				Mnext[i*ld + k++] = M[i*ld + j] - s*M[c*ld + j];
+			}
+		}
+	}
+
+	return ((r - 1 + jp) & 1 ? -pref : pref) * pivot;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Maximal minors of the first 'r' columns of the 'level'-th matrix in 'ws', restricted to row subsets
+/// with largest row 'c', scaled by 'pref' and stored in lexicographical order in 'psi', complex version
+///
+static void MaximalMinorsStepComplex(const plucker_complex_workspace_t *ws, const int level, const int c, const int r, const double complex pref, double complex *psi)
+{
+	const int ld = ws->N;
+	const double complex *M = &ws->M[level*ws->orbs*ld];
+
+	if (r == 1)
+	{
+		psi[0] = pref * M[c*ld];
+		return;
+	}
+
+	// number of row subsets with largest row 'c'
+	const int num = Binomial(c, r - 1);
+
+	if (r == 2)
+	{
+		// column pivoting; only a single column remains after elimination
+		const int jp = (cabs(M[c*ld + 1]) > cabs(M[c*ld]) ? 1 : 0);
+		const int q = 1 - jp;
+		const double complex pivot = M[c*ld + jp];
+		if (pivot == 0)
+		{
+			memset(psi, 0, num * sizeof(double complex));
+			return;
+		}
+		// Laplace expansion along column 'jp' after elimination; row 'c' is the last row
+		const double complex p = (jp == 0 ? -pref : pref) * pivot;
+		int i;
+		for (i = 0; i < c; i++)
+		{
+			psi[i] = p * (M[i*ld + q] - M[i*ld + jp]*M[c*ld + q]/pivot);
+		}
+		return;
+	}
+
+	const double complex p = MaximalMinorsEliminateComplex(ws, level, c, r, pref);
+	if (p == 0)
+	{
+		memset(psi, 0, num * sizeof(double complex));
+		return;
+	}
+
+	int d;
+	for (d = r - 2; d < c; d++)
+	{
+		MaximalMinorsStepComplex(ws, level + 1, d, r - 1, p, psi + Binomial(d, r - 1));
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate all maximal (N x N) minors of the 'orbs x N' matrix 'C', i.e., its Pluecker coordinates
+///
+int MaximalMinorsComplex(const int orbs, const int N, const double complex *C, double complex *psi)
+{
+	assert(0 <= N && N <= orbs);
+
+	if (N == 0)
+	{
+		psi[0] = 1;
+		return 0;
+	}
+	if (N == 1)
+	{
+		memcpy(psi, C, orbs * sizeof(double complex));
+		return 0;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		plucker_complex_workspace_t ws;
+		ws.orbs = orbs;
+		ws.N = N;
+		ws.M = (double complex *)malloc(N*orbs*N * sizeof(double complex));
+		if (ws.M == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			memcpy(ws.M, C, orbs*N * sizeof(double complex));
+		}
+
+		// pairs (c, d) of the two largest rows, with the elimination of row 'c' reused for consecutive pairs
+		int clast = -1;
+		double complex p = 0;
+		int t;
+		#pragma omp for schedule(dynamic)
+		for (t = 0; t < orbs*orbs; t++)
+		{
+			const int c = t / orbs;
+			const int d = t % orbs;
+			if (ws.M == NULL || c < N - 1 || d < N - 2 || d >= c) {
+				continue;
+			}
+			if (c != clast)
+			{
+				p = MaximalMinorsEliminateComplex(&ws, 0, c, N, 1);
+				clast = c;
+			}
+			double complex *psi_cd = psi + Binomial(c, N) + Binomial(d, N - 1);
+			if (p == 0) {
+				memset(psi_cd, 0, Binomial(d, N - 2) * sizeof(double complex));
+			}
+			else {
+				MaximalMinorsStepComplex(&ws, 1, d, N - 1, p, psi_cd);
+			}
+		}
+
+		free(ws.M);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-th compound matrix of the 'm x n' matrix 'A', i.e., all p x p minors of 'A',
+/// with row and column subsets in lexicographical order
+///
+/// For a square matrix 'A', this is the dense matrix representation of (A otimes A ... otimes A): wedge^p H -> wedge^p H.
+/// Each row of the output consists of the maximal minors of the corresponding p rows of 'A',
+/// and the rows are processed in parallel. Output matrix 'Ap' must have dimension 'Binomial(m, p) x Binomial(n, p)'.
+///
+int CompoundMatrix(const int m, const int n, const int p, const double *A, double *Ap)
+{
+	assert(0 <= p && p <= m && p <= n);
+
+	const int nrows = Binomial(m, p);
+	const int ncols = Binomial(n, p);
+
+	if (p == 0)
+	{
+		Ap[0] = 1;
+		return 0;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		plucker_workspace_t ws;
+		ws.orbs = n;
+		ws.N = p;
+		ws.M = (double *)malloc(p*n*p * sizeof(double));
+		fermi_coords_t *x = (fermi_coords_t *)malloc(p * sizeof(fermi_coords_t));
+		if (ws.M == NULL || x == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+
+		int i;
+		#pragma omp for schedule(dynamic)
+		for (i = 0; i < nrows; i++)
+		{
+			if (ws.M == NULL || x == NULL) {
+				continue;
+			}
+
+			// decode i-th row subset by unranking (colex order)
+			int r = i;
+			int k;
+			for (k = p; k > 0; k--)
+			{
+				int c = k - 1;
+				while (Binomial(c + 1, k) <= r) {
+					c++;
+				}
+				x[k-1] = c;
+				r -= Binomial(c, k);
+			}
+
+			// transpose of the selected rows
+			int j;
+			for (j = 0; j < n; j++)
+			{
+				for (k = 0; k < p; k++)
+				{
+					ws.M[j*p + k] = A[x[k]*n + j];
+				}
+			}
+
+			int c;
+			for (c = p - 1; c < n; c++)
+			{
+				MaximalMinorsStep(&ws, 0, c, p, 1, Ap + (size_t)i*ncols + Binomial(c, p));
+			}
+		}
+
+		free(x);
+		free(ws.M);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the p-th compound matrix of the 'm x n' matrix 'A', i.e., all p x p minors of 'A',
+/// with row and column subsets in lexicographical order
+///
+int CompoundMatrixComplex(const int m, const int n, const int p, const double complex *A, double complex *Ap)
+{
+	assert(0 <= p && p <= m && p <= n);
+
+	const int nrows = Binomial(m, p);
+	const int ncols = Binomial(n, p);
+
+	if (p == 0)
+	{
+		Ap[0] = 1;
+		return 0;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		plucker_complex_workspace_t ws;
+		ws.orbs = n;
+		ws.N = p;
+		ws.M = (double complex *)malloc(p*n*p * sizeof(double complex));
+		fermi_coords_t *x = (fermi_coords_t *)malloc(p * sizeof(fermi_coords_t));
+		if (ws.M == NULL || x == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+
+		int i;
+		#pragma omp for schedule(dynamic)
+		for (i = 0; i < nrows; i++)
+		{
+			if (ws.M == NULL || x == NULL) {
+				continue;
+			}
+
+			// decode i-th row subset by unranking (colex order)
+			int r = i;
+			int k;
+			for (k = p; k > 0; k--)
+			{
+				int c = k - 1;
+				while (Binomial(c + 1, k) <= r) {
+					c++;
+				}
+				x[k-1] = c;
+				r -= Binomial(c, k);
+			}
+
+			// transpose of the selected rows
+			int j;
+			for (j = 0; j < n; j++)
+			{
+				for (k = 0; k < p; k++)
+				{
+					ws.M[j*p + k] = A[x[k]*n + j];
+				}
+			}
+
+			int c;
+			for (c = p - 1; c < n; c++)
+			{
+				MaximalMinorsStepComplex(&ws, 0, c, p, 1, Ap + (size_t)i*ncols + Binomial(c, p));
+			}
+		}
+
+		free(x);
+		free(ws.M);
+	}
+
+	return status;
+}
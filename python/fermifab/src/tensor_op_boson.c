@@ -0,0 +1,579 @@
+/// \file tensor_op_boson.c
+/// \brief Calculate the symmetric tensor product (A otimes A ... otimes A): Sym^N H -> Sym^N H via permanents.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "tensor_op_boson.h"
+#include "boson_map.h"
+#include "util.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <math.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Temporary workspace for the permanent calculation
+///
+typedef struct
+{
+	int *k;         //!< Gray code digits, i.e., number of selected copies of each column
+	int *o;         //!< Gray code directions
+	int *f;         //!< Gray code focus pointers
+	void *s;        //!< row sums
+}
+permanent_workspace_t;
+
+
+static int CreatePermanentWorkspace(const int n, const size_t elsize, permanent_workspace_t *ws)
+{
+	ws->k = (int *)malloc(n * sizeof(int));
+	ws->o = (int *)malloc(n * sizeof(int));
+	ws->f = (int *)malloc((n + 1) * sizeof(int));
+	ws->s = malloc(n * elsize);
+	if (ws->k == NULL || ws->o == NULL || ws->f == NULL || ws->s == NULL) {
+		return -1;
+	}
+
+	return 0;
+}
+
+
+static void DeletePermanentWorkspace(permanent_workspace_t *ws)
+{
+	free(ws->s);
+	free(ws->f);
+	free(ws->o);
+	free(ws->k);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of Gray code steps when summing over the columns with multiplicities 'mul'
+///
+static inline double RyserSteps(const int n, const int *mul)
+{
+	double steps = 1;
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		steps *= mul[i] + 1;
+	}
+
+	return steps;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Ryser formula for a matrix with repeated rows and columns,
+/// perm = (-1)^N sum_{k_j = 0, ..., cmul[j]} (-1)^{|k|} prod_j Binomial(cmul[j], k_j) prod_i (sum_j k_j M[i,j])^{rmul[i]},
+/// traversing the tuples 'k' in reflected mixed-radix Gray code order (Knuth's loopless Algorithm H),
+/// such that each step updates the row sums by a single column
+///
+/// Entries are accessed as M[i*rs + j*cs], to allow for implicit transposition.
+///
+static double PermanentRyser(const int nr, const int nc, const double *M, const int rs, const int cs,
+	const int *rmul, const int *cmul, const int N, const permanent_workspace_t *ws)
+{
+	if (N == 0) {
+		return 1;
+	}
+
+	int *k = ws->k;
+	int *o = ws->o;
+	int *f = ws->f;
+	double *s = (double *)ws->s;
+
+	int i, j;
+	for (i = 0; i < nr; i++) {
+		s[i] = 0;
+	}
+	for (j = 0; j < nc; j++)
+	{
+		k[j] = 0;
+		o[j] = 1;
+		f[j] = j;
+	}
+	f[nc] = nc;
+
+	// product of binomial coefficients
+	double w = 1;
+	// parity of |k|
+	int parity = 0;
+
+	// first term with k = 0 vanishes
+	double perm = 0;
+	while (true)
+	{
+		j = f[0];
+		f[0] = 0;
+		if (j == nc) {
+			break;
+		}
+
+		if (o[j] > 0)
+		{
+			w *= (double)(cmul[j] - k[j]) / (k[j] + 1);
+			k[j]++;
+			for (i = 0; i < nr; i++) {
+				s[i] += M[i*rs + j*cs];
+			}
+		}
+		else
+		{
+			w *= (double)k[j] / (cmul[j] - k[j] + 1);
+			k[j]--;
+			for (i = 0; i < nr; i++) {
+				s[i] -= M[i*rs + j*cs];
+			}
+		}
+		parity ^= 1;
+
+		if (k[j] == 0 || k[j] == cmul[j])
+		{
+			o[j] = -o[j];
+			f[j] = f[j + 1];
+			f[j + 1] = j + 1;
+		}
+
+		double t = w;
+		for (i = 0; i < nr; i++)
+		{
+			int l;
+			for (l = 0; l < rmul[i]; l++) {
+				t *= s[i];
+			}
+		}
+		perm += (parity ? -t : t);
+	}
+
+	return ((N & 1) ? -perm : perm);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Ryser formula for a complex matrix with repeated rows and columns, see 'PermanentRyser'
+///
+static double complex PermanentRyserComplex(const int nr, const int nc, const double complex *M, const int rs, const int cs,
+	const int *rmul, const int *cmul, const int N, const permanent_workspace_t *ws)
+{
+	if (N == 0) {
+		return 1;
+	}
+
+	int *k = ws->k;
+	int *o = ws->o;
+	int *f = ws->f;
+	double complex *s = (double complex *)ws->s;
+
+	int i, j;
+	for (i = 0; i < nr; i++) {
+		s[i] = 0;
+	}
+	for (j = 0; j < nc; j++)
+	{
+		k[j] = 0;
+		o[j] = 1;
+		f[j] = j;
+	}
+	f[nc] = nc;
+
+	// product of binomial coefficients
+	double w = 1;
+	// parity of |k|
+	int parity = 0;
+
+	// first term with k = 0 vanishes
+	double complex perm = 0;
+	while (true)
+	{
+		j = f[0];
+		f[0] = 0;
+		if (j == nc) {
+			break;
+		}
+
+		if (o[j] > 0)
+		{
+			w *= (double)(cmul[j] - k[j]) / (k[j] + 1);
+			k[j]++;
+			for (i = 0; i < nr; i++) {
+				s[i] += M[i*rs + j*cs];
+			}
+		}
+		else
+		{
+			w *= (double)k[j] / (cmul[j] - k[j] + 1);
+			k[j]--;
+			for (i = 0; i < nr; i++) {
+				s[i] -= M[i*rs + j*cs];
+			}
+		}
+		parity ^= 1;
+
+		if (k[j] == 0 || k[j] == cmul[j])
+		{
+			o[j] = -o[j];
+			f[j] = f[j + 1];
+			f[j + 1] = j + 1;
+		}
+
+		double complex t = w;
+		for (i = 0; i < nr; i++)
+		{
+			int l;
+			for (l = 0; l < rmul[i]; l++) {
+				t *= s[i];
+			}
+		}
+		perm += (parity ? -t : t);
+	}
+
+	return ((N & 1) ? -perm : perm);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the permanent of the N x N matrix obtained from the 'nr x nc' matrix 'M'
+/// by repeating row i 'rmul[i]' times and column j 'cmul[j]' times
+///
+/// Uses the multiplicity-aware Ryser formula with Gray code updates, summing over the rows or columns
+/// depending on which requires fewer steps, i.e., prod_j (cmul[j] + 1) instead of 2^N terms.
+///
+double Permanent(const int nr, const int nc, const double *M, const int *rmul, const int *cmul)
+{
+	const int N = IntegerSum(cmul, nc);
+	assert(IntegerSum(rmul, nr) == N);
+
+	const int n = (nr > nc ? nr : nc);
+	permanent_workspace_t ws;
+	if (CreatePermanentWorkspace(n > 0 ? n : 1, sizeof(double), &ws) < 0) {
+		DeletePermanentWorkspace(&ws);
+		return NAN;
+	}
+
+	double perm;
+	if (RyserSteps(nc, cmul) <= RyserSteps(nr, rmul)) {
+		perm = PermanentRyser(nr, nc, M, nc, 1, rmul, cmul, N, &ws);
+	}
+	else {
+		// permanent of transposed matrix
+		perm = PermanentRyser(nc, nr, M, 1, nc, cmul, rmul, N, &ws);
+	}
+
+	DeletePermanentWorkspace(&ws);
+
+	return perm;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the permanent of the N x N matrix obtained from the complex 'nr x nc' matrix 'M'
+/// by repeating row i 'rmul[i]' times and column j 'cmul[j]' times, see 'Permanent'
+///
+double complex PermanentComplex(const int nr, const int nc, const double complex *M, const int *rmul, const int *cmul)
+{
+	const int N = IntegerSum(cmul, nc);
+	assert(IntegerSum(rmul, nr) == N);
+
+	const int n = (nr > nc ? nr : nc);
+	permanent_workspace_t ws;
+	if (CreatePermanentWorkspace(n > 0 ? n : 1, sizeof(double complex), &ws) < 0) {
+		DeletePermanentWorkspace(&ws);
+		return NAN;
+	}
+
+	double complex perm;
+	if (RyserSteps(nc, cmul) <= RyserSteps(nr, rmul)) {
+		perm = PermanentRyserComplex(nr, nc, M, nc, 1, rmul, cmul, N, &ws);
+	}
+	else {
+		// permanent of transposed matrix
+		perm = PermanentRyserComplex(nc, nr, M, 1, nc, cmul, rmul, N, &ws);
+	}
+
+	DeletePermanentWorkspace(&ws);
+
+	return perm;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Occupied modes and their occupation numbers of all basis states
+///
+typedef struct
+{
+	int *modes;         //!< occupied modes, matrix of dimension 'num x N'
+	int *mul;           //!< corresponding occupation numbers, matrix of dimension 'num x N'
+	int *nocc;          //!< number of occupied modes of each basis state
+	double *norm;       //!< normalization factors 1/sqrt(prod_m n_m!)
+	int num;            //!< number of basis states
+}
+boson_occupations_t;
+
+
+static void DeleteBosonOccupations(boson_occupations_t *bo)
+{
+	free(bo->norm);
+	free(bo->nocc);
+	free(bo->mul);
+	free(bo->modes);
+}
+
+
+static int BosonOccupations(const int modes, const int N, boson_occupations_t *bo)
+{
+	boson_map_t bm;
+	if (BosonBasis(modes, N, &bm) < 0) {
+		return -1;
+	}
+	if (bm.num > INT_MAX) {
+		DeleteBosonMap(&bm);
+		return -1;
+	}
+	const int num = (int)bm.num;
+	const int width = (N > 0 ? N : 1);
+
+	bo->num   = num;
+	bo->modes = (int *)malloc((size_t)num*width * sizeof(int));
+	bo->mul   = (int *)malloc((size_t)num*width * sizeof(int));
+	bo->nocc  = (int *)malloc(num * sizeof(int));
+	bo->norm  = (double *)malloc(num * sizeof(double));
+	if (bo->modes == NULL || bo->mul == NULL || bo->nocc == NULL || bo->norm == NULL) {
+		DeleteBosonOccupations(bo);
+		DeleteBosonMap(&bm);
+		return -1;
+	}
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		int *occ = (int *)malloc(modes * sizeof(int));
+		if (occ == NULL)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int i;
+			#pragma omp for
+			for (i = 0; i < num; i++)
+			{
+				BosonUnrank(&bm, i, occ);
+
+				double fact = 1;
+				int c = 0;
+				int m;
+				for (m = 0; m < modes; m++)
+				{
+					if (occ[m] > 0)
+					{
+						bo->modes[(size_t)i*width + c] = m;
+						bo->mul  [(size_t)i*width + c] = occ[m];
+						c++;
+						int l;
+						for (l = 2; l <= occ[m]; l++) {
+							fact *= l;
+						}
+					}
+				}
+				bo->nocc[i] = c;
+				bo->norm[i] = 1 / sqrt(fact);
+			}
+		}
+
+		free(occ);
+	}
+
+	DeleteBosonMap(&bm);
+
+	if (status < 0) {
+		DeleteBosonOccupations(bo);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the symmetric tensor product (A otimes A ... otimes A): Sym^N H -> Sym^N H for an operator A: H -> H
+///
+/// With respect to the normalized occupation number basis (ordered as in 'BosonRank'), the entries are
+/// AN[u,v] = perm(A[rows repeated by n_u, columns repeated by n_v]) / sqrt(prod n_u! prod n_v!).
+/// The entries are computed in parallel, each by the multiplicity-aware Ryser formula.
+/// The output matrix 'AN' must have dimension 'num x num' with 'num = Binomial(modes + N - 1, N)'.
+///
+int TensorOpBoson(const int modes, const int N, const double *A, double *AN)
+{
+	boson_occupations_t bo;
+	if (BosonOccupations(modes, N, &bo) < 0) {
+		return -1;
+	}
+	const int num = bo.num;
+	const int width = (N > 0 ? N : 1);
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		double *M = (double *)malloc(width*width * sizeof(double));
+		permanent_workspace_t ws;
+		const int ws_status = CreatePermanentWorkspace(width, sizeof(double), &ws);
+		if (M == NULL || ws_status < 0)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int u;
+			#pragma omp for schedule(dynamic)
+			for (u = 0; u < num; u++)
+			{
+				const int nr = bo.nocc[u];
+				const int *rmodes = &bo.modes[(size_t)u*width];
+				const int *rmul   = &bo.mul  [(size_t)u*width];
+				const double rsteps = RyserSteps(nr, rmul);
+
+				int v;
+				for (v = 0; v < num; v++)
+				{
+					const int nc = bo.nocc[v];
+					const int *cmodes = &bo.modes[(size_t)v*width];
+					const int *cmul   = &bo.mul  [(size_t)v*width];
+
+					int i, j;
+					for (i = 0; i < nr; i++)
+					{
+						for (j = 0; j < nc; j++)
+						{
+							M[i*nc + j] = A[rmodes[i]*modes + cmodes[j]];
+						}
+					}
+
+					double perm;
+					if (RyserSteps(nc, cmul) <= rsteps) {
+						perm = PermanentRyser(nr, nc, M, nc, 1, rmul, cmul, N, &ws);
+					}
+					else {
+						perm = PermanentRyser(nc, nr, M, 1, nc, cmul, rmul, N, &ws);
+					}
+
+					AN[(size_t)u*num + v] = bo.norm[u] * bo.norm[v] * perm;
+				}
+			}
+		}
+
+		DeletePermanentWorkspace(&ws);
+		free(M);
+	}
+
+	DeleteBosonOccupations(&bo);
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the symmetric tensor product (A otimes A ... otimes A): Sym^N H -> Sym^N H
+/// for a complex operator A: H -> H, see 'TensorOpBoson'
+///
+int TensorOpBosonComplex(const int modes, const int N, const double complex *A, double complex *AN)
+{
+	boson_occupations_t bo;
+	if (BosonOccupations(modes, N, &bo) < 0) {
+		return -1;
+	}
+	const int num = bo.num;
+	const int width = (N > 0 ? N : 1);
+
+	int status = 0;
+
+	#pragma omp parallel
+	{
+		// thread-local workspace
+		double complex *M = (double complex *)malloc(width*width * sizeof(double complex));
+		permanent_workspace_t ws;
+		const int ws_status = CreatePermanentWorkspace(width, sizeof(double complex), &ws);
+		if (M == NULL || ws_status < 0)
+		{
+			#pragma omp atomic write
+			status = -1;
+		}
+		else
+		{
+			int u;
+			#pragma omp for schedule(dynamic)
+			for (u = 0; u < num; u++)
+			{
+				const int nr = bo.nocc[u];
+				const int *rmodes = &bo.modes[(size_t)u*width];
+				const int *rmul   = &bo.mul  [(size_t)u*width];
+				const double rsteps = RyserSteps(nr, rmul);
+
+				int v;
+				for (v = 0; v < num; v++)
+				{
+					const int nc = bo.nocc[v];
+					const int *cmodes = &bo.modes[(size_t)v*width];
+					const int *cmul   = &bo.mul  [(size_t)v*width];
+
+					int i, j;
+					for (i = 0; i < nr; i++)
+					{
+						for (j = 0; j < nc; j++)
+						{
+							M[i*nc + j] = A[rmodes[i]*modes + cmodes[j]];
+						}
+					}
+
+					double complex perm;
+					if (RyserSteps(nc, cmul) <= rsteps) {
+						perm = PermanentRyserComplex(nr, nc, M, nc, 1, rmul, cmul, N, &ws);
+					}
+					else {
+						perm = PermanentRyserComplex(nc, nr, M, 1, nc, cmul, rmul, N, &ws);
+					}
+
+					AN[(size_t)u*num + v] = bo.norm[u] * bo.norm[v] * perm;
+				}
+			}
+		}
+
+		DeletePermanentWorkspace(&ws);
+		free(M);
+	}
+
+	DeleteBosonOccupations(&bo);
+
+	return status;
+}
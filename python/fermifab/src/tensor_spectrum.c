@@ -0,0 +1,300 @@
+/// \file tensor_spectrum.c
+/// \brief Traces and spectra of the tensor product (A otimes A ... otimes A): wedge^N H -> wedge^N H via the eigenvalues of A.
+//
+//  Copyright (c) 2008-2020, Christian B. Mendl
+//  All rights reserved.
+//  http://christian.mendl.net
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the Simplified BSD License
+//  http://www.opensource.org/licenses/bsd-license.php
+//
+//  Reference:
+//      Christian B. Mendl
+//      The FermiFab toolbox for fermionic many-particle quantum systems
+//      Comput. Phys. Commun. 182, 1327-1337 (2011)
+//      preprint http://arxiv.org/abs/1103.0872
+//________________________________________________________________________________________________________________________
+//
+
+#include "tensor_spectrum.h"
+#include "util.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <malloc.h>
+#include <memory.h>
+#include <assert.h>
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the elementary symmetric polynomials e_0, ..., e_n of the numbers 'x'
+///
+/// The output vector 'e' must have length n + 1. If 'x' are the eigenvalues of A,
+/// then e_N = trace(A otimes A ... otimes A) on wedge^N H, i.e., the coefficients of det(1 + t A).
+/// Uses the recurrence of multiplying out prod_i (1 + t x_i), with cost O(n^2).
+///
+void ElementarySymmetric(const int n, const double complex *x, double complex *e)
+{
+	int i, j;
+
+	e[0] = 1;
+	for (j = 1; j <= n; j++)
+	{
+		e[j] = 0;
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		// traverse in reverse order to use 'e' in-place
+		for (j = i + 1; j > 0; j--)
+		{
+			e[j] += x[i] * e[j-1];
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Heap entry for the best-first subset enumeration
+///
+typedef struct
+{
+	double key;         //!< logarithm of the product magnitude
+	bitfield_t s;       //!< subset with respect to the sorted ordering
+}
+subset_entry_t;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Move the last heap entry upwards to restore the (maximum) heap property
+///
+static void HeapSiftUp(subset_entry_t *heap, int i)
+{
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if (heap[parent].key >= heap[i].key) {
+			break;
+		}
+		subset_entry_t t = heap[parent];
+		heap[parent] = heap[i];
+		heap[i] = t;
+		i = parent;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Move the first heap entry downwards to restore the (maximum) heap property
+///
+static void HeapSiftDown(subset_entry_t *heap, const int size)
+{
+	int i = 0;
+	while (true)
+	{
+		int l = 2*i + 1;
+		int r = l + 1;
+		int m = i;
+		if (l < size && heap[l].key > heap[m].key) {
+			m = l;
+		}
+		if (r < size && heap[r].key > heap[m].key) {
+			m = r;
+		}
+		if (m == i) {
+			break;
+		}
+		subset_entry_t t = heap[m];
+		heap[m] = heap[i];
+		heap[i] = t;
+		i = m;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Insert 's' into the open addressing hash set 'table' of size 'mask + 1';
+/// return false if 's' is already contained in the set
+///
+static bool HashSetInsert(bitfield_t *table, const bitfield_t mask, const int shift, const bitfield_t s)
+{
+	// Fibonacci hashing
+	bitfield_t h = (s * 0x9E3779B97F4A7C15ULL) >> shift;
+	while (table[h] != 0)
+	{
+		if (table[h] == s) {
+			return false;
+		}
+		h = (h + 1) & mask;
+	}
+	table[h] = s;
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Index permutation sorting 'x' by descending magnitude (insertion sort, since n <= 64)
+///
+static void SortByMagnitude(const int n, const double complex *x, int *order)
+{
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		int t = i;
+		int j = i;
+		while (j > 0 && cabs(x[order[j-1]]) < cabs(x[t]))
+		{
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = t;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Calculate the 'k' N-subset products of the numbers 'x' with largest magnitude, in descending order
+///
+/// If 'x' are the eigenvalues of A, these are the dominant eigenvalues of (A otimes A ... otimes A) on wedge^N H.
+/// Uses a best-first search starting from the N largest entries, where each step shifts one entry of a subset
+/// to the next smaller one; the cost is O(k N (N + log(k N))), independent of Binomial(n, N).
+///
+/// \param n        number of entries in 'x' (at most 64)
+/// \param x        input numbers, e.g., eigenvalues of A
+/// \param N        subset size
+/// \param k        maximum number of products to compute
+/// \param prod     subset products (output, vector of length 'k')
+/// \param subsets  corresponding subsets of indices into 'x' as bitfields (output, can be NULL)
+/// \return number of computed products, i.e., min(k, Binomial(n, N)), or -1 if out of memory
+///
+int TopSubsetProducts(const int n, const double complex *x, const int N, const int k, double complex *prod, bitfield_t *subsets)
+{
+	assert(0 <= N && N <= n && n <= (int)(8*sizeof(bitfield_t)));
+
+	if (k <= 0) {
+		return 0;
+	}
+	if (N == 0)
+	{
+		prod[0] = 1;
+		if (subsets != NULL) {
+			subsets[0] = 0;
+		}
+		return 1;
+	}
+
+	int i;
+
+	int *order = (int *)malloc(n * sizeof(int));
+	double *logabs = (double *)malloc(n * sizeof(double));
+	if (order == NULL || logabs == NULL)
+	{
+		free(logabs);
+		free(order);
+		return -1;
+	}
+	SortByMagnitude(n, x, order);
+	for (i = 0; i < n; i++)
+	{
+		logabs[i] = log(cabs(x[order[i]]));   // can be -inf
+	}
+
+	// each extracted subset adds at most N new candidates
+	const int maxentries = 1 + k*N;
+	subset_entry_t *heap = (subset_entry_t *)malloc(maxentries * sizeof(subset_entry_t));
+	if (heap == NULL)
+	{
+		free(logabs);
+		free(order);
+		return -1;
+	}
+
+	// hash set of visited subsets, with load factor at most 1/2
+	int shift = 8*sizeof(bitfield_t) - 1;
+	while ((((bitfield_t)1) << (8*sizeof(bitfield_t) - shift)) < 2*(bitfield_t)maxentries) {
+		shift--;
+	}
+	const bitfield_t mask = (((bitfield_t)1) << (8*sizeof(bitfield_t) - shift)) - 1;
+	bitfield_t *visited = (bitfield_t *)calloc(mask + 1, sizeof(bitfield_t));
+	if (visited == NULL)
+	{
+		free(heap);
+		free(logabs);
+		free(order);
+		return -1;
+	}
+
+	// start with the N entries of largest magnitude
+	int size = 1;
+	heap[0].s = (N < (int)(8*sizeof(bitfield_t)) ? (((bitfield_t)1) << N) : 0) - 1;
+	heap[0].key = 0;
+	for (i = 0; i < N; i++) {
+		heap[0].key += logabs[i];
+	}
+	HashSetInsert(visited, mask, shift, heap[0].s);
+
+	int count = 0;
+	while (count < k && size > 0)
+	{
+		const bitfield_t s = heap[0].s;
+		heap[0] = heap[--size];
+		HeapSiftDown(heap, size);
+
+		// record product
+		prod[count] = 1;
+		bitfield_t u = 0;
+		for (i = 0; i < n; i++)
+		{
+			if (s & (((bitfield_t)1) << i))
+			{
+				prod[count] *= x[order[i]];
+				u |= ((bitfield_t)1) << order[i];
+			}
+		}
+		if (subsets != NULL) {
+			subsets[count] = u;
+		}
+		count++;
+
+		// successors: shift a single entry to the next position if it is unoccupied
+		for (i = 0; i < n - 1; i++)
+		{
+			const bitfield_t b = ((bitfield_t)1) << i;
+			if ((s & b) && !(s & (b << 1)))
+			{
+				const bitfield_t t = s - b + (b << 1);
+				if (HashSetInsert(visited, mask, shift, t))
+				{
+					assert(size < maxentries);
+					heap[size].s = t;
+					heap[size].key = 0;
+					int j;
+					for (j = 0; j < n; j++)
+					{
+						if (t & (((bitfield_t)1) << j)) {
+							heap[size].key += logabs[j];
+						}
+					}
+					HeapSiftUp(heap, size);
+					size++;
+				}
+			}
+		}
+	}
+
+	// clean up
+	free(visited);
+	free(heap);
+	free(logabs);
+	free(order);
+
+	return count;
+}
@@ -18,12 +18,15 @@
 //
 
 #include "util.h"
+#include <stdint.h>
 #include <assert.h>
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Calculate the binomial coefficient 'n choose k' recursively
+/// \brief Calculate the binomial coefficient 'n choose k'
+///
+/// Uses the multiplicative formula, such that all intermediate results are binomial coefficients as well
 ///
 int Binomial(const int n, const int k)
 {
@@ -33,11 +36,17 @@ int Binomial(const int n, const int k)
 	{
 		return 0;
 	}
-	else if (k == 0)
+
+	// use symmetry to reduce number of iterations
+	const int m = (2*k > n ? n - k : k);
+
+	int64_t b = 1;
+	int i;
+	for (i = 1; i <= m; i++)
 	{
-		return 1;
+		// b * (n - m + i) / i == Binomial(n - m + i, i)
+		b = (b * (n - m + i)) / i;
 	}
 
-	// recursive function call
-	return Binomial(n-1, k) + Binomial(n-1, k-1);
+	return (int)b;
 }
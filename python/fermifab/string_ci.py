@@ -0,0 +1,147 @@
+import numpy as np
+from scipy.special import comb
+from scipy.sparse.linalg import LinearOperator
+from .fermiop import FermiOp
+from .sparse_state import _det_bits
+import fermifab.kernel
+
+__all__ = ['string_ci_dim', 'string_ci_dets', 'string_ci_rdm1', 'string_ci_rdm2', 'string_ci_spinfree_rdm', 'string_ci_sigma', 'string_ci_hamiltonian']
+
+
+# The CI space with 'Na' spin-up and 'Nb' spin-down electrons in 'norb' spatial orbitals is the
+# two-partition configuration orbs = (norb, norb), N = (Na, Nb), i.e., the product of alpha and beta strings.
+# The coefficient of the basis state with alpha string index 'ia' and beta string index 'ib'
+# is stored at 'ib*dim_alpha + ia', such that a CI vector reshaped to (dim_beta, dim_alpha)
+# is the coefficient matrix C[ib, ia].
+
+
+def string_ci_dim(norb, Na, Nb):
+    """
+    Dimension of the CI space with `Na` spin-up and `Nb` spin-down electrons in `norb` spatial orbitals.
+    """
+    return int(comb(norb, Na, exact=True) * comb(norb, Nb, exact=True))
+
+
+def string_ci_dets(norb, Na, Nb):
+    """
+    Bit-encoded Slater determinants of the CI basis, with the alpha string
+    in bits [0, norb) and the beta string in bits [norb, 2 norb).
+    """
+    assert 2*norb <= 64
+    sa = _det_bits(norb, Na)
+    sb = _det_bits(norb, Nb)
+    return (np.left_shift(sb, np.uint64(norb))[:, None] | sa[None, :]).reshape(-1)
+
+
+def string_ci_rdm1(psi, norb, Na, Nb):
+    """
+    Calculate the spin-resolved one-body reduced density matrices of a CI vector,
+    using precomputed single excitations of the alpha and beta strings.
+
+    Args:
+        psi:  CI vector of length `string_ci_dim(norb, Na, Nb)`
+        norb: number of spatial orbitals
+        Na:   number of spin-up electrons
+        Nb:   number of spin-down electrons
+
+    Returns:
+        tuple: alpha and beta one-body reduced density matrices (FermiOp)
+    """
+    psi = np.asarray(psi).reshape(-1)
+    Ga, Gb = fermifab.kernel.string_ci_rdm1(fermifab.kernel.string_ci_space(norb, Na, Nb), psi)
+    if np.isrealobj(psi):
+        Ga = Ga.real
+        Gb = Gb.real
+    return FermiOp(norb, 1, 1, data=Ga), FermiOp(norb, 1, 1, data=Gb)
+
+
+def string_ci_rdm2(psi, norb, Na, Nb):
+    """
+    Calculate the spin-resolved two-body reduced density matrices of a CI vector, i.e., the non-zero
+    blocks of the two-body reduced density matrix of the `2*norb` spin orbitals.
+
+    Args:
+        psi:  CI vector of length `string_ci_dim(norb, Na, Nb)`
+        norb: number of spatial orbitals
+        Na:   number of spin-up electrons
+        Nb:   number of spin-down electrons
+
+    Returns:
+        tuple: alpha-alpha and beta-beta two-body reduced density matrices (FermiOp), and the alpha-beta
+        block as `norb^2 x norb^2` matrix with respect to the pairs of an alpha orbital `i` and a beta
+        orbital `k` at index `k*norb + i`, in the order `(Gaa, Gab, Gbb)`
+    """
+    psi = np.asarray(psi).reshape(-1)
+    _, _, Gaa, Gab, Gbb, _ = fermifab.kernel.string_ci_rdm2(fermifab.kernel.string_ci_space(norb, Na, Nb), psi)
+    if np.isrealobj(psi):
+        Gaa = Gaa.real
+        Gab = Gab.real
+        Gbb = Gbb.real
+    return FermiOp(norb, 2, 2, data=Gaa), Gab, FermiOp(norb, 2, 2, data=Gbb)
+
+
+def string_ci_spinfree_rdm(psi, norb, Na, Nb):
+    """
+    Calculate the spin-summed one- and two-body reduced density matrices
+    :math:`\\gamma_{ij} = \\langle E_{ij} \\rangle` and
+    :math:`\\Gamma_{ijkl} = \\langle E_{ij} E_{kl} - \\delta_{jk} E_{il} \\rangle`
+    of a CI vector, such that the energy of the spin-free Hamiltonian in `string_ci_sigma` is
+    :math:`\\sum_{ij} h_{ij} \\gamma_{ij} + \\frac{1}{2} \\sum_{ijkl} g_{ijkl} \\Gamma_{ijkl}`.
+
+    Returns:
+        tuple: `norb x norb` matrix gamma and `norb x norb x norb x norb` tensor Gamma
+    """
+    psi = np.asarray(psi).reshape(-1)
+    # one-body reduced density matrices from the same pass
+    Ga, Gb, _, _, _, P = fermifab.kernel.string_ci_rdm2(fermifab.kernel.string_ci_space(norb, Na, Nb), psi)
+    # <E_ij> = G[j, i]
+    gamma = (Ga + Gb).T
+    if np.isrealobj(psi):
+        gamma = gamma.real
+        P = P.real
+    return gamma, P
+
+
+def string_ci_sigma(h, g, psi, norb, Na, Nb):
+    """
+    Apply the spin-free Hamiltonian
+    :math:`H = \\sum_{ij} h_{ij} E_{ij} + \\frac{1}{2} \\sum_{ijkl} g_{ijkl} (E_{ij} E_{kl} - \\delta_{jk} E_{il})`
+    with :math:`E_{ij} = \\sum_\\sigma a^\\dagger_{i\\sigma} a_{j\\sigma}` to a CI vector (sigma vector).
+
+    Args:
+        h:    one-body integrals, `norb x norb` matrix
+        g:    two-body integrals in chemists' notation (ij|kl), `norb x norb x norb x norb` array
+        psi:  CI vector of length `string_ci_dim(norb, Na, Nb)`
+        norb: number of spatial orbitals
+        Na:   number of spin-up electrons
+        Nb:   number of spin-down electrons
+
+    Returns:
+        numpy.ndarray: H psi
+    """
+    return _string_ci_sigma(fermifab.kernel.string_ci_space(norb, Na, Nb), np.asarray(h), np.asarray(g), psi)
+
+
+def _string_ci_sigma(space, h, g, psi):
+    """
+    Sigma vector using the excitation lists `space` returned by `fermifab.kernel.string_ci_space`.
+    """
+    psi = np.asarray(psi).reshape(-1)
+    sigma = fermifab.kernel.string_ci_sigma(space, h, g, psi)
+    if np.isrealobj(h) and np.isrealobj(g) and np.isrealobj(psi):
+        sigma = sigma.real
+    return sigma
+
+
+def string_ci_hamiltonian(h, g, norb, Na, Nb):
+    """
+    Spin-free Hamiltonian (see `string_ci_sigma`) on the CI space as matrix-free
+    `scipy.sparse.linalg.LinearOperator`, e.g., for use with `scipy.sparse.linalg.eigsh`.
+    """
+    h = np.asarray(h)
+    g = np.asarray(g)
+    dim = string_ci_dim(norb, Na, Nb)
+    dtype = np.result_type(h.dtype, g.dtype, float)
+    # excitation lists of the alpha and beta strings, built once and kept alive by the operator
+    space = fermifab.kernel.string_ci_space(norb, Na, Nb)
+    return LinearOperator((dim, dim), matvec=lambda psi: _string_ci_sigma(space, h, g, psi), dtype=dtype)
@@ -0,0 +1,144 @@
+import numpy as np
+from scipy.sparse import csr_matrix
+from .fermistate import FermiState
+from .fermiop import FermiOp
+from .rdm import kernel_expectation, kernel_operator
+import fermifab.kernel
+
+__all__ = ['FermiSymmetry', 'rdm_sym', 'p2N_sym', 'tensor_op_sym']
+
+
+class FermiSymmetry(object):
+
+    def __init__(self, labels, order=None, rule='xor'):
+        """
+        Abelian symmetry of the single-particle orbitals, e.g., spin projection Sz,
+        point group irreducible representations or crystal momentum.
+
+        The label of a Slater determinant is the combination of the labels of its occupied
+        orbitals, either by bitwise XOR (point groups like D2h, with irreducible representations
+        numbered as bit patterns) or by addition modulo `order` (e.g., momentum on a ring;
+        shift the labels to be non-negative for Sz).
+
+        Args:
+            labels: label in {0, ..., order - 1} of each orbital
+            order:  number of sectors (optional, default smallest power of 2 or
+                    smallest integer containing all labels for rule 'xor' or 'add', respectively)
+            rule:   'xor' or 'add'
+        """
+        self.labels = np.asarray(labels, dtype=np.intc)
+        assert self.labels.ndim == 1 and np.all(self.labels >= 0)
+        if rule not in ('xor', 'add'):
+            raise ValueError("rule must be 'xor' or 'add'")
+        self.rule = rule
+        if order is None:
+            order = int(self.labels.max()) + 1 if len(self.labels) > 0 else 1
+            if rule == 'xor':
+                order = 1 << (order - 1).bit_length()
+        self.order = order
+
+    @property
+    def orbs(self):
+        """Number of orbitals."""
+        return len(self.labels)
+
+    @property
+    def _rule_id(self):
+        return 0 if self.rule == 'xor' else 1
+
+    def combine(self, a, b):
+        """Combined label of two labels."""
+        return a ^ b if self.rule == 'xor' else (a + b) % self.order
+
+    def label(self, occ):
+        """Symmetry label of the Slater determinant with occupied orbitals `occ`."""
+        s = 0
+        for i in occ:
+            s = self.combine(s, int(self.labels[i]))
+        return s
+
+    def sectors(self, N):
+        """
+        Base indices (w.r.t. the ordered Slater basis of all N-particle states) of the Slater
+        determinants in each symmetry sector, as list of length `order`.
+        """
+        dets, offset = fermifab.kernel.fermi_map_sectors((self.orbs,), (N,), self.labels, self.order, self._rule_id)
+        idx = fermifab.kernel.fermi_index(dets)
+        return [idx[offset[s]:offset[s+1]] for s in range(self.order)]
+
+
+def rdm_sym(psi, p, sym, target, N=None):
+    """
+    Calculate the p-body reduced density matrix of a N-body state with well-defined symmetry label `target`,
+    exploiting that it is block-diagonal with respect to the symmetry sectors of the p-particle space.
+
+    Args:
+        psi:    `FermiState` with support in sector `target`, or its coefficients w.r.t. the
+                Slater determinants in this sector (see `FermiSymmetry.sectors`)
+        p:      target particle number
+        sym:    orbital symmetry of type `FermiSymmetry`
+        target: symmetry label of the state
+        N:      number of particles (only required if `psi` is a coefficient vector)
+
+    Returns:
+        list: diagonal blocks of the reduced density matrix, indexed by sector,
+        w.r.t. the p-particle Slater determinants of `sym.sectors(p)`
+    """
+    if type(psi) == FermiState:
+        assert psi.orbs == sym.orbs
+        N = psi.N
+        psi = psi.data[sym.sectors(N)[target]]
+    psi = np.asarray(psi).reshape(-1)
+    dims, val, ind, offsetP, _ = fermifab.kernel.gen_rdm_sym((sym.orbs,), (p,), (N,), (N,),
+        sym.labels, sym.order, sym._rule_id, target, target)
+    assert dims[2] == len(psi)
+    G = kernel_expectation(dims, val, ind, psi)
+    return [G[offsetP[s]:offsetP[s+1], offsetP[s]:offsetP[s+1]] for s in range(sym.order)]
+
+
+def p2N_sym(h, N, sym, target):
+    """
+    Calculate the block of the N-body operator :math:`H = \\sum_{ij} h_{ij} \\, a^\\dagger_i a_j`
+    generated from the p-body operator `h` (commuting with the symmetry) on sector `target`.
+
+    Args:
+        h:      p-body operator of type `FermiOp`
+        N:      number of particles
+        sym:    orbital symmetry of type `FermiSymmetry`
+        target: symmetry label
+
+    Returns:
+        scipy.sparse.csr_matrix: operator block w.r.t. the Slater determinants in `sym.sectors(N)[target]`
+    """
+    assert type(h) == FermiOp and h.orbs == sym.orbs and h.pFrom == h.pTo
+    p = h.pFrom
+    dims, val, ind, offsetP, _ = fermifab.kernel.gen_rdm_sym((sym.orbs,), (p,), (N,), (N,),
+        sym.labels, sym.order, sym._rule_id, target, target)
+    # reorder h according to the p-particle symmetry sectors
+    perm = np.concatenate(sym.sectors(p))
+    hs = np.asarray(h.data)[np.ix_(perm, perm)]
+    return kernel_operator(dims, val, ind, hs)
+
+
+def tensor_op_sym(op, N, sym):
+    """
+    Calculate the diagonal blocks of the N-fold tensor product of an operator
+    commuting with the symmetry, i.e., not coupling orbitals with different labels.
+
+    Args:
+        op:  quantum operator of type `FermiOp`, with `pFrom` and `pTo` equal to 1
+        N:   number of tensor factors
+        sym: orbital symmetry of type `FermiSymmetry`
+
+    Returns:
+        list: blocks of type `scipy.sparse.csr_matrix` indexed by sector,
+        w.r.t. the Slater determinants of `sym.sectors(N)`
+    """
+    if op.pFrom != 1 or op.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    assert op.orbs == sym.orbs
+    blocks = []
+    for s in range(sym.order):
+        dims, val, ind = fermifab.kernel.tensor_op_sym(op.data, N, sym.labels, sym.order, sym._rule_id, s)
+        blocks.append(csr_matrix((val, (ind[:, 0], ind[:, 1])), shape=dims))
+    return blocks
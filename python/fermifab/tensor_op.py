@@ -1,8 +1,10 @@
+import numpy as np
 from scipy.sparse import csr_matrix
+from scipy.special import binom
 from .fermiop import FermiOp
 import fermifab.kernel
 
-__all__ = ['tensor_op']
+__all__ = ['tensor_op', 'tensor_op_diag', 'tensor_op_trace', 'tensor_op_eigvals', 'grand_partition']
 
 
 def tensor_op(op, N):
@@ -22,3 +24,103 @@ def tensor_op(op, N):
     # finally convert to dense matrix, for simplicity
     AN = csr_matrix((val, (ind[:, 0], ind[:, 1])), shape=dims).todense()
     return FermiOp(op.orbs, N, N, data=AN)
+
+
+def tensor_op_diag(op, N):
+    """
+    Calculate the diagonal of the matrix representation of the N-fold tensor product of an operator,
+    i.e., its principal N x N minors, without constructing the full tensor product.
+
+    Args:
+        op: quantum operator of type `FermiOp`, with `pFrom` and `pTo` equal to 1
+        N:  number of tensor factors
+
+    Returns:
+        numpy.ndarray: diagonal entries w.r.t. the ordered Slater basis
+    """
+    if op.pFrom != 1 or op.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    return fermifab.kernel.tensor_op_diag(op.data, N)
+
+
+def _is_hermitian(A):
+    return np.allclose(A, A.conj().T)
+
+
+def tensor_op_trace(op):
+    """
+    Calculate the traces of the N-fold tensor products of an operator
+    for all N = 0, ..., orbs at once, without constructing the tensor products.
+
+    The trace for N particles is the N-th elementary symmetric polynomial
+    of the eigenvalues of the operator.
+
+    Args:
+        op: quantum operator of type `FermiOp`, with `pFrom` and `pTo` equal to 1
+
+    Returns:
+        numpy.ndarray: vector of length `orbs + 1` whose N-th entry equals `trace(tensor_op(op, N))`
+    """
+    if op.pFrom != 1 or op.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    if _is_hermitian(op.data):
+        lam = np.linalg.eigvalsh(op.data)
+    else:
+        lam = np.linalg.eigvals(op.data)
+    e = fermifab.kernel.elem_sym_poly(lam)
+    if np.isrealobj(op.data):
+        e = e.real
+    return e
+
+
+def tensor_op_eigvals(op, N, k=None):
+    """
+    Calculate the eigenvalues of largest magnitude of the N-fold tensor product of an operator,
+    without constructing the tensor product.
+
+    The eigenvalues are the products of N-subsets of the eigenvalues of the operator.
+
+    Args:
+        op: quantum operator of type `FermiOp`, with `pFrom` and `pTo` equal to 1
+        N:  number of tensor factors
+        k:  number of eigenvalues (optional, all eigenvalues by default)
+
+    Returns:
+        numpy.ndarray: eigenvalues sorted by descending magnitude
+    """
+    if op.pFrom != 1 or op.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    if k is None:
+        k = int(binom(op.orbs, N))
+    hermitian = _is_hermitian(op.data)
+    if hermitian:
+        lam = np.linalg.eigvalsh(op.data)
+    else:
+        lam = np.linalg.eigvals(op.data)
+    mu, _ = fermifab.kernel.subset_prod(lam, N, k)
+    if hermitian:
+        mu = mu.real
+    return mu
+
+
+def grand_partition(h, beta, mu=0):
+    """
+    Calculate the grand-canonical partition function of a one-body Hamiltonian
+    :math:`Z = \\mathrm{tr}(e^{-\\beta (H - \\mu N)}) = \\sum_N e^{\\beta \\mu N} Z_N`
+    on the fermionic Fock space.
+
+    Args:
+        h:    Hermitian one-body Hamiltonian of type `FermiOp`, with `pFrom` and `pTo` equal to 1
+        beta: inverse temperature
+        mu:   chemical potential (optional)
+
+    Returns:
+        tuple: grand-canonical partition function `Z` and vector of
+               canonical partition functions `Z_N` for N = 0, ..., orbs
+    """
+    if h.pFrom != 1 or h.pTo != 1:
+        raise ValueError('operator particle numbers must be equal to 1')
+    eps = np.linalg.eigvalsh(h.data)
+    ZN = fermifab.kernel.elem_sym_poly(np.exp(-beta*eps)).real
+    Z = np.dot(np.exp(beta*mu*np.arange(len(ZN))), ZN)
+    return Z, ZN
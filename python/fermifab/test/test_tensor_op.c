@@ -121,6 +121,18 @@ int TestTensorOp(void)
 
 		err += UniformDistance(nelem, ANd, AN_ref);
 
+		// diagonal only
+		double *ANdiag = (double *)malloc(AN.dims[0] * sizeof(double));
+		if (ANdiag == NULL) { return -1; }
+		status = TensorOpDiag(orbs, N, A, ANdiag);
+		if (status < 0) { return status; }
+		int i;
+		for (i = 0; i < AN.dims[0]; i++)
+		{
+			err += fabs(ANdiag[i] - AN_ref[i*(AN.dims[0] + 1)]);
+		}
+		free(ANdiag);
+
 		free(AN_ref);
 		free(ANd);
 		DeleteSparseArray(&AN);
@@ -148,6 +160,18 @@ int TestTensorOp(void)
 
 		err += UniformDistanceComplex(nelem, BNd, BN_ref);
 
+		// diagonal only
+		double complex *BNdiag = (double complex *)malloc(BN.dims[0] * sizeof(double complex));
+		if (BNdiag == NULL) { return -1; }
+		status = TensorOpDiagComplex(orbs, N, B, BNdiag);
+		if (status < 0) { return status; }
+		int i;
+		for (i = 0; i < BN.dims[0]; i++)
+		{
+			err += cabs(BNdiag[i] - BN_ref[i*(BN.dims[0] + 1)]);
+		}
+		free(BNdiag);
+
 		free(BN_ref);
 		free(BNd);
 		DeleteSparseComplexArray(&BN);
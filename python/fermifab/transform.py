@@ -0,0 +1,80 @@
+import numpy as np
+from .fermistate import FermiState
+from .fermiop import FermiOp
+import fermifab.kernel
+
+__all__ = ['orbital_perm', 'particle_hole_perm', 'perm_orbitals', 'particle_hole']
+
+
+def orbital_perm(sigma, N):
+    """
+    Index map and fermionic sign of the Slater determinants of `N` particles
+    under the orbital permutation `sigma` (old orbital k -> new orbital sigma[k]).
+
+    Returns:
+        tuple: `(perm, sign)` such that the permuted state is `sign * psi[perm]`
+    """
+    return fermifab.kernel.orbital_perm(np.asarray(sigma, dtype=np.intc), N)
+
+
+def particle_hole_perm(orbs, N):
+    """
+    Index map and sign of the particle-hole conjugation :math:`|D\\rangle \\mapsto \\epsilon_D |\\bar{D}\\rangle`
+    from `N` to `orbs - N` particles, with :math:`|D\\rangle \\wedge |\\bar{D}\\rangle = \\epsilon_D |0 1 \\dots\\rangle`.
+
+    Returns:
+        tuple: `(perm, sign)` such that the conjugated state is `sign * psi[perm]`
+    """
+    return fermifab.kernel.particle_hole_perm(orbs, N)
+
+
+def _permute_state_data(x, perm, sign, inplace):
+    if inplace:
+        if x.data.dtype not in (np.float64, np.complex128) or not x.data.flags.c_contiguous:
+            x.data = np.ascontiguousarray(x.data, dtype=np.result_type(x.data.dtype, float))
+        fermifab.kernel.permute_inplace(x.data, perm, sign)
+        return x.data
+    return fermifab.kernel.permute_gather(x.data, perm, sign)
+
+
+def perm_orbitals(x, sigma, inplace=False):
+    """
+    Transform a state or operator under the orbital permutation `sigma` (old orbital k -> new orbital sigma[k]),
+    as signed index gather in O(dim) operations instead of multiplying by the permutation matrix.
+
+    Args:
+        x:       `FermiState` or `FermiOp`
+        sigma:   permutation of the orbitals
+        inplace: overwrite the data of a `FermiState` (optional)
+
+    Returns:
+        transformed `FermiState` or `FermiOp`
+    """
+    assert len(sigma) == x.orbs
+    if type(x) == FermiState:
+        perm, sign = orbital_perm(sigma, x.N)
+        data = _permute_state_data(x, perm, sign, inplace)
+        return x if inplace else FermiState(x.orbs, x.N, data=data)
+    elif type(x) == FermiOp:
+        assert not inplace, 'in-place transformation is only supported for states'
+        permTo,   signTo   = orbital_perm(sigma, x.pTo)
+        permFrom, signFrom = orbital_perm(sigma, x.pFrom)
+        data = fermifab.kernel.permute_gather_matrix(x.data, permTo, permFrom, signTo, signFrom)
+        return FermiOp(x.orbs, x.pFrom, x.pTo, data=data)
+    raise TypeError("x must be a FermiState or FermiOp.")
+
+
+def particle_hole(x):
+    """
+    Particle-hole conjugation of a state (N -> orbs - N particles) or operator,
+    as signed index gather (see `particle_hole_perm`).
+    """
+    if type(x) == FermiState:
+        perm, sign = particle_hole_perm(x.orbs, x.N)
+        return FermiState(x.orbs, x.orbs - x.N, data=fermifab.kernel.permute_gather(x.data, perm, sign))
+    elif type(x) == FermiOp:
+        permTo,   signTo   = particle_hole_perm(x.orbs, x.pTo)
+        permFrom, signFrom = particle_hole_perm(x.orbs, x.pFrom)
+        data = fermifab.kernel.permute_gather_matrix(x.data, permTo, permFrom, signTo, signFrom)
+        return FermiOp(x.orbs, x.orbs - x.pFrom, x.orbs - x.pTo, data=data)
+    raise TypeError("x must be a FermiState or FermiOp.")
@@ -2,8 +2,10 @@ import numpy as np
 from scipy.sparse import issparse
 from .fermistate import FermiState
 from .fermiop import FermiOp
+import fermifab.kernel
 
-__all__ = ['crand', 'norm', 'kron', 'trace', 'trace_prod', 'matrix_power', 'eig', 'comprise_config']
+__all__ = ['crand', 'norm', 'kron', 'trace', 'trace_prod', 'matrix_power', 'eig', 'comprise_config',
+           'comprise_perm', 'permute_state', 'permute_op']
 
 
 def crand(*args):
@@ -101,3 +103,43 @@ def comprise_config(orbs1, orbs2, N1, N2):
     m2 = m2[:-1]
 
     return m1, m2, orbs, N
+
+
+def comprise_perm(orbs1, N1, orbs2, N2):
+    """
+    Index permutation between two partition layouts of the same orbitals and particle number,
+    e.g., a partitioned and a merged basis (see `comprise_config`).
+
+    The orbitals of all partitions are numbered consecutively, and the Slater determinants
+    of a layout are ordered as by `fermi2coords` (first partition varying fastest).
+
+    Returns:
+        numpy.ndarray: for each basis index of layout 2, the index of the same Slater determinant
+        with respect to layout 1, or -1 if it is not contained in layout 1
+    """
+    return fermifab.kernel.comprise_perm(np.atleast_1d(orbs1), np.atleast_1d(N1), np.atleast_1d(orbs2), np.atleast_1d(N2))
+
+
+def permute_state(x, perm, sign=None):
+    """
+    Reorder a state vector by the gather `y[i] = sign[i] * x[perm[i]]` (zero for negative `perm[i]`),
+    e.g., with `perm` from `comprise_perm`.
+    """
+    if sign is not None:
+        sign = np.asarray(sign, dtype=np.intc)
+    return fermifab.kernel.permute_gather(x, np.asarray(perm, dtype=np.intc), sign)
+
+
+def permute_op(A, perm1, perm2=None, sign1=None, sign2=None):
+    """
+    Reorder the rows and columns of an operator by the gather
+    `B[i, j] = sign1[i] * sign2[j] * A[perm1[i], perm2[j]]` (zero for negative indices),
+    with `perm2` and `sign2` defaulting to `perm1` and `sign1`.
+    """
+    if perm2 is None:
+        perm2, sign2 = perm1, sign1
+    if sign1 is not None:
+        sign1 = np.asarray(sign1, dtype=np.intc)
+    if sign2 is not None:
+        sign2 = np.asarray(sign2, dtype=np.intc)
+    return fermifab.kernel.permute_gather_matrix(A, np.asarray(perm1, dtype=np.intc), np.asarray(perm2, dtype=np.intc), sign1, sign2)
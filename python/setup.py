@@ -4,11 +4,12 @@ from numpy.distutils.core import setup, Extension
 
 os.chdir(os.path.dirname(os.path.abspath(__file__)))
 
-srcfiles = ['fermifab_module.c', 'bitfield.c', 'boson_map.c', 'fermi_map.c', 'generate_rdm.c', 'sparse.c', 'tensor_op.c', 'util.c']
+srcfiles = ['fermifab_module.c', 'bitfield.c', 'boson_map.c', 'compact_kernel.c', 'comprise.c', 'excitation_graph.c', 'fermi_map.c', 'fermi_union.c', 'generate_rdm.c', 'generate_rdm_boson.c', 'hamiltonian.c', 'integrals.c', 'restricted_space.c', 'selected_ci.c', 'slater_rdm.c', 'sparse.c', 'sparse_state.c', 'string_ci.c', 'tensor_op.c', 'tensor_op_boson.c', 'tensor_spectrum.c', 'util.c']
 module = Extension('fermifab.kernel',
                    sources=['fermifab/src/' + file for file in srcfiles],
                    include_dirs=['fermifab/include', '/usr/include/x86_64-linux-gnu'],
-                   extra_link_args=['-lm', '-lblas', '-llapacke'])
+                   extra_compile_args=['-fopenmp'],
+                   extra_link_args=['-lm', '-lblas', '-llapacke', '-fopenmp'])
 
 setup(
     name='fermifab',
@@ -0,0 +1,113 @@
+import itertools
+import numpy as np
+from scipy.linalg import expm
+from scipy.special import comb
+import fermifab
+import unittest
+
+
+class TestBoson(unittest.TestCase):
+
+    def test_rank(self):
+        modes = 4
+        N = 5
+        occ = np.array([n for n in itertools.product(range(N + 1), repeat=modes) if sum(n) == N])
+        self.assertEqual(len(occ), fermifab.boson_dim(modes, N))
+        # reference ordering: numerical order of the "stars and bars" bit patterns
+        w = fermifab.boson_encode(occ)
+        self.assertEqual(w.shape[1], 1)
+        occ_ref = occ[np.argsort(w[:, 0])]
+        r = fermifab.boson_rank(occ_ref)
+        self.assertTrue(np.array_equal(r, np.arange(len(occ))))
+        self.assertTrue(np.array_equal(fermifab.boson_unrank(modes, N, r), occ_ref))
+
+    def test_large_particle_number(self):
+        modes = 6
+        N = 1000
+        occ = np.random.multinomial(N, np.ones(modes) / modes, size=20)
+        r = fermifab.boson_rank(occ)
+        self.assertTrue(np.all((r >= 0) & (r < fermifab.boson_dim(modes, N))))
+        self.assertTrue(np.array_equal(fermifab.boson_unrank(modes, N, r), occ))
+        # multi-word encoding
+        w = fermifab.boson_encode(occ)
+        self.assertEqual(w.shape[1], (modes + N - 1 + 63) // 64)
+        self.assertTrue(np.array_equal(fermifab.boson_decode(modes, w), occ))
+        # extremal states
+        self.assertEqual(fermifab.boson_rank([N] + [0]*(modes - 1)), 0)
+        self.assertEqual(fermifab.boson_rank([0]*(modes - 1) + [N]), fermifab.boson_dim(modes, N) - 1)
+
+    def test_word_boundary(self):
+        # modes + N - 1 is a multiple of 64, such that the implicit last separator lies beyond the last word
+        for occ in [[[20, 20, 22], [62, 0, 0], [0, 0, 62]], [[30, 31, 32, 31, 0], [0, 0, 0, 0, 124]]]:
+            occ = np.array(occ)
+            modes = occ.shape[1]
+            w = fermifab.boson_encode(occ)
+            self.assertEqual(w.shape[1], (modes + occ[0].sum() - 1) // 64)
+            self.assertTrue(np.array_equal(fermifab.boson_decode(modes, w), occ))
+
+    @staticmethod
+    def _symmetric_basis(modes, N):
+        # normalized symmetric tensors of the occupation number basis states, as columns
+        r = np.arange(fermifab.boson_dim(modes, N))
+        occ = fermifab.boson_unrank(modes, N, r)
+        V = np.zeros((modes**N, len(r)))
+        for k, n in enumerate(occ):
+            x = np.repeat(np.arange(modes), n)
+            for perm in set(itertools.permutations(x)):
+                V[np.ravel_multi_index(perm, (modes,)*N), k] = 1
+            V[:, k] /= np.linalg.norm(V[:, k])
+        return V
+
+    def test_tensor_op(self):
+        for modes, N, real_valued in [(3, 3, True), (4, 2, False), (2, 4, False), (3, 1, True), (3, 0, True)]:
+            A = np.random.randn(modes, modes) if real_valued else fermifab.crand(modes, modes)
+            AN = fermifab.boson_tensor_op(A, N)
+            V = self._symmetric_basis(modes, N)
+            AN_ref = np.ones((1, 1))
+            for _ in range(N):
+                AN_ref = np.kron(AN_ref, A)
+            AN_ref = V.T @ AN_ref @ V
+            self.assertEqual(AN.dtype, AN_ref.dtype)
+            self.assertAlmostEqual(np.linalg.norm(AN - AN_ref), 0)
+        # homomorphism property for larger particle numbers
+        modes, N = 3, 8
+        A = fermifab.crand(modes, modes)
+        B = fermifab.crand(modes, modes)
+        err = np.linalg.norm(fermifab.boson_tensor_op(A @ B, N) - fermifab.boson_tensor_op(A, N) @ fermifab.boson_tensor_op(B, N))
+        self.assertAlmostEqual(err / np.linalg.norm(fermifab.boson_tensor_op(A @ B, N)), 0)
+
+    def test_rdm(self):
+        for modes, N, p in [(3, 4, 1), (3, 4, 2), (4, 3, 3), (2, 5, 0)]:
+            psi = fermifab.crand(fermifab.boson_dim(modes, N))
+            psi /= np.linalg.norm(psi)
+            G = fermifab.boson_rdm(psi, modes, N, p)
+            self.assertAlmostEqual(np.linalg.norm(G - fermifab.boson_rdm(psi, modes, N, p, use_kernel=True)), 0)
+            self.assertAlmostEqual(np.linalg.norm(G - G.conj().T), 0)
+            self.assertAlmostEqual(abs(np.trace(G) - comb(N, p)), 0)
+            if p == N:
+                self.assertAlmostEqual(np.linalg.norm(G - np.outer(psi, psi.conj())), 0)
+            # expectation value of lifted operator
+            dp = fermifab.boson_dim(modes, p)
+            h = fermifab.crand(dp, dp)
+            H = fermifab.boson_p2N(h, modes, p, N)
+            self.assertAlmostEqual(abs(np.vdot(psi, H @ psi) - np.trace(h @ G)), 0)
+            # matrix-free application
+            Hop = fermifab.boson_p2N(h, modes, p, N, matrix_free=True)
+            self.assertAlmostEqual(np.linalg.norm(Hop @ psi - H @ psi), 0)
+        # all particles in the first mode
+        modes, N = 4, 5
+        psi = np.zeros(fermifab.boson_dim(modes, N))
+        psi[0] = 1
+        G = fermifab.boson_rdm(psi, modes, N, 1)
+        self.assertAlmostEqual(np.linalg.norm(G - np.diag([N, 0, 0, 0])), 0)
+
+    def test_p2N_tensor_op(self):
+        # the lifted one-body operator generates the symmetric tensor product
+        modes, N = 3, 4
+        h = 0.5*fermifab.crand(modes, modes)
+        H = fermifab.boson_p2N(h, modes, 1, N)
+        self.assertAlmostEqual(np.linalg.norm(expm(H) - fermifab.boson_tensor_op(expm(h), N)), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,58 @@
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestComprise(unittest.TestCase):
+
+    def _dets(self, orbs, N):
+        coords = fermifab.kernel.fermi2coords(orbs, N).astype(np.uint64)
+        return np.bitwise_or.reduce(np.left_shift(np.uint64(1), coords), axis=1)
+
+    def _perm_ref(self, orbs1, N1, orbs2, N2):
+        dets1 = list(self._dets(orbs1, N1))
+        return np.array([dets1.index(d) if d in dets1 else -1 for d in self._dets(orbs2, N2)])
+
+    def test_perm(self):
+        for orbs1, N1, orbs2, N2 in [((3, 4, 6), (1, 2, 4), (7, 6), (3, 4)),
+                                     ((7, 6), (3, 4), (3, 4, 6), (1, 2, 4)),
+                                     ((4, 3), (2, 1), (2, 5), (1, 2)),
+                                     ((5,), (3,), (2, 3), (1, 2))]:
+            perm = fermifab.comprise_perm(orbs1, N1, orbs2, N2)
+            self.assertTrue(np.array_equal(perm, self._perm_ref(orbs1, N1, orbs2, N2)))
+
+    def test_merge_matches_comprise_config(self):
+        orbs1, N1 = np.array([3, 4, 6]), np.array([1, 2, 4])
+        orbs2, N2 = np.array([7, 6]), np.array([3, 4])
+        _, _, orbs, N = fermifab.comprise_config(orbs1, orbs2, N1, N2)
+        self.assertEqual(list(orbs), [7, 6])
+        # every determinant of the finer layout is found in the merged one
+        perm = fermifab.comprise_perm(orbs, N, orbs1, N1)
+        self.assertTrue(np.all(perm >= 0))
+        self.assertEqual(len(np.unique(perm)), len(perm))
+
+    def test_permute(self):
+        orbs1, N1, orbs2, N2 = (3, 4, 6), (1, 2, 4), (7, 6), (3, 4)
+        perm1 = fermifab.comprise_perm(orbs1, N1, orbs2, N2)
+        perm2 = fermifab.comprise_perm(orbs2, N2, orbs1, N1)
+        for real_valued in [True, False]:
+            n = len(perm2)
+            x = np.random.randn(n) if real_valued else fermifab.crand(n)
+            y = fermifab.permute_state(x, perm1)
+            self.assertEqual(y.dtype, x.dtype)
+            y_ref = np.where(perm1 >= 0, x[np.maximum(perm1, 0)], 0)
+            self.assertTrue(np.array_equal(y, y_ref))
+            # round trip
+            self.assertTrue(np.array_equal(fermifab.permute_state(y, perm2), x))
+            sign = np.random.choice([-1, 1], len(perm1))
+            self.assertTrue(np.array_equal(fermifab.permute_state(x, perm1, sign), sign*y_ref))
+            A = np.random.randn(n, n) if real_valued else fermifab.crand(n, n)
+            B = fermifab.permute_op(A, perm1, sign1=sign)
+            mask = np.outer(perm1 >= 0, perm1 >= 0)
+            B_ref = np.outer(sign, sign) * np.where(mask, A[np.ix_(np.maximum(perm1, 0), np.maximum(perm1, 0))], 0)
+            self.assertTrue(np.allclose(B, B_ref))
+            self.assertTrue(np.array_equal(fermifab.permute_op(B, perm2, sign1=sign[perm2]), A))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,59 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+from test_symmetry import _embedded_state, _p2N_block
+
+
+class TestConfigUnion(unittest.TestCase):
+
+    def test_gen_config(self):
+        C = fermifab.gen_config(3, 2)
+        self.assertTrue(np.array_equal(C, [[2, 0, 0], [1, 1, 0], [0, 2, 0], [1, 0, 1], [0, 1, 1], [0, 0, 2]]))
+        C = fermifab.gen_config(3, 2, [2, 2, 1])
+        self.assertTrue(np.array_equal(C, [[2, 0, 0], [1, 1, 0], [0, 2, 0], [1, 0, 1], [0, 1, 1]]))
+        self.assertEqual(len(fermifab.gen_config(2, 5, [2, 2])), 0)
+        # compare with filtering all configurations
+        maxC = [3, 2, 4, 1]
+        C_all = fermifab.gen_config(4, 6)
+        C_ref = [c for c in C_all if all(c[i] <= maxC[i] for i in range(4))]
+        self.assertTrue(np.array_equal(fermifab.gen_config(4, 6, maxC), C_ref))
+
+    def test_union(self):
+        orbs = (3, 4, 2)
+        N = 4
+        configs = fermifab.gen_config(len(orbs), N, orbs)
+        u = fermifab.ConfigUnion(orbs, configs)
+        # all configurations together span the Slater basis of all orbitals
+        self.assertEqual(len(u), int(binom(sum(orbs), N)))
+        self.assertTrue(np.array_equal(u.index(u.dets), np.arange(len(u))))
+        for s in range(len(configs)):
+            dets = u.dets[u.sector(s)]
+            for k in range(len(orbs)):
+                part = (dets >> np.uint64(sum(orbs[:k]))) & np.uint64((1 << orbs[k]) - 1)
+                self.assertTrue(all(bin(int(d)).count('1') == configs[s][k] for d in part))
+
+    def test_rdm(self):
+        orbs = (3, 3, 2)
+        # subset of the configurations of 3 particles
+        configs = fermifab.gen_config(3, 3, [2, 1, 1])[::2]
+        u = fermifab.ConfigUnion(orbs, configs)
+        psi, phi = _embedded_state(u.norbs, u.N, u.embedding())
+        for p in [1, 2]:
+            G = u.rdm(psi, p)
+            G_ref = fermifab.rdm(phi, p)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+
+    def test_p2N(self):
+        orbs = (2, 3, 2)
+        configs = [[1, 1, 1], [2, 1, 0], [0, 2, 1]]
+        u = fermifab.ConfigUnion(orbs, configs)
+        idx = u.embedding()
+        for p in [1, 2]:
+            m = int(binom(u.norbs, p))
+            h = fermifab.FermiOp(u.norbs, p, p, data=fermifab.crand(m, m))
+            self.assertAlmostEqual(np.linalg.norm(u.p2N(h).toarray() - _p2N_block(h, u.N, idx)), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
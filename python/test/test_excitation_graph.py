@@ -0,0 +1,62 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestExcitationGraph(unittest.TestCase):
+
+    def test_rdm(self):
+        for orbs, N, p, real_valued in [(7, 3, 1, True), (7, 4, 2, False), (6, 2, 2, True), (5, 3, 0, False)]:
+            n = int(binom(orbs, N))
+            data = np.random.randn(n) if real_valued else fermifab.crand(n)
+            psi = fermifab.FermiState(orbs, N, data=data/np.linalg.norm(data))
+            graph = fermifab.ExcitationGraph(orbs, N)
+            G = graph.rdm(psi, p)
+            G_ref = fermifab.rdm(psi, p)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+
+    def test_apply(self):
+        for orbs, N, p in [(7, 3, 1), (7, 4, 2), (6, 3, 2)]:
+            n = int(binom(orbs, N))
+            m = int(binom(orbs, p))
+            h = fermifab.FermiOp(orbs, p, p, data=fermifab.crand(m, m))
+            psi = fermifab.FermiState(orbs, N, data=fermifab.crand(n))
+            graph = fermifab.ExcitationGraph(orbs, N, level=p)
+            H = fermifab.p2N(h, N)
+            chi = graph.apply(h, psi)
+            self.assertAlmostEqual(np.linalg.norm(chi.data - H.data @ psi.data), 0)
+            Hop = graph.p2N(h)
+            self.assertAlmostEqual(np.linalg.norm(Hop @ psi.data - H.data @ psi.data), 0)
+
+    def test_partitions(self):
+        # two partitions, e.g., spin-up and spin-down orbitals
+        norb, Na, Nb = 4, 2, 1
+        graph = fermifab.ExcitationGraph((norb, norb), (Na, Nb))
+        psi = fermifab.crand(len(graph))
+        psi /= np.linalg.norm(psi)
+        # reference: embedding into the Slater basis of all orbitals
+        idx = fermifab.kernel.fermi_index(fermifab.string_ci_dets(norb, Na, Nb))
+        data = np.zeros(int(binom(2*norb, Na + Nb)), dtype=complex)
+        data[idx] = psi
+        phi = fermifab.FermiState(2*norb, Na + Nb, data=data)
+        for p in [1, 2]:
+            G = graph.rdm(psi, p)
+            G_ref = fermifab.rdm(phi, p)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+        # particle number conserving operator within each partition
+        e = np.zeros((2*norb, 2*norb), dtype=complex)
+        e[:norb, :norb] = fermifab.crand(norb, norb)
+        e[norb:, norb:] = fermifab.crand(norb, norb)
+        h = fermifab.FermiOp(2*norb, 1, 1, data=e)
+        H = fermifab.p2N(h, Na + Nb).data[np.ix_(idx, idx)]
+        self.assertAlmostEqual(np.linalg.norm(graph.apply(h, psi) - H @ psi), 0)
+        # number of stored excitations
+        self.assertEqual(len(graph.singles[0]), len(graph) + 1)
+        # views of the graphs owned by the kernel
+        self.assertFalse(graph.singles[1].flags.writeable)
+        self.assertIsNone(fermifab.ExcitationGraph((norb, norb), (Na, Nb), level=1).doubles)
+
+
+if __name__ == '__main__':
+    unittest.main()
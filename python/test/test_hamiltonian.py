@@ -0,0 +1,97 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+from test_integrals import _random_integrals
+
+
+def _fock_hamiltonian(h, v, ecore):
+    """
+    Reference Hamiltonian on the Fock space of the 2*norb spin orbitals (alpha first),
+    with annihilation operators constructed by the Jordan-Wigner transformation.
+    """
+    norb = h.shape[0]
+    L = 2*norb
+    # basis state index = bit pattern of occupied orbitals
+    a = []
+    for p in range(L):
+        ap = np.zeros((2**L, 2**L))
+        for x in range(2**L):
+            if x & (1 << p):
+                ap[x ^ (1 << p), x] = (-1)**bin(x & ((1 << p) - 1)).count('1')
+        a.append(ap)
+    H = ecore * np.identity(2**L)
+    for p in range(L):
+        for q in range(L):
+            if p // norb == q // norb:
+                H += h[p % norb, q % norb] * a[p].T @ a[q]
+    for p in range(L):
+        for q in range(L):
+            if p // norb != q // norb:
+                continue
+            for r in range(L):
+                for s in range(L):
+                    if r // norb != s // norb:
+                        continue
+                    H += 0.5 * v[p % norb, q % norb, r % norb, s % norb] * a[p].T @ a[r].T @ a[s] @ a[q]
+    return H
+
+
+class TestHamiltonian(unittest.TestCase):
+
+    def test_slater_condon(self):
+        norb = 3
+        h, v = _random_integrals(norb)
+        ints = fermifab.Integrals(h, v, ecore=0.3)
+        Hfock = _fock_hamiltonian(h, v, 0.3)
+        for N in [1, 2, 3, 4, 5, (1, 1), (2, 1), (0, 3), (2, 2)]:
+            H = ints.hamiltonian(N)
+            if np.isscalar(N):
+                orbs, Nc = (2*norb,), (N,)
+            else:
+                orbs, Nc = (norb, norb), N
+            coords = fermifab.kernel.fermi2coords(orbs, Nc).astype(np.int64)
+            dets = np.sum(np.left_shift(1, coords), axis=1)
+            H_ref = Hfock[np.ix_(dets, dets)]
+            self.assertEqual(H.shape, 2*(len(dets),))
+            self.assertAlmostEqual(np.linalg.norm(H.toarray() - H_ref), 0, delta=1e-12)
+            # diagonal entry first, then off-diagonal entries in ascending column order
+            for i in range(H.shape[0]):
+                cols = H.indices[H.indptr[i]:H.indptr[i+1]]
+                self.assertEqual(cols[0], i)
+                self.assertTrue(np.all(np.diff(cols[1:]) > 0))
+
+    def test_matrix_element(self):
+        norb = 4
+        h, v = _random_integrals(norb)
+        ints = fermifab.Integrals(h, v, ecore=-0.6)
+        # all determinants with 2 alpha and 2 beta electrons
+        coords = fermifab.kernel.fermi2coords((norb, norb), (2, 2)).astype(np.int64)
+        dets = np.sum(np.left_shift(1, coords), axis=1).astype(np.uint64)
+        H = ints.hamiltonian((2, 2)).toarray()
+        self.assertAlmostEqual(np.linalg.norm(ints.matrix_block(dets, dets) - H), 0, delta=1e-12)
+        # random pairs
+        k = np.random.randint(len(dets), size=50)
+        l = np.random.randint(len(dets), size=50)
+        self.assertAlmostEqual(np.linalg.norm(ints.matrix_element(dets[k], dets[l]) - H[k, l]), 0, delta=1e-12)
+        self.assertAlmostEqual(ints.matrix_element(dets[3], dets[7]), H[3, 7], delta=1e-12)
+        # rows w.r.t. a subset of the determinants
+        self.assertAlmostEqual(np.linalg.norm(ints.matrix_block(dets[k[:5]], dets[l]) - H[np.ix_(k[:5], l)]), 0, delta=1e-12)
+        # different particle numbers and triple excitations result in zero
+        self.assertEqual(ints.matrix_element(0b00110011, 0b00010011), 0)
+        self.assertEqual(ints.matrix_element(0b00001110, 0b11100000), 0)
+
+    def test_one_body(self):
+        # without two-electron integrals, compare with the N-body operator generated from the one-body Hamiltonian
+        norb, N = 4, 3
+        h, _ = _random_integrals(norb)
+        ints = fermifab.Integrals(h, np.zeros(4*(norb,)))
+        H = ints.hamiltonian(N, tol=1e-14)
+        hspin = fermifab.FermiOp(2*norb, 1, 1, data=np.kron(np.identity(2), h))
+        H_ref = fermifab.p2N(hspin, N)
+        self.assertEqual(H.shape[0], int(binom(2*norb, N)))
+        self.assertAlmostEqual(np.linalg.norm(H.toarray() - H_ref.data), 0, delta=1e-12)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,94 @@
+from itertools import combinations, product
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+def _dets(orbs, N):
+    """Slater determinants as sorted orbital tuples, in the order of the Fermi map (partition 0 fastest)."""
+    offsets = np.cumsum((0,) + tuple(orbs))
+    parts = [sorted(combinations(range(offsets[k], offsets[k + 1]), N[k]), key=lambda c: sum(1 << x for x in c))
+             for k in range(len(orbs))]
+    return [tuple(sorted(sum(t, ()))) for t in product(*reversed(parts))]
+
+
+def _perm_sign(x):
+    """Sign of the permutation sorting the list 'x'."""
+    inv = sum(1 for i in range(len(x)) for j in range(i + 1, len(x)) if x[i] > x[j])
+    return 1 - 2*(inv % 2)
+
+
+def _kernel_ref(orbs, p1, N1, N2):
+    """Dense reference kernel tensor K[a, b, t, d] = <t| a_b^dagger a_a |d> from explicit permutation signs."""
+    p2 = tuple(n1 - n2 + q for n1, n2, q in zip(N1, N2, p1))
+    P1, P2, D1, D2 = _dets(orbs, p1), _dets(orbs, p2), _dets(orbs, N1), _dets(orbs, N2)
+    index1 = {t: i for i, t in enumerate(D1)}
+    K = np.zeros((len(P1), len(P2), len(D1), len(D2)))
+    for i, a in enumerate(P1):
+        for j, b in enumerate(P2):
+            for n, d in enumerate(D2):
+                if not set(a) <= set(d):
+                    continue
+                rest = [x for x in d if x not in a]
+                y = list(b) + rest
+                if len(set(y)) < len(y):
+                    continue
+                t = tuple(sorted(y))
+                if t not in index1:
+                    continue
+                K[i, j, index1[t], n] = _perm_sign(list(a) + rest) * _perm_sign(y)
+    return K
+
+
+def _dense_kernel(dims, val, ind):
+    """Dense kernel tensor from its sparse representation as returned by 'gen_rdm'."""
+    K = np.zeros(dims)
+    for v, i in zip(val, ind):
+        K[tuple(i)] += v
+    return K
+
+
+class TestHolePicture(unittest.TestCase):
+
+    def test_rdm_kernel(self):
+        # more than half-filled partitions are enumerated in the hole picture, and at most half-filled ones directly
+        for orbs, p1, N1, N2 in [((6,), (1,), (4,), (4,)), ((6,), (2,), (5,), (5,)), ((6,), (2,), (4,), (5,)),
+                                 ((6,), (2,), (3,), (2,)), ((4, 3), (1, 0), (3, 1), (3, 1)), ((3, 4), (1, 1), (2, 3), (2, 3)), ((5,), (0,), (5,), (5,))]:
+            dims, val, ind = fermifab.kernel.gen_rdm(orbs, p1, N1, N2)
+            self.assertEqual(np.linalg.norm(_dense_kernel(dims, val, ind) - _kernel_ref(orbs, p1, N1, N2)), 0)
+
+    def test_rdm(self):
+        # compare with the excitation graph evaluation
+        orbs = 7
+        for N, p in [(5, 1), (6, 2), (4, 2)]:
+            data = fermifab.crand(int(binom(orbs, N)))
+            psi = fermifab.FermiState(orbs, N, data=data/np.linalg.norm(data))
+            G = fermifab.rdm(psi, p)
+            G_ref = fermifab.ExcitationGraph(orbs, N).rdm(psi, p)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+
+    def test_tensor_op(self):
+        orbs = 6
+        # complementary minors of the inverse
+        A = np.random.randn(orbs, orbs)
+        B = fermifab.crand(orbs, orbs)
+        # block-diagonal, such that structural zeros must be retained
+        C = np.zeros((orbs, orbs), dtype=complex)
+        C[:3, :3] = fermifab.crand(3, 3)
+        C[3:, 3:] = fermifab.crand(3, 3)
+        # singular matrix: fallback to direct evaluation
+        S = np.random.randn(orbs, 2) @ np.random.randn(2, orbs)
+        S[:, 0] = 0
+        for M in [A, B, C, S]:
+            for N in range(1, orbs + 1):
+                dets = _dets((orbs,), (N,))
+                AN_ref = np.array([[np.linalg.det(M[np.ix_(x, y)]) for y in dets] for x in dets])
+                AN = fermifab.tensor_op(fermifab.FermiOp(orbs, 1, 1, data=M), N).data
+                self.assertAlmostEqual(np.linalg.norm(AN - AN_ref), 0)
+                if M is C:
+                    self.assertEqual(np.count_nonzero(AN), np.count_nonzero(abs(AN_ref) > 1e-14))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,101 @@
+import os
+import tempfile
+import numpy as np
+import fermifab
+import unittest
+
+
+def _random_integrals(norb):
+    """Random one- and two-electron integrals with the 8-fold permutation symmetry of real orbitals."""
+    h = np.random.randn(norb, norb)
+    h = h + h.T
+    v = np.random.randn(norb, norb, norb, norb)
+    v = v + v.transpose(1, 0, 2, 3)
+    v = v + v.transpose(0, 1, 3, 2)
+    v = v + v.transpose(2, 3, 0, 1)
+    return h, v
+
+
+class TestIntegrals(unittest.TestCase):
+
+    def test_packing(self):
+        norb = 5
+        h, v = _random_integrals(norb)
+        ints = fermifab.Integrals(h, v, ecore=0.7)
+        self.assertEqual(len(ints.eri), 120)
+        self.assertEqual(np.linalg.norm(ints.h1_matrix() - h), 0)
+        self.assertEqual(np.linalg.norm(ints.eri_tensor() - v), 0)
+        # canonical order as 'ApplySymmetry': pairs (a <= b) ordered by b, then a
+        canonical = []
+        for d in range(norb):
+            for c in range(d + 1):
+                for b in range(d + 1):
+                    for a in range(b + 1 if b < d else c + 1):
+                        canonical.append((a, b, c, d))
+        self.assertEqual(len(canonical), len(ints.eri))
+        idx = [fermifab.coulomb_index(*x) for x in canonical]
+        self.assertEqual(idx, sorted(idx))
+        self.assertEqual(idx, list(range(len(ints.eri))))
+
+    def test_fcidump(self):
+        norb = 4
+        h, v = _random_integrals(norb)
+        ints = fermifab.Integrals(h, v, ecore=-1.25, nelec=4, ms2=0, isym=1, orbsym=[1, 2, 1, 3])
+        with tempfile.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'FCIDUMP')
+            ints.write_fcidump(filename)
+            # append permuted copies of an integral with Fortran exponent and a line with an orbital energy
+            with open(filename, 'a') as f:
+                f.write('{:.16E} 2 4 1 3\n'.format(v[1, 3, 0, 2]).replace('E', 'D'))
+                f.write('0.5 3 0 0 0\n')
+            ints2 = fermifab.read_fcidump(filename)
+            self.assertEqual((ints2.norb, ints2.nelec, ints2.ms2, ints2.isym), (norb, 4, 0, 1))
+            self.assertEqual(list(ints2.orbsym), [1, 2, 1, 3])
+            self.assertEqual(ints2.ecore, -1.25)
+            self.assertAlmostEqual(np.linalg.norm(ints2.h1_matrix() - h), 0, delta=1e-14)
+            self.assertAlmostEqual(np.linalg.norm(ints2.eri_tensor() - v), 0, delta=1e-13)
+            # unused header keys with non-integer values, as written by other programs
+            with open(filename) as f:
+                content = f.read()
+            with open(filename, 'w') as f:
+                f.write(content.replace('ISYM=1,', 'ISYM=1, UHF=.FALSE., IUHF=0,'))
+            ints3 = fermifab.read_fcidump(filename)
+            self.assertEqual((ints3.norb, ints3.nelec, ints3.isym), (norb, 4, 1))
+            self.assertEqual(np.linalg.norm(ints3.eri - ints2.eri), 0)
+            # invalid file
+            with open(filename, 'w') as f:
+                f.write(' &FCI NORB=2,\n &END\n 1.0 3 1 1 1\n')
+            with self.assertRaises(ValueError):
+                fermifab.read_fcidump(filename)
+
+    def test_binary(self):
+        norb = 6
+        h, v = _random_integrals(norb)
+        ints = fermifab.Integrals(h, v, ecore=3.5, nelec=6, ms2=2, isym=2, orbsym=np.arange(norb) % 2 + 1)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'ints.bin')
+            ints.save(filename)
+            ints2 = fermifab.load_integrals(filename)
+            self.assertEqual((ints2.norb, ints2.nelec, ints2.ms2, ints2.isym, ints2.ecore), (norb, 6, 2, 2, 3.5))
+            self.assertEqual(list(ints2.orbsym), list(ints.orbsym))
+            self.assertEqual(np.linalg.norm(ints2.h1 - ints.h1), 0)
+            self.assertEqual(np.linalg.norm(ints2.eri - ints.eri), 0)
+            self.assertAlmostEqual(ints2.coulomb(3, 1, 5, 2), v[1, 3, 2, 5])
+            # read-only mapping
+            self.assertFalse(ints2.eri.flags.writeable)
+            # views keep the mapping alive
+            eri = ints2.eri
+            del ints2
+            self.assertEqual(np.linalg.norm(eri - ints.eri), 0)
+            del eri
+            # invalid file
+            with open(filename, 'r+b') as f:
+                f.write(b'XX')
+            with self.assertRaises(ValueError):
+                fermifab.load_integrals(filename)
+        with self.assertRaises(OSError):
+            fermifab.load_integrals(os.path.join(tmpdir, 'missing.bin'))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,46 @@
+import numpy as np
+import fermifab
+import unittest
+from test_hole_picture import _dense_kernel
+
+
+class TestRDMHalf(unittest.TestCase):
+
+    def test_kernel(self):
+        # at most half-filled, more than half-filled (hole picture), and several partitions
+        for orbs, p, N in [((6,), (1,), (2,)), ((6,), (2,), (3,)), ((6,), (2,), (5,)), ((7,), (3,), (4,)),
+                           ((4, 3), (1, 1), (2, 1)), ((3, 4), (0, 2), (2, 3)), ((5,), (0,), (3,))]:
+            dims, val, ind = fermifab.kernel.gen_rdm(orbs, p, N, N)
+            dims_half, val_half, ind_half = fermifab.kernel.gen_rdm_half(orbs, p, N)
+            self.assertEqual(dims_half, dims)
+            # only the blocks i <= j are stored
+            self.assertTrue(np.all(ind_half[:, 0] <= ind_half[:, 1]))
+            K = _dense_kernel(dims, val, ind)
+            iu = np.triu_indices(dims[0])
+            self.assertEqual(np.linalg.norm(_dense_kernel(dims, val_half, ind_half)[iu] - K[iu]), 0)
+            ndiag = np.count_nonzero(ind[:, 0] == ind[:, 1])
+            self.assertEqual(len(val_half), (len(val) + ndiag) // 2)
+
+    def test_rdm(self):
+        for orbs, p, N in [(6, 1, 2), (6, 2, 3), (7, 2, 5), (5, 0, 3)]:
+            dims, val, ind = fermifab.kernel.gen_rdm((orbs,), (p,), (N,), (N,))
+            K = _dense_kernel(dims, val, ind)
+            for real_valued in [True, False]:
+                data = np.random.randn(dims[2]) if real_valued else fermifab.crand(dims[2])
+                G = fermifab.rdm(fermifab.FermiState(orbs, N, data=data), p).data
+                G_ref = np.einsum('t,ijtd,d->ij', data.conj(), K, data)
+                self.assertEqual(np.iscomplexobj(G), not real_valued)
+                self.assertAlmostEqual(np.linalg.norm(G - G_ref), 0)
+                self.assertEqual(np.linalg.norm(G - G.conj().T), 0)
+
+    def test_rdm_partitions(self):
+        for orbs, p, N in [((4, 3), (1, 1), (2, 1)), ((3, 4), (1, 0), (2, 3))]:
+            dims, val, ind = fermifab.kernel.gen_rdm(orbs, p, N, N)
+            data = fermifab.crand(dims[2])
+            G = fermifab.kernel.fermi_rdm(orbs, p, N, data)
+            G_ref = np.einsum('t,ijtd,d->ij', data.conj(), _dense_kernel(dims, val, ind), data)
+            self.assertAlmostEqual(np.linalg.norm(G - G_ref), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,44 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestRDMHierarchy(unittest.TestCase):
+
+    def test_partial_trace(self):
+        for orbs, N in [(6, 3), (7, 4), (5, 5)]:
+            for real_valued in [True, False]:
+                n = int(binom(orbs, N))
+                data = np.random.randn(n) if real_valued else fermifab.crand(n)
+                psi = fermifab.FermiState(orbs, N, data=data)
+                for p in range(2, min(N, 3) + 1):
+                    g = fermifab.rdm_partial_trace(fermifab.rdm(psi, p), N)
+                    self.assertEqual((g.pFrom, g.pTo), (p - 1, p - 1))
+                    self.assertEqual(np.iscomplexobj(g.data), not real_valued)
+                    self.assertAlmostEqual(fermifab.norm(g - fermifab.rdm(psi, p - 1)), 0)
+
+    def test_density_matrix(self):
+        # mixed state, compare with the kernel evaluation of the 1-body RDM of the 2-body RDM
+        orbs, N = 6, 3
+        n = int(binom(orbs, N))
+        rho = fermifab.crand(n, n)
+        rho = fermifab.FermiOp(orbs, N, N, data=rho @ rho.conj().T)
+        g2 = fermifab.rdm(rho, 2)
+        self.assertAlmostEqual(fermifab.norm(fermifab.rdm_partial_trace(g2, N) - fermifab.rdm(g2, 1)/(N - 1)), 0)
+
+    def test_hierarchy(self):
+        orbs, N, k = 7, 4, 3
+        psi = fermifab.FermiState(orbs, N, data=fermifab.crand(int(binom(orbs, N))))
+        for state in [psi, fermifab.SparseFermiState.from_dense(psi)]:
+            G = fermifab.rdm_hierarchy(state, k)
+            self.assertEqual(len(G), k)
+            for p in range(1, k + 1):
+                self.assertEqual(G[p - 1].pFrom, p)
+                self.assertAlmostEqual(fermifab.norm(G[p - 1] - fermifab.rdm(psi, p)), 0)
+                # trace equals binomial(N, p) times the squared norm
+                self.assertAlmostEqual(abs(fermifab.trace(G[p - 1]) - binom(N, p)*np.vdot(psi.data, psi.data)), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
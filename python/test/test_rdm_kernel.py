@@ -0,0 +1,34 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+from fermifab.rdm import kernel_expectation
+
+
+class TestRDMKernel(unittest.TestCase):
+
+    def test_rdm(self):
+        # index widths of 1, 2 and 4 bytes
+        for orbs, p, N in [(6, 2, 3), (12, 1, 6), ((8, 8), (1, 1), (3, 2)), (19, 0, 9), (7, 3, 5), ((4, 3), (0, 1), (2, 2))]:
+            K = fermifab.RDMKernel(orbs, p, N)
+            dims, val, ind = fermifab.kernel.gen_rdm(K.orbs, K.p, K.N, K.N)
+            self.assertEqual(K.dims, dims)
+            # substantially smaller than the uncompressed kernel with all blocks
+            self.assertLess(2*K.nbytes, val.nbytes + ind.nbytes)
+            for real_valued in [True, False]:
+                data = np.random.randn(dims[2]) if real_valued else fermifab.crand(dims[2])
+                G = K(data)
+                self.assertEqual(np.iscomplexobj(G), not real_valued)
+                # reference from the uncompressed kernel
+                self.assertAlmostEqual(np.linalg.norm(G - kernel_expectation(dims, val, ind, data)), 0)
+
+    def test_reuse(self):
+        orbs, N = 8, 4
+        K = fermifab.RDMKernel(orbs, 2, N)
+        for _ in range(3):
+            psi = fermifab.FermiState(orbs, N, data=fermifab.crand(int(binom(orbs, N))))
+            self.assertAlmostEqual(np.linalg.norm(K(psi.data) - fermifab.rdm(psi, 2).data), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
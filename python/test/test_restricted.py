@@ -0,0 +1,52 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+from test_symmetry import _embedded_state, _p2N_block
+
+
+class TestRestricted(unittest.TestCase):
+
+    def _reference_dets(self, orbs, N, predicate):
+        coords = fermifab.kernel.fermi2coords((orbs,), (N,))
+        dets = np.bitwise_or.reduce(np.left_shift(np.uint64(1), coords.astype(np.uint64)), axis=1)
+        return np.array([d for d, x in zip(dets, coords) if predicate(set(x))], dtype=np.uint64)
+
+    def _spaces(self):
+        # CISD with default reference, CISDT with reference determinant {0, 2, 5}, and RAS
+        return [(fermifab.excitation_space(7, 3, 2), lambda x: len({0, 1, 2} - x) <= 2),
+                (fermifab.excitation_space(7, 3, 1, ref=(0, 2, 5)), lambda x: len({0, 2, 5} - x) <= 1),
+                (fermifab.ras_space(2, 3, 3, 4, 1, 2),
+                    lambda x: len({0, 1} - x) <= 1 and len(x & {5, 6, 7}) <= 2),
+                (fermifab.RestrictedSpace(8, 4, sections=[(3, 1, 2), (2, 1, 2), (3, 0, 3)], ref=(1, 2, 3, 4), max_exc=2),
+                    lambda x: 1 <= len(x & {0, 1, 2}) <= 2 and 1 <= len(x & {3, 4}) <= 2 and len({1, 2, 3, 4} - x) <= 2)]
+
+    def test_enumeration(self):
+        for space, predicate in self._spaces():
+            ref = self._reference_dets(space.orbs, space.N, predicate)
+            self.assertTrue(np.array_equal(space.dets, ref))
+            self.assertTrue(np.array_equal(space.index(space.dets), np.arange(len(space))))
+            # all other determinants are rejected
+            coords = fermifab.kernel.fermi2coords((space.orbs,), (space.N,))
+            dets = np.bitwise_or.reduce(np.left_shift(np.uint64(1), coords.astype(np.uint64)), axis=1)
+            self.assertEqual(np.count_nonzero(space.index(dets) >= 0), len(space))
+
+    def test_rdm(self):
+        for space, _ in self._spaces():
+            psi, phi = _embedded_state(space.orbs, space.N, space.embedding())
+            for p in [1, 2]:
+                G = space.rdm(psi, p)
+                G_ref = fermifab.rdm(phi, p)
+                self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+
+    def test_p2N(self):
+        for space, _ in self._spaces():
+            idx = space.embedding()
+            for p in [1, 2]:
+                m = int(binom(space.orbs, p))
+                h = fermifab.FermiOp(space.orbs, p, p, data=fermifab.crand(m, m))
+                self.assertAlmostEqual(np.linalg.norm(space.p2N(h).toarray() - _p2N_block(h, space.N, idx)), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,74 @@
+import numpy as np
+import fermifab
+import unittest
+from test_integrals import _random_integrals
+
+
+def _model_integrals(norb, scale=0.1):
+    """Integrals with well-separated orbital energies and weak random couplings."""
+    h, v = _random_integrals(norb)
+    return fermifab.Integrals(np.diag(np.arange(norb, dtype=float)) + 0.5*scale*h, scale*v, ecore=0.5)
+
+
+def _config_dets(norb, Na, Nb):
+    coords = fermifab.kernel.fermi2coords((norb, norb), (Na, Nb)).astype(np.int64)
+    return np.sum(np.left_shift(1, coords), axis=1).astype(np.uint64)
+
+
+class TestSelectedCI(unittest.TestCase):
+
+    def test_selected_hamiltonian(self):
+        norb = 4
+        ints = _model_integrals(norb, scale=1.)
+        H = ints.hamiltonian((2, 1)).toarray()
+        dets = _config_dets(norb, 2, 1)
+        idx = np.sort(np.random.choice(len(dets), 10, replace=False))
+        sci = fermifab.SelectedCI(ints, (2, 1), dets=dets[idx])
+        Hsel = sci.hamiltonian()
+        self.assertAlmostEqual(np.linalg.norm(Hsel.toarray() - H[np.ix_(idx, idx)]), 0, delta=1e-12)
+        # diagonal entry first in each row
+        self.assertTrue(np.all(Hsel.indices[Hsel.indptr[:-1]] == np.arange(len(idx))))
+
+    def test_candidates(self):
+        norb = 4
+        ints = _model_integrals(norb, scale=1.)
+        dets = _config_dets(norb, 2, 2)
+        H = ints.hamiltonian((2, 2)).toarray()
+        idx = np.sort(np.random.choice(len(dets), 6, replace=False))
+        sci = fermifab.SelectedCI(ints, (2, 2), dets=dets[idx])
+        E, c = sci.diagonalize()
+        cand, e2 = sci.candidates()
+        # reference: couplings of the complement
+        rest = np.setdiff1d(np.arange(len(dets)), idx)
+        coupling = H[np.ix_(rest, idx)] @ c
+        keep = np.abs(coupling) > 0
+        self.assertEqual(list(cand), list(dets[rest][keep]))
+        e2_ref = coupling[keep]**2 / (E - np.diag(H)[rest][keep])
+        self.assertAlmostEqual(np.linalg.norm(e2 - e2_ref), 0, delta=1e-12)
+
+    def test_run(self):
+        norb, Na, Nb = 6, 3, 3
+        ints = _model_integrals(norb)
+        H = ints.hamiltonian((Na, Nb)).toarray()
+        w, v = np.linalg.eigh(H)
+        E_fci = w[0]
+        # truncated selection: variational upper bound, improved by the second-order correction
+        sci = fermifab.SelectedCI(ints, (Na, Nb))
+        E, pt2 = sci.run(eps=1e-6, max_dets=40)
+        self.assertEqual(len(sci), 40)
+        self.assertGreater(E, E_fci - 1e-12)
+        self.assertLess(pt2, 0)
+        self.assertLess(abs(E + pt2 - E_fci), abs(E - E_fci))
+        # full selection converges to the full CI ground state
+        sci = fermifab.SelectedCI(ints, Na + Nb)
+        E, pt2 = sci.run(eps=0., grow=3.)
+        self.assertEqual(len(sci), len(H))
+        self.assertAlmostEqual(E, E_fci, delta=1e-10)
+        self.assertAlmostEqual(pt2, 0, delta=1e-12)
+        # one-body reduced density matrix
+        psi = fermifab.SparseFermiState(2*norb, Na + Nb, dets=_config_dets(norb, Na, Nb), data=v[:, 0])
+        self.assertAlmostEqual(np.linalg.norm(sci.rdm(1).data - psi.rdm(1).data), 0, delta=1e-8)
+
+
+if __name__ == '__main__':
+    unittest.main()
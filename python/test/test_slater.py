@@ -0,0 +1,58 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestSlater(unittest.TestCase):
+
+    def _slater_state_err(self, orbs, N, real_valued=True):
+        if real_valued:
+            U, _ = np.linalg.qr(np.random.randn(orbs, orbs))
+        else:
+            U, _ = np.linalg.qr(fermifab.crand(orbs, orbs))
+
+        # Slater determinant of the first N columns of 'U'
+        psi = fermifab.slater_state(U[:, :N])
+
+        # reference: N-fold tensor product applied to the first Slater basis state
+        UN = fermifab.tensor_op(fermifab.FermiOp(orbs, 1, 1, U), N)
+
+        return np.linalg.norm(psi.data - np.asarray(UN.data)[:, 0])
+
+    def test_slater_state(self):
+        self.assertAlmostEqual(self._slater_state_err(7, 3, True),  0)
+        self.assertAlmostEqual(self._slater_state_err(7, 4, False), 0)
+        self.assertAlmostEqual(self._slater_state_err(6, 6, True),  0)
+        self.assertAlmostEqual(self._slater_state_err(6, 1, False), 0)
+
+    def test_slater_state_rank_deficient(self):
+        orbs = 8
+        N = 4
+        C = np.random.randn(orbs, N)
+        # zero rows lead to vanishing pivots
+        C[5] = 0
+        C[2] = 0
+        psi = fermifab.slater_state(C)
+        coords = fermifab.kernel.fermi2coords([orbs], [N])
+        psi_ref = np.array([np.linalg.det(C[x]) for x in coords])
+        self.assertEqual(len(psi), int(binom(orbs, N)))
+        self.assertAlmostEqual(np.linalg.norm(psi.data - psi_ref), 0)
+
+    def _slater_rdm_err(self, orbs, N, p):
+        C = fermifab.crand(orbs, N)
+        psi = fermifab.slater_state(C)
+        psi = psi / fermifab.norm(psi)
+        G_ref = fermifab.rdm(psi, p)
+        err = fermifab.norm(fermifab.slater_rdm(C, p) - G_ref)
+        err += fermifab.norm(fermifab.wick_rdm(fermifab.rdm(psi, 1), p) - G_ref)
+        return err
+
+    def test_slater_rdm(self):
+        self.assertAlmostEqual(self._slater_rdm_err(6, 3, 1), 0)
+        self.assertAlmostEqual(self._slater_rdm_err(6, 3, 2), 0)
+        self.assertAlmostEqual(self._slater_rdm_err(7, 4, 3), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,58 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestSparseState(unittest.TestCase):
+
+    def _random_sparse_state(self, orbs, N, real_valued):
+        n = int(binom(orbs, N))
+        data = np.random.randn(n) if real_valued else fermifab.crand(n)
+        # keep only a few determinants
+        data[np.random.rand(n) < 0.6] = 0
+        data /= np.linalg.norm(data)
+        psi = fermifab.FermiState(orbs, N, data=data)
+        return psi, fermifab.SparseFermiState.from_dense(psi)
+
+    def test_dense_conversion(self):
+        psi, phi = self._random_sparse_state(7, 3, False)
+        self.assertEqual(phi.nnz, np.count_nonzero(psi.data))
+        self.assertAlmostEqual(np.linalg.norm(phi.to_dense().data - psi.data), 0)
+        self.assertAlmostEqual(abs(phi.vdot(phi) - 1), 0)
+        # repeated determinants are combined
+        chi = phi + 2*phi - phi
+        self.assertEqual(chi.nnz, phi.nnz)
+        self.assertAlmostEqual(np.linalg.norm(chi.to_dense().data - 2*psi.data), 0)
+
+    def test_rdm(self):
+        for orbs, N, p, real_valued in [(7, 3, 1, True), (7, 4, 2, False), (6, 3, 3, False), (6, 2, 0, True)]:
+            psi, phi = self._random_sparse_state(orbs, N, real_valued)
+            G_ref = fermifab.rdm(psi, p)
+            G = fermifab.rdm(phi, p)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+
+    def test_apply(self):
+        for orbs, N, p, real_valued in [(7, 3, 1, True), (7, 4, 2, False), (6, 3, 3, False)]:
+            psi, phi = self._random_sparse_state(orbs, N, real_valued)
+            n = int(binom(orbs, p))
+            h = fermifab.FermiOp(orbs, p, p, data=(np.random.randn(n, n) if real_valued else fermifab.crand(n, n)))
+            H = fermifab.p2N(h, N)
+            chi = h @ phi
+            self.assertAlmostEqual(np.linalg.norm(chi.to_dense().data - np.asarray(H.data) @ psi.data), 0)
+
+    def test_slater_pair_rdm(self):
+        for orbs, N, p, real_valued in [(7, 3, 1, True), (7, 4, 2, False), (6, 3, 3, False), (7, 2, 0, True), (8, 6, 2, False)]:
+            psi, phi = self._random_sparse_state(orbs, N, real_valued)
+            G_ref = fermifab.rdm(psi, p)
+            # all pairs (D_n, D_m) with weights c_n conj(c_m)
+            s1, s2 = np.meshgrid(phi.dets, phi.dets, indexing='ij')
+            w = np.outer(phi.data, phi.data.conj())
+            G = fermifab.slater_pair_rdm(orbs, p, s1, s2, w)
+            self.assertAlmostEqual(np.linalg.norm(G.data - G_ref.data), 0)
+            Gs = fermifab.slater_pair_rdm(orbs, p, s1, s2, w, sparse=True)
+            self.assertAlmostEqual(np.linalg.norm(Gs.toarray() - G_ref.data), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,115 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+from test_integrals import _random_integrals
+
+
+class TestStringCI(unittest.TestCase):
+
+    def _embed(self, psi, norb, Na, Nb):
+        # CI vector as state on 2 norb spin orbitals, alpha orbitals first
+        data = np.zeros(int(binom(2*norb, Na + Nb)), dtype=psi.dtype)
+        data[fermifab.kernel.fermi_index(fermifab.string_ci_dets(norb, Na, Nb))] = psi
+        return fermifab.FermiState(2*norb, Na + Nb, data=data)
+
+    def test_dets(self):
+        norb, Na, Nb = 4, 2, 1
+        dets = fermifab.string_ci_dets(norb, Na, Nb)
+        self.assertEqual(len(dets), fermifab.string_ci_dim(norb, Na, Nb))
+        # consistent with the two-partition Slater basis
+        coords = fermifab.kernel.fermi2coords((norb, norb), (Na, Nb))
+        ref = np.bitwise_or.reduce(np.left_shift(np.uint64(1), coords.astype(np.uint64)), axis=1)
+        self.assertTrue(np.array_equal(dets, ref))
+
+    def test_rdm1(self):
+        for norb, Na, Nb, real_valued in [(4, 2, 1, True), (5, 2, 3, False), (3, 0, 2, False)]:
+            n = fermifab.string_ci_dim(norb, Na, Nb)
+            psi = np.random.randn(n) if real_valued else fermifab.crand(n)
+            psi /= np.linalg.norm(psi)
+            Ga, Gb = fermifab.string_ci_rdm1(psi, norb, Na, Nb)
+            G = fermifab.rdm(self._embed(psi, norb, Na, Nb), 1).data
+            self.assertAlmostEqual(np.linalg.norm(Ga.data - G[:norb, :norb]), 0)
+            self.assertAlmostEqual(np.linalg.norm(Gb.data - G[norb:, norb:]), 0)
+            self.assertAlmostEqual(abs(np.trace(Ga.data) - Na), 0)
+            self.assertAlmostEqual(abs(np.trace(Gb.data) - Nb), 0)
+
+    def test_rdm2(self):
+        for norb, Na, Nb, real_valued in [(4, 2, 1, True), (4, 2, 2, False), (3, 0, 2, False), (3, 3, 1, True)]:
+            n = fermifab.string_ci_dim(norb, Na, Nb)
+            psi = np.random.randn(n) if real_valued else fermifab.crand(n)
+            psi /= np.linalg.norm(psi)
+            Gaa, Gab, Gbb = fermifab.string_ci_rdm2(psi, norb, Na, Nb)
+            G = fermifab.rdm(self._embed(psi, norb, Na, Nb), 2).data
+            # pair {p < q} of spin orbitals at index q(q-1)/2 + p
+            pair = lambda p, q: q*(q - 1)//2 + p
+            same = [(i, k) for k in range(norb) for i in range(k)]
+            ia = [pair(i, k) for i, k in same]
+            ib = [pair(norb + i, norb + k) for i, k in same]
+            iab = [pair(i, norb + k) for k in range(norb) for i in range(norb)]
+            self.assertAlmostEqual(np.linalg.norm(Gaa.data - G[np.ix_(ia, ia)]), 0)
+            self.assertAlmostEqual(np.linalg.norm(Gbb.data - G[np.ix_(ib, ib)]), 0)
+            self.assertAlmostEqual(np.linalg.norm(Gab - G[np.ix_(iab, iab)]), 0)
+            # all other entries vanish by spin symmetry
+            self.assertAlmostEqual(np.linalg.norm(G)**2 - np.linalg.norm(Gaa.data)**2 - np.linalg.norm(Gbb.data)**2 - np.linalg.norm(Gab)**2, 0)
+
+    def test_spinfree_rdm(self):
+        norb, Na, Nb = 4, 2, 1
+        h = fermifab.crand(norb, norb)
+        g = fermifab.crand(norb, norb, norb, norb)
+        n = fermifab.string_ci_dim(norb, Na, Nb)
+        psi = fermifab.crand(n)
+        gamma, Gamma = fermifab.string_ci_spinfree_rdm(psi, norb, Na, Nb)
+        self.assertAlmostEqual(abs(np.trace(gamma) - (Na + Nb)*np.vdot(psi, psi)), 0)
+        Ga, Gb = fermifab.string_ci_rdm1(psi, norb, Na, Nb)
+        self.assertAlmostEqual(np.linalg.norm(gamma - (Ga.data + Gb.data).T), 0)
+        energy = np.sum(h * gamma) + 0.5*np.sum(g * Gamma)
+        self.assertAlmostEqual(abs(energy - np.vdot(psi, fermifab.string_ci_sigma(h, g, psi, norb, Na, Nb))), 0)
+
+    def test_sigma(self):
+        for norb, Na, Nb, real_valued in [(3, 2, 1, True), (4, 2, 2, False)]:
+            N = Na + Nb
+            if real_valued:
+                h = np.random.randn(norb, norb)
+                g = np.random.randn(norb, norb, norb, norb)
+            else:
+                h = fermifab.crand(norb, norb)
+                g = fermifab.crand(norb, norb, norb, norb)
+            # reference: E_ij as N-body operators on the spin orbitals
+            E = [[None for j in range(norb)] for i in range(norb)]
+            for i in range(norb):
+                for j in range(norb):
+                    e = np.zeros((2*norb, 2*norb))
+                    e[i, j] = 1
+                    e[norb + i, norb + j] = 1
+                    E[i][j] = fermifab.p2N(fermifab.FermiOp(2*norb, 1, 1, data=e), N).data
+            H = sum(h[i, j] * E[i][j] for i in range(norb) for j in range(norb))
+            for i in range(norb):
+                for j in range(norb):
+                    for k in range(norb):
+                        for l in range(norb):
+                            H = H + 0.5*g[i, j, k, l] * (E[i][j] @ E[k][l] - (j == k) * E[i][l])
+            idx = fermifab.kernel.fermi_index(fermifab.string_ci_dets(norb, Na, Nb))
+            H = H[np.ix_(idx, idx)]
+            n = fermifab.string_ci_dim(norb, Na, Nb)
+            psi = np.random.randn(n) if real_valued else fermifab.crand(n)
+            sigma = fermifab.string_ci_sigma(h, g, psi, norb, Na, Nb)
+            self.assertAlmostEqual(np.linalg.norm(sigma - H @ psi), 0)
+            Hop = fermifab.string_ci_hamiltonian(h, g, norb, Na, Nb)
+            self.assertAlmostEqual(np.linalg.norm(Hop @ psi - H @ psi), 0)
+
+    def test_sigma_blocks(self):
+        # CI space spanning several blocks of excited vectors
+        norb, Na, Nb = 10, 5, 5
+        h, g = _random_integrals(norb)
+        dets = fermifab.string_ci_dets(norb, Na, Nb)
+        psi = np.random.randn(len(dets))
+        psi /= np.linalg.norm(psi)
+        sigma = fermifab.string_ci_sigma(h, g, psi, norb, Na, Nb)
+        k = np.random.randint(len(dets), size=20)
+        ref = fermifab.Integrals(h, g).matrix_block(dets[k], dets) @ psi
+        self.assertAlmostEqual(np.linalg.norm(sigma[k] - ref), 0, delta=1e-10)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,87 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+def _embedded_state(orbs, N, idx):
+    """
+    Random normalized coefficients supported on the base indices `idx`,
+    together with the corresponding `FermiState` w.r.t. all Slater determinants.
+    """
+    psi = fermifab.crand(len(idx))
+    psi /= np.linalg.norm(psi)
+    data = np.zeros(int(binom(orbs, N)), dtype=complex)
+    data[idx] = psi
+    return psi, fermifab.FermiState(orbs, N, data=data)
+
+
+def _p2N_block(h, N, idx):
+    """Block of the N-body operator generated from `h` w.r.t. the base indices `idx`."""
+    return fermifab.p2N(h, N).data[np.ix_(idx, idx)]
+
+
+class TestSymmetry(unittest.TestCase):
+
+    def _symmetries(self, orbs):
+        # D2h-like labels combined by XOR, and momentum-like labels combined by addition
+        return [fermifab.FermiSymmetry(np.arange(orbs) % 4, rule='xor'),
+                fermifab.FermiSymmetry(np.arange(orbs) % 3, order=3, rule='add')]
+
+    def test_sectors(self):
+        orbs, N = 7, 3
+        for sym in self._symmetries(orbs):
+            sectors = sym.sectors(N)
+            self.assertEqual(sum(len(s) for s in sectors), int(binom(orbs, N)))
+            coords = fermifab.kernel.fermi2coords((orbs,), (N,))
+            for s in range(sym.order):
+                for n in sectors[s]:
+                    self.assertEqual(sym.label(coords[n]), s)
+
+    def test_rdm(self):
+        orbs, N = 7, 3
+        for sym in self._symmetries(orbs):
+            sectors = sym.sectors(N)
+            for target in range(sym.order):
+                _, psi = _embedded_state(orbs, N, sectors[target])
+                for p in [1, 2]:
+                    G_ref = fermifab.rdm(psi, p).data
+                    blocks = fermifab.rdm_sym(psi, p, sym, target)
+                    psec = sym.sectors(p)
+                    G = np.zeros_like(G_ref)
+                    for s in range(sym.order):
+                        G[np.ix_(psec[s], psec[s])] = blocks[s]
+                    self.assertAlmostEqual(np.linalg.norm(G - G_ref), 0)
+
+    def test_p2N(self):
+        orbs, N = 6, 3
+        for sym in self._symmetries(orbs):
+            for p in [1, 2]:
+                psec = sym.sectors(p)
+                # operator commuting with the symmetry
+                m = int(binom(orbs, p))
+                hdata = np.zeros((m, m), dtype=complex)
+                for s in range(sym.order):
+                    hdata[np.ix_(psec[s], psec[s])] = fermifab.crand(len(psec[s]), len(psec[s]))
+                h = fermifab.FermiOp(orbs, p, p, data=hdata)
+                sectors = sym.sectors(N)
+                for target in range(sym.order):
+                    Hs = fermifab.p2N_sym(h, N, sym, target).toarray()
+                    self.assertAlmostEqual(np.linalg.norm(Hs - _p2N_block(h, N, sectors[target])), 0)
+
+    def test_tensor_op(self):
+        orbs, N = 7, 3
+        for sym in self._symmetries(orbs):
+            for real_valued in [True, False]:
+                A = np.random.randn(orbs, orbs) if real_valued else fermifab.crand(orbs, orbs)
+                A[sym.labels[:, None] != sym.labels[None, :]] = 0
+                op = fermifab.FermiOp(orbs, 1, 1, data=A)
+                AN = fermifab.tensor_op(op, N).data
+                sectors = sym.sectors(N)
+                blocks = fermifab.tensor_op_sym(op, N, sym)
+                for s in range(sym.order):
+                    self.assertAlmostEqual(np.linalg.norm(blocks[s].toarray() - AN[np.ix_(sectors[s], sectors[s])]), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
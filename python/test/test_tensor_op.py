@@ -32,6 +32,57 @@ class TestTensorOp(unittest.TestCase):
         err = self._tensor_op_err(orbs, p, N)
         self.assertAlmostEqual(err, 0)
 
+    def test_tensor_op_diag(self):
+        orbs = 7
+        for N in range(orbs + 1):
+            A = fermifab.FermiOp(orbs, 1, 1, np.random.randn(orbs, orbs))
+            # enforce some zero pivots
+            A.data[2, 2] = 0
+            A.data[5, 5] = 0
+            B = fermifab.FermiOp(orbs, 1, 1, fermifab.crand(orbs, orbs))
+            for op in [A, B]:
+                d = fermifab.tensor_op_diag(op, N)
+                d_ref = np.diag(fermifab.tensor_op(op, N).data) if N > 0 else np.ones(1)
+                self.assertAlmostEqual(np.linalg.norm(d - d_ref), 0)
+
+    def test_tensor_op_trace(self):
+        orbs = 6
+        A = fermifab.FermiOp(orbs, 1, 1, fermifab.crand(orbs, orbs))
+        tr = fermifab.tensor_op_trace(A)
+        err = abs(tr[0] - 1)
+        for N in range(1, orbs + 1):
+            err += abs(tr[N] - fermifab.trace(fermifab.tensor_op(A, N)))
+        self.assertAlmostEqual(err, 0)
+
+    def test_tensor_op_eigvals(self):
+        orbs = 7
+        N = 3
+        H = fermifab.crand(orbs, orbs)
+        A = fermifab.FermiOp(orbs, 1, 1, H + H.conj().T)
+        ev_ref = np.linalg.eigvalsh(fermifab.tensor_op(A, N).data)
+        ev_ref = ev_ref[np.argsort(-abs(ev_ref))]
+        ev = fermifab.tensor_op_eigvals(A, N)
+        self.assertAlmostEqual(np.linalg.norm(abs(ev) - abs(ev_ref)), 0)
+        # partial spectrum
+        k = 5
+        ev = fermifab.tensor_op_eigvals(A, N, k)
+        self.assertEqual(len(ev), k)
+        self.assertAlmostEqual(np.linalg.norm(ev - ev_ref[:k]), 0)
+
+    def test_grand_partition(self):
+        orbs = 5
+        beta = 0.7
+        mu = 0.3
+        H = fermifab.crand(orbs, orbs)
+        h = fermifab.FermiOp(orbs, 1, 1, H + H.conj().T)
+        Z, ZN = fermifab.grand_partition(h, beta, mu)
+        Z_ref = 0
+        for N in range(orbs + 1):
+            E = np.linalg.eigvalsh(fermifab.p2N(h, N).data) if N > 0 else np.zeros(1)
+            self.assertAlmostEqual(ZN[N], np.sum(np.exp(-beta*E)))
+            Z_ref += np.sum(np.exp(-beta*(E - mu*N)))
+        self.assertAlmostEqual(Z, Z_ref)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,61 @@
+from scipy.special import binom
+import numpy as np
+import fermifab
+import unittest
+
+
+class TestTransform(unittest.TestCase):
+
+    def _perm_matrix(self, sigma):
+        P = np.zeros((len(sigma), len(sigma)))
+        P[sigma, np.arange(len(sigma))] = 1
+        return P
+
+    def test_perm_orbitals(self):
+        orbs = 7
+        sigma = np.random.permutation(orbs)
+        for N in [1, 3, 4, 7]:
+            # reference: N-fold tensor product of the single-particle permutation
+            U = fermifab.tensor_op(fermifab.FermiOp(orbs, 1, 1, data=self._perm_matrix(sigma)), N).data
+            psi = fermifab.FermiState(orbs, N, data=fermifab.crand(int(binom(orbs, N))))
+            chi = fermifab.perm_orbitals(psi, sigma)
+            self.assertAlmostEqual(np.linalg.norm(chi.data - U @ psi.data), 0)
+            fermifab.perm_orbitals(psi, sigma, inplace=True)
+            self.assertAlmostEqual(np.linalg.norm(chi.data - psi.data), 0)
+        # operators
+        N = 3
+        n = int(binom(orbs, N))
+        U = fermifab.tensor_op(fermifab.FermiOp(orbs, 1, 1, data=self._perm_matrix(sigma)), N).data
+        A = fermifab.FermiOp(orbs, N, N, data=np.random.randn(n, n))
+        B = fermifab.perm_orbitals(A, sigma)
+        self.assertAlmostEqual(np.linalg.norm(B.data - U @ A.data @ U.T), 0)
+        # consistent with the reduced density matrix
+        psi = fermifab.FermiState(orbs, N, data=fermifab.crand(n))
+        G = fermifab.rdm(psi, 1).data
+        G1 = fermifab.rdm(fermifab.perm_orbitals(psi, sigma), 1).data
+        P = self._perm_matrix(sigma)
+        self.assertAlmostEqual(np.linalg.norm(G1 - P @ G @ P.T), 0)
+
+    def test_particle_hole(self):
+        orbs = 6
+        for N in [1, 2, 4]:
+            psi = fermifab.FermiState(orbs, N, data=fermifab.crand(int(binom(orbs, N))))
+            psi.data /= np.linalg.norm(psi.data)
+            chi = fermifab.particle_hole(psi)
+            self.assertEqual(chi.N, orbs - N)
+            # one-body reduced density matrix of the holes
+            G = fermifab.rdm(psi, 1).data
+            H = fermifab.rdm(chi, 1).data
+            self.assertAlmostEqual(np.linalg.norm(H - (np.identity(orbs) - G.T)), 0)
+            # conjugating twice yields the original state up to a global sign
+            phi = fermifab.particle_hole(chi)
+            self.assertAlmostEqual(np.linalg.norm(phi.data - (-1)**(N*(orbs - N)) * psi.data), 0)
+            # operators transform consistently
+            n = len(psi.data)
+            A = fermifab.FermiOp(orbs, N, N, data=fermifab.crand(n, n))
+            B = fermifab.particle_hole(A)
+            self.assertAlmostEqual(abs(np.vdot(chi.data, B.data @ chi.data) - np.vdot(psi.data, A.data @ psi.data)), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()